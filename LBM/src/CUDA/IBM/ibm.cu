@@ -14,7 +14,8 @@ void immersedBoundaryMethod(
     cudaStream_t streamLBM[N_GPUS],
     cudaStream_t streamIBM[N_GPUS],
     unsigned int step,
-    ParticleEulerNodesUpdate* pEulerNodes
+    ParticleEulerNodesUpdate* pEulerNodes,
+    IBMBorderBuffers border[N_GPUS]
     )
 {
     // TODO: Update kernels to multi GPU
@@ -25,6 +26,12 @@ void immersedBoundaryMethod(
         particles.pCenterArray);
     checkCudaErrors(cudaStreamSynchronize(streamIBM[0]));
 
+    #if IBM_BORDER_PACK
+    // Footprint of the stencils in the ghost planes, concurrent with the
+    // macroscopics update
+    ibmBorderBoxesUpdate(border, particles.nodesSoA, streamIBM);
+    #endif
+
     // Grid for only  z-borders
     dim3 copyMacrGrid = gridLBM;
     // Grid for full domain, including z-borders
@@ -71,14 +78,22 @@ void immersedBoundaryMethod(
     }
     #endif
 
+    #if IBM_BORDER_PACK
+    // Copy macroscopics of the boxes in the borders, concurrent with the 
+    // particles kernels
+    ibmBorderCopyMacr(border, macr, streamLBM);
+    #endif
 
     for(int i = 0; i < N_GPUS; i++){
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
-        int nxt = (i+1) % N_GPUS;
+        #if !IBM_BORDER_PACK
+        // IBM is only used with z slabs (DECOMP_SLABS_ONLY)
+        int nxt = decompShift(i, 0, 0, 1);
         // Copy macroscopics
         gpuCopyBorderMacr<<<copyMacrGrid, threadsLBM, 0, streamLBM[i]>>>(macr[i], macr[nxt]);
         checkCudaErrors(cudaStreamSynchronize(streamLBM[i]));
         getLastCudaError("Copy macroscopics border error\n");
+        #endif
         // If GPU has nodes in it
         if(particles.nodesSoA[i].numNodes > 0){
             // Reset forces in all IBM nodes;
@@ -107,27 +122,52 @@ void immersedBoundaryMethod(
             // If GPU has nodes in it
             if(particles.nodesSoA[j].numNodes > 0){
                 checkCudaErrors(cudaSetDevice(GPUS_TO_USE[j]));
+                #if IBM_BORDER_PACK
+                // Macroscopics and particles centers must be updated
+                checkCudaErrors(cudaStreamWaitEvent(streamIBM[j], border[j].macrDone, 0));
+                checkCudaErrors(cudaStreamWaitEvent(streamIBM[j], border[0].centersDone, 0));
+                #endif
                 // Make the interpolation of LBM and spreading of IBM forces
                 gpuForceInterpolationSpread<<<gridNodesIBM[j], threadsNodesIBM[j], 
                     0, streamIBM[j]>>>(
                     particles.nodesSoA[j], particles.pCenterArray, macr[j], ibmMacrsAux, j);
+                #if !IBM_BORDER_PACK
                 checkCudaErrors(cudaStreamSynchronize(streamIBM[j]));
+                #endif
                 getLastCudaError("IBM interpolation spread error\n");
             }
+            #if IBM_BORDER_PACK
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[j]));
+            checkCudaErrors(cudaEventRecord(border[j].spreadDone, streamIBM[j]));
+            #endif
         }
 
+        #if IBM_BORDER_PACK
+        // Sum border macroscopics, concurrent with the update of the particles
+        // centers, that waits the spread of all GPUs
+        ibmBorderSumAux(border, macr, ibmMacrsAux, streamLBM);
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
+        for(int j = 0; j < N_GPUS; j++)
+            checkCudaErrors(cudaStreamWaitEvent(streamIBM[0], border[j].spreadDone, 0));
+        #endif
+
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
         // Update particle velocity using body center force and constant forces
         gpuUpdateParticleCenterVelocityAndRotation<<<GRID_PARTICLES_IBM, THREADS_PARTICLES_IBM, 0, streamIBM[0]>>>(
             particles.pCenterArray);
+        #if IBM_BORDER_PACK
+        checkCudaErrors(cudaEventRecord(border[0].centersDone, streamIBM[0]));
+        #else
         checkCudaErrors(cudaStreamSynchronize(streamIBM[0]));
+        #endif
         getLastCudaError("IBM update particle center velocity error\n");
 
+        #if !IBM_BORDER_PACK
         // Sum border macroscopics
         for(int j = 0; j < N_GPUS; j++){
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[j]));
-            int nxt = (j+1) % N_GPUS;
-            int prv = (j-1+N_GPUS) % N_GPUS;
+            int nxt = decompShift(j, 0, 0, 1);
+            int prv = decompShift(j, 0, 0, -1);
             bool run_nxt = nxt != 0;
             bool run_prv = prv != (N_GPUS-1);
             #ifdef IBM_BC_Z_PERIODIC
@@ -145,6 +185,7 @@ void immersedBoundaryMethod(
             }
             getLastCudaError("Sum border macroscopics error\n");
         }
+        #endif
 
         #if IBM_EULER_OPTIMIZATION
 
@@ -154,7 +195,9 @@ void immersedBoundaryMethod(
                 dim3 currGrid(pEulerNodes->currEulerNodes[j]/64+(pEulerNodes->currEulerNodes[j]%64? 1 : 0), 1, 1);
                 gpuEulerSumIBMAuxsReset<<<currGrid, 64, 0, streamLBM[j]>>>(macr[j], ibmMacrsAux,
                     pEulerNodes->eulerIndexesUpdate[j], pEulerNodes->currEulerNodes[j], j);
+                #if !IBM_BORDER_PACK
                 checkCudaErrors(cudaStreamSynchronize(streamLBM[j]));
+                #endif
                 getLastCudaError("IBM sum auxiliary values error\n");
             }
         }
@@ -162,7 +205,17 @@ void immersedBoundaryMethod(
         for(int j = 0; j < N_GPUS; j++){
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[j]));
             gpuEulerSumIBMAuxsReset<<<borderMacrGrid, threadsLBM, 0, streamLBM[j]>>>(macr[j], ibmMacrsAux, j);
+            #if !IBM_BORDER_PACK
             checkCudaErrors(cudaStreamSynchronize(streamLBM[j]));
+            #endif
+        }
+        #endif
+
+        #if IBM_BORDER_PACK
+        // Macroscopics ready for the interpolation of next iteration
+        for(int j = 0; j < N_GPUS; j++){
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[j]));
+            checkCudaErrors(cudaEventRecord(border[j].macrDone, streamLBM[j]));
         }
         #endif
 
@@ -187,6 +240,15 @@ void immersedBoundaryMethod(
         }
     }
 
+    #if IBM_BORDER_PACK
+    // Sum of borders and reset of auxiliary values
+    for(int i = 0; i < N_GPUS; i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaStreamSynchronize(streamLBM[i]));
+    }
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
+    #endif
+
     checkCudaErrors(cudaDeviceSynchronize());
 }
 
@@ -574,39 +636,8 @@ void gpuUpdateMacrIBM(Populations pop, Macroscopics macr, IBMMacrsAux ibmMacrsAu
     // ux = sum(f[i]*cx[i] + Fx/2) / rho
     // uy = sum(f[i]*cy[i] + Fy/2) / rho
     // uz = sum(f[i]*cz[i] + Fz/2) / rho
-#ifdef D3Q19
-    const dfloat rhoVar = fNode[0] + fNode[1] + fNode[2] + fNode[3] + fNode[4] 
-        + fNode[5] + fNode[6] + fNode[7] + fNode[8] + fNode[9] + fNode[10] 
-        + fNode[11] + fNode[12] + fNode[13] + fNode[14] + fNode[15] + fNode[16] 
-        + fNode[17] + fNode[18];
-    const dfloat invRho = 1 / rhoVar;
-    const dfloat uxVar = ((fNode[1] + fNode[7] + fNode[9] + fNode[13] + fNode[15]) 
-    - (fNode[2] + fNode[8] + fNode[10] + fNode[14] + fNode[16]) + 0.5 * f.x) * invRho;
-    const dfloat uyVar = ((fNode[3] + fNode[7] + fNode[11] + fNode[14] + fNode[17])
-     - (fNode[4] + fNode[8] + fNode[12] + fNode[13] + fNode[18]) + 0.5 * f.y) * invRho;
-    const dfloat uzVar = ((fNode[5] + fNode[9] + fNode[11] + fNode[16] + fNode[18])
-     - (fNode[6] + fNode[10] + fNode[12] + fNode[15] + fNode[17]) + 0.5 * f.z) * invRho;
-#endif // !D3Q19
-#ifdef D3Q27
-    const dfloat rhoVar = fNode[0] + fNode[1] + fNode[2] + fNode[3] + fNode[4] 
-        + fNode[5] + fNode[6] + fNode[7] + fNode[8] + fNode[9] + fNode[10] 
-        + fNode[11] + fNode[12] + fNode[13] + fNode[14] + fNode[15] + fNode[16] 
-        + fNode[17] + fNode[18] + fNode[19] + fNode[20] + fNode[21] + fNode[22] 
-        + fNode[23] + fNode[24] + fNode[25] + fNode[26];
-    const dfloat invRho = 1 / rhoVar;
-    const dfloat uxVar = ((fNode[1] + fNode[7] + fNode[9] + fNode[13] + fNode[15] 
-        + fNode[19] + fNode[21] + fNode[23] + fNode[26]) 
-        - (fNode[2] + fNode[8] + fNode[10] + fNode[14] + fNode[16] + fNode[20] 
-        + fNode[22] + fNode[24] + fNode[25]) + 0.5 * f.x) * invRho;
-    const dfloat uyVar = ((fNode[3] + fNode[7] + fNode[11] + fNode[14] + fNode[17]
-        + fNode[19] + fNode[21] + fNode[24] + fNode[25]) 
-        - (fNode[4] + fNode[8] + fNode[12] + fNode[13] + fNode[18] + fNode[20] 
-        + fNode[22] + fNode[23] + fNode[26]) + 0.5 * f.y) * invRho;
-    const dfloat uzVar = ((fNode[5] + fNode[9] + fNode[11] + fNode[16] + fNode[18]
-        + fNode[19] + fNode[22] + fNode[23] + fNode[25]) 
-        - (fNode[6] + fNode[10] + fNode[12] + fNode[15] + fNode[17] + fNode[20] 
-        + fNode[21] + fNode[24] + fNode[26]) + 0.5 * f.z) * invRho;
-#endif // !D3Q27
+    dfloat rhoVar, uxVar, uyVar, uzVar;
+    popMacroscopics(fNode, f.x, f.y, f.z, rhoVar, uxVar, uyVar, uzVar);
 
     macr.rho[idx] = rhoVar;
     macr.u.x[idx] = uxVar;
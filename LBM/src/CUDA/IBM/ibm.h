@@ -24,6 +24,7 @@
 #include "structs/particleEulerNodesUpdate.h"
 #include "ibmReport.h"
 #include "collision/ibmCollision.h"
+#include "ibmBorderPack.h"
 
 /**
 *   @brief Run immersed boundary method (IBM)
@@ -38,6 +39,8 @@
 *   @param streamIBM: IBM CUDA streams for GPUs
 *   @param step: current time step
 *   @param pEulerNodes: euler nodes (from LBM) that are used
+*   @param border[N_GPUS]: packed buffers of the borders of each GPU 
+*                          (only if IBM_BORDER_PACK is true)
 */
 __host__
 void immersedBoundaryMethod(
@@ -50,7 +53,8 @@ void immersedBoundaryMethod(
     cudaStream_t streamLBM[N_GPUS],
     cudaStream_t streamIBM[N_GPUS],
     unsigned int step,
-    ParticleEulerNodesUpdate* pEulerNodes
+    ParticleEulerNodesUpdate* pEulerNodes,
+    IBMBorderBuffers border[N_GPUS]
 );
 
 
@@ -0,0 +1,393 @@
+#include "ibmBorderPack.h"
+
+#ifdef IBM
+
+
+__host__
+void ibmBorderBuffersAllocation(IBMBorderBuffers border[N_GPUS])
+{
+    // Full planes of the side, for the fields of the sum (the most)
+    const size_t maxCount = (size_t)IBM_BORDER_AUX_FIELDS*NX*NY*MACR_BORDER_NODES;
+    for(int i = 0; i < N_GPUS; i++){
+        IBMBorderBuffers* b = &border[i];
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        for(int s = 0; s < 2; s++){
+            b->send[s] = (dfloat*)simMalloc(sizeof(dfloat)*maxCount, IN_VIRTUAL);
+            b->recv[s] = (dfloat*)simMalloc(sizeof(dfloat)*maxCount, IN_VIRTUAL);
+        }
+        b->boxExtent = (int*)simMalloc(sizeof(int)*8, IN_VIRTUAL);
+        b->boxExtentHost = (int*)simMalloc(sizeof(int)*8, IN_HOST);
+        checkCudaErrors(cudaEventCreateWithFlags(&(b->boxDone), cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(b->copyDone), cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(b->unpackDone), cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(b->macrDone), cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(b->spreadDone), cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(b->centersDone), cudaEventDisableTiming));
+    }
+}
+
+
+__host__
+void ibmBorderBuffersFree(IBMBorderBuffers border[N_GPUS])
+{
+    for(int i = 0; i < N_GPUS; i++){
+        IBMBorderBuffers* b = &border[i];
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        for(int s = 0; s < 2; s++){
+            simFree(b->send[s], IN_VIRTUAL);
+            simFree(b->recv[s], IN_VIRTUAL);
+            b->send[s] = nullptr;
+            b->recv[s] = nullptr;
+        }
+        simFree(b->boxExtent, IN_VIRTUAL);
+        simFree(b->boxExtentHost, IN_HOST);
+        b->boxExtent = nullptr;
+        b->boxExtentHost = nullptr;
+        checkCudaErrors(cudaEventDestroy(b->boxDone));
+        checkCudaErrors(cudaEventDestroy(b->copyDone));
+        checkCudaErrors(cudaEventDestroy(b->unpackDone));
+        checkCudaErrors(cudaEventDestroy(b->macrDone));
+        checkCudaErrors(cudaEventDestroy(b->spreadDone));
+        checkCudaErrors(cudaEventDestroy(b->centersDone));
+    }
+}
+
+
+__global__
+void gpuIBMBorderBoxes(
+    ParticleNodeSoA particlesNodes,
+    int* const boxExtent,
+    const int n_gpu)
+{
+    const unsigned int i = threadIdx.x + blockDim.x * blockIdx.x;
+
+    if (i >= particlesNodes.numNodes)
+        return;
+
+    // Same base position as in gpuForceInterpolationSpread
+    const int posBase[3] = {
+        int(particlesNodes.pos.x[i]) - (P_DIST) + 1,
+        int(particlesNodes.pos.y[i]) - (P_DIST) + 1,
+        int(particlesNodes.pos.z[i]) - (P_DIST) + 1 - NZ*n_gpu
+    };
+    // Stencil reaches ghost planes of each side
+    const bool side[2] = {posBase[2] < 0, posBase[2]+P_DIST*2 > NZ};
+    if(!side[IBM_BORDER_BACK] && !side[IBM_BORDER_FRONT])
+        return;
+
+    int x0 = posBase[0], x1 = posBase[0]+P_DIST*2-1;
+    int y0 = posBase[1], y1 = posBase[1]+P_DIST*2-1;
+    // Stencils crossing the periodic boundaries wrap around, so the whole
+    // row is used
+    #ifdef IBM_BC_X_PERIODIC
+    if(x0 < IBM_BC_X_0 || x1 >= IBM_BC_X_E){
+        x0 = 0;
+        x1 = NX-1;
+    }
+    #endif //IBM_BC_X_PERIODIC
+    #ifdef IBM_BC_Y_PERIODIC
+    if(y0 < IBM_BC_Y_0 || y1 >= IBM_BC_Y_E){
+        y0 = 0;
+        y1 = NY-1;
+    }
+    #endif //IBM_BC_Y_PERIODIC
+    x0 = max(x0, 0);
+    y0 = max(y0, 0);
+    x1 = min(x1, (int)NX-1);
+    y1 = min(y1, (int)NY-1);
+
+    for(int s = 0; s < 2; s++){
+        if(!side[s])
+            continue;
+        atomicMax(&boxExtent[4*s+0], -x0);
+        atomicMax(&boxExtent[4*s+1], -y0);
+        atomicMax(&boxExtent[4*s+2], x1);
+        atomicMax(&boxExtent[4*s+3], y1);
+    }
+}
+
+
+/*
+*   @brief Scalar index of a value of the buffer, for the planes of box
+*          starting at z0
+*   @param box: box of buffer
+*   @param z0: first plane of box
+*   @param idx: value index in field of buffer
+*   @return scalar index with border (idxScalarWBorder)
+*/
+__device__ __forceinline__
+size_t ibmBorderIndex(const IBMBorderBox& box, const int z0, const size_t idx)
+{
+    const int x = box.x0 + idx % box.nx;
+    const int y = box.y0 + (idx / box.nx) % box.ny;
+    const int z = z0 + idx / ((size_t)box.nx*box.ny);
+    return idxScalarWBorder(x, y, z);
+}
+
+
+__global__
+void gpuIBMBorderPackMacr(
+    Macroscopics macr,
+    dfloat* const buffer,
+    const IBMBorderBox box,
+    const int z0)
+{
+    const size_t count = (size_t)box.nx*box.ny*MACR_BORDER_NODES;
+    const size_t i = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(i >= count)
+        return;
+
+    const size_t idx = ibmBorderIndex(box, z0, i);
+    buffer[i] = macr.rho[idx];
+    buffer[count+i] = macr.u.x[idx];
+    buffer[2*count+i] = macr.u.y[idx];
+    buffer[3*count+i] = macr.u.z[idx];
+}
+
+
+__global__
+void gpuIBMBorderUnpackMacr(
+    Macroscopics macr,
+    const dfloat* const buffer,
+    const IBMBorderBox box,
+    const int z0)
+{
+    const size_t count = (size_t)box.nx*box.ny*MACR_BORDER_NODES;
+    const size_t i = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(i >= count)
+        return;
+
+    const size_t idx = ibmBorderIndex(box, z0, i);
+    macr.rho[idx] = buffer[i];
+    macr.u.x[idx] = buffer[count+i];
+    macr.u.y[idx] = buffer[2*count+i];
+    macr.u.z[idx] = buffer[3*count+i];
+}
+
+
+__global__
+void gpuIBMBorderPackAux(
+    IBMMacrsAux ibmMacrsAux,
+    const int n_gpu,
+    dfloat* const buffer,
+    const IBMBorderBox box,
+    const int z0)
+{
+    const size_t count = (size_t)box.nx*box.ny*MACR_BORDER_NODES;
+    const size_t i = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(i >= count)
+        return;
+
+    const size_t idx = ibmBorderIndex(box, z0, i);
+    buffer[i] = ibmMacrsAux.velAux[n_gpu].x[idx];
+    buffer[count+i] = ibmMacrsAux.velAux[n_gpu].y[idx];
+    buffer[2*count+i] = ibmMacrsAux.velAux[n_gpu].z[idx];
+    buffer[3*count+i] = ibmMacrsAux.fAux[n_gpu].x[idx];
+    buffer[4*count+i] = ibmMacrsAux.fAux[n_gpu].y[idx];
+    buffer[5*count+i] = ibmMacrsAux.fAux[n_gpu].z[idx];
+}
+
+
+__global__
+void gpuIBMBorderUnpackSum(
+    Macroscopics macr,
+    const dfloat* const buffer,
+    const IBMBorderBox box,
+    const int z0)
+{
+    const size_t count = (size_t)box.nx*box.ny*MACR_BORDER_NODES;
+    const size_t i = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(i >= count)
+        return;
+
+    const size_t idx = ibmBorderIndex(box, z0, i);
+    // Sum velocities
+    macr.u.x[idx] += buffer[i];
+    macr.u.y[idx] += buffer[count+i];
+    macr.u.z[idx] += buffer[2*count+i];
+    // Sum forces
+    macr.f.x[idx] += buffer[3*count+i];
+    macr.f.y[idx] += buffer[4*count+i];
+    macr.f.z[idx] += buffer[5*count+i];
+}
+
+
+/*
+*   @brief Neighbor GPU of side
+*   @param n_gpu: GPU number
+*   @param side: IBM_BORDER_BACK or IBM_BORDER_FRONT
+*   @return neighbor GPU number
+*/
+__host__
+static int ibmBorderNeighbor(const int n_gpu, const int side)
+{
+    // IBM is only used with z slabs (DECOMP_SLABS_ONLY)
+    return decompShift(n_gpu, 0, 0, side == IBM_BORDER_FRONT ? 1 : -1);
+}
+
+
+/*
+*   @brief Number of blocks of the border kernels for box
+*   @param box: box of kernel
+*   @return number of blocks (0 if box is empty)
+*/
+__host__
+static unsigned int ibmBorderBlocks(const IBMBorderBox& box)
+{
+    const size_t count = (size_t)box.nx*box.ny*MACR_BORDER_NODES;
+    return (unsigned int)((count+IBM_BORDER_THREADS-1)/IBM_BORDER_THREADS);
+}
+
+
+__host__
+void ibmBorderBoxesUpdate(
+    IBMBorderBuffers border[N_GPUS],
+    ParticleNodeSoA nodesSoA[N_GPUS],
+    cudaStream_t streams[N_GPUS])
+{
+    for(int i = 0; i < N_GPUS; i++){
+        IBMBorderBuffers* b = &border[i];
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        // Bytes of 0x80 are a large negative value, so any node sets them
+        checkCudaErrors(cudaMemsetAsync(b->boxExtent, 0x80, sizeof(int)*8, streams[i]));
+        const unsigned int numNodes = nodesSoA[i].numNodes;
+        if(numNodes > 0){
+            const unsigned int nBlocks = (numNodes+IBM_BORDER_THREADS-1)/IBM_BORDER_THREADS;
+            gpuIBMBorderBoxes<<<nBlocks, IBM_BORDER_THREADS, 0, streams[i]>>>(
+                nodesSoA[i], b->boxExtent, i);
+            getLastCudaError("IBM border boxes error\n");
+        }
+        checkCudaErrors(cudaMemcpyAsync(b->boxExtentHost, b->boxExtent, sizeof(int)*8,
+            cudaMemcpyDeviceToHost, streams[i]));
+        checkCudaErrors(cudaEventRecord(b->boxDone, streams[i]));
+    }
+}
+
+
+__host__
+void ibmBorderCopyMacr(
+    IBMBorderBuffers border[N_GPUS],
+    Macroscopics* macr,
+    cudaStream_t streams[N_GPUS])
+{
+    // Boxes of each side, from the extents of the nodes
+    for(int i = 0; i < N_GPUS; i++){
+        IBMBorderBuffers* b = &border[i];
+        checkCudaErrors(cudaEventSynchronize(b->boxDone));
+        for(int s = 0; s < 2; s++){
+            const int* ext = &(b->boxExtentHost[4*s]);
+            b->box[s].x0 = -ext[0];
+            b->box[s].y0 = -ext[1];
+            b->box[s].nx = ext[2]+ext[0]+1;
+            b->box[s].ny = ext[3]+ext[1]+1;
+            // No nodes in side
+            if(b->box[s].nx <= 0 || b->box[s].ny <= 0)
+                b->box[s] = {0, 0, 0, 0};
+        }
+    }
+
+    // Pack the planes next to the neighbor, in the box of its ghost planes,
+    // and copy to it
+    for(int i = 0; i < N_GPUS; i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        for(int s = 0; s < 2; s++){
+            const int dst = ibmBorderNeighbor(i, s);
+            const IBMBorderBox box = border[dst].box[1-s];
+            const unsigned int nBlocks = ibmBorderBlocks(box);
+            if(nBlocks == 0)
+                continue;
+            const int z0 = (s == IBM_BORDER_FRONT) ? NZ-MACR_BORDER_NODES : 0;
+            gpuIBMBorderPackMacr<<<nBlocks, IBM_BORDER_THREADS, 0, streams[i]>>>(
+                macr[i], border[i].send[s], box, z0);
+            getLastCudaError("IBM border pack macroscopics error\n");
+            // Receive buffer of neighbor already unpacked
+            checkCudaErrors(cudaStreamWaitEvent(streams[i], border[dst].unpackDone, 0));
+            checkCudaErrors(cudaMemcpyPeerAsync(border[dst].recv[1-s], GPUS_TO_USE[dst],
+                border[i].send[s], GPUS_TO_USE[i],
+                sizeof(dfloat)*IBM_BORDER_MACR_FIELDS*box.nx*box.ny*MACR_BORDER_NODES,
+                streams[i]));
+        }
+        checkCudaErrors(cudaEventRecord(border[i].copyDone, streams[i]));
+    }
+
+    // Unpack to the ghost planes after the neighbors copied to this GPU
+    for(int i = 0; i < N_GPUS; i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        for(int s = 0; s < 2; s++){
+            const int src = ibmBorderNeighbor(i, s);
+            const IBMBorderBox box = border[i].box[s];
+            const unsigned int nBlocks = ibmBorderBlocks(box);
+            if(nBlocks == 0)
+                continue;
+            const int z0 = (s == IBM_BORDER_FRONT) ? NZ : -MACR_BORDER_NODES;
+            checkCudaErrors(cudaStreamWaitEvent(streams[i], border[src].copyDone, 0));
+            gpuIBMBorderUnpackMacr<<<nBlocks, IBM_BORDER_THREADS, 0, streams[i]>>>(
+                macr[i], border[i].recv[s], box, z0);
+            getLastCudaError("IBM border unpack macroscopics error\n");
+        }
+        checkCudaErrors(cudaEventRecord(border[i].unpackDone, streams[i]));
+        checkCudaErrors(cudaEventRecord(border[i].macrDone, streams[i]));
+    }
+}
+
+
+__host__
+void ibmBorderSumAux(
+    IBMBorderBuffers border[N_GPUS],
+    Macroscopics* macr,
+    IBMMacrsAux ibmMacrsAux,
+    cudaStream_t streams[N_GPUS])
+{
+    // Pack the ghost planes of each side and copy to the neighbor. The
+    // macroscopics of the GPU are only changed after its spread is done
+    for(int i = 0; i < N_GPUS; i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaStreamWaitEvent(streams[i], border[i].spreadDone, 0));
+        for(int s = 0; s < 2; s++){
+            const int dst = ibmBorderNeighbor(i, s);
+            bool run = (s == IBM_BORDER_FRONT) ? (dst != 0) : (dst != N_GPUS-1);
+            #ifdef IBM_BC_Z_PERIODIC
+            run = true;
+            #endif
+            const IBMBorderBox box = border[i].box[s];
+            const unsigned int nBlocks = ibmBorderBlocks(box);
+            if(!run || nBlocks == 0)
+                continue;
+            const int z0 = (s == IBM_BORDER_FRONT) ? NZ : -MACR_BORDER_NODES;
+            gpuIBMBorderPackAux<<<nBlocks, IBM_BORDER_THREADS, 0, streams[i]>>>(
+                ibmMacrsAux, i, border[i].send[s], box, z0);
+            getLastCudaError("IBM border pack auxiliary values error\n");
+            checkCudaErrors(cudaStreamWaitEvent(streams[i], border[dst].unpackDone, 0));
+            checkCudaErrors(cudaMemcpyPeerAsync(border[dst].recv[1-s], GPUS_TO_USE[dst],
+                border[i].send[s], GPUS_TO_USE[i],
+                sizeof(dfloat)*IBM_BORDER_AUX_FIELDS*box.nx*box.ny*MACR_BORDER_NODES,
+                streams[i]));
+        }
+        checkCudaErrors(cudaEventRecord(border[i].copyDone, streams[i]));
+    }
+
+    // Sum to the planes next to the neighbors after they copied to this GPU
+    for(int i = 0; i < N_GPUS; i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        for(int s = 0; s < 2; s++){
+            const int src = ibmBorderNeighbor(i, s);
+            // Same condition as the neighbor, for its opposite side
+            bool run = (1-s == IBM_BORDER_FRONT) ? (i != 0) : (i != N_GPUS-1);
+            #ifdef IBM_BC_Z_PERIODIC
+            run = true;
+            #endif
+            const IBMBorderBox box = border[src].box[1-s];
+            const unsigned int nBlocks = ibmBorderBlocks(box);
+            if(!run || nBlocks == 0)
+                continue;
+            const int z0 = (s == IBM_BORDER_FRONT) ? NZ-MACR_BORDER_NODES : 0;
+            checkCudaErrors(cudaStreamWaitEvent(streams[i], border[src].copyDone, 0));
+            gpuIBMBorderUnpackSum<<<nBlocks, IBM_BORDER_THREADS, 0, streams[i]>>>(
+                macr[i], border[i].recv[s], box, z0);
+            getLastCudaError("IBM border sum auxiliary values error\n");
+        }
+        checkCudaErrors(cudaEventRecord(border[i].unpackDone, streams[i]));
+    }
+}
+
+#endif // !IBM
@@ -0,0 +1,238 @@
+/*
+*   @file ibmBorderPack.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Packed exchange of the IBM macroscopics border planes between GPUs
+*          (IBM_BORDER_PACK). Only the x/y footprint of the Lagrangian stencils
+*          of each GPU that reach its ghost planes in z is exchanged, one box
+*          for each side. The values are packed in contiguous buffers, copied
+*          to the neighbor GPU and unpacked there, ordered by events, so the
+*          exchange runs concurrently with the particles kernels.
+*          Pack format: the fields in order, each one with the nodes of the
+*          box in x, y and z order,
+*          buffer[f*count + z*ny*nx + (y-y0)*nx + (x-x0)]
+*   @version 0.3.0
+*   @date 26/08/2020
+*/
+
+#ifndef __IBM_BORDER_PACK_H
+#define __IBM_BORDER_PACK_H
+
+#include "ibmVar.h"
+#include "../errorDef.h"
+#include "../memArena.h"
+#include "../globalFunctions.h"
+#include "../structs/macroscopics.h"
+#include "structs/ibmMacrsAux.h"
+#include "structs/particleNode.h"
+
+// Threads in block of IBM border kernels
+#define IBM_BORDER_THREADS (128)
+// Sides of the ghost planes in z of a GPU
+#define IBM_BORDER_BACK (0)     // z < 0, from/to previous GPU
+#define IBM_BORDER_FRONT (1)    // z >= NZ, from/to next GPU
+// Fields packed in the copy of macroscopics (rho, ux, uy, uz)
+#define IBM_BORDER_MACR_FIELDS (4)
+// Fields packed in the sum of auxiliary values (velocities and forces)
+#define IBM_BORDER_AUX_FIELDS (6)
+
+
+/*
+*   Box in x and y of a side, with MACR_BORDER_NODES planes in z
+*/
+typedef struct ibmBorderBox {
+    int x0, y0;     // first node of box
+    int nx, ny;     // nodes of box in x and y (0 if empty)
+} IBMBorderBox;
+
+
+/*
+*   Packed buffers and boxes of a GPU, to exchange with the neighbor GPUs
+*/
+typedef struct ibmBorderBuffers {
+    dfloat* send[2];            // buffer of each side, to neighbor of side
+    dfloat* recv[2];            // buffer of each side, from neighbor of side
+    int* boxExtent;             // extents of the boxes, updated by the nodes
+                                // (-x0, -y0, x1, y1) for each side, in device
+    int* boxExtentHost;         // extents copied to host
+    IBMBorderBox box[2];        // footprint of the stencils of GPU in each side
+    cudaEvent_t boxDone;        // extents copied to host
+    cudaEvent_t copyDone;       // buffers of GPU copied to neighbor GPUs
+    cudaEvent_t unpackDone;     // buffers of GPU unpacked, may be overwritten
+    cudaEvent_t macrDone;       // macroscopics of GPU ready for interpolation
+    cudaEvent_t spreadDone;     // interpolation and spread of GPU done
+    cudaEvent_t centersDone;    // particles centers updated (first GPU)
+
+    ibmBorderBuffers()
+    {
+        for(int s = 0; s < 2; s++){
+            send[s] = nullptr;
+            recv[s] = nullptr;
+            box[s] = {0, 0, 0, 0};
+        }
+        boxExtent = nullptr;
+        boxExtentHost = nullptr;
+    }
+} IBMBorderBuffers;
+
+
+/**
+*   @brief Allocates the buffers and events of each GPU, sized for full
+*          planes
+*
+*   @param border[N_GPUS]: buffers of each GPU to allocate
+*/
+__host__
+void ibmBorderBuffersAllocation(IBMBorderBuffers border[N_GPUS]);
+
+
+/**
+*   @brief Frees the buffers and events of each GPU
+*
+*   @param border[N_GPUS]: buffers of each GPU to free
+*/
+__host__
+void ibmBorderBuffersFree(IBMBorderBuffers border[N_GPUS]);
+
+
+/**
+*   @brief Adds the stencil footprint of the nodes reaching the ghost planes
+*          of the GPU to the extents of each side
+*
+*   @param particlesNodes: IBM particles nodes of GPU
+*   @param boxExtent: extents of the boxes to update (-x0, -y0, x1, y1 for
+*                     each side)
+*   @param n_gpu: GPU number
+*/
+__global__
+void gpuIBMBorderBoxes(
+    ParticleNodeSoA particlesNodes,
+    int* const boxExtent,
+    const int n_gpu
+);
+
+
+/**
+*   @brief Packs the macroscopics (rho, u) of the planes of box starting at z0
+*
+*   @param macr: macroscopics to read from
+*   @param buffer: buffer to write to
+*   @param box: box to pack
+*   @param z0: first plane of box
+*/
+__global__
+void gpuIBMBorderPackMacr(
+    Macroscopics macr,
+    dfloat* const buffer,
+    const IBMBorderBox box,
+    const int z0
+);
+
+
+/**
+*   @brief Unpacks the macroscopics (rho, u) to the planes of box starting at
+*          z0
+*
+*   @param macr: macroscopics to write to
+*   @param buffer: buffer to read from
+*   @param box: box to unpack
+*   @param z0: first plane of box
+*/
+__global__
+void gpuIBMBorderUnpackMacr(
+    Macroscopics macr,
+    const dfloat* const buffer,
+    const IBMBorderBox box,
+    const int z0
+);
+
+
+/**
+*   @brief Packs the auxiliary velocities and forces of the planes of box
+*          starting at z0
+*
+*   @param ibmMacrsAux: auxiliary vector for velocities and forces
+*   @param n_gpu: GPU number where the aux IBM macrs resides
+*   @param buffer: buffer to write to
+*   @param box: box to pack
+*   @param z0: first plane of box
+*/
+__global__
+void gpuIBMBorderPackAux(
+    IBMMacrsAux ibmMacrsAux,
+    const int n_gpu,
+    dfloat* const buffer,
+    const IBMBorderBox box,
+    const int z0
+);
+
+
+/**
+*   @brief Sums the auxiliary velocities and forces to the macroscopics of the
+*          planes of box starting at z0
+*
+*   @param macr: macroscopics to sum to
+*   @param buffer: buffer to read from
+*   @param box: box to unpack
+*   @param z0: first plane of box
+*/
+__global__
+void gpuIBMBorderUnpackSum(
+    Macroscopics macr,
+    const dfloat* const buffer,
+    const IBMBorderBox box,
+    const int z0
+);
+
+
+/**
+*   @brief Starts the update of the boxes of each GPU from its nodes.
+*          Asynchronous, the boxes are read by ibmBorderCopyMacr
+*
+*   @param border[N_GPUS]: buffers of each GPU
+*   @param nodesSoA[N_GPUS]: IBM particles nodes of each GPU
+*   @param streams[N_GPUS]: stream of each GPU
+*/
+__host__
+void ibmBorderBoxesUpdate(
+    IBMBorderBuffers border[N_GPUS],
+    ParticleNodeSoA nodesSoA[N_GPUS],
+    cudaStream_t streams[N_GPUS]
+);
+
+
+/**
+*   @brief Copies the macroscopics of the neighbor GPUs to the ghost planes
+*          of each GPU, in its boxes. Asynchronous, macrDone of each GPU is
+*          recorded when its ghost planes are ready
+*
+*   @param border[N_GPUS]: buffers of each GPU
+*   @param macr[N_GPUS]: macroscopics of each GPU
+*   @param streams[N_GPUS]: stream of each GPU
+*/
+__host__
+void ibmBorderCopyMacr(
+    IBMBorderBuffers border[N_GPUS],
+    Macroscopics* macr,
+    cudaStream_t streams[N_GPUS]
+);
+
+
+/**
+*   @brief Sums the auxiliary values of the ghost planes of each GPU, in its
+*          boxes, to the macroscopics of the neighbor GPUs. Each GPU starts
+*          after its spreadDone. Asynchronous
+*
+*   @param border[N_GPUS]: buffers of each GPU
+*   @param macr[N_GPUS]: macroscopics of each GPU
+*   @param ibmMacrsAux: auxiliary vector for velocities and forces
+*   @param streams[N_GPUS]: stream of each GPU
+*/
+__host__
+void ibmBorderSumAux(
+    IBMBorderBuffers border[N_GPUS],
+    Macroscopics* macr,
+    IBMMacrsAux ibmMacrsAux,
+    cudaStream_t streams[N_GPUS]
+);
+
+#endif // !__IBM_BORDER_PACK_H
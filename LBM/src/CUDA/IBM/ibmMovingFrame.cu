@@ -0,0 +1,277 @@
+#include "ibmMovingFrame.h"
+
+#ifdef IBM
+
+/**
+*   @brief Starts the copy of the followed particle position to host, read by
+*          the next update
+*
+*   @param frame: moving frame state
+*   @param particles: IBM particles
+*/
+__host__
+static void movingFrameCopyPos(IBMMovingFrame* frame, ParticlesSoA particles)
+{
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaMemcpyAsync(frame->posZ, 
+        &(particles.pCenterArray[IBM_MOVING_FRAME_PARTICLE].pos.z), sizeof(dfloat),
+        cudaMemcpyDefault, 0));
+    checkCudaErrors(cudaEventRecord(frame->posDone, 0));
+}
+
+
+__host__
+void movingFrameSetup(IBMMovingFrame* frame, ParticlesSoA particles)
+{
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaMallocHost((void**)&(frame->posZ), sizeof(dfloat)));
+    checkCudaErrors(cudaEventCreateWithFlags(&(frame->posDone), cudaEventDisableTiming));
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaEventCreateWithFlags(&(frame->ready[i]), cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(frame->shiftDone[i]), cudaEventDisableTiming));
+    }
+    movingFrameCopyPos(frame, particles);
+}
+
+
+__host__
+void movingFrameFree(IBMMovingFrame* frame)
+{
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaFreeHost(frame->posZ));
+    checkCudaErrors(cudaEventDestroy(frame->posDone));
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaEventDestroy(frame->ready[i]));
+        checkCudaErrors(cudaEventDestroy(frame->shiftDone[i]));
+    }
+    frame->posZ = nullptr;
+}
+
+
+__host__
+bool movingFrameUpdate(
+    IBMMovingFrame* frame,
+    ParticlesSoA particles,
+    Populations* pop,
+    Macroscopics* macr,
+    IBMMacrsAux ibmMacrsAux,
+    dim3 gridLBM,
+    dim3 threadsLBM,
+    unsigned int step)
+{
+    // Position copied in the previous update, already done
+    checkCudaErrors(cudaEventSynchronize(frame->posDone));
+    const dfloat dz = *(frame->posZ) - IBM_MOVING_FRAME_Z_POS;
+
+    // Domain is shifted at most one cell per step
+    int shift = 0;
+    if(dz <= -1)
+        shift = -1;
+    else if(dz >= 1)
+        shift = 1;
+    else{
+        movingFrameCopyPos(frame, particles);
+        return false;
+    }
+
+    // Shift populations and forces to auxiliary arrays (density and velocity
+    // are evaluated from populations after). The values from neighbor GPUs
+    // are used, so each GPU waits the previous work of its neighbors
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaEventRecord(frame->ready[i], 0));
+    }
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        int nxt = (i+1) % N_GPUS;
+        int prv = (i-1+N_GPUS) % N_GPUS;
+        checkCudaErrors(cudaStreamWaitEvent(0, frame->ready[prv], 0));
+        checkCudaErrors(cudaStreamWaitEvent(0, frame->ready[nxt], 0));
+        gpuMovingFrameShiftPop<<<gridLBM, threadsLBM>>>(
+            pop[i].popAux, pop[prv].pop, pop[i].pop, pop[nxt].pop, i, shift);
+        gpuMovingFrameShiftForces<<<gridLBM, threadsLBM>>>(
+            ibmMacrsAux.fAux[i], macr[prv], macr[i], macr[nxt], i, shift);
+        getLastCudaError("Moving frame shift error\n");
+        checkCudaErrors(cudaEventRecord(frame->shiftDone[i], 0));
+    }
+
+    // Move shifted values to populations and macroscopics and reset 
+    // auxiliary arrays, as expected by IBM. The previous values are 
+    // overwritten after the neighbors shifted them
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        int nxt = (i+1) % N_GPUS;
+        int prv = (i-1+N_GPUS) % N_GPUS;
+        checkCudaErrors(cudaStreamWaitEvent(0, frame->shiftDone[prv], 0));
+        checkCudaErrors(cudaStreamWaitEvent(0, frame->shiftDone[nxt], 0));
+        pop[i].swapPop();
+        checkCudaErrors(cudaMemcpyAsync(macr[i].f.x, ibmMacrsAux.fAux[i].x, 
+            MEM_SIZE_IBM_SCALAR, cudaMemcpyDefault, 0));
+        checkCudaErrors(cudaMemcpyAsync(macr[i].f.y, ibmMacrsAux.fAux[i].y, 
+            MEM_SIZE_IBM_SCALAR, cudaMemcpyDefault, 0));
+        checkCudaErrors(cudaMemcpyAsync(macr[i].f.z, ibmMacrsAux.fAux[i].z, 
+            MEM_SIZE_IBM_SCALAR, cudaMemcpyDefault, 0));
+        checkCudaErrors(cudaMemsetAsync(ibmMacrsAux.fAux[i].x, 0, MEM_SIZE_IBM_SCALAR, 0));
+        checkCudaErrors(cudaMemsetAsync(ibmMacrsAux.fAux[i].y, 0, MEM_SIZE_IBM_SCALAR, 0));
+        checkCudaErrors(cudaMemsetAsync(ibmMacrsAux.fAux[i].z, 0, MEM_SIZE_IBM_SCALAR, 0));
+        // Density and velocity from shifted populations
+        gpuUpdateMacr<<<gridLBM, threadsLBM>>>(pop[i], macr[i]);
+        getLastCudaError("Moving frame macroscopics update error\n");
+    }
+
+    // Shift particles centers and nodes
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    gpuMovingFrameShiftParticles<<<GRID_PARTICLES_IBM, THREADS_PARTICLES_IBM>>>(
+        particles.pCenterArray, shift);
+    getLastCudaError("Moving frame particles shift error\n");
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        unsigned int pNumNodes = particles.nodesSoA[i].numNodes;
+        if(pNumNodes == 0)
+            continue;
+        unsigned int gridNodes = pNumNodes % 64 ? pNumNodes / 64 + 1 : pNumNodes / 64;
+        gpuMovingFrameShiftNodes<<<gridNodes, 64>>>(particles.nodesSoA[i], shift);
+        getLastCudaError("Moving frame nodes shift error\n");
+    }
+
+    // Particles last positions are not shifted, so nodes changing GPU are
+    // updated. They are read in host, only required with more than one GPU
+    if(N_GPUS > 1){
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            checkCudaErrors(cudaDeviceSynchronize());
+        }
+        particles.updateNodesGPUs();
+    }
+    movingFrameCopyPos(frame, particles);
+
+    // Update frame state
+    frame->totalShift += shift;
+    if(step > frame->lastShiftStep)
+        frame->velZ = (dfloat)shift / (step - frame->lastShiftStep);
+    frame->lastShiftStep = step;
+
+    return true;
+}
+
+
+__global__
+void gpuMovingFrameShiftPop(
+    dfloat* popDst,
+    dfloat* popPrv,
+    dfloat* popBase,
+    dfloat* popNxt,
+    int n_gpu,
+    int shift)
+{
+    const int x = threadIdx.x + blockDim.x * blockIdx.x;
+    const int y = threadIdx.y + blockDim.y * blockIdx.y;
+    const int z = threadIdx.z + blockDim.z * blockIdx.z;
+    if (x >= NX || y >= NY || z >= NZ)
+        return;
+
+    // Source of the node, it may be in a neighbor GPU or outside the domain
+    int zSrc = z + shift;
+    dfloat* popSrc = popBase;
+    if(zSrc < 0){
+        popSrc = (n_gpu == 0) ? nullptr : popPrv;
+        zSrc += NZ;
+    }
+    else if(zSrc >= NZ){
+        popSrc = (n_gpu == N_GPUS-1) ? nullptr : popNxt;
+        zSrc -= NZ;
+    }
+
+    if(popSrc != nullptr){
+        for(int i = 0; i < Q; i++)
+            popDst[idxPop(x, y, z, i)] = popSrc[idxPop(x, y, zSrc, i)];
+        return;
+    }
+
+    // Node entering the domain, with far field values
+    const dfloat ux = IBM_MOVING_FRAME_UX_INF;
+    const dfloat uy = IBM_MOVING_FRAME_UY_INF;
+    const dfloat uz = IBM_MOVING_FRAME_UZ_INF;
+    const dfloat p1_muu = 1 - 1.5*(ux*ux + uy*uy + uz*uz);
+    for(int i = 0; i < Q; i++)
+    {
+        popDst[idxPop(x, y, z, i)] = gpu_f_eq(w[i] * RHO_0,
+            3 * (ux * cx[i] + uy * cy[i] + uz * cz[i]),
+            p1_muu);
+    }
+}
+
+
+__global__
+void gpuMovingFrameShiftForces(
+    dfloat3SoA fDst,
+    Macroscopics macrPrv,
+    Macroscopics macrBase,
+    Macroscopics macrNxt,
+    int n_gpu,
+    int shift)
+{
+    const int x = threadIdx.x + blockDim.x * blockIdx.x;
+    const int y = threadIdx.y + blockDim.y * blockIdx.y;
+    const int z = threadIdx.z + blockDim.z * blockIdx.z;
+    if (x >= NX || y >= NY || z >= NZ)
+        return;
+
+    int zSrc = z + shift;
+    Macroscopics* macrSrc = &macrBase;
+    if(zSrc < 0){
+        macrSrc = (n_gpu == 0) ? nullptr : &macrPrv;
+        zSrc += NZ;
+    }
+    else if(zSrc >= NZ){
+        macrSrc = (n_gpu == N_GPUS-1) ? nullptr : &macrNxt;
+        zSrc -= NZ;
+    }
+
+    const size_t idx = idxScalarWBorder(x, y, z);
+    if(macrSrc != nullptr){
+        const size_t idxSrc = idxScalarWBorder(x, y, zSrc);
+        fDst.x[idx] = macrSrc->f.x[idxSrc];
+        fDst.y[idx] = macrSrc->f.y[idxSrc];
+        fDst.z[idx] = macrSrc->f.z[idxSrc];
+        return;
+    }
+
+    fDst.x[idx] = FX;
+    fDst.y[idx] = FY;
+    fDst.z[idx] = FZ;
+}
+
+
+__global__
+void gpuMovingFrameShiftParticles(
+    ParticleCenter particleCenters[NUM_PARTICLES],
+    int shift)
+{
+    unsigned int p = threadIdx.x + blockDim.x * blockIdx.x;
+
+    if(p >= NUM_PARTICLES)
+        return;
+
+    ParticleCenter *pc = &(particleCenters[p]);
+    pc->pos.z -= shift;
+    pc->pos_old.z -= shift;
+}
+
+
+__global__
+void gpuMovingFrameShiftNodes(
+    ParticleNodeSoA particlesNodes,
+    int shift)
+{
+    unsigned int i = threadIdx.x + blockDim.x * blockIdx.x;
+
+    if(i >= particlesNodes.numNodes)
+        return;
+
+    particlesNodes.pos.z[i] -= shift;
+}
+
+#endif // !IBM
@@ -0,0 +1,176 @@
+/*
+*   @file ibmMovingFrame.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Moving reference frame following an IBM particle in z
+*   @version 0.3.0
+*   @date 26/08/2020
+*/
+
+#ifndef __IBM_MOVING_FRAME_H
+#define __IBM_MOVING_FRAME_H
+
+#include "ibmVar.h"
+#include "../structs/macroscopics.h"
+#include "../structs/populations.h"
+#include "../lbm.h"
+#include "structs/particle.h"
+#include "structs/ibmMacrsAux.h"
+
+// The shift reads the z planes of the neighbor GPUs with uniform slabs of NZ
+// planes and the populations of the default layout (idxPop with POP_GHOST 
+// planes and no halo), and moves the post collision values stored in pop
+#if defined(IBM) && IBM_MOVING_FRAME
+#if POP_PACKED_HALO || POP_HALO_LAYOUT
+#error "IBM_MOVING_FRAME can not be used with POP_PACKED_HALO or POP_HALO_LAYOUT"
+#endif
+#if DECOMP_Z_BALANCE || BC_POST_COL_BUFFER
+#error "IBM_MOVING_FRAME can not be used with DECOMP_Z_BALANCE or BC_POST_COL_BUFFER"
+#endif
+#endif
+
+
+/*
+*   Struct with the state of the moving frame
+*/
+typedef struct ibmMovingFrame{
+    int totalShift;     // Cells the domain has moved in z (laboratory z = z + totalShift)
+    int lastShiftStep;  // Step of the last shift
+    dfloat velZ;        // Frame velocity in z, evaluated between the last two shifts
+    dfloat* posZ;       // Position in z of the followed particle, copied
+                        // to host (pinned) in the previous update
+    cudaEvent_t posDone;            // posZ copied, in first GPU
+    cudaEvent_t ready[N_GPUS];      // previous work of each GPU done
+    cudaEvent_t shiftDone[N_GPUS];  // shift kernels of each GPU done
+
+    /* Constructor */
+    __host__
+    ibmMovingFrame()
+    {
+        totalShift = 0;
+        lastShiftStep = 0;
+        velZ = 0;
+        posZ = nullptr;
+    }
+} IBMMovingFrame;
+
+
+/**
+*   @brief Allocates the position buffer and events of the moving frame and
+*          starts the copy of the followed particle position
+*
+*   @param frame: moving frame state
+*   @param particles: IBM particles
+*/
+__host__
+void movingFrameSetup(IBMMovingFrame* frame, ParticlesSoA particles);
+
+
+/**
+*   @brief Frees the position buffer and events of the moving frame
+*
+*   @param frame: moving frame state
+*/
+__host__
+void movingFrameFree(IBMMovingFrame* frame);
+
+
+/**
+*   @brief Check if the followed particle has drifted one cell and, if so, 
+*          shift the domain one cell in z following it. The position is the
+*          one copied in the previous update (one step before), so the 
+*          devices are not synchronized. The shift runs in the default 
+*          stream of each GPU, ordered by events with the neighbor GPUs
+*   
+*   @param frame: moving frame state
+*   @param particles: IBM particles
+*   @param pop: populations of each GPU
+*   @param macr: macroscopics of each GPU
+*   @param ibmMacrsAux: auxiliary IBM macroscopics, used as buffer for the shift
+*   @param gridLBM: LBM CUDA grid size
+*   @param threadsLBM: LBM CUDA block size
+*   @param step: current time step
+*   @return true if the domain was shifted, false otherwise
+*/
+__host__
+bool movingFrameUpdate(
+    IBMMovingFrame* frame,
+    ParticlesSoA particles,
+    Populations* pop,
+    Macroscopics* macr,
+    IBMMacrsAux ibmMacrsAux,
+    dim3 gridLBM,
+    dim3 threadsLBM,
+    unsigned int step
+);
+
+
+/**
+*   @brief Shift populations one cell in z (popDst(z) = pop(z+shift)). Nodes 
+*          entering the domain are set to the far field equilibrium
+*   
+*   @param popDst: populations to write shifted values to
+*   @param popPrv: populations of previous GPU
+*   @param popBase: populations of current GPU
+*   @param popNxt: populations of next GPU
+*   @param n_gpu: current GPU number
+*   @param shift: cells to shift (-1 or 1)
+*/
+__global__
+void gpuMovingFrameShiftPop(
+    dfloat* popDst,
+    dfloat* popPrv,
+    dfloat* popBase,
+    dfloat* popNxt,
+    int n_gpu,
+    int shift
+);
+
+
+/**
+*   @brief Shift forces one cell in z. Nodes entering the domain have 
+*          force (FX, FY, FZ)
+*   
+*   @param fDst: forces to write shifted values to
+*   @param macrPrv: macroscopics of previous GPU
+*   @param macrBase: macroscopics of current GPU
+*   @param macrNxt: macroscopics of next GPU
+*   @param n_gpu: current GPU number
+*   @param shift: cells to shift (-1 or 1)
+*/
+__global__
+void gpuMovingFrameShiftForces(
+    dfloat3SoA fDst,
+    Macroscopics macrPrv,
+    Macroscopics macrBase,
+    Macroscopics macrNxt,
+    int n_gpu,
+    int shift
+);
+
+
+/**
+*   @brief Shift particles centers one cell in z (pos = pos-shift)
+*   
+*   @param particleCenters: particles centers to shift
+*   @param shift: cells the domain was shifted
+*/
+__global__
+void gpuMovingFrameShiftParticles(
+    ParticleCenter particleCenters[NUM_PARTICLES],
+    int shift
+);
+
+
+/**
+*   @brief Shift particles nodes one cell in z (pos = pos-shift)
+*   
+*   @param particlesNodes: particles nodes to shift
+*   @param shift: cells the domain was shifted
+*/
+__global__
+void gpuMovingFrameShiftNodes(
+    ParticleNodeSoA particlesNodes,
+    int shift
+);
+
+#endif // !__IBM_MOVING_FRAME_H
@@ -98,6 +98,11 @@
 // Leave as 1 if you're not interested in this optimization
 #define IBM_EULER_UPDATE_INTERVAL (0)
 
+// Exchange of the macroscopics border planes between GPUs only in the x/y 
+// footprint of the stencils reaching them, packed in contiguous buffers and 
+// concurrent with the particles kernels. False to exchange the full planes
+#define IBM_BORDER_PACK false
+
 //Define the discrization coefiecient for the particle movement: 1 = only current time step
 // 0.5 =  half current and half previous,  0 = only previous time step information
 #define IBM_MOVEMENT_DISCRETIZATION (0.5)  //TODO: its not the correct name, but for now i cant recall it.
@@ -127,6 +132,25 @@ constexpr dfloat GZ = 0.0; //-1.179430e-03/SCALE/SCALE/SCALE;
 /* -------------------------------------------------------------------------- */
 
 
+/* ------------------------------ MOVING FRAME ----------------------------- */
+// Domain follows a particle in z (e.g. settling particle). Every time the 
+// particle drifts one lattice cell from IBM_MOVING_FRAME_Z_POS, populations, 
+// forces and particles are shifted one cell, so the particle stays at the same
+// place in the domain. Velocities are kept in the laboratory frame, so the 
+// velocity boundary conditions of the z faces impose the far field velocity
+// below, without frame velocity (see gpuVelocityBC)
+#define IBM_MOVING_FRAME false
+// Particle to follow
+#define IBM_MOVING_FRAME_PARTICLE (0)
+// Position in z to keep the particle at
+#define IBM_MOVING_FRAME_Z_POS (NZ_TOTAL/2.0)
+// Far field velocity (laboratory frame) of the fluid entering the domain
+constexpr dfloat IBM_MOVING_FRAME_UX_INF = 0.0;
+constexpr dfloat IBM_MOVING_FRAME_UY_INF = 0.0;
+constexpr dfloat IBM_MOVING_FRAME_UZ_INF = 0.0;
+/* -------------------------------------------------------------------------- */
+
+
 /* ------------------------------ STENCIL ----------------------------------- */
 // Define only one
 // #define STENCIL_2 
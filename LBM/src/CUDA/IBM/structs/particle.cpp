@@ -25,8 +25,7 @@ void ParticlesSoA::updateParticlesAsSoA(Particle* particles){
 
     // Allocate particle center array
     checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
-    checkCudaErrors(
-        cudaMallocManaged((void**)&(this->pCenterArray), sizeof(ParticleCenter) * NUM_PARTICLES));
+    this->pCenterArray = (ParticleCenter*)simMalloc(sizeof(ParticleCenter) * NUM_PARTICLES, IN_VIRTUAL);
     // Allocate array of last positions for Particles
     this->pCenterLastPos = (dfloat3*)malloc(sizeof(dfloat3)*NUM_PARTICLES);
     this->pCenterLastWPos = (dfloat3*)malloc(sizeof(dfloat3) * NUM_PARTICLES);
@@ -187,7 +186,7 @@ void ParticlesSoA::freeNodesAndCenters(){
         this->nodesSoA[i].freeMemory();
     }
     checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
-    cudaFree(this->pCenterArray);
+    simFree(this->pCenterArray, IN_VIRTUAL);
     free(this->pCenterLastPos);
     free(this->pCenterLastWPos);
     this->pCenterArray = nullptr;
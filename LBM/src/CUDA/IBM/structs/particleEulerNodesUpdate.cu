@@ -24,17 +24,12 @@ ParticleEulerNodesUpdate::~particleEulerNodesUpdate(){
 #if IBM_EULER_OPTIMIZATION
 
 __host__
-void ParticleEulerNodesUpdate::initializeEulerNodes(ParticleCenter p[NUM_PARTICLES]){
-    int nParticlesFixed = 0;
-    int idxFixed[NUM_PARTICLES], idxMoving[NUM_PARTICLES];
+void ParticleEulerNodesUpdate::allocateEulerNodes(ParticleCenter p[NUM_PARTICLES]){
     // Pre process particles to calculate some necessary values
     for(int i = 0; i <  NUM_PARTICLES; i++){
         if(p[i].movable){
-            idxMoving[this->nParticlesMovable] = i;
             this->nParticlesMovable += 1;
         } else {
-            idxFixed[nParticlesFixed] = i;
-            nParticlesFixed += 1;
             this->hasFixed = true;
         }
         // TODO: UPDATE THIS TO BE DONE BY PARTICLES FOR OTHER GEOMETRIES
@@ -58,10 +53,10 @@ void ParticleEulerNodesUpdate::initializeEulerNodes(ParticleCenter p[NUM_PARTICL
     for(int i = 0; i < N_GPUS; i++){
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
         // Allocate indexes of Euler nodes to update
-        checkCudaErrors(cudaMallocManaged((void**)&(this->eulerIndexesUpdate[i]), 
-            this->maxEulerNodes*sizeof(size_t)));
-        // Allocate mask array
-        this->eulerMaskArray[i] = (uint32_t*) malloc((size_t)NUMBER_LBM_IB_MACR_NODES*sizeof(uint32_t));
+        this->eulerIndexesUpdate[i] = (size_t*)simMalloc(this->maxEulerNodes*sizeof(size_t), 
+            IN_VIRTUAL);
+        // Allocate mask array, with no nodes masked
+        this->eulerMaskArray[i] = (uint32_t*) calloc((size_t)NUMBER_LBM_IB_MACR_NODES, sizeof(uint32_t));
         checkCudaErrors(cudaDeviceSynchronize());
     }
     // Allocate array of pointers to particleCenters, for moving particles
@@ -70,20 +65,35 @@ void ParticleEulerNodesUpdate::initializeEulerNodes(ParticleCenter p[NUM_PARTICL
     this->particlesLastPos = (dfloat3*)malloc(this->nParticlesMovable*sizeof(dfloat3));
     this->particlesLastWPos = (dfloat3*)malloc(this->nParticlesMovable*sizeof(dfloat3));
 
-    for(int i=0; i < nParticlesFixed; i++){
+    int nMovable = 0;
+    for(int i = 0; i < NUM_PARTICLES; i++){
+        if(!p[i].movable)
+            continue;
+        ParticleCenter* mp = &(p[i]);
+        this->pCenterMovable[nMovable] = mp;
+        this->particlesLastPos[nMovable] = mp->pos;
+        this->particlesLastWPos[nMovable] = mp->w_pos;
+        nMovable += 1;
+    }
+}
+
+__host__
+void ParticleEulerNodesUpdate::initializeEulerNodes(ParticleCenter p[NUM_PARTICLES]){
+    this->allocateEulerNodes(p);
+
+    for(int i=0; i < NUM_PARTICLES; i++){
+        if(p[i].movable)
+            continue;
         for(int j=0; j< N_GPUS; j++){
             // Mask for fixes particles is always 0b1
-            this->eulerFixedNodes[j] += this->updateEulerNodes(&p[idxFixed[i]], 0b1, j);
+            this->eulerFixedNodes[j] += this->updateEulerNodes(&p[i], 0b1, j);
         }
     }
 
     const char shift = this->hasFixed? 1 : 0;
 
     for(int i=0; i < this->nParticlesMovable; i++){
-        ParticleCenter* mp = &(p[idxMoving[i]]);
-        this->pCenterMovable[i] = mp;
-        this->particlesLastPos[i] = mp->pos;
-        this->particlesLastWPos[i] = mp->w_pos;
+        ParticleCenter* mp = this->pCenterMovable[i];
         for(int j = 0; j < N_GPUS; j++){
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[j]));
             // Mask for fixes particles is 0b1 shifted its index +shift to the left
@@ -98,7 +108,7 @@ void ParticleEulerNodesUpdate::freeEulerNodes(){
     // Free variables
     for(int i = 0; i < N_GPUS; i++)
     {
-        checkCudaErrors(cudaFree(this->eulerIndexesUpdate[i]));
+        simFree(this->eulerIndexesUpdate[i], IN_VIRTUAL);
         free(this->eulerMaskArray[i]);
     }
     free(this->pCenterMovable);
@@ -37,6 +37,15 @@ typedef struct particleEulerNodesUpdate{
     particleEulerNodesUpdate();
     ~particleEulerNodesUpdate();
 
+    /**
+    *   @brief Allocate euler nodes arrays and setup movable particles, 
+    *          without adding any node
+    *   
+    *   @param p: simulation particles
+    */
+    __host__
+    void allocateEulerNodes(ParticleCenter p[NUM_PARTICLES]);
+
     /**
     *   @brief Initialize euler nodes that must be updated, given particles
     *   
@@ -26,10 +26,8 @@ void ParticleNodeSoA::allocateMemory(unsigned int numMaxNodes)
     this->f.allocateMemory((size_t) numMaxNodes);
     this->deltaF.allocateMemory((size_t) numMaxNodes);
 
-    checkCudaErrors(
-        cudaMallocManaged((void**)&(this->S), sizeof(dfloat) * numMaxNodes));
-    checkCudaErrors(
-        cudaMallocManaged((void**)&(this->particleCenterIdx), sizeof(unsigned int) * numMaxNodes));
+    this->S = (dfloat*)simMalloc(sizeof(dfloat) * numMaxNodes, IN_VIRTUAL);
+    this->particleCenterIdx = (unsigned int*)simMalloc(sizeof(unsigned int) * numMaxNodes, IN_VIRTUAL);
 }
 
 void ParticleNodeSoA::freeMemory()
@@ -42,8 +40,8 @@ void ParticleNodeSoA::freeMemory()
     this->f.freeMemory();
     this->deltaF.freeMemory();
 
-    cudaFree(this->S);
-    cudaFree(this->particleCenterIdx);
+    simFree(this->S, IN_VIRTUAL);
+    simFree(this->particleCenterIdx, IN_VIRTUAL);
 }
 
 bool is_inside_gpu(dfloat3 pos, unsigned int n_gpu){
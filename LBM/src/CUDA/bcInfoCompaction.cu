@@ -0,0 +1,270 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "bcInfoCompaction.h"
+
+// Number of blocks of compaction kernels
+constexpr size_t BC_COMPACT_BLOCKS = 
+    (NUMBER_LBM_NODES + BC_COMPACT_THREADS - 1) / BC_COMPACT_THREADS;
+
+
+__global__
+void gpuBCGroupsHistogram(
+    NodeTypeMap* const mapBC,
+    unsigned long long int* const groupCount)
+{
+    __shared__ unsigned int sCount[BC_GROUPS_MAX];
+    const size_t idx = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+
+    for(unsigned int key = threadIdx.x; key < BC_GROUPS_MAX; key += blockDim.x)
+        sCount[key] = 0;
+    __syncthreads();
+
+    if(idx < NUMBER_LBM_NODES){
+        NodeTypeMap ntm = mapBC[idx];
+        if(BoundaryConditionsInfo::isBCNode(ntm))
+            atomicAdd(&sCount[BoundaryConditionsInfo::bcGroupKey(ntm)], 1);
+    }
+    __syncthreads();
+
+    for(unsigned int key = threadIdx.x; key < BC_GROUPS_MAX; key += blockDim.x)
+        if(sCount[key] != 0)
+            atomicAdd(&groupCount[key], (unsigned long long int)sCount[key]);
+}
+
+
+/*
+*   @brief Checks if node is in group
+*   @param mapBC: full boundary conditions map
+*   @param key: group key
+*   @param idx: node scalar index (may be out of domain)
+*/
+__device__ __forceinline__
+bool isNodeInGroup(NodeTypeMap* const mapBC, const unsigned int key, const size_t idx)
+{
+    if(idx >= NUMBER_LBM_NODES)
+        return false;
+    NodeTypeMap ntm = mapBC[idx];
+    return BoundaryConditionsInfo::isBCNode(ntm) 
+        && BoundaryConditionsInfo::bcGroupKey(ntm) == key;
+}
+
+
+__global__
+void gpuBCGroupCount(
+    NodeTypeMap* const mapBC,
+    const unsigned int key,
+    unsigned int* const blockCount)
+{
+    const size_t idx = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    // All threads of block must reach the reduction
+    const unsigned int count = __syncthreads_count(isNodeInGroup(mapBC, key, idx));
+    if(threadIdx.x == 0)
+        blockCount[blockIdx.x] = count;
+}
+
+
+__global__
+void gpuExclusiveScan(
+    unsigned int* const values,
+    const size_t n)
+{
+    __shared__ unsigned int sSum[BC_SCAN_THREADS];
+    // Each thread sums a chunk of values
+    const size_t chunk = (n + BC_SCAN_THREADS - 1) / BC_SCAN_THREADS;
+    const size_t begin = threadIdx.x * chunk;
+    const size_t end = myMin(begin + chunk, n);
+
+    unsigned int sum = 0;
+    for(size_t i = begin; i < end; i++)
+        sum += values[i];
+    sSum[threadIdx.x] = sum;
+    __syncthreads();
+
+    // Inclusive scan of chunk sums (Hillis-Steele)
+    for(unsigned int offset = 1; offset < BC_SCAN_THREADS; offset *= 2){
+        const unsigned int add = (threadIdx.x >= offset) ? sSum[threadIdx.x - offset] : 0;
+        __syncthreads();
+        sSum[threadIdx.x] += add;
+        __syncthreads();
+    }
+
+    // Exclusive scan of each chunk, from the sum of previous chunks
+    unsigned int first = sSum[threadIdx.x] - sum;
+    for(size_t i = begin; i < end; i++){
+        const unsigned int value = values[i];
+        values[i] = first;
+        first += value;
+    }
+}
+
+
+/*
+*   @brief Rank of thread among the threads of block with predicate true, 
+*          in order of thread. All threads of block must call it
+*   @param pred: thread predicate
+*   @return rank of thread in block
+*/
+__device__ __forceinline__
+unsigned int blockRank(const bool pred)
+{
+    __shared__ unsigned int sWarpFirst[BC_COMPACT_THREADS/32];
+    const unsigned int lane = threadIdx.x % 32;
+    const unsigned int warp = threadIdx.x / 32;
+
+    // Rank of node in warp and number of nodes of each warp
+    const unsigned int ballot = __ballot_sync(0xffffffff, pred);
+    const unsigned int rankWarp = __popc(ballot & ((1u << lane) - 1));
+    if(lane == 0)
+        sWarpFirst[warp] = __popc(ballot);
+    __syncthreads();
+
+    // First node of each warp in block (exclusive prefix sum)
+    if(threadIdx.x == 0){
+        unsigned int first = 0;
+        for(unsigned int w = 0; w < BC_COMPACT_THREADS/32; w++){
+            const unsigned int count = sWarpFirst[w];
+            sWarpFirst[w] = first;
+            first += count;
+        }
+    }
+    __syncthreads();
+
+    return sWarpFirst[warp] + rankWarp;
+}
+
+
+__global__
+void gpuBCGroupScatter(
+    NodeTypeMap* const mapBC,
+    const unsigned int key,
+    const unsigned int* const blockFirst,
+    size_t* const idxGroup)
+{
+    const size_t idx = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    const bool inGroup = isNodeInGroup(mapBC, key, idx);
+    const unsigned int rank = blockRank(inGroup);
+    if(inGroup)
+        idxGroup[blockFirst[blockIdx.x] + rank] = idx;
+}
+
+
+__global__
+void gpuPostColRows(
+    NodeTypeMap* const mapBC,
+    unsigned int* const slot)
+{
+    const size_t row = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(row >= NUMBER_POST_COL_ROWS)
+        return;
+    const unsigned int x0 = (row % POST_COL_ROWS_X)*32;
+    const size_t yz = row / POST_COL_ROWS_X;
+    const size_t idx0 = yz*NX + x0;
+
+    unsigned int mask = 0;
+    for(unsigned int i = 0; i < 32 && x0 + i < NX; i++){
+        NodeTypeMap ntm = mapBC[idx0 + i];
+        if(ntm.getIsUsed() && ntm.getSavePostCol())
+            mask |= 1u << i;
+    }
+    slot[row] = mask;
+    slot[NUMBER_POST_COL_ROWS + row] = __popc(mask);
+}
+
+
+__host__
+void setupBoundaryConditionsInfoDevice(
+    BoundaryConditionsInfo* bcInfo,
+    NodeTypeMap* const mapBC)
+{
+    unsigned long long int* groupCountDevice;
+    unsigned int* blockCount;
+    checkCudaErrors(cudaMalloc((void**)&groupCountDevice, 
+        BC_GROUPS_MAX*sizeof(unsigned long long int)));
+    checkCudaErrors(cudaMalloc((void**)&blockCount, BC_COMPACT_BLOCKS*sizeof(unsigned int)));
+    checkCudaErrors(cudaMemset(groupCountDevice, 0, 
+        BC_GROUPS_MAX*sizeof(unsigned long long int)));
+
+    // Count nodes of each group, only the counts go to host
+    gpuBCGroupsHistogram<<<BC_COMPACT_BLOCKS, BC_COMPACT_THREADS>>>(mapBC, groupCountDevice);
+    getLastCudaError("BC groups histogram error");
+    unsigned long long int hGroupCountDevice[BC_GROUPS_MAX];
+    checkCudaErrors(cudaMemcpy(hGroupCountDevice, groupCountDevice, 
+        BC_GROUPS_MAX*sizeof(unsigned long long int), cudaMemcpyDeviceToHost));
+
+    size_t groupCount[BC_GROUPS_MAX];
+    size_t groupFirst[BC_GROUPS_MAX];
+    for(unsigned int key = 0; key < BC_GROUPS_MAX; key++)
+        groupCount[key] = hGroupCountDevice[key];
+    bcInfo->setupBCGroups(groupCount, groupFirst);
+
+    // Compaction of each group (count, prefix sum and scatter)
+    for(unsigned int key = 0; key < BC_GROUPS_MAX; key++){
+        if(groupCount[key] == 0)
+            continue;
+        gpuBCGroupCount<<<BC_COMPACT_BLOCKS, BC_COMPACT_THREADS>>>(mapBC, key, blockCount);
+        gpuExclusiveScan<<<1, BC_SCAN_THREADS>>>(blockCount, BC_COMPACT_BLOCKS);
+        gpuBCGroupScatter<<<BC_COMPACT_BLOCKS, BC_COMPACT_THREADS>>>
+            (mapBC, key, blockCount, bcInfo->idxBCNodes + groupFirst[key]);
+    }
+    checkCudaErrors(cudaDeviceSynchronize());
+    getLastCudaError("BC info compaction error");
+
+    checkCudaErrors(cudaFree(groupCountDevice));
+    checkCudaErrors(cudaFree(blockCount));
+}
+
+
+__host__
+void setupPostColBufferDevice(
+    BoundaryConditionsInfo* bcInfo,
+    NodeTypeMap* const mapBC)
+{
+    bcInfo->totalPostColNodes = 0;
+    bcInfo->slotPostCol = nullptr;
+    bcInfo->popPostColBC = nullptr;
+    #if BC_POST_COL_BUFFER
+    // Partitions in the same device would share its constant memory, so 
+    // they save the populations in pop
+    if(partitionDevicesShared())
+        return;
+    bcInfo->slotPostCol = (unsigned int*)simMalloc(MEM_SIZE_POST_COL_SLOT, IN_VIRTUAL);
+    unsigned int* rowFirst = bcInfo->slotPostCol + NUMBER_POST_COL_ROWS;
+
+    // Mask and count of each row, then the first slots (prefix sum)
+    gpuPostColRows<<<(unsigned int)((NUMBER_POST_COL_ROWS+BC_COMPACT_THREADS-1)/BC_COMPACT_THREADS), 
+        BC_COMPACT_THREADS>>>(mapBC, bcInfo->slotPostCol);
+    getLastCudaError("Post collision rows error");
+    unsigned int lastCount, lastFirst;
+    checkCudaErrors(cudaMemcpy(&lastCount, rowFirst + NUMBER_POST_COL_ROWS - 1, 
+        sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    gpuExclusiveScan<<<1, BC_SCAN_THREADS>>>(rowFirst, NUMBER_POST_COL_ROWS);
+    checkCudaErrors(cudaMemcpy(&lastFirst, rowFirst + NUMBER_POST_COL_ROWS - 1, 
+        sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    getLastCudaError("Post collision slots compaction error");
+    const size_t totalPostColNodes = (size_t)lastFirst + lastCount;
+
+    bcInfo->totalPostColNodes = totalPostColNodes;
+    if(totalPostColNodes > 0)
+        bcInfo->popPostColBC = (dfloat*)simMalloc(
+            totalPostColNodes*Q*sizeof(dfloat), IN_VIRTUAL);
+    #endif
+}
@@ -0,0 +1,129 @@
+/*
+*   @file bcInfoCompaction.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Boundary conditions info built in device, by stream compaction
+*          of the boundary conditions map (BC_INFO_DEVICE)
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __BC_INFO_COMPACTION_H
+#define __BC_INFO_COMPACTION_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "var.h"
+#include "errorDef.h"
+#include "structs/nodeTypeMap.h"
+#include "structs/boundaryConditionsInfo.h"
+#include "postColBuffer.h"
+#include "partitionDevices.h"
+
+// Threads of compaction kernels (multiple of 32)
+#define BC_COMPACT_THREADS (256)
+// Threads of scan kernel (one block)
+#define BC_SCAN_THREADS (1024)
+
+
+/*
+*   @brief Counts the nodes of each group of boundary conditions nodes
+*   @param mapBC: full boundary conditions map
+*   @param groupCount[BC_GROUPS_MAX]: number of nodes of each group key, 
+*                                     to add to (zeroed before)
+*/
+__global__
+void gpuBCGroupsHistogram(
+    NodeTypeMap* const mapBC,
+    unsigned long long int* const groupCount
+);
+
+
+/*
+*   @brief Counts the nodes of a group in each block of nodes
+*   @param mapBC: full boundary conditions map
+*   @param key: group key
+*   @param blockCount: number of group nodes of each block, to write to
+*/
+__global__
+void gpuBCGroupCount(
+    NodeTypeMap* const mapBC,
+    const unsigned int key,
+    unsigned int* const blockCount
+);
+
+
+/*
+*   @brief Exclusive prefix sum, in place. Must be launched with one block 
+*          of BC_SCAN_THREADS threads
+*   @param values: values to sum
+*   @param n: number of values
+*/
+__global__
+void gpuExclusiveScan(
+    unsigned int* const values,
+    const size_t n
+);
+
+
+/*
+*   @brief Writes the indexes of the nodes of a group, in order of index
+*   @param mapBC: full boundary conditions map
+*   @param key: group key
+*   @param blockFirst: first node of each block in group (exclusive prefix 
+*                      sum of gpuBCGroupCount)
+*   @param idxGroup: indexes of group nodes, to write to
+*/
+__global__
+void gpuBCGroupScatter(
+    NodeTypeMap* const mapBC,
+    const unsigned int key,
+    const unsigned int* const blockFirst,
+    size_t* const idxGroup
+);
+
+
+/*
+*   @brief Setup boundary conditions info of the current device from its 
+*          map in device, without transfering the map. The groups are 
+*          counted and then each group is compacted (count, prefix sum and
+*          scatter), so the nodes are sorted as in the host version
+*   @param bcInfo: boundary conditions info to setup
+*   @param mapBC: full boundary conditions map (device)
+*/
+__host__
+void setupBoundaryConditionsInfoDevice(
+    BoundaryConditionsInfo* bcInfo,
+    NodeTypeMap* const mapBC
+);
+
+
+/*
+*   @brief Writes the mask of nodes that save post collision populations of
+*          each row of 32 nodes in x and its number of nodes, to be summed 
+*          to the first slot of the row (gpuExclusiveScan)
+*   @param mapBC: full boundary conditions map
+*   @param slot: masks (NUMBER_POST_COL_ROWS) and counts of rows, to write to
+*/
+__global__
+void gpuPostColRows(
+    NodeTypeMap* const mapBC,
+    unsigned int* const slot
+);
+
+
+/*
+*   @brief Setup buffer of post collision populations of the current device
+*          and its slots (BC_POST_COL_BUFFER). Must be called after the 
+*          boundary conditions info is set up. Without buffer if partitions
+*          share the device
+*   @param bcInfo: boundary conditions info to setup
+*   @param mapBC: full boundary conditions map (device)
+*/
+__host__
+void setupPostColBufferDevice(
+    BoundaryConditionsInfo* bcInfo,
+    NodeTypeMap* const mapBC
+);
+
+#endif // !__BC_INFO_COMPACTION_H
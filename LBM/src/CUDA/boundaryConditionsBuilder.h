@@ -22,4 +22,18 @@ __global__
 void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber);
 
 
+/*
+*   @brief Signed distance from point to the walls of the interpolated bounce
+*          back nodes, positive in fluid. Defined by the builders with 
+*          interpolated bounce back, used with GEOMETRY_SDF to evaluate the 
+*          wall distances once in setup
+*   @param x: point x value (node x is at x+0.5)
+*   @param y: point y value (node y is at y+0.5)
+*   @param z: point z value in the whole domain (node z is at z+0.5)
+*   @return signed distance
+*/
+__host__
+dfloat builderSignedDistance(const dfloat x, const dfloat y, const dfloat z);
+
+
 #endif // !__BOUNDARY_CONDITIONS_BUILDER_H
\ No newline at end of file
@@ -38,7 +38,9 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
     const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
     const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
-    const unsigned int zDomain = z + NZ*gpuNumber;
+    const unsigned int xDomain = x + decompOrigin(gpuNumber, 0);
+    const unsigned int yDomain = y + decompOrigin(gpuNumber, 1);
+    const unsigned int zDomain = z + decompOrigin(gpuNumber, 2);
 
     if(x >= NX || y >= NY || z >= NZ)
         return;
@@ -54,15 +56,14 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     gpuMapBC[idxScalar(x, y, z)].setRhoIdx(0); // manually assigned (index of rho=RHO_0)
 
     // Cilinder values
-    // THIS RADIUS MUST BE THE SAME AS IN 
-    // "boundaryConditionsSchemes/interpolatedBounceBack.cu"
-    dfloat R = NY/2.0-0.5;
-    dfloat xCenter = (NX/2.0);
-    dfloat yCenter = (NY/2.0);
+    // THIS RADIUS MUST BE THE SAME AS IN "builderSignedDistance"
+    dfloat R = NY_TOTAL/2.0-0.5;
+    dfloat xCenter = (NX_TOTAL/2.0);
+    dfloat yCenter = (NY_TOTAL/2.0);
 
     // Node values
-    dfloat xNode = x+0.5;
-    dfloat yNode = y+0.5;
+    dfloat xNode = xDomain+0.5;
+    dfloat yNode = yDomain+0.5;
 
     dfloat distNode = distPoints2D(xNode, yNode, xCenter, yCenter);
 
@@ -102,7 +103,7 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
         dfloat xAdj = xNode - dirs[i][0];
         dfloat yAdj = yNode - dirs[i][1];
         // if the adjancent node is in boundaries
-        if(xAdj < NX && xAdj > 0 && yAdj < NY && yAdj > 0)
+        if(xAdj < NX_TOTAL && xAdj > 0 && yAdj < NY_TOTAL && yAdj > 0)
         {
             dfloat distAdj = distPoints2D(xAdj, yAdj, xCenter, yCenter);
             if(distAdj > R)
@@ -121,6 +122,19 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
 }
 
 
+__host__
+dfloat builderSignedDistance(const dfloat x, const dfloat y, const dfloat z)
+{
+    // Cilinder values, same as in "gpuBuildBoundaryConditions"
+    const dfloat R = NY_TOTAL/2.0-0.5;
+    const dfloat xCenter = (NX_TOTAL/2.0);
+    const dfloat yCenter = (NY_TOTAL/2.0);
+
+    // positive inside the cilinder
+    return R - distPoints2D(x, y, xCenter, yCenter);
+}
+
+
 __device__
 void gpuSchSpecial(NodeTypeMap* gpuNT, 
     dfloat* fPostStream,
@@ -37,7 +37,9 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
     const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
     const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
-    const unsigned int zDomain = z + NZ*gpuNumber;
+    const unsigned int xDomain = x + decompOrigin(gpuNumber, 0);
+    const unsigned int yDomain = y + decompOrigin(gpuNumber, 1);
+    const unsigned int zDomain = z + decompOrigin(gpuNumber, 2);
 
 
     if(x >= NX || y >= NY || z >= NZ)
@@ -53,13 +55,13 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     gpuMapBC[idxScalar(x, y, z)].setUzIdx(0); // manually assigned (index of uz=0)
     gpuMapBC[idxScalar(x, y, z)].setRhoIdx(0); // manually assigned (index of rho=RHO_0)
 
-    if (y == 0) // S
+    if (yDomain == 0) // S
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_VEL_ZOUHE);
         gpuMapBC[idxScalar(x, y, z)].setDirection(SOUTH);
         gpuMapBC[idxScalar(x, y, z)].setUzIdx(2); // manually assigned (index of uz=-UMAX/2)
     }
-    else if (y == (NY - 1)) // N
+    else if (yDomain == (NY_TOTAL - 1)) // N
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_VEL_ZOUHE);
         gpuMapBC[idxScalar(x, y, z)].setDirection(NORTH);
@@ -38,7 +38,9 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
     const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
     const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
-    const unsigned int zDomain = z + NZ*gpuNumber;
+    const unsigned int xDomain = x + decompOrigin(gpuNumber, 0);
+    const unsigned int yDomain = y + decompOrigin(gpuNumber, 1);
+    const unsigned int zDomain = z + decompOrigin(gpuNumber, 2);
 
 
     if(x >= NX || y >= NY || z >= NZ)
@@ -54,32 +56,32 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     gpuMapBC[idxScalar(x, y, z)].setUzIdx(0); // manually assigned (index of uz=0)
     gpuMapBC[idxScalar(x, y, z)].setRhoIdx(0); // manually assigned (index of rho=RHO_0)
 
-    if (y == 0 && zDomain == 0) // SB
+    if (yDomain == 0 && zDomain == 0) // SB
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_FREE_SLIP);
         gpuMapBC[idxScalar(x, y, z)].setDirection(SOUTH);
     }
-    else if (y == 0 && zDomain == (NZ_TOTAL-1)) // SF
+    else if (yDomain == 0 && zDomain == (NZ_TOTAL-1)) // SF
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_FREE_SLIP);
         gpuMapBC[idxScalar(x, y, z)].setDirection(SOUTH);
     }
-    else if (y == (NY - 1) && zDomain == 0) // NB
+    else if (yDomain == (NY_TOTAL - 1) && zDomain == 0) // NB
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_FREE_SLIP);
         gpuMapBC[idxScalar(x, y, z)].setDirection(NORTH);
     }
-    else if (y == (NY - 1) && zDomain == (NZ_TOTAL-1)) // NF
+    else if (yDomain == (NY_TOTAL - 1) && zDomain == (NZ_TOTAL-1)) // NF
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_FREE_SLIP);
         gpuMapBC[idxScalar(x, y, z)].setDirection(NORTH);
     }
-    else if (y == 0) // S
+    else if (yDomain == 0) // S
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_FREE_SLIP);
         gpuMapBC[idxScalar(x, y, z)].setDirection(SOUTH);
     }
-    else if (y == (NY - 1)) // N
+    else if (yDomain == (NY_TOTAL - 1)) // N
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_FREE_SLIP);
         gpuMapBC[idxScalar(x, y, z)].setDirection(NORTH);
@@ -92,9 +94,15 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     }
     else if (zDomain == (NZ_TOTAL-1)) // F
     {
+        // outlet lets the wakes leave the domain, if compiled
+        #ifdef BC_SCHEME_OUTFLOW_CONVECTIVE
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_OUTFLOW_CONVECTIVE);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(FRONT);
+        #else
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_VEL_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(FRONT);
         gpuMapBC[idxScalar(x, y, z)].setUzIdx(1);
+        #endif
     }
 }
 
@@ -38,7 +38,9 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
     const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
     const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
-    const unsigned int zDomain = z + NZ*gpuNumber;
+    const unsigned int xDomain = x + decompOrigin(gpuNumber, 0);
+    const unsigned int yDomain = y + decompOrigin(gpuNumber, 1);
+    const unsigned int zDomain = z + decompOrigin(gpuNumber, 2);
 
 
     if(x >= NX || y >= NY || z >= NZ)
@@ -54,117 +56,117 @@ void gpuBuildBoundaryConditions(NodeTypeMap* const gpuMapBC, int gpuNumber)
     gpuMapBC[idxScalar(x, y, z)].setUzIdx(0); // manually assigned (index of uz=0)
     gpuMapBC[idxScalar(x, y, z)].setRhoIdx(0); // manually assigned (index of rho=RHO_0)
 
-    if (y == 0 && x == 0 && zDomain == 0) // SWB
+    if (yDomain == 0 && xDomain == 0 && zDomain == 0) // SWB
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (y == 0 && x == 0 && zDomain == (NZ_TOTAL-1)) // SWF
+    else if (yDomain == 0 && xDomain == 0 && zDomain == (NZ_TOTAL-1)) // SWF
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (y == 0 && x == (NX - 1) && zDomain == 0) // SEB
+    else if (yDomain == 0 && xDomain == (NX_TOTAL - 1) && zDomain == 0) // SEB
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
     }
-    else if (y == 0 && x == (NX - 1) && zDomain == (NZ_TOTAL-1)) // SEF
+    else if (yDomain == 0 && xDomain == (NX_TOTAL - 1) && zDomain == (NZ_TOTAL-1)) // SEF
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
     }
-    else if (y == (NY - 1) && x == 0 && zDomain == 0) // NWB
+    else if (yDomain == (NY_TOTAL - 1) && xDomain == 0 && zDomain == 0) // NWB
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (y == (NY - 1) && x == 0 && zDomain == (NZ_TOTAL-1)) // NWF
+    else if (yDomain == (NY_TOTAL - 1) && xDomain == 0 && zDomain == (NZ_TOTAL-1)) // NWF
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (y == (NY - 1) && x == (NX - 1) && zDomain == 0) // NEB
+    else if (yDomain == (NY_TOTAL - 1) && xDomain == (NX_TOTAL - 1) && zDomain == 0) // NEB
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
 
     }
-    else if (y == (NY - 1) && x == (NX - 1) && zDomain == (NZ_TOTAL-1)) // NEF
+    else if (yDomain == (NY_TOTAL - 1) && xDomain == (NX_TOTAL - 1) && zDomain == (NZ_TOTAL-1)) // NEF
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
     }
-    else if (y == 0 && x == 0) // SW
+    else if (yDomain == 0 && xDomain == 0) // SW
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (y == 0 && x == (NX - 1)) // SE
+    else if (yDomain == 0 && xDomain == (NX_TOTAL - 1)) // SE
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
     }
-    else if (y == (NY - 1) && x == 0) // NW
+    else if (yDomain == (NY_TOTAL - 1) && xDomain == 0) // NW
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (y == (NY - 1) && x == (NX - 1)) // NE
+    else if (yDomain == (NY_TOTAL - 1) && xDomain == (NX_TOTAL - 1)) // NE
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
     }
-    else if (y == 0 && zDomain == 0) // SB
+    else if (yDomain == 0 && zDomain == 0) // SB
     {
 
     }
-    else if (y == 0 && zDomain == (NZ_TOTAL-1)) // SF
+    else if (yDomain == 0 && zDomain == (NZ_TOTAL-1)) // SF
     {
 
     }
-    else if (y == (NY - 1) && zDomain == 0) // NB
+    else if (yDomain == (NY_TOTAL - 1) && zDomain == 0) // NB
     {
 
     }
-    else if (y == (NY - 1) && zDomain == (NZ_TOTAL-1)) // NF
+    else if (yDomain == (NY_TOTAL - 1) && zDomain == (NZ_TOTAL-1)) // NF
     {
 
     }
-    else if (x == 0 && zDomain == 0) // WB
+    else if (xDomain == 0 && zDomain == 0) // WB
     {        
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (x == 0 && zDomain == (NZ_TOTAL-1)) // WF
+    else if (xDomain == 0 && zDomain == (NZ_TOTAL-1)) // WF
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (x == (NX - 1) && zDomain == 0) // EB
+    else if (xDomain == (NX_TOTAL - 1) && zDomain == 0) // EB
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
     }
-    else if (x == (NX - 1) && zDomain == (NZ_TOTAL-1)) // EF
+    else if (xDomain == (NX_TOTAL - 1) && zDomain == (NZ_TOTAL-1)) // EF
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
     }
-    else if (y == 0) // S
+    else if (yDomain == 0) // S
     {
 
     }
-    else if (y == (NY - 1)) // N
+    else if (yDomain == (NY_TOTAL - 1)) // N
     {
 
     }
-    else if (x == 0) // W
+    else if (xDomain == 0) // W
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
     }
-    else if (x == (NX - 1)) // E
+    else if (xDomain == (NX_TOTAL - 1)) // E
     {
         gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
         gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
@@ -0,0 +1,122 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "boundaryConditionsBuilder.h"
+#include "boundaryConditionsHandler.h"
+
+/*
+*   Quarter of square duct, with symmetry in west (x=0) and south (y=0) 
+*   and walls in east (x=NX-1) and north (y=NY-1). The full duct has 
+*   2*NX x 2*NY nodes. It requires COMP_SYMMETRY and COMP_BOUNCE_BACK
+*/
+
+__global__
+void gpuBuildBoundaryConditions(NodeTypeMap * const gpuMapBC, int gpuNumber)
+{
+    const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
+    const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
+    const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
+    const unsigned int xDomain = x + decompOrigin(gpuNumber, 0);
+    const unsigned int yDomain = y + decompOrigin(gpuNumber, 1);
+
+
+    if(x >= NX || y >= NY || z >= NZ)
+        return;
+
+    gpuMapBC[idxScalar(x, y, z)].setIsUsed(true); // set all nodes fluid inicially and no bc
+    gpuMapBC[idxScalar(x, y, z)].setSavePostCol(false); // set all nodes to not save post 
+                                                    // collision population (just stream)
+    gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_NULL);
+    gpuMapBC[idxScalar(x, y, z)].setGeometry(CONCAVE);
+    gpuMapBC[idxScalar(x, y, z)].setUxIdx(0); // manually assigned (index of ux=0)
+    gpuMapBC[idxScalar(x, y, z)].setUyIdx(0); // manually assigned (index of uy=0)
+    gpuMapBC[idxScalar(x, y, z)].setUzIdx(0); // manually assigned (index of uz=0)
+    gpuMapBC[idxScalar(x, y, z)].setRhoIdx(0); // manually assigned (index of rho=RHO_0)
+
+    if (yDomain == 0 && xDomain == 0) // SW (symmetry and symmetry)
+    {
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_SYMMETRY);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(SOUTH_WEST);
+    }
+    else if (yDomain == 0 && xDomain == (NX_TOTAL - 1)) // SE (symmetry and wall)
+    {
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_SPECIAL);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(SOUTH_EAST);
+    }
+    else if (yDomain == (NY_TOTAL - 1) && xDomain == 0) // NW (wall and symmetry)
+    {
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_SPECIAL);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(NORTH_WEST);
+    }
+    else if (yDomain == (NY_TOTAL - 1) && xDomain == (NX_TOTAL - 1)) // NE (wall and wall)
+    {
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(NORTH_EAST);
+    }
+    else if (yDomain == 0) // S
+    {
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_SYMMETRY);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(SOUTH);
+    }
+    else if (yDomain == (NY_TOTAL - 1)) // N
+    {
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(NORTH);
+    }
+    else if (xDomain == 0) // W
+    {
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_SYMMETRY);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(WEST);
+    }
+    else if (xDomain == (NX_TOTAL - 1)) // E
+    {
+        gpuMapBC[idxScalar(x, y, z)].setSchemeBC(BC_SCHEME_BOUNCE_BACK);
+        gpuMapBC[idxScalar(x, y, z)].setDirection(EAST);
+    }
+}
+
+
+__device__
+void gpuSchSpecial(NodeTypeMap* gpuNT, 
+    dfloat* fPostStream,
+    dfloat* fPostCol,
+    const short unsigned int x, 
+    const short unsigned int y, 
+    const short unsigned int z)
+{
+    // Edges between symmetry and wall. Symmetry is applied first, so the 
+    // populations that come from the wall are overwritten by bounce back
+    switch(gpuNT->getDirection())
+    {
+    case NORTH_WEST:
+        gpuBCSymmetryW(fPostStream, fPostCol, x, y, z);
+        gpuBCBounceBackN(fPostStream, fPostCol, x, y, z);
+        break;
+
+    case SOUTH_EAST:
+        gpuBCSymmetryS(fPostStream, fPostCol, x, y, z);
+        gpuBCBounceBackE(fPostStream, fPostCol, x, y, z);
+        break;
+
+    default:
+        break;
+    }
+}
\ No newline at end of file
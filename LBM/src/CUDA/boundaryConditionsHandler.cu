@@ -20,6 +20,31 @@
 */
 
 #include "boundaryConditionsHandler.h"
+#include "IBM/ibmVar.h"
+
+
+/*
+*   @brief Velocity of a velocity boundary condition node, from its indexes
+*          (UX_BC, UY_BC, UZ_BC). With the IBM moving frame, the inflow and 
+*          outflow faces in z (FRONT and BACK) impose the far field velocity
+*          (IBM_MOVING_FRAME_U*_INF). The frame moves by whole cells, shifting
+*          the values, and velocities are kept in laboratory frame, so the
+*          frame velocity is not subtracted
+*   @param gpuNT: node's map
+*   @return velocity to impose
+*/
+__device__ __forceinline__
+dfloat3 gpuVelocityBC(NodeTypeMap* gpuNT)
+{
+    #if defined(IBM) && IBM_MOVING_FRAME
+    const char dir = gpuNT->getDirection();
+    if(dir == FRONT || dir == BACK)
+        return dfloat3(IBM_MOVING_FRAME_UX_INF, IBM_MOVING_FRAME_UY_INF, 
+            IBM_MOVING_FRAME_UZ_INF);
+    #endif
+    return dfloat3(UX_BC[gpuNT->getUxIdx()], UY_BC[gpuNT->getUyIdx()], 
+        UZ_BC[gpuNT->getUzIdx()]);
+}
 
 
 __device__
@@ -62,11 +87,9 @@ void gpuBoundaryConditions(NodeTypeMap* gpuNT,
         gpuSchFreeSlip(gpuNT, fPostStream, fPostCol, x, y, z);
         break;
     #endif
-    #ifdef BC_SCHEME_INTERP_BOUNCE_BACK
-    case BC_SCHEME_INTERP_BOUNCE_BACK:
-        gpuBCInterpolatedBounceBack((unsigned char)(gpuNT->getBitsUnknownPopsInterpBB()), 
-            (bool)(gpuNT->getIsInsideNodeInterpoBB()),
-            fPostStream, fPostCol, x, y, z);
+    #ifdef BC_SCHEME_SYMMETRY
+    case BC_SCHEME_SYMMETRY:
+        gpuSchSymmetry(gpuNT, fPostStream, fPostCol, x, y, z);
         break;
     #endif
     case BC_SCHEME_SPECIAL:
@@ -119,6 +142,21 @@ void gpuSchFreeSlip(NodeTypeMap* gpuNT,
 #endif
 
 
+#ifdef BC_SCHEME_SYMMETRY
+__device__
+void gpuSchSymmetry(NodeTypeMap* gpuNT, 
+    dfloat* fPostStream,
+    dfloat* fPostCol,
+    const short unsigned int x, 
+    const short unsigned int y, 
+    const short unsigned int z)
+{
+    // Planes, edges and corners, concave or convex
+    gpuBCSymmetry(fPostStream, fPostCol, gpuNT->getDirection(), gpuNT->getGeometry(), x, y, z);
+}
+#endif
+
+
 #ifdef BC_SCHEME_BOUNCE_BACK
 __device__
 void gpuSchBounceBack(NodeTypeMap* gpuNT, 
@@ -271,30 +309,31 @@ void gpuSchVelBounceBack(NodeTypeMap* gpuNT,
     const short unsigned int z)
 {
     #ifdef D3Q19 // support only for D3Q19
+    const dfloat3 u = gpuVelocityBC(gpuNT);
     switch (gpuNT->getDirection())
     {
     case NORTH:
-        gpuBCVelBounceBackN(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()], UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelBounceBackN(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case SOUTH:
-        gpuBCVelBounceBackS(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()], UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelBounceBackS(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case WEST:
-        gpuBCVelBounceBackW(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()], UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelBounceBackW(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case EAST:
-        gpuBCVelBounceBackE(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()], UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelBounceBackE(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case FRONT:
-        gpuBCVelBounceBackF(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()], UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelBounceBackF(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case BACK:
-        gpuBCVelBounceBackB(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()], UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelBounceBackB(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     default:
@@ -358,36 +397,31 @@ void gpuSchVelZouHe(NodeTypeMap* gpuNT,
     const short unsigned int z)
 {
     #ifdef D3Q19 // support only for D3Q19
+    const dfloat3 u = gpuVelocityBC(gpuNT);
     switch (gpuNT->getDirection())
     {
     case NORTH:
-        gpuBCVelZouHeN(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()], 
-            UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelZouHeN(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case SOUTH:
-        gpuBCVelZouHeS(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()],
-            UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelZouHeS(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case WEST:
-        gpuBCVelZouHeW(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()],
-            UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelZouHeW(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case EAST:
-        gpuBCVelZouHeE(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()],
-            UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelZouHeE(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case FRONT:
-        gpuBCVelZouHeF(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()],
-            UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelZouHeF(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
 
     case BACK:
-        gpuBCVelZouHeB(fPostStream, fPostCol, x, y, z, UX_BC[gpuNT->getUxIdx()],
-            UY_BC[gpuNT->getUyIdx()], UZ_BC[gpuNT->getUzIdx()]);
+        gpuBCVelZouHeB(fPostStream, fPostCol, x, y, z, u.x, u.y, u.z);
         break;
     default:
         break;
@@ -13,7 +13,9 @@
 #include "structs/populations.h"
 #include "boundaryConditionsSchemes/bounceBack.h"
 #include "boundaryConditionsSchemes/freeSlip.h"
+#include "boundaryConditionsSchemes/symmetry.h"
 #include "boundaryConditionsSchemes/interpolatedBounceBack.h"
+#include "boundaryConditionsSchemes/outflow.h"
 #ifdef D3Q19
 #include "boundaryConditionsSchemes/D3Q19_VelBounceBack.h"
 #include "boundaryConditionsSchemes/D3Q19_VelZouHe.h"
@@ -74,6 +76,24 @@ void gpuSchFreeSlip(NodeTypeMap* gpuNT,
     const short unsigned int z);
 
 
+/*
+*   @brief Applies symmetry boundary condition given node's type
+*   @param gpuNT: node's map
+*   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
+*   @param fPostCol[(NX, NY, NZ, Q)]: post collision populations from last step
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*/
+__device__
+void gpuSchSymmetry(NodeTypeMap* gpuNT,
+    dfloat* fPostStream,
+    dfloat* fPostCol,
+    const short unsigned int x, 
+    const short unsigned int y, 
+    const short unsigned int z);
+
+
 /*
 *   @brief Applies bounce back boundary condition given node's population
 *   @param gpuNT: node's map
@@ -148,4 +168,53 @@ void gpuSchVelZouHe(NodeTypeMap* gpuNT,
     const short unsigned int z);
 
 
+
+/*
+*   @brief Applies boundary condition of scheme given in compile time. Used 
+*          by groups of nodes with same scheme, direction and geometry, so
+*          the direction and geometry switches of the scheme do not diverge
+*   @param gpuNT: node's map
+*   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
+*   @param fPostCol[(NX, NY, NZ, Q)]: post collision populations from last step
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*/
+template <unsigned char SCHEME>
+__device__ __forceinline__
+void gpuBoundaryConditionsScheme(NodeTypeMap* gpuNT,
+    dfloat* fPostStream,
+    dfloat* fPostCol,
+    const short unsigned int x, 
+    const short unsigned int y, 
+    const short unsigned int z)
+{
+    #ifdef BC_SCHEME_BOUNCE_BACK
+    if constexpr (SCHEME == BC_SCHEME_BOUNCE_BACK)
+        gpuSchBounceBack(gpuNT, fPostStream, fPostCol, x, y, z);
+    #endif
+    #ifdef BC_SCHEME_VEL_BOUNCE_BACK
+    if constexpr (SCHEME == BC_SCHEME_VEL_BOUNCE_BACK)
+        gpuSchVelBounceBack(gpuNT, fPostStream, fPostCol, x, y, z);
+    #endif
+    #ifdef BC_SCHEME_VEL_ZOUHE
+    if constexpr (SCHEME == BC_SCHEME_VEL_ZOUHE)
+        gpuSchVelZouHe(gpuNT, fPostStream, fPostCol, x, y, z);
+    #endif
+    #ifdef BC_SCHEME_PRES_ZOUHE
+    if constexpr (SCHEME == BC_SCHEME_PRES_ZOUHE)
+        gpuSchPresZouHe(gpuNT, fPostStream, fPostCol, x, y, z);
+    #endif
+    #ifdef BC_SCHEME_FREE_SLIP
+    if constexpr (SCHEME == BC_SCHEME_FREE_SLIP)
+        gpuSchFreeSlip(gpuNT, fPostStream, fPostCol, x, y, z);
+    #endif
+    #ifdef BC_SCHEME_SYMMETRY
+    if constexpr (SCHEME == BC_SCHEME_SYMMETRY)
+        gpuSchSymmetry(gpuNT, fPostStream, fPostCol, x, y, z);
+    #endif
+    if constexpr (SCHEME == BC_SCHEME_SPECIAL)
+        gpuSchSpecial(gpuNT, fPostStream, fPostCol, x, y, z);
+}
+
 #endif // !__BOUNDARY_CONDITIONS_HANDLER_H
\ No newline at end of file
@@ -20,31 +20,48 @@
 */
 
 #include "D3Q19_PresZouHe.h"
+#include "./../velocitySets/velocitySetUnroll.h"
 
 #ifdef BC_SCHEME_PRES_ZOUHE
 #ifdef D3Q19
 
+/*
+*   @brief Applies pressure Zou-He boundary condition on node of face with 
+*          normal SIGN in direction DIR, unrolled from the velocity set. The
+*          velocity is normal to the face
+*   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*   @param rho_w: node's density
+*/
+template <int DIR, int SIGN>
+__device__ __forceinline__
+void gpuBCPresZouHe(dfloat* fPostStream, const short unsigned int x, const short unsigned int y,
+    const short unsigned int z, const dfloat rho_w)
+{
+    dfloat fNode[Q];
+    #pragma unroll
+    for(int i = 0; i < Q; i++)
+        fNode[i] = fPostStream[idxPop(x, y, z, i)];
+
+    // u = SIGN*((sum(f, c=0) + 2*sum(f, c=SIGN))/rho - 1), in DIR
+    const dfloat uN = SIGN*((popSumDir<DIR, 0>(fNode) + 2*popSumDir<DIR, SIGN>(fNode))
+        / rho_w - 1);
+
+    // Transverse momentum corrections, nt = 0.5*sum(f*ct, c=0)
+    popZouHe<DIR, SIGN>(fPostStream, fNode, x, y, z, rho_w,
+        (DIR == 0) ? uN : 0, (DIR == 1) ? uN : 0, (DIR == 2) ? uN : 0,
+        0.5*popMomentPlane<DIR, 0>(fNode), 0.5*popMomentPlane<DIR, 1>(fNode),
+        0.5*popMomentPlane<DIR, 2>(fNode));
+}
+
+
 __device__
 void gpuBCPresZouHeN(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat rho_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat uy_w = -1 + (1/rho_w) * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 2)]
-        + f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 9)]
-        + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 7)]
-            + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 11)] + f[idxPop(x, y, z, 17)]));
-
-    const dfloat nyx = 0.5 * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 9)] + f[idxPop(x, y, z, 15)]
-        - (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]));
-    const dfloat nyz = 0.5 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 9)] + f[idxPop(x, y, z, 16)]
-        - (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 10)]));
-
-    f[idxPop(x, y, z, 4)] = f[idxPop(x, y, z, 3)] + rho_w * (-uy_w) / 3;
-    f[idxPop(x, y, z, 8)] = f[idxPop(x, y, z, 7)] + rho_w * (-uy_w) / 6 + nyx;
-    f[idxPop(x, y, z, 13)] = f[idxPop(x, y, z, 14)] + rho_w * (-uy_w) / 6 - nyx;
-    f[idxPop(x, y, z, 12)] = f[idxPop(x, y, z, 11)] + rho_w * (-uy_w) / 6 + nyz;
-    f[idxPop(x, y, z, 18)] = f[idxPop(x, y, z, 17)] + rho_w * (-uy_w) / 6 - nyz;
+    gpuBCPresZouHe<1, 1>(fPostStream, x, y, z, rho_w);
 }
 
 
@@ -52,23 +69,7 @@ __device__
 void gpuBCPresZouHeS(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat rho_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat uy_w = 1 - (1/rho_w) * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 2)]
-        + f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 9)]
-        + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 13)]
-            + f[idxPop(x, y, z, 8)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)]));
-
-    const dfloat nyx = 0.5 * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 9)] + f[idxPop(x, y, z, 15)]
-        - (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]));
-    const dfloat nyz = 0.5 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 9)] + f[idxPop(x, y, z, 16)]
-        - (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 10)]));
-
-    f[idxPop(x, y, z, 3)] = f[idxPop(x, y, z, 4)] + rho_w * uy_w / 3;
-    f[idxPop(x, y, z, 7)] = f[idxPop(x, y, z, 8)] + rho_w * (uy_w) / 6 - nyx;
-    f[idxPop(x, y, z, 14)] = f[idxPop(x, y, z, 13)] + rho_w * (uy_w) / 6 + nyx;
-    f[idxPop(x, y, z, 11)] = f[idxPop(x, y, z, 12)] + rho_w * (uy_w) / 6 - nyz;
-    f[idxPop(x, y, z, 17)] = f[idxPop(x, y, z, 18)] + rho_w * (uy_w) / 6 + nyz;
+    gpuBCPresZouHe<1, -1>(fPostStream, x, y, z, rho_w);
 }
 
 
@@ -76,23 +77,7 @@ __device__
 void gpuBCPresZouHeW(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat rho_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat ux_w = 1 - (1/rho_w) * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 4)]
-        + f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 11)]
-        + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 14)]
-            + f[idxPop(x, y, z, 8)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]));
-
-    const dfloat nxy = 0.5 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 11)] + f[idxPop(x, y, z, 17)]
-        - (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)]));
-    const dfloat nxz = 0.5 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 11)]
-        - (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 12)]));
-
-    f[idxPop(x, y, z, 1)] = f[idxPop(x, y, z, 2)] + rho_w * ux_w / 3;
-    f[idxPop(x, y, z, 13)] = f[idxPop(x, y, z, 14)] + rho_w * (ux_w) / 6 + nxy;
-    f[idxPop(x, y, z, 7)] = f[idxPop(x, y, z, 8)] + rho_w * (ux_w) / 6 - nxy;
-    f[idxPop(x, y, z, 9)] = f[idxPop(x, y, z, 10)] + rho_w * (ux_w) / 6 - nxz;
-    f[idxPop(x, y, z, 15)] = f[idxPop(x, y, z, 16)] + rho_w * (ux_w) / 6 + nxz;
+    gpuBCPresZouHe<0, -1>(fPostStream, x, y, z, rho_w);
 }
 
 
@@ -100,23 +85,7 @@ __device__
 void gpuBCPresZouHeE(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat rho_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat ux_w = -1 + (1/rho_w) * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 4)]
-        + f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 11)]
-        + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 14)]
-            + f[idxPop(x, y, z, 8)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]));
-
-    const dfloat nxy = 0.5 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 11)] + f[idxPop(x, y, z, 17)]
-        - (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)]));
-    const dfloat nxz = 0.5 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 11)]
-        - (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 12)]));
-
-    f[idxPop(x, y, z, 2)] = f[idxPop(x, y, z, 2)] + rho_w * ux_w / 3;
-    f[idxPop(x, y, z, 14)] = f[idxPop(x, y, z, 14)] + rho_w * (ux_w) / 6 + nxy;
-    f[idxPop(x, y, z, 8)] = f[idxPop(x, y, z, 8)] + rho_w * (ux_w) / 6 - nxy;
-    f[idxPop(x, y, z, 10)] = f[idxPop(x, y, z, 10)] + rho_w * (ux_w) / 6 - nxz;
-    f[idxPop(x, y, z, 16)] = f[idxPop(x, y, z, 16)] + rho_w * (ux_w) / 6 + nxz;
+    gpuBCPresZouHe<0, 1>(fPostStream, x, y, z, rho_w);
 }
 
 
@@ -124,26 +93,7 @@ __device__
 void gpuBCPresZouHeF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat rho_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat uz_w = -1 + (1 / rho_w) * (f[idxPop(x, y, z, 1)]  + f[idxPop(x, y, z, 2)]
-        + f[idxPop(x, y, z, 3)]  + f[idxPop(x, y, z, 4)]  + f[idxPop(x, y, z, 7)]
-        + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 8)]  + f[idxPop(x, y, z, 13)]
-        + f[idxPop(x, y, z, 0)]  +2*(f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 9)]
-        + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 11)] + f[idxPop(x, y, z, 18)]));
-    
-    const dfloat nzx = 0.5 * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 7)] + f[idxPop(x, y, z, 13)]
-        - (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 8)]));
-        // - rho_w*ux_w/3;
-    
-    const dfloat nzy = 0.5 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 7)] + f[idxPop(x, y, z, 14)]
-        - (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 13)] + f[idxPop(x, y, z, 8)]));
-        // - rho_w*uy_w/3
-
-    f[idxPop(x, y, z, 6)] = f[idxPop(x, y, z, 5)] + rho_w*(-uz_w)/3;
-    f[idxPop(x, y, z, 15)] = f[idxPop(x, y, z, 16)] + rho_w*(-uz_w) / 6 - nzx;
-    f[idxPop(x, y, z, 10)] = f[idxPop(x, y, z,  9)] + rho_w*(-uz_w) / 6 + nzx;
-    f[idxPop(x, y, z, 17)] = f[idxPop(x, y, z, 18)] + rho_w*(-uz_w) / 6 - nzy;
-    f[idxPop(x, y, z, 12)] = f[idxPop(x, y, z, 11)] + rho_w*(-uz_w) / 6 + nzy;
+    gpuBCPresZouHe<2, 1>(fPostStream, x, y, z, rho_w);
 }
 
 
@@ -151,26 +101,7 @@ __device__
 void gpuBCPresZouHeB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat rho_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat uz_w = 1 - (1 / rho_w) * (f[idxPop(x, y, z, 1)]  + f[idxPop(x, y, z, 2)]
-        + f[idxPop(x, y, z, 3)]  + f[idxPop(x, y, z, 4)]  + f[idxPop(x, y, z, 7)]
-        + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 8)]  + f[idxPop(x, y, z, 13)]
-        + f[idxPop(x, y, z, 0)]  +2*(f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 10)]
-        + f[idxPop(x, y, z, 12)] + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 17)]));
-    
-    const dfloat nzx = 0.5 * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 7)] + f[idxPop(x, y, z, 13)]
-        - (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 8)]));
-        // - rho_w*ux_w/3;
-    
-    const dfloat nzy = 0.5 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 7)] + f[idxPop(x, y, z, 14)]
-        - (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 13)] + f[idxPop(x, y, z, 8)]));
-        // - rho_w*uy_w/3
-
-    f[idxPop(x, y, z, 5)] = f[idxPop(x, y, z, 6)] + rho_w*uz_w/3;
-    f[idxPop(x, y, z,  9)] = f[idxPop(x, y, z, 10)] + rho_w*uz_w / 6 - nzx;
-    f[idxPop(x, y, z, 16)] = f[idxPop(x, y, z, 15)] + rho_w*uz_w / 6 + nzx;
-    f[idxPop(x, y, z, 11)] = f[idxPop(x, y, z, 12)] + rho_w*uz_w / 6 - nzy;
-    f[idxPop(x, y, z, 18)] = f[idxPop(x, y, z, 17)] + rho_w*uz_w / 6 + nzy;
+    gpuBCPresZouHe<2, -1>(fPostStream, x, y, z, rho_w);
 }
 
 #endif //!D3Q19
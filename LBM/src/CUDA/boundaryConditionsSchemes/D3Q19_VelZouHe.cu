@@ -20,31 +20,51 @@
 */
 
 #include "D3Q19_VelZouHe.h"
+#include "./../velocitySets/velocitySetUnroll.h"
 
 #ifdef BC_SCHEME_VEL_ZOUHE
 #ifdef D3Q19
 
+/*
+*   @brief Applies velocity Zou-He boundary condition on node of face with 
+*          normal SIGN in direction DIR, unrolled from the velocity set
+*   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*   @param ux_w: node's x velocity
+*   @param uy_w: node's y velocity
+*   @param uz_w: node's z velocity
+*/
+template <int DIR, int SIGN>
+__device__ __forceinline__
+void gpuBCVelZouHe(dfloat* fPostStream, const short unsigned int x, const short unsigned int y,
+    const short unsigned int z, const dfloat ux_w, const dfloat uy_w, const dfloat uz_w)
+{
+    dfloat fNode[Q];
+    #pragma unroll
+    for(int i = 0; i < Q; i++)
+        fNode[i] = fPostStream[idxPop(x, y, z, i)];
+
+    const dfloat uN = (DIR == 0) ? ux_w : ((DIR == 1) ? uy_w : uz_w);
+    // rho = (sum(f, c=0) + 2*sum(f, c=SIGN)) / (1 + SIGN*u), in DIR
+    const dfloat rho_w = (popSumDir<DIR, 0>(fNode) + 2*popSumDir<DIR, SIGN>(fNode))
+        / (1 + SIGN*uN);
+
+    // Transverse momentum corrections, nt = 0.5*sum(f*ct, c=0) - rho*ut/3
+    const dfloat ntx = 0.5*popMomentPlane<DIR, 0>(fNode) - rho_w*ux_w/3;
+    const dfloat nty = 0.5*popMomentPlane<DIR, 1>(fNode) - rho_w*uy_w/3;
+    const dfloat ntz = 0.5*popMomentPlane<DIR, 2>(fNode) - rho_w*uz_w/3;
+
+    popZouHe<DIR, SIGN>(fPostStream, fNode, x, y, z, rho_w, ux_w, uy_w, uz_w, ntx, nty, ntz);
+}
+
+
 __device__
 void gpuBCVelZouHeN(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat ux_w, const dfloat uy_w, const dfloat uz_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat rho_w = (1 / (1 + uy_w)) * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 2)]
-        + f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 9)]
-        + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 7)] 
-        + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 11)] + f[idxPop(x, y, z, 17)]));
-
-    const dfloat nyx = 0.5 * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 9)] + f[idxPop(x, y, z, 15)]
-        - (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)])) - ux_w * rho_w / 3;
-    const dfloat nyz = 0.5 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 9)] + f[idxPop(x, y, z, 16)]
-        - (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 10)])) - uz_w * rho_w / 3;
-
-    f[idxPop(x, y, z, 4)] = f[idxPop(x, y, z, 3)] + rho_w * (-uy_w) / 3;
-    f[idxPop(x, y, z, 8)] = f[idxPop(x, y, z, 7)] + rho_w * (-uy_w - ux_w) / 6 + nyx;
-    f[idxPop(x, y, z, 13)] = f[idxPop(x, y, z, 14)] + rho_w * (-uy_w + ux_w) / 6 - nyx;
-    f[idxPop(x, y, z, 12)] = f[idxPop(x, y, z, 11)] + rho_w * (-uy_w - uz_w) / 6 + nyz;
-    f[idxPop(x, y, z, 18)] = f[idxPop(x, y, z, 17)] + rho_w * (-uy_w + uz_w) / 6 - nyz;
+    gpuBCVelZouHe<1, 1>(fPostStream, x, y, z, ux_w, uy_w, uz_w);
 }
 
 
@@ -52,23 +72,7 @@ __device__
 void gpuBCVelZouHeS(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat ux_w, const dfloat uy_w, const dfloat uz_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat rho_w = (1 / (1 - uy_w)) * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 2)]
-        + f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 9)]
-        + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 13)]
-        + f[idxPop(x, y, z, 8)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)]));
-
-    const dfloat nyx = 0.5 * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 9)] + f[idxPop(x, y, z, 15)]
-        - (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)])) - ux_w * rho_w / 3;
-    const dfloat nyz = 0.5 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 9)] + f[idxPop(x, y, z, 16)]
-        - (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 15)] + f[idxPop(x, y, z, 10)])) - uz_w * rho_w / 3;
-    
-    f[idxPop(x, y, z, 3)] = f[idxPop(x, y, z, 4)] + rho_w * uy_w / 3;
-    f[idxPop(x, y, z, 7)] = f[idxPop(x, y, z, 8)] + rho_w * (uy_w + ux_w) / 6 - nyx;
-    f[idxPop(x, y, z, 14)] = f[idxPop(x, y, z, 13)] + rho_w * (uy_w - ux_w) / 6 + nyx;
-    f[idxPop(x, y, z, 11)] = f[idxPop(x, y, z, 12)] + rho_w * (uy_w + uz_w) / 6 - nyz;
-    f[idxPop(x, y, z, 17)] = f[idxPop(x, y, z, 18)] + rho_w * (uy_w - uz_w) / 6 + nyz;
+    gpuBCVelZouHe<1, -1>(fPostStream, x, y, z, ux_w, uy_w, uz_w);
 }
 
 
@@ -76,23 +80,7 @@ __device__
 void gpuBCVelZouHeW(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat ux_w, const dfloat uy_w, const dfloat uz_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat rho_w = (1 / (1 - ux_w)) * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 4)]
-        + f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 11)]
-        + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 14)]
-            + f[idxPop(x, y, z, 8)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]));
-
-    const dfloat nxy = 0.5 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 11)] + f[idxPop(x, y, z, 17)]
-        - (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)])) - uy_w * rho_w / 3;
-    const dfloat nxz = 0.5 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 11)]
-        - (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 12)])) - uz_w * rho_w / 3;
-
-    f[idxPop(x, y, z, 1)] = f[idxPop(x, y, z, 2)] + rho_w * ux_w / 3;
-    f[idxPop(x, y, z, 13)] = f[idxPop(x, y, z, 14)] + rho_w * (ux_w - uy_w) / 6 + nxy;
-    f[idxPop(x, y, z, 7)] = f[idxPop(x, y, z, 8)] + rho_w * (ux_w + uy_w) / 6 - nxy;
-    f[idxPop(x, y, z, 9)] = f[idxPop(x, y, z, 10)] + rho_w * (ux_w + uz_w) / 6 - nxz;
-    f[idxPop(x, y, z, 15)] = f[idxPop(x, y, z, 16)] + rho_w * (ux_w - uy_w) / 6 + nxz;
+    gpuBCVelZouHe<0, -1>(fPostStream, x, y, z, ux_w, uy_w, uz_w);
 }
 
 
@@ -100,23 +88,7 @@ __device__
 void gpuBCVelZouHeE(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat ux_w, const dfloat uy_w, const dfloat uz_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat rho_w = (1 / (1 + ux_w)) * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 4)]
-        + f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 11)]
-        + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 14)]
-            + f[idxPop(x, y, z, 8)] + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 10)]));
-
-    const dfloat nxy = 0.5 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 11)] + f[idxPop(x, y, z, 17)]
-        - (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 12)])) - uy_w * rho_w / 3;
-    const dfloat nxz = 0.5 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 18)] + f[idxPop(x, y, z, 11)]
-        - (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 12)])) - uz_w * rho_w / 3;
-
-    f[idxPop(x, y, z, 2)] = f[idxPop(x, y, z, 2)] + rho_w * ux_w / 3;
-    f[idxPop(x, y, z, 14)] = f[idxPop(x, y, z, 14)] + rho_w * (ux_w - uy_w) / 6 + nxy;
-    f[idxPop(x, y, z, 8)] = f[idxPop(x, y, z, 8)] + rho_w * (ux_w + uy_w) / 6 - nxy;
-    f[idxPop(x, y, z, 10)] = f[idxPop(x, y, z, 10)] + rho_w * (ux_w + uz_w) / 6 - nxz;
-    f[idxPop(x, y, z, 16)] = f[idxPop(x, y, z, 16)] + rho_w * (ux_w - uy_w) / 6 + nxz;
+    gpuBCVelZouHe<0, 1>(fPostStream, x, y, z, ux_w, uy_w, uz_w);
 }
 
 
@@ -124,24 +96,7 @@ __device__
 void gpuBCVelZouHeF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat ux_w, const dfloat uy_w, const dfloat uz_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat rho_w = (1 / (1 + uz_w)) * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 2)]
-        + f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 7)]
-        + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 8)] + f[idxPop(x, y, z, 13)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 5)] + f[idxPop(x, y, z, 9)]
-            + f[idxPop(x, y, z, 16)] + f[idxPop(x, y, z, 11)] + f[idxPop(x, y, z, 18)]));
-
-    const dfloat nzx = 0.5 * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 7)] + f[idxPop(x, y, z, 13)]
-        - (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 8)])) - rho_w * ux_w / 3;
-
-    const dfloat nzy = 0.5 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 7)] + f[idxPop(x, y, z, 14)]
-        - (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 13)] + f[idxPop(x, y, z, 8)])) - rho_w * uy_w / 3;
-
-    f[idxPop(x, y, z, 6)] = f[idxPop(x, y, z, 5)] + rho_w * (-uz_w) / 3;
-    f[idxPop(x, y, z, 15)] = f[idxPop(x, y, z, 16)] + rho_w * (-uz_w + ux_w) / 6 - nzx;
-    f[idxPop(x, y, z, 10)] = f[idxPop(x, y, z, 9)] + rho_w * (-uz_w - ux_w) / 6 + nzx;
-    f[idxPop(x, y, z, 17)] = f[idxPop(x, y, z, 18)] + rho_w * (-uz_w + uy_w) / 6 - nzy;
-    f[idxPop(x, y, z, 12)] = f[idxPop(x, y, z, 11)] + rho_w * (-uz_w - uy_w) / 6 + nzy;
+    gpuBCVelZouHe<2, 1>(fPostStream, x, y, z, ux_w, uy_w, uz_w);
 }
 
 
@@ -149,24 +104,7 @@ __device__
 void gpuBCVelZouHeB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z, const dfloat ux_w, const dfloat uy_w, const dfloat uz_w)
 {
-    dfloat* f = fPostStream;
-    const dfloat rho_w = (1 / (1 + uz_w)) * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 2)]
-        + f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 7)]
-        + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 8)] + f[idxPop(x, y, z, 13)]
-        + f[idxPop(x, y, z, 0)] + 2 * (f[idxPop(x, y, z, 6)] + f[idxPop(x, y, z, 15)]
-            + f[idxPop(x, y, z, 10)] + f[idxPop(x, y, z, 17)] + f[idxPop(x, y, z, 12)]));
-
-    const dfloat nzx = 0.5 * (f[idxPop(x, y, z, 1)] + f[idxPop(x, y, z, 7)] + f[idxPop(x, y, z, 13)]
-        - (f[idxPop(x, y, z, 2)] + f[idxPop(x, y, z, 14)] + f[idxPop(x, y, z, 8)])) - rho_w * ux_w / 3;
-
-    const dfloat nzy = 0.5 * (f[idxPop(x, y, z, 3)] + f[idxPop(x, y, z, 7)] + f[idxPop(x, y, z, 14)]
-        - (f[idxPop(x, y, z, 4)] + f[idxPop(x, y, z, 13)] + f[idxPop(x, y, z, 8)])) - rho_w * uy_w / 3;
-
-    f[idxPop(x, y, z, 5)] = f[idxPop(x, y, z, 6)] + rho_w * (uz_w) / 3;
-    f[idxPop(x, y, z, 9)] = f[idxPop(x, y, z, 10)] + rho_w * (uz_w + ux_w) / 6 - nzx;
-    f[idxPop(x, y, z, 16)] = f[idxPop(x, y, z, 15)] + rho_w * (uz_w - ux_w) / 6 + nzx;
-    f[idxPop(x, y, z, 11)] = f[idxPop(x, y, z, 12)] + rho_w * (uz_w + ux_w) / 6 - nzy;
-    f[idxPop(x, y, z, 18)] = f[idxPop(x, y, z, 17)] + rho_w * (uz_w - ux_w) / 6 + nzy;
+    gpuBCVelZouHe<2, -1>(fPostStream, x, y, z, ux_w, uy_w, uz_w);
 }
 
 #endif //!D3Q19
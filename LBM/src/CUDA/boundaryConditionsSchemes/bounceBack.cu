@@ -27,16 +27,16 @@ __device__
 void gpuBCBounceBackN(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(x, y, z, 19)];
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(x, y, z, 21)];
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(x, y, z, 24)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(x, y, z, 25)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, x, y, z, 19);
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, x, y, z, 21);
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, x, y, z, 24);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, x, y, z, 25);
     #endif
 }
 
@@ -45,16 +45,16 @@ __device__
 void gpuBCBounceBackS(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(x, y, z, 20)];
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(x, y, z, 22)];
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(x, y, z, 23)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(x, y, z, 26)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, x, y, z, 20);
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, x, y, z, 22);
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, x, y, z, 23);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, x, y, z, 26);
     #endif
 }
 
@@ -63,16 +63,16 @@ __device__
 void gpuBCBounceBackW(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(x, y, z, 20)];
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(x, y, z, 22)];
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(x, y, z, 24)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(x, y, z, 25)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, x, y, z, 20);
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, x, y, z, 22);
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, x, y, z, 24);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, x, y, z, 25);
     #endif
 }
 
@@ -81,16 +81,16 @@ __device__
 void gpuBCBounceBackE(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(x, y, z, 19)];
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(x, y, z, 21)];
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(x, y, z, 23)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(x, y, z, 26)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, x, y, z, 19);
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, x, y, z, 21);
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, x, y, z, 23);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, x, y, z, 26);
     #endif
 }
 
@@ -99,16 +99,16 @@ __device__
 void gpuBCBounceBackF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(x, y, z, 19)];
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(x, y, z, 22)];
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(x, y, z, 23)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(x, y, z, 25)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, x, y, z, 19);
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, x, y, z, 22);
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, x, y, z, 23);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, x, y, z, 25);
     #endif
 }
 
@@ -117,16 +117,16 @@ __device__
 void gpuBCBounceBackB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(x, y, z, 20)];
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(x, y, z, 21)];
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(x, y, z, 24)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(x, y, z, 26)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, x, y, z, 20);
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, x, y, z, 21);
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, x, y, z, 24);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, x, y, z, 26);
     #endif
 }
 
@@ -135,16 +135,16 @@ __device__
 void gpuBCBounceBackNW(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(x, y, z, 24)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(x, y, z, 25)];
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, x, y, z, 24);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, x, y, z, 25);
     #endif
     //Dead Pop are: [7, 8, 19, 20, 21, 22]
 }
@@ -154,16 +154,16 @@ __device__
 void gpuBCBounceBackNE(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(x, y, z, 19)];
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(x, y, z, 21)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, x, y, z, 19);
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, x, y, z, 21);
     #endif
     //Dead Pop are: [13, 14, 23, 24, 25, 26]
 }
@@ -173,16 +173,16 @@ __device__
 void gpuBCBounceBackNF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(x, y, z, 19)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(x, y, z, 25)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, x, y, z, 19);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, x, y, z, 25);
     #endif
     //Dead Pop are: [17, 18, 21, 22, 23, 24]
 }
@@ -192,16 +192,16 @@ __device__
 void gpuBCBounceBackNB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(x, y, z, 21)];
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(x, y, z, 24)];
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, x, y, z, 21);
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, x, y, z, 24);
     #endif
     //Dead Pop are: [11, 12, 19, 20, 25, 26]
 }
@@ -211,16 +211,16 @@ __device__
 void gpuBCBounceBackSW(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(x, y, z, 20)];
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(x, y, z, 22)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, x, y, z, 20);
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, x, y, z, 22);
     #endif
     //Dead Pop are: [13, 14, 23, 24, 25, 26]
 }
@@ -231,16 +231,16 @@ __device__
 void gpuBCBounceBackSE(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(x, y, z, 23)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(x, y, z, 26)];
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, x, y, z, 23);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, x, y, z, 26);
     #endif
     //Dead Pop are: [7, 8, 19, 20, 21, 22]
 }
@@ -250,16 +250,16 @@ __device__
 void gpuBCBounceBackSF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(x, y, z, 22)];
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(x, y, z, 23)];
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, x, y, z, 22);
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, x, y, z, 23);
     #endif
     //Dead Pop are: [11, 12, 19, 20, 25, 26]
 }
@@ -269,16 +269,16 @@ __device__
 void gpuBCBounceBackSB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(x, y, z, 20)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(x, y, z, 26)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, x, y, z, 20);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, x, y, z, 26);
     #endif
     //Dead Pop are: [17, 18, 21, 22, 23, 24]
 }
@@ -288,16 +288,16 @@ __device__
 void gpuBCBounceBackWF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(x, y, z, 22)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(x, y, z, 25)];
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, x, y, z, 22);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, x, y, z, 25);
     #endif
     //Dead Pop are: [9, 10, 19, 20, 23, 24]
 }
@@ -307,16 +307,16 @@ __device__
 void gpuBCBounceBackWB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(x, y, z, 20)];
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(x, y, z, 24)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, x, y, z, 20);
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, x, y, z, 24);
     #endif
     //Dead Pop are: [15, 16, 21, 22, 25, 26]
 
@@ -327,16 +327,16 @@ __device__
 void gpuBCBounceBackEF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(x, y, z, 19)];
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(x, y, z, 23)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, x, y, z, 19);
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, x, y, z, 23);
     #endif
     //Dead Pop are: [15, 16, 21, 22, 25, 26]
 }
@@ -346,16 +346,16 @@ __device__
 void gpuBCBounceBackEB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(x, y, z, 21)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(x, y, z, 26)];
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, x, y, z, 21);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, x, y, z, 26);
     #endif
     //Dead Pop are: [9, 10, 19, 20, 23, 24]
 }
@@ -365,14 +365,14 @@ __device__
 void gpuBCBounceBackNWF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(x, y, z, 25)];
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, x, y, z, 25);
     #endif
     //Dead Pop are: [7, 8, 9, 10, 17, 18, 19, 20, 21, 22, 23, 24]
 }
@@ -382,14 +382,14 @@ __device__
 void gpuBCBounceBackNWB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, y, z, 14);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(x, y, z, 24)];
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, x, y, z, 24);
     #endif
     //Dead Pop are: [7, 8, 11, 12, 15, 16, 19, 20, 21, 22, 25, 26]
 }
@@ -399,14 +399,14 @@ __device__
 void gpuBCBounceBackNEF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, z, 11)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, z, 11);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(x, y, z, 19)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, x, y, z, 19);
     #endif
     //Dead Pop are: [13, 14, 15, 16, 17, 18, 21, 22, 23, 24, 25, 26]
 }
@@ -416,14 +416,14 @@ __device__
 void gpuBCBounceBackNEB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, z, 17)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, y, z, 7);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, z, 17);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(x, y, z, 21)];
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, x, y, z, 21);
     #endif
     //Dead Pop are: [9, 10, 11, 12, 13, 14, 19, 20, 23, 24, 25, 26]
 
@@ -434,14 +434,14 @@ __device__
 void gpuBCBounceBackSWF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, z, 16)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, z, 16);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(x, y, z, 22)];
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, x, y, z, 22);
     #endif
     //Dead Pop are: [9, 10, 11, 12, 13, 14, 19, 20, 23, 24, 25, 26]
 }
@@ -451,14 +451,14 @@ __device__
 void gpuBCBounceBackSWB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, y, z, 8);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, z, 10);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(x, y, z, 20)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, x, y, z, 20);
     #endif
     //Dead Pop are: [13, 14, 15, 16, 17, 18, 21, 22, 23, 24, 25, 26]
 }
@@ -468,14 +468,14 @@ __device__
 void gpuBCBounceBackSEF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, z, 18)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, z, 9);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, z, 18);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(x, y, z, 23)];
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, x, y, z, 23);
     #endif
     //Dead Pop are: [7, 8, 11, 12, 15, 16, 19, 20, 21, 22, 25, 26]
 }
@@ -485,14 +485,14 @@ __device__
 void gpuBCBounceBackSEB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned int x, const short unsigned int y,
     const short unsigned int z)
 {
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, z, 12)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, z, 15)];
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, z, 12);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, y, z, 13);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, z, 15);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(x, y, z, 26)];
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, x, y, z, 26);
     #endif
     //Dead Pop are: [7, 8, 9, 10, 17, 18, 19, 20, 21, 22, 23, 24]
 }
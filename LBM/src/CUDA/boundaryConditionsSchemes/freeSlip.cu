@@ -29,20 +29,20 @@ void gpuBCFreeSlipN(dfloat* fPostStream, dfloat* fPostCol, const short unsigned
 {
     const unsigned short int xp1 = (x + 1) % NX;
     //const unsigned short int yp1 = (y + 1) % NY;
-    const unsigned short int zp1 = (z + 1) % NZ;
+    const unsigned short int zp1 = (z + 1) % decompLocalNZ();
     const unsigned short int xm1 = (NX + x - 1) % NX;
     //const unsigned short int ym1 = (NY + y - 1) % NY;
-    const unsigned short int zm1 = (NZ + z - 1) % NZ;
-    fPostStream[idxPop(x, y, z, 4)] = fPostCol[idxPop(x, y, z, 3)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(xp1, y, z, 14)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, y, zp1, 17)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(xm1, y, z, 7)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, y, zm1, 11)];
+    const unsigned short int zm1 = (decompLocalNZ() + z - 1) % decompLocalNZ();
+    fPostStream[idxPop(x, y, z, 4)] = postColPop(fPostCol, x, y, z, 3);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, xp1, y, z, 14);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, y, zp1, 17);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, xm1, y, z, 7);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, y, zm1, 11);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(xp1, y, zp1, 24)];
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(xp1, y, zm1, 25)];
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(xm1, y, zm1, 19)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(xm1, y, zp1, 21)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, xp1, y, zp1, 24);
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, xp1, y, zm1, 25);
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, xm1, y, zm1, 19);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, xm1, y, zp1, 21);
     #endif
 }
 
@@ -53,20 +53,20 @@ void gpuBCFreeSlipS(dfloat* fPostStream, dfloat* fPostCol, const short unsigned
 {
     const unsigned short int xp1 = (x + 1) % NX;
     //const unsigned short int yp1 = (y + 1) % NY;
-    const unsigned short int zp1 = (z + 1) % NZ;
+    const unsigned short int zp1 = (z + 1) % decompLocalNZ();
     const unsigned short int xm1 = (NX + x - 1) % NX;
     //const unsigned short int ym1 = (NY + y - 1) % NY;
-    const unsigned short int zm1 = (NZ + z - 1) % NZ;
-    fPostStream[idxPop(x, y, z, 3)] = fPostCol[idxPop(x, y, z, 4)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(xm1, y, z, 13)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, y, zm1, 18)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(xp1, y, z, 8)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, y, zp1, 12)];
+    const unsigned short int zm1 = (decompLocalNZ() + z - 1) % decompLocalNZ();
+    fPostStream[idxPop(x, y, z, 3)] = postColPop(fPostCol, x, y, z, 4);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, xm1, y, z, 13);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, y, zm1, 18);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, xp1, y, z, 8);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, y, zp1, 12);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(xm1, y, zm1, 23)];
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(xm1, y, zp1, 26)];
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(xp1, y, zp1, 20)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(xp1, y, zm1, 22)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, xm1, y, zm1, 23);
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, xm1, y, zp1, 26);
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, xp1, y, zp1, 20);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, xp1, y, zm1, 22);
     #endif
 }
 
@@ -77,20 +77,20 @@ void gpuBCFreeSlipW(dfloat* fPostStream, dfloat* fPostCol, const short unsigned
 {
     //const unsigned short int xp1 = (x + 1) % NX;
     const unsigned short int yp1 = (y + 1) % NY;
-    const unsigned short int zp1 = (z + 1) % NZ;
+    const unsigned short int zp1 = (z + 1) % decompLocalNZ();
     //const unsigned short int xm1 = (NX + x - 1) % NX;
     const unsigned short int ym1 = (NY + y - 1) % NY;
-    const unsigned short int zm1 = (NZ + z - 1) % NZ;
-    fPostStream[idxPop(x, y, z, 1)] = fPostCol[idxPop(x, y, z, 2)];
-    fPostStream[idxPop(x, y, z, 7)] = fPostCol[idxPop(x, ym1, z, 14)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(x, y, zm1, 16)];
-    fPostStream[idxPop(x, y, z, 13)] = fPostCol[idxPop(x, yp1, z, 8)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(x, y, zp1, 10)];
+    const unsigned short int zm1 = (decompLocalNZ() + z - 1) % decompLocalNZ();
+    fPostStream[idxPop(x, y, z, 1)] = postColPop(fPostCol, x, y, z, 2);
+    fPostStream[idxPop(x, y, z, 7)] = postColPop(fPostCol, x, ym1, z, 14);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, x, y, zm1, 16);
+    fPostStream[idxPop(x, y, z, 13)] = postColPop(fPostCol, x, yp1, z, 8);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, x, y, zp1, 10);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(x, ym1, zm1, 25)];
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(x, ym1, zp1, 24)];
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(x, yp1, zm1, 22)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(x, yp1, zp1, 20)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, x, ym1, zm1, 25);
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, x, ym1, zp1, 24);
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, x, yp1, zm1, 22);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, x, yp1, zp1, 20);
     #endif
 }
 
@@ -101,20 +101,20 @@ void gpuBCFreeSlipE(dfloat* fPostStream, dfloat* fPostCol, const short unsigned
 {
     //const unsigned short int xp1 = (x + 1) % NX;
     const unsigned short int yp1 = (y + 1) % NY;
-    const unsigned short int zp1 = (z + 1) % NZ;
+    const unsigned short int zp1 = (z + 1) % decompLocalNZ();
     //const unsigned short int xm1 = (NX + x - 1) % NX;
     const unsigned short int ym1 = (NY + y - 1) % NY;
-    const unsigned short int zm1 = (NZ + z - 1) % NZ;
-    fPostStream[idxPop(x, y, z, 2)] = fPostCol[idxPop(x, y, z, 1)];
-    fPostStream[idxPop(x, y, z, 8)] = fPostCol[idxPop(x, yp1, z, 13)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(x, y, zp1, 15)];
-    fPostStream[idxPop(x, y, z, 14)] = fPostCol[idxPop(x, ym1, z, 7)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(x, y, zm1, 9)];
+    const unsigned short int zm1 = (decompLocalNZ() + z - 1) % decompLocalNZ();
+    fPostStream[idxPop(x, y, z, 2)] = postColPop(fPostCol, x, y, z, 1);
+    fPostStream[idxPop(x, y, z, 8)] = postColPop(fPostCol, x, yp1, z, 13);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, x, y, zp1, 15);
+    fPostStream[idxPop(x, y, z, 14)] = postColPop(fPostCol, x, ym1, z, 7);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, x, y, zm1, 9);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(x, yp1, zp1, 26)];
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(x, yp1, zm1, 23)];
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(x, ym1, zp1, 21)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(x, ym1, zm1, 19)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, x, yp1, zp1, 26);
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, x, yp1, zm1, 23);
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, x, ym1, zp1, 21);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, x, ym1, zm1, 19);
     #endif
 }
 
@@ -129,16 +129,16 @@ void gpuBCFreeSlipF(dfloat* fPostStream, dfloat* fPostCol, const short unsigned
     const unsigned short int xm1 = (NX + x - 1) % NX;
     const unsigned short int ym1 = (NY + y - 1) % NY;
     //const unsigned short int zm1 = (NZ + z - 1) % NZ;
-    fPostStream[idxPop(x, y, z, 6)] = fPostCol[idxPop(x, y, z, 5)];
-    fPostStream[idxPop(x, y, z, 10)] = fPostCol[idxPop(xp1, y, z, 16)];
-    fPostStream[idxPop(x, y, z, 12)] = fPostCol[idxPop(x, yp1, z, 18)];
-    fPostStream[idxPop(x, y, z, 15)] = fPostCol[idxPop(xm1, y, z, 9)];
-    fPostStream[idxPop(x, y, z, 17)] = fPostCol[idxPop(x, ym1, z, 11)];
+    fPostStream[idxPop(x, y, z, 6)] = postColPop(fPostCol, x, y, z, 5);
+    fPostStream[idxPop(x, y, z, 10)] = postColPop(fPostCol, xp1, y, z, 16);
+    fPostStream[idxPop(x, y, z, 12)] = postColPop(fPostCol, x, yp1, z, 18);
+    fPostStream[idxPop(x, y, z, 15)] = postColPop(fPostCol, xm1, y, z, 9);
+    fPostStream[idxPop(x, y, z, 17)] = postColPop(fPostCol, x, ym1, z, 11);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 20)] = fPostCol[idxPop(xp1, yp1, z, 22)];
-    fPostStream[idxPop(x, y, z, 21)] = fPostCol[idxPop(xm1, ym1, z, 19)];
-    fPostStream[idxPop(x, y, z, 24)] = fPostCol[idxPop(xp1, ym1, z, 25)];
-    fPostStream[idxPop(x, y, z, 26)] = fPostCol[idxPop(xm1, yp1, z, 23)];
+    fPostStream[idxPop(x, y, z, 20)] = postColPop(fPostCol, xp1, yp1, z, 22);
+    fPostStream[idxPop(x, y, z, 21)] = postColPop(fPostCol, xm1, ym1, z, 19);
+    fPostStream[idxPop(x, y, z, 24)] = postColPop(fPostCol, xp1, ym1, z, 25);
+    fPostStream[idxPop(x, y, z, 26)] = postColPop(fPostCol, xm1, yp1, z, 23);
     #endif
 }
 
@@ -153,16 +153,16 @@ void gpuBCFreeSlipB(dfloat* fPostStream, dfloat* fPostCol, const short unsigned
     const unsigned short int xm1 = (NX + x - 1) % NX;
     const unsigned short int ym1 = (NY + y - 1) % NY;
     //const unsigned short int zm1 = (NZ + z - 1) % NZ;
-    fPostStream[idxPop(x, y, z, 5)] = fPostCol[idxPop(x, y, z, 6)];
-    fPostStream[idxPop(x, y, z, 9)] = fPostCol[idxPop(xm1, y, z, 15)];
-    fPostStream[idxPop(x, y, z, 11)] = fPostCol[idxPop(x, ym1, z, 17)];
-    fPostStream[idxPop(x, y, z, 16)] = fPostCol[idxPop(xp1, y, z, 10)];
-    fPostStream[idxPop(x, y, z, 18)] = fPostCol[idxPop(x, yp1, z, 12)];
+    fPostStream[idxPop(x, y, z, 5)] = postColPop(fPostCol, x, y, z, 6);
+    fPostStream[idxPop(x, y, z, 9)] = postColPop(fPostCol, xm1, y, z, 15);
+    fPostStream[idxPop(x, y, z, 11)] = postColPop(fPostCol, x, ym1, z, 17);
+    fPostStream[idxPop(x, y, z, 16)] = postColPop(fPostCol, xp1, y, z, 10);
+    fPostStream[idxPop(x, y, z, 18)] = postColPop(fPostCol, x, yp1, z, 12);
     #ifdef D3Q27
-    fPostStream[idxPop(x, y, z, 19)] = fPostCol[idxPop(xm1, ym1, z, 21)];
-    fPostStream[idxPop(x, y, z, 22)] = fPostCol[idxPop(xp1, yp1, z, 20)];
-    fPostStream[idxPop(x, y, z, 23)] = fPostCol[idxPop(xm1, yp1, z, 26)];
-    fPostStream[idxPop(x, y, z, 25)] = fPostCol[idxPop(xp1, ym1, z, 24)];
+    fPostStream[idxPop(x, y, z, 19)] = postColPop(fPostCol, xm1, ym1, z, 21);
+    fPostStream[idxPop(x, y, z, 22)] = postColPop(fPostCol, xp1, yp1, z, 20);
+    fPostStream[idxPop(x, y, z, 23)] = postColPop(fPostCol, xm1, yp1, z, 26);
+    fPostStream[idxPop(x, y, z, 25)] = postColPop(fPostCol, xp1, ym1, z, 24);
     #endif
 }
 
@@ -12,6 +12,7 @@
 
 #include "./../globalFunctions.h"
 #include "./../structs/nodeTypeMap.h"
+#include "./../postColBuffer.h"
 #include <cuda_runtime.h>
 
 /*
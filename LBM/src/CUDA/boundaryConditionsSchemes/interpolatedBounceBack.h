@@ -1,10 +1,11 @@
 /*
 *   @file interpolatedBounceBack.h
 *   @author Waine Jr. (waine@alunos.utfpr.edu.br)
-*   @brief Interpolated bounce back boundary condition. It is suited for 
-*          cilinders and 2D curved surfaces. Some assumptions are made for 
-*          faster processing, as the shape being a cilinder with center
-*          in (NX/2, NY/2) and axial direction in Z.
+*   @brief Interpolated bounce back boundary condition, for curved walls of
+*          any shape. The wall distances (q) of the links cut by the wall are
+*          evaluated once in setup, from the mesh (GEOMETRY_MESH) or from the
+*          signed distance function of the builder (GEOMETRY_SDF), and the
+*          boundary condition only reads them
 *   @version 0.3.0
 *   @date 16/12/2019
 */
@@ -14,28 +15,51 @@
 
 #include "./../globalFunctions.h"
 #include "./../structs/nodeTypeMap.h"
+#include "./../postColBuffer.h"
+#include "./../velocitySets/velocitySetUnroll.h"
 #include <cuda_runtime.h>
+#include <vector>
+
+#if GEOMETRY_MESH && GEOMETRY_SDF
+#error "GEOMETRY_MESH and GEOMETRY_SDF can not be used together"
+#endif
+// The duct builders set interpolated bounce back nodes, without wall 
+// distances they would have no boundary condition
+#if (COMP_INTERP_BOUNCE_BACK || COMP_ALL_BC) && !(GEOMETRY_MESH || GEOMETRY_SDF)
+#error "Interpolated bounce back (also in COMP_ALL_BC) requires wall distances from GEOMETRY_MESH or GEOMETRY_SDF"
+#endif
+#if GEOMETRY_SDF && !(COMP_INTERP_BOUNCE_BACK || COMP_ALL_BC)
+#error "GEOMETRY_SDF requires interpolated bounce back (COMP_INTERP_BOUNCE_BACK)"
+#endif
+
+// Wall distance of the links not cut (known populations)
+#define INTERP_BB_Q_NONE (-1)
 
 
 /*
-*   @brief Applies interpolated bounce back boundary condition
-*   @param unknownPops: unknown populations (using D2Q9 velocity set) 
-*   @param is_inside: Node is an inside Interpolated BC Node (wall is to the center)
-                or outside (wall is away from the center) (used for annular duct)
+*   Wall distances of the interpolated bounce back nodes, evaluated in host. 
+*   q is the distance from node to wall, normalized by the link length, for 
+*   population i coming from wall (node - c[i] is solid)
+*/
+typedef struct interpBBWallDist {
+    std::vector<size_t> idxNodes;   // scalar index of boundary nodes
+    std::vector<float> q;           // q of boundary nodes [idxNodes.size()][Q],
+                                    // INTERP_BB_Q_NONE for known populations
+} InterpBBWallDist;
+
+
+/*
+*   @brief Applies interpolated bounce back boundary condition to one link
+*   @param link: link to apply, idxScalar(x, y, z)*Q + population (unknown)
+*   @param q: wall distance of the link
 *   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
 *   @param fPostCol[(NX, NY, NZ, Q)]: post collision populations from last step 
-*   @param x: node's x value
-*   @param y: node's y value
-*   @param z: node's z value
 */
 __device__ 
-void gpuBCInterpolatedBounceBack(const unsigned char unknownPops,
-    const bool is_inside,
+void gpuBCInterpolatedBounceBack(const size_t link,
+    const float q,
     dfloat* fPostStream,
-    dfloat* fPostCol,
-    const short unsigned int x,
-    const short unsigned int y,
-    const short unsigned int z);
+    dfloat* fPostCol);
 
 
 /*
@@ -72,43 +96,20 @@ dfloat __inline__ gpuInterpolatedBounceBackHigherQ(
 }
 
 
-__device__
-dfloat gpuDistNormalizedFromNodePopulationToWall_a0(
-    dfloat x1,
-    dfloat y1,
-    dfloat x2,
-    dfloat y2,
-    dfloat R
-);
-
-
-__device__
-dfloat gpuDistNormalizedFromNodePopulationToWall_ainf(
-    dfloat x1,
-    dfloat y1,
-    dfloat x2,
-    dfloat y2,
-    dfloat R
-);
-
-
-__device__
-dfloat gpuDistNormalizedFromNodePopulationToWall_ap1(
-    dfloat x1,
-    dfloat y1,
-    dfloat x2,
-    dfloat y2,
-    dfloat R
-);
-
-
-__device__
-dfloat gpuDistNormalizedFromNodePopulationToWall_am1(
-    dfloat x1,
-    dfloat y1,
-    dfloat x2,
-    dfloat y2,
-    dfloat R
-);
+/*
+*   @brief Evaluates the wall distances of the interpolated bounce back nodes
+*          of the map from a signed distance function. Populations coming 
+*          from points with negative distance are unknown, and its q is the
+*          root of the function along the link
+*   @param hMapBC: full boundary conditions map of the GPU (host)
+*   @param gpuNumber: GPU number
+*   @param sdf: signed distance function, positive in fluid, with the node
+*               (x, y, z) at (x+0.5, y+0.5, z+0.5) and z in the whole domain
+*   @param wallDist: wall distances to write to
+*/
+__host__
+void interpBBWallDistSDF(const NodeTypeMap* hMapBC, const int gpuNumber,
+    dfloat (*sdf)(const dfloat, const dfloat, const dfloat),
+    InterpBBWallDist* wallDist);
 
 #endif // !__BC_INTERPOLATED_BOUNCE_BACK_H
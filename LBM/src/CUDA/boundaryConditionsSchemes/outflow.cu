@@ -0,0 +1,174 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "outflow.h"
+
+#if defined(BC_SCHEME_OUTFLOW_CONVECTIVE) || defined(BC_SCHEME_OUTFLOW_NON_REFLECTING)
+
+/*
+*   @brief Loads populations of the interior neighbor of face node and 
+*          evaluates its macroscopics
+*/
+__device__ __forceinline__
+void outflowAdjacent(dfloat* fPostStream, const int nx, const int ny, const int nz,
+    const short unsigned int x, const short unsigned int y, const short unsigned int z,
+    dfloat* fAdj, dfloat& rhoAdj, dfloat& uxAdj, dfloat& uyAdj, dfloat& uzAdj)
+{
+    const unsigned int xAdj = x - nx;
+    const unsigned int yAdj = y - ny;
+    const unsigned int zAdj = z - nz;
+    #pragma unroll
+    for(int i = 0; i < Q; i++)
+        fAdj[i] = fPostStream[idxPop(xAdj, yAdj, zAdj, i)];
+    popMacroscopics(fAdj, 0, 0, 0, rhoAdj, uxAdj, uyAdj, uzAdj);
+}
+
+
+__device__
+void gpuBCOutflowConvective(const char dir,
+    dfloat* fPostStream,
+    dfloat* fPrev,
+    const size_t strideFPrev,
+    const short unsigned int x,
+    const short unsigned int y,
+    const short unsigned int z)
+{
+    int nx, ny, nz;
+    if(!outflowNormal(dir, nx, ny, nz))
+        return;
+
+    dfloat fAdj[Q];
+    dfloat rhoAdj, uxAdj, uyAdj, uzAdj;
+    outflowAdjacent(fPostStream, nx, ny, nz, x, y, z, fAdj, rhoAdj, uxAdj, uyAdj, uzAdj);
+
+    // Convective velocity, limited so the scheme is stable
+    const dfloat uConv = myMin(myMax(uxAdj*nx + uyAdj*ny + uzAdj*nz, (dfloat)0), (dfloat)1);
+    const dfloat invUConv = 1/(1+uConv);
+
+    int k = 0;
+    #pragma unroll
+    for(int i = 1; i < Q; i++)
+    {
+        // unknown populations come from outside
+        if(velCx(i)*nx + velCy(i)*ny + velCz(i)*nz != -1)
+            continue;
+        const dfloat f = (fPrev[k*strideFPrev] + uConv*fAdj[i]) * invUConv;
+        fPostStream[idxPop(x, y, z, i)] = f;
+        fPrev[k*strideFPrev] = f;
+        k++;
+    }
+}
+
+
+__device__
+void gpuBCOutflowNonReflecting(const char dir,
+    const dfloat rhoTarget,
+    dfloat* fPostStream,
+    dfloat* fPrev,
+    const size_t strideFPrev,
+    const short unsigned int x,
+    const short unsigned int y,
+    const short unsigned int z)
+{
+    int nx, ny, nz;
+    if(!outflowNormal(dir, nx, ny, nz))
+        return;
+
+    dfloat fAdj[Q];
+    dfloat rhoAdj, uxAdj, uyAdj, uzAdj;
+    outflowAdjacent(fPostStream, nx, ny, nz, x, y, z, fAdj, rhoAdj, uxAdj, uyAdj, uzAdj);
+
+    // Characteristic speeds of the outgoing acoustic wave and of the 
+    // convected velocity, limited so the scheme is stable
+    const dfloat unAdj = uxAdj*nx + uyAdj*ny + uzAdj*nz;
+    const dfloat lambdaRho = myMin(myMax(unAdj + OUTFLOW_CS, (dfloat)0), (dfloat)1);
+    const dfloat lambdaU = myMin(myMax(unAdj, (dfloat)0), (dfloat)1);
+
+    const dfloat rhoVar = (fPrev[0] + lambdaRho*rhoAdj + OUTFLOW_NR_SIGMA*rhoTarget)
+        / (1 + lambdaRho + OUTFLOW_NR_SIGMA);
+    const dfloat invLambdaU = 1/(1+lambdaU);
+    const dfloat uxVar = (fPrev[strideFPrev] + lambdaU*uxAdj) * invLambdaU;
+    const dfloat uyVar = (fPrev[2*strideFPrev] + lambdaU*uyAdj) * invLambdaU;
+    const dfloat uzVar = (fPrev[3*strideFPrev] + lambdaU*uzAdj) * invLambdaU;
+
+    #pragma unroll
+    for(int i = 1; i < Q; i++)
+    {
+        // unknown populations come from outside
+        if(velCx(i)*nx + velCy(i)*ny + velCz(i)*nz != -1)
+            continue;
+        fPostStream[idxPop(x, y, z, i)] = fPostStream[idxPop(x, y, z, velOpp(i))]
+            + 6*velW(i)*rhoVar*(velCx(i)*uxVar + velCy(i)*uyVar + velCz(i)*uzVar);
+    }
+
+    fPrev[0] = rhoVar;
+    fPrev[strideFPrev] = uxVar;
+    fPrev[2*strideFPrev] = uyVar;
+    fPrev[3*strideFPrev] = uzVar;
+}
+
+
+__device__
+void gpuBCOutflowInit(const char scheme,
+    const char dir,
+    dfloat* f,
+    dfloat* fPrev,
+    const size_t strideFPrev,
+    const short unsigned int x,
+    const short unsigned int y,
+    const short unsigned int z)
+{
+    int nx, ny, nz;
+    if(!outflowNormal(dir, nx, ny, nz))
+        return;
+
+    #ifdef BC_SCHEME_OUTFLOW_CONVECTIVE
+    if(scheme == BC_SCHEME_OUTFLOW_CONVECTIVE)
+    {
+        int k = 0;
+        #pragma unroll
+        for(int i = 1; i < Q; i++)
+        {
+            if(velCx(i)*nx + velCy(i)*ny + velCz(i)*nz != -1)
+                continue;
+            fPrev[k*strideFPrev] = f[idxPop(x, y, z, i)];
+            k++;
+        }
+    }
+    #endif
+    #ifdef BC_SCHEME_OUTFLOW_NON_REFLECTING
+    if(scheme == BC_SCHEME_OUTFLOW_NON_REFLECTING)
+    {
+        dfloat fNode[Q];
+        #pragma unroll
+        for(int i = 0; i < Q; i++)
+            fNode[i] = f[idxPop(x, y, z, i)];
+        dfloat rhoVar, uxVar, uyVar, uzVar;
+        popMacroscopics(fNode, 0, 0, 0, rhoVar, uxVar, uyVar, uzVar);
+        fPrev[0] = rhoVar;
+        fPrev[strideFPrev] = uxVar;
+        fPrev[2*strideFPrev] = uyVar;
+        fPrev[3*strideFPrev] = uzVar;
+    }
+    #endif
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+*   @file outflow.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Outflow boundary conditions for faces, that let waves and vortices
+*          leave the domain with low reflection: convective (Orlanski type,
+*          with the local normal velocity) and non reflecting (characteristic,
+*          with the density carried by the outgoing acoustic wave). Both use
+*          values of the previous step of the outflow node, stored in a
+*          compact buffer with OUTFLOW_N_PREV values for each outflow node
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __BC_OUTFLOW_H
+#define __BC_OUTFLOW_H
+
+#include "./../globalFunctions.h"
+#include "./../structs/nodeTypeMap.h"
+#include "./../velocitySets/velocitySetUnroll.h"
+#include <cuda_runtime.h>
+
+// Number of unknown populations in a face (coming from outside the domain)
+constexpr int OUTFLOW_N_UNKNOWN = velCountDir(2, -1);
+// Values of each node in outflow buffer, the unknown populations (convective)
+// or the density and velocity (non reflecting)
+constexpr int OUTFLOW_N_PREV = (OUTFLOW_N_UNKNOWN > 4) ? OUTFLOW_N_UNKNOWN : 4;
+// Lattice sound speed
+constexpr dfloat OUTFLOW_CS = 0.57735026918962576;
+
+
+/*
+*   @brief Outward normal of face direction
+*   @param dir: node's direction (NORTH, SOUTH, WEST, EAST, FRONT or BACK)
+*   @param nx, ny, nz: normal to write to
+*   @return true if direction is a face, false otherwise
+*/
+__device__ __forceinline__
+bool outflowNormal(const char dir, int& nx, int& ny, int& nz)
+{
+    nx = (dir == EAST) - (dir == WEST);
+    ny = (dir == NORTH) - (dir == SOUTH);
+    nz = (dir == FRONT) - (dir == BACK);
+    return (nx != 0 || ny != 0 || nz != 0);
+}
+
+
+/*
+*   @brief Applies convective outflow on face node. The unknown populations
+*          are convected from the interior neighbor with its normal velocity
+*          (limited to [0, 1]):
+*          f(t+1) = (f(t) + U*f_adj(t+1)) / (1 + U)
+*   @param dir: node's direction (face)
+*   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
+*   @param fPrev: node's values in outflow buffer (previous step)
+*   @param strideFPrev: stride between values of a node in outflow buffer
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*/
+__device__
+void gpuBCOutflowConvective(const char dir,
+    dfloat* fPostStream,
+    dfloat* fPrev,
+    const size_t strideFPrev,
+    const short unsigned int x,
+    const short unsigned int y,
+    const short unsigned int z);
+
+
+/*
+*   @brief Applies non reflecting outflow on face node. The density is
+*          carried from the interior neighbor by the outgoing acoustic wave
+*          (speed u_n + cs) and slightly relaxed to target, the velocity is
+*          convected (speed u_n), and the unknown populations are set by
+*          bounce back with these values:
+*          f_i = f_opp(i) + 6*w_i*rho*(c_i . u)
+*   @param dir: node's direction (face)
+*   @param rhoTarget: density to relax to (OUTFLOW_NR_SIGMA per step)
+*   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
+*   @param fPrev: node's values in outflow buffer (previous step)
+*   @param strideFPrev: stride between values of a node in outflow buffer
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*/
+__device__
+void gpuBCOutflowNonReflecting(const char dir,
+    const dfloat rhoTarget,
+    dfloat* fPostStream,
+    dfloat* fPrev,
+    const size_t strideFPrev,
+    const short unsigned int x,
+    const short unsigned int y,
+    const short unsigned int z);
+
+
+/*
+*   @brief Initializes node's values in outflow buffer from its populations
+*   @param scheme: node's scheme
+*   @param dir: node's direction (face)
+*   @param f[(NX, NY, NZ, Q)]: populations to use
+*   @param fPrev: node's values in outflow buffer to write to
+*   @param strideFPrev: stride between values of a node in outflow buffer
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*/
+__device__
+void gpuBCOutflowInit(const char scheme,
+    const char dir,
+    dfloat* f,
+    dfloat* fPrev,
+    const size_t strideFPrev,
+    const short unsigned int x,
+    const short unsigned int y,
+    const short unsigned int z);
+
+#endif // !__BC_OUTFLOW_H
@@ -0,0 +1,315 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "symmetry.h"
+
+
+#ifdef BC_SCHEME_SYMMETRY
+
+/*
+*   @brief Applies symmetry boundary condition on node of direction, from
+*          population I on (unrolled in compile time)
+*   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
+*   @param fPostCol[(NX, NY, NZ, Q)]: post collision populations from last step
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*   @param nz: planes of partition in z
+*/
+template <int DIR, bool CONVEX_NODE, int I = 1>
+__device__ __forceinline__
+void gpuBCSymmetryUnroll(dfloat* fPostStream, dfloat* fPostCol,
+    const int x, const int y, const int z, const int nz)
+{
+    constexpr int nrmX = symmetryNormal(DIR, 0);
+    constexpr int nrmY = symmetryNormal(DIR, 1);
+    constexpr int nrmZ = symmetryNormal(DIR, 2);
+    // Population crosses the plane if it comes from beyond it
+    constexpr bool crossX = (nrmX != 0 && velCx(I) == -nrmX);
+    constexpr bool crossY = (nrmY != 0 && velCy(I) == -nrmY);
+    constexpr bool crossZ = (nrmZ != 0 && velCz(I) == -nrmZ);
+    constexpr int nCross = (int)crossX + (int)crossY + (int)crossZ;
+    constexpr int nPlanes = (nrmX != 0) + (nrmY != 0) + (nrmZ != 0);
+
+    // Concave nodes miss the populations crossing any plane, convex ones
+    // only the populations crossing all of them (from the solid corner)
+    if constexpr(CONVEX_NODE ? (nCross == nPlanes) : (nCross > 0)){
+        // Mirrored across the planes crossed, from the node itself in the
+        // axes of these planes and from the neighbour in the others
+        constexpr int j = velFind(crossX ? -velCx(I) : velCx(I), 
+            crossY ? -velCy(I) : velCy(I), crossZ ? -velCz(I) : velCz(I));
+        static_assert(j < Q, "Velocity set is not symmetric");
+        int sx, sy, sz;
+        if(symmetryShiftAxis(x, crossX ? 0 : -velCx(I), NX, DECOMP_PX > 1, sx)
+            && symmetryShiftAxis(y, crossY ? 0 : -velCy(I), NY, DECOMP_PY > 1, sy)
+            && symmetryShiftAxis(z, crossZ ? 0 : -velCz(I), nz, DECOMP_PZ > 1, sz))
+            fPostStream[idxPop(x, y, z, I)] = postColPop(fPostCol, sx, sy, sz, j);
+    }
+    if constexpr(I+1 < Q)
+        gpuBCSymmetryUnroll<DIR, CONVEX_NODE, I+1>(fPostStream, fPostCol, x, y, z, nz);
+}
+
+
+/*
+*   @brief Applies symmetry boundary condition on node of direction, with 
+*          its geometry. Planes are the same for both geometries
+*/
+template <int DIR>
+__device__ __forceinline__
+void gpuBCSymmetryDir(dfloat* fPostStream, dfloat* fPostCol, const unsigned char geometry,
+    const int x, const int y, const int z, const int nz)
+{
+    if constexpr(DIR >= NORTH_WEST){
+        if(geometry == CONVEX){
+            gpuBCSymmetryUnroll<DIR, true>(fPostStream, fPostCol, x, y, z, nz);
+            return;
+        }
+    }
+    gpuBCSymmetryUnroll<DIR, false>(fPostStream, fPostCol, x, y, z, nz);
+}
+
+
+__device__
+void gpuBCSymmetry(dfloat* fPostStream, dfloat* fPostCol,
+    const unsigned char direction, const unsigned char geometry,
+    const short unsigned int x, const short unsigned int y, const short unsigned int z)
+{
+    const int nz = decompLocalNZ();
+    switch(direction)
+    {
+    case NORTH:
+        gpuBCSymmetryDir<NORTH>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH:
+        gpuBCSymmetryDir<SOUTH>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case WEST:
+        gpuBCSymmetryDir<WEST>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case EAST:
+        gpuBCSymmetryDir<EAST>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case FRONT:
+        gpuBCSymmetryDir<FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case BACK:
+        gpuBCSymmetryDir<BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case NORTH_WEST:
+        gpuBCSymmetryDir<NORTH_WEST>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case NORTH_EAST:
+        gpuBCSymmetryDir<NORTH_EAST>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case NORTH_FRONT:
+        gpuBCSymmetryDir<NORTH_FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case NORTH_BACK:
+        gpuBCSymmetryDir<NORTH_BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH_WEST:
+        gpuBCSymmetryDir<SOUTH_WEST>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH_EAST:
+        gpuBCSymmetryDir<SOUTH_EAST>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH_FRONT:
+        gpuBCSymmetryDir<SOUTH_FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH_BACK:
+        gpuBCSymmetryDir<SOUTH_BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case WEST_FRONT:
+        gpuBCSymmetryDir<WEST_FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case WEST_BACK:
+        gpuBCSymmetryDir<WEST_BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case EAST_FRONT:
+        gpuBCSymmetryDir<EAST_FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case EAST_BACK:
+        gpuBCSymmetryDir<EAST_BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case NORTH_WEST_FRONT:
+        gpuBCSymmetryDir<NORTH_WEST_FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case NORTH_WEST_BACK:
+        gpuBCSymmetryDir<NORTH_WEST_BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case NORTH_EAST_FRONT:
+        gpuBCSymmetryDir<NORTH_EAST_FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case NORTH_EAST_BACK:
+        gpuBCSymmetryDir<NORTH_EAST_BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH_WEST_FRONT:
+        gpuBCSymmetryDir<SOUTH_WEST_FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH_WEST_BACK:
+        gpuBCSymmetryDir<SOUTH_WEST_BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH_EAST_FRONT:
+        gpuBCSymmetryDir<SOUTH_EAST_FRONT>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    case SOUTH_EAST_BACK:
+        gpuBCSymmetryDir<SOUTH_EAST_BACK>(fPostStream, fPostCol, geometry, x, y, z, nz);
+        break;
+    default:
+        break;
+    }
+}
+
+
+__global__
+void gpuSymmetryLinks(
+    NodeTypeMap* const mapBC,
+    size_t* const idxLinks,
+    size_t* const idxSrc,
+    unsigned int* const nLinks,
+    unsigned int* const nUnsupported)
+{
+    const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
+    const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
+    const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
+    if(x >= NX || y >= NY || z >= decompLocalNZ())
+        return;
+
+    NodeTypeMap nodeMap = mapBC[idxScalar(x, y, z)];
+    if(!nodeMap.getIsUsed() || nodeMap.getSchemeBC() != BC_SCHEME_SYMMETRY)
+        return;
+
+    const int r[3] = {(int)x, (int)y, (int)z};
+    const int n[3] = {NX, NY, decompLocalNZ()};
+    const bool split[3] = {DECOMP_PX > 1, DECOMP_PY > 1, DECOMP_PZ > 1};
+    const unsigned char direction = nodeMap.getDirection();
+    const bool convex = (direction >= NORTH_WEST && nodeMap.getGeometry() == CONVEX);
+    int nrm[3];
+    int nPlanes = 0;
+    for(int a = 0; a < 3; a++){
+        nrm[a] = symmetryNormal(direction, a);
+        nPlanes += (nrm[a] != 0);
+    }
+
+    // Same populations as gpuBCSymmetryUnroll
+    for(int i = 1; i < Q; i++){
+        const int c[3] = {velCx(i), velCy(i), velCz(i)};
+        int mirror[3], s[3], src[3];
+        int nCross = 0;
+        bool local = true;
+        bool supported = true;
+        for(int a = 0; a < 3; a++){
+            const bool cross = (nrm[a] != 0 && c[a] == -nrm[a]);
+            nCross += cross;
+            mirror[a] = cross ? -c[a] : c[a];
+            if(!symmetryShiftAxis(r[a], cross ? 0 : -c[a], n[a], split[a], s[a]))
+                local = false;
+            // The mirrored population is streamed beyond the planes crossed 
+            // and, if its node is in another partition, exchanged to this one
+            if(!symmetryShiftAxis(r[a], cross ? nrm[a] : 0, n[a], split[a], src[a]))
+                supported = false;
+        }
+        if(!(convex ? (nCross == nPlanes) : (nCross > 0)) || local)
+            continue;
+        if(!supported){
+            atomicAdd(nUnsupported, 1);
+            continue;
+        }
+        const unsigned int l = atomicAdd(nLinks, 1);
+        if(idxLinks != nullptr){
+            idxLinks[l] = idxPop(x, y, z, i);
+            idxSrc[l] = idxPop(src[0], src[1], src[2], velFind(mirror[0], mirror[1], mirror[2]));
+        }
+    }
+}
+
+
+__global__
+void gpuSymmetryLinksGather(
+    const dfloat* const popPostStream,
+    const size_t* const idxSrc,
+    dfloat* const popLinks,
+    const size_t totalLinks)
+{
+    const size_t l = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(l >= totalLinks)
+        return;
+    popLinks[l] = popPostStream[idxSrc[l]];
+}
+
+
+__global__
+void gpuSymmetryLinksScatter(
+    dfloat* const popPostStream,
+    const size_t* const idxLinks,
+    const dfloat* const popLinks,
+    const size_t totalLinks)
+{
+    const size_t l = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(l >= totalLinks)
+        return;
+    popPostStream[idxLinks[l]] = popLinks[l];
+}
+
+
+__host__
+void setupSymmetryLinks(
+    BoundaryConditionsInfo* bcInfo,
+    NodeTypeMap* const mapBC,
+    const dim3 grid,
+    const dim3 threads,
+    const int gpuNumber)
+{
+    bcInfo->totalSymLinks = 0;
+    bcInfo->idxSymLinks = nullptr;
+    bcInfo->idxSymSrc = nullptr;
+    bcInfo->popSymLinks = nullptr;
+
+    // Links and unsupported links
+    unsigned int* count;
+    checkCudaErrors(cudaMallocManaged((void**)&count, 2*sizeof(unsigned int)));
+    count[0] = 0;
+    count[1] = 0;
+    gpuSymmetryLinks<<<grid, threads>>>(mapBC, nullptr, nullptr, &count[0], &count[1]);
+    checkCudaErrors(cudaDeviceSynchronize());
+    getLastCudaError("Symmetry links count error");
+    if(count[1] > 0){
+        fprintf(stderr, "Symmetry nodes of GPU %d mirror %u populations from diagonal "
+            "partitions, not exchanged. Use a decomposition without the axes normal to "
+            "the symmetry planes split (DECOMP_MANUAL_PX, ...)\n", gpuNumber, count[1]);
+        exit(-1);
+    }
+
+    if(count[0] > 0){
+        bcInfo->totalSymLinks = count[0];
+        bcInfo->idxSymLinks = (size_t*)simMalloc(count[0]*sizeof(size_t), IN_VIRTUAL);
+        bcInfo->idxSymSrc = (size_t*)simMalloc(count[0]*sizeof(size_t), IN_VIRTUAL);
+        bcInfo->popSymLinks = (dfloat*)simMalloc(count[0]*sizeof(dfloat), IN_VIRTUAL);
+        count[0] = 0;
+        gpuSymmetryLinks<<<grid, threads>>>(mapBC, bcInfo->idxSymLinks, 
+            bcInfo->idxSymSrc, &count[0], &count[1]);
+        checkCudaErrors(cudaDeviceSynchronize());
+        getLastCudaError("Symmetry links error");
+    }
+    checkCudaErrors(cudaFree(count));
+}
+
+#endif
@@ -0,0 +1,203 @@
+/*
+*   @file symmetry.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Symmetry boundary condition (specular reflection), for planes,
+*          edges and corners. The symmetry plane is half way between the node
+*          and its mirror, so a symmetric domain can be halved (or quartered)
+*          cutting it in the middle of two lattice nodes. The unknown
+*          populations are mirrored across the planes they cross: in concave
+*          edges and corners the ones crossing any plane, in convex ones the
+*          ones crossing all of them. Each direction is unrolled in compile
+*          time from the velocity set. Mirrored populations from nodes of
+*          other partitions are taken where streaming and the halo exchange
+*          place them, by the links of symmetry
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __BC_SYMMETRY_H
+#define __BC_SYMMETRY_H
+
+#include "./../globalFunctions.h"
+#include "./../errorDef.h"
+#include "./../structs/nodeTypeMap.h"
+#include "./../structs/boundaryConditionsInfo.h"
+#include "./../postColBuffer.h"
+#include "./../velocitySets/velocitySetUnroll.h"
+#include <cuda_runtime.h>
+
+
+/*
+*   @brief Component of vector in axis
+*   @param axis: 0 for x, 1 for y, 2 for z
+*   @param vx: vector component in x
+*   @param vy: vector component in y
+*   @param vz: vector component in z
+*   @return component in axis
+*/
+__host__ __device__
+constexpr int symmetryAxis(const int axis, const int vx, const int vy, const int vz)
+{
+    return (axis == 0) ? vx : ((axis == 1) ? vy : vz);
+}
+
+
+/*
+*   @brief Normal of boundary condition direction, out of the fluid (NORTH
+*          is (0, 1, 0), SOUTH_WEST is (-1, -1, 0), ...)
+*   @param direction: boundary condition direction
+*   @param axis: 0 for x, 1 for y, 2 for z
+*   @return normal component in axis, -1, 0 or 1
+*/
+__host__ __device__
+constexpr int symmetryNormal(const int direction, const int axis)
+{
+    switch(direction)
+    {
+    case NORTH: return symmetryAxis(axis, 0, 1, 0);
+    case SOUTH: return symmetryAxis(axis, 0, -1, 0);
+    case WEST: return symmetryAxis(axis, -1, 0, 0);
+    case EAST: return symmetryAxis(axis, 1, 0, 0);
+    case FRONT: return symmetryAxis(axis, 0, 0, 1);
+    case BACK: return symmetryAxis(axis, 0, 0, -1);
+    case NORTH_WEST: return symmetryAxis(axis, -1, 1, 0);
+    case NORTH_EAST: return symmetryAxis(axis, 1, 1, 0);
+    case NORTH_FRONT: return symmetryAxis(axis, 0, 1, 1);
+    case NORTH_BACK: return symmetryAxis(axis, 0, 1, -1);
+    case SOUTH_WEST: return symmetryAxis(axis, -1, -1, 0);
+    case SOUTH_EAST: return symmetryAxis(axis, 1, -1, 0);
+    case SOUTH_FRONT: return symmetryAxis(axis, 0, -1, 1);
+    case SOUTH_BACK: return symmetryAxis(axis, 0, -1, -1);
+    case WEST_FRONT: return symmetryAxis(axis, -1, 0, 1);
+    case WEST_BACK: return symmetryAxis(axis, -1, 0, -1);
+    case EAST_FRONT: return symmetryAxis(axis, 1, 0, 1);
+    case EAST_BACK: return symmetryAxis(axis, 1, 0, -1);
+    case NORTH_WEST_FRONT: return symmetryAxis(axis, -1, 1, 1);
+    case NORTH_WEST_BACK: return symmetryAxis(axis, -1, 1, -1);
+    case NORTH_EAST_FRONT: return symmetryAxis(axis, 1, 1, 1);
+    case NORTH_EAST_BACK: return symmetryAxis(axis, 1, 1, -1);
+    case SOUTH_WEST_FRONT: return symmetryAxis(axis, -1, -1, 1);
+    case SOUTH_WEST_BACK: return symmetryAxis(axis, -1, -1, -1);
+    case SOUTH_EAST_FRONT: return symmetryAxis(axis, 1, -1, 1);
+    case SOUTH_EAST_BACK: return symmetryAxis(axis, 1, -1, -1);
+    default: return 0;
+    }
+}
+
+
+/*
+*   @brief Shifted node in axis. Out of the partition, it is wrapped as in
+*          streaming, which is only valid if the axis is not split among GPUs
+*   @param r: node's value in axis
+*   @param shift: shift of the node
+*   @param n: number of nodes of the partition in axis
+*   @param split: if the axis is split among GPUs
+*   @param s: shifted node's value in axis, to write to
+*   @return false if the shifted node is in another partition
+*/
+__host__ __device__ __forceinline__
+bool symmetryShiftAxis(const int r, const int shift, const int n, const bool split, int& s)
+{
+    s = r + shift;
+    if(s >= 0 && s < n)
+        return true;
+    s = (s + n) % n;
+    return !split;
+}
+
+
+/*
+*   @brief Applies symmetry boundary condition on node. Unknown populations
+*          mirrored from nodes of other partitions are set by the links of
+*          symmetry (gpuSymmetryLinksScatter)
+*   @param fPostStream[(NX, NY, NZ, Q)]: populations post streaming
+*   @param fPostCol[(NX, NY, NZ, Q)]: post collision populations from last step
+*   @param direction: node's direction
+*   @param geometry: node's geometry (CONCAVE or CONVEX)
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*/
+__device__
+void gpuBCSymmetry(dfloat* fPostStream, dfloat* fPostCol,
+    const unsigned char direction, const unsigned char geometry,
+    const short unsigned int x, const short unsigned int y, const short unsigned int z);
+
+
+/*
+*   @brief Links of symmetry nodes whose mirrored populations come from nodes
+*          of other partitions: the unknown population and the node where
+*          streaming and the halo exchange place the mirrored one, beyond
+*          the planes crossed. Counts the links, and writes them if idxLinks
+*          is not null
+*   @param mapBC: full boundary conditions map of GPU
+*   @param idxLinks: idxPop of the unknown population of each link, to write to
+*   @param idxSrc: idxPop of the mirrored population of each link, to write to
+*   @param nLinks: counter of links
+*   @param nUnsupported: counter of links with the mirrored population in
+*          a diagonal partition, beyond a plane split among GPUs
+*/
+__global__
+void gpuSymmetryLinks(
+    NodeTypeMap* const mapBC,
+    size_t* const idxLinks,
+    size_t* const idxSrc,
+    unsigned int* const nLinks,
+    unsigned int* const nUnsupported
+);
+
+
+/*
+*   @brief Reads the mirrored populations of the links of symmetry, after
+*          the halo exchange and before the boundary conditions overwrite them
+*   @param popPostStream: populations post streaming
+*   @param idxSrc: idxPop of the mirrored population of each link
+*   @param popLinks: values of the links, to write to
+*   @param totalLinks: number of links
+*/
+__global__
+void gpuSymmetryLinksGather(
+    const dfloat* const popPostStream,
+    const size_t* const idxSrc,
+    dfloat* const popLinks,
+    const size_t totalLinks
+);
+
+
+/*
+*   @brief Writes the values of the links of symmetry to their unknown
+*          populations, after the boundary conditions
+*   @param popPostStream: populations post streaming to update
+*   @param idxLinks: idxPop of the unknown population of each link
+*   @param popLinks: values of the links
+*   @param totalLinks: number of links
+*/
+__global__
+void gpuSymmetryLinksScatter(
+    dfloat* const popPostStream,
+    const size_t* const idxLinks,
+    const dfloat* const popLinks,
+    const size_t totalLinks
+);
+
+
+/*
+*   @brief Setup links of symmetry of the current device, from the full map
+*          with the final partitions. Exits if a mirrored population is in a
+*          diagonal partition, which is not exchanged
+*   @param bcInfo: boundary conditions info to setup
+*   @param mapBC: full boundary conditions map (device)
+*   @param grid: grid of map kernels
+*   @param threads: threads of map kernels
+*   @param gpuNumber: GPU number
+*/
+__host__
+void setupSymmetryLinks(
+    BoundaryConditionsInfo* bcInfo,
+    NodeTypeMap* const mapBC,
+    const dim3 grid,
+    const dim3 threads,
+    const int gpuNumber
+);
+
+#endif // !__BC_SYMMETRY_H
@@ -2,24 +2,35 @@
 # as in "var.h"
 # Second argument is used to define the prefix of the executable. It is usually 
 # defined equal to the "ID_SIM" of the "var.h" file
+# Third argument is optional, "mpi" to compile with MPI_BACKEND (the host code
+# is compiled and linked with mpicxx). Run it with one process for each GPU,
+# as "mpirun -np 4 ./../../bin/011sim_D3Q19_sm80"
 
 # example of usage is:
 # sh compile.sh D3Q19 011
 # sh compile.sh D3Q27 202
+# sh compile.sh D3Q19 011 mpi
 
 # Compute capbility, change it to the compute capability of your device
 # Example: 35 stands for compute capability 3.5, 70 for CC 7.0, etc.
 CC=80
 
+# Host compiler, mpicxx for MPI_BACKEND
+HOST_COMPILER=""
+if [[ "$3" = "mpi" ]]
+then
+    HOST_COMPILER="-ccbin mpicxx"
+fi
+
 if [[ "$1" = "D3Q19" || "$1" = "D3Q27" ]]
 then
-    nvcc -gencode arch=compute_${CC},code=sm_${CC} -rdc=true --ptxas-options=-v -O3 --restrict \
+    nvcc -gencode arch=compute_${CC},code=sm_${CC} -rdc=true --ptxas-options=-v -O3 --restrict -std=c++17 -Xcompiler -fopenmp ${HOST_COMPILER} \
         ./IBM/*.cu ./IBM/*.cpp \
         ./IBM/structs/*.cpp ./IBM/structs/*.cu \
         ./IBM/collision/*.cu \
         *.cu *.cpp \
         ./boundaryConditionsSchemes/*.cu \
-        -lcudadevrt -lcurand -o ./../../bin/$2sim_$1_sm${CC}
+        -lcudadevrt -lcurand -lgomp -o ./../../bin/$2sim_$1_sm${CC}
 else
     echo "Input error, example of usage is"
     echo "sh compile.sh D3Q19 011"
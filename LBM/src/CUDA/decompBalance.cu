@@ -0,0 +1,252 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "decompBalance.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#if DECOMP_Z_BALANCE
+int decompZStart[N_GPUS+1];
+__constant__ int gpuDecompZStart[N_GPUS+1];
+__constant__ int gpuDecompNZ;
+#endif
+
+
+__host__
+void decompBalanceSet(const int zStart[N_GPUS+1])
+{
+    #if DECOMP_Z_BALANCE
+    for(int i = 0; i <= N_GPUS; i++)
+        decompZStart[i] = zStart[i];
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        const int nz = decompNZ(i);
+        checkCudaErrors(cudaMemcpyToSymbol(gpuDecompZStart, decompZStart, sizeof(decompZStart)));
+        checkCudaErrors(cudaMemcpyToSymbol(gpuDecompNZ, &nz, sizeof(int)));
+    }
+    #endif
+}
+
+
+__host__
+void decompBalanceUniform(int zStart[N_GPUS+1])
+{
+    for(int i = 0; i <= N_GPUS; i++)
+        zStart[i] = i*(NZ_TOTAL/N_GPUS);
+    zStart[N_GPUS] = NZ_TOTAL;
+}
+
+
+__global__
+void gpuDecompPlaneWork(const NodeTypeMap* const mapBCFull, unsigned long long* const work)
+{
+    __shared__ unsigned long long sWork[N_THREADS];
+
+    const unsigned int tid = threadIdx.x;
+    const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
+    const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
+    const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
+
+    // All threads must reach the barriers, so nodes out of slab just add 0
+    sWork[tid] = 0;
+    if(x < NX && y < NY && z < decompLocalNZ())
+    {
+        NodeTypeMap nodeMap = mapBCFull[idxScalar(x, y, z)];
+        if(!nodeMap.getIsUsed())
+            sWork[tid] = DECOMP_BALANCE_WORK_SOLID;
+        else if(nodeMap.getSchemeBC() != BC_NULL)
+            sWork[tid] = DECOMP_BALANCE_WORK_BC;
+        else
+            sWork[tid] = DECOMP_BALANCE_WORK_FLUID;
+    }
+    __syncthreads();
+
+    // Tree reduction in shared memory with sequential addressing. N_THREADS
+    // may not be a power of 2, so it starts from the largest one below it
+    unsigned int sFirst = 1;
+    while(2*sFirst < blockDim.x)
+        sFirst *= 2;
+    for(unsigned int s = sFirst; s > 0; s >>= 1)
+    {
+        if(tid < s && tid + s < blockDim.x)
+            sWork[tid] += sWork[tid+s];
+        __syncthreads();
+    }
+
+    if(tid == 0 && y < NY && z < decompLocalNZ())
+        atomicAdd(&work[z], sWork[0]);
+}
+
+
+__global__
+void gpuDecompClearPlanes(NodeTypeMap* const mapBCFull)
+{
+    const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
+    const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
+    const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
+    if(x >= NX || y >= NY || z >= NZ || z < decompLocalNZ())
+        return;
+
+    // Without bits set, the node is not used and has no BC
+    mapBCFull[idxScalar(x, y, z)] = NodeTypeMap();
+}
+
+
+/*
+*   @brief Checks if the planes from first can be divided in slabs with at
+*          most maxWork each, with 2 to NZ planes in each slab. Each slab 
+*          takes the most planes it can
+*   @param cumWork[NZ_TOTAL+1]: cumulative work of the planes
+*   @param first: first plane
+*   @param nSlabs: number of slabs
+*   @param maxWork: maximum work of a slab
+*   @return true if it is possible, false otherwise
+*/
+__host__
+static bool slabsFit(const std::vector<size_t>& cumWork, const int first, 
+    const int nSlabs, const size_t maxWork)
+{
+    int start = first;
+    for(int i = 0; i < nSlabs; i++){
+        const int remaining = nSlabs-1-i;
+        int end = std::min(start+NZ, NZ_TOTAL-2*remaining);
+        while(end > start+2 && cumWork[end]-cumWork[start] > maxWork)
+            end--;
+        if(end < start+2 || cumWork[end]-cumWork[start] > maxWork)
+            return false;
+        start = end;
+    }
+    return start == NZ_TOTAL;
+}
+
+
+/*
+*   @brief Slabs with about the same work. The maximum work of a slab is the
+*          minimum possible (with 2 to NZ planes in each one), and each slab
+*          ends in the plane where the cumulative work is closest to its 
+*          share of the total, if the next slabs still fit
+*   @param planeWork[NZ_TOTAL]: work of each plane of the whole domain
+*   @param zStart[N_GPUS+1]: first plane of each slab to write to
+*/
+__host__
+static void balancedStarts(const std::vector<size_t>& planeWork, int zStart[N_GPUS+1])
+{
+    std::vector<size_t> cumWork(NZ_TOTAL+1, 0);
+    for(int z = 0; z < NZ_TOTAL; z++)
+        cumWork[z+1] = cumWork[z] + planeWork[z];
+    const size_t total = cumWork[NZ_TOTAL];
+
+    // Minimum of the maximum work of a slab
+    size_t lo = 0, hi = total;
+    while(lo < hi){
+        const size_t mid = lo + (hi-lo)/2;
+        if(slabsFit(cumWork, 0, N_GPUS, mid))
+            hi = mid;
+        else
+            lo = mid+1;
+    }
+    const size_t maxWork = lo;
+
+    zStart[0] = 0;
+    zStart[N_GPUS] = NZ_TOTAL;
+    for(int i = 1; i < N_GPUS; i++){
+        const int start = zStart[i-1];
+        const double target = (double)total*i/N_GPUS;
+        int best = -1;
+        double bestDist = 0;
+        for(int end = start+2; end <= std::min(start+NZ, NZ_TOTAL); end++){
+            if(cumWork[end]-cumWork[start] > maxWork)
+                break;
+            if(!slabsFit(cumWork, end, N_GPUS-i, maxWork))
+                continue;
+            const double dist = std::abs(cumWork[end]-target);
+            if(best < 0 || dist < bestDist){
+                best = end;
+                bestDist = dist;
+            }
+        }
+        zStart[i] = best;
+    }
+}
+
+
+__host__
+bool decompBalanceSlabs(NodeTypeMap* mapBCFull[N_GPUS], const dim3 grid,
+    const dim3 threads, size_t slabWork[N_GPUS])
+{
+    #if DECOMP_Z_BALANCE
+    // Partitions in the same device would share its gpuDecompNZ, so the 
+    // slabs are kept uniform
+    if(partitionDevicesSharedAny())
+        return false;
+
+    // Work of the planes of each GPU, in the whole domain
+    std::vector<size_t> planeWork(NZ_TOTAL, 0);
+    std::vector<unsigned long long> hWork(NZ);
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        unsigned long long* work;
+        checkCudaErrors(cudaMalloc((void**)&work, NZ*sizeof(unsigned long long)));
+        checkCudaErrors(cudaMemset(work, 0, NZ*sizeof(unsigned long long)));
+        gpuDecompPlaneWork<<<grid, threads>>>(mapBCFull[i], work);
+        getLastCudaError("Plane work error");
+        checkCudaErrors(cudaMemcpy(hWork.data(), work, NZ*sizeof(unsigned long long), 
+            cudaMemcpyDeviceToHost));
+        for(int z = 0; z < decompNZ(i); z++)
+            planeWork[decompOrigin(i, 2)+z] += hWork[z];
+        checkCudaErrors(cudaFree(work));
+    }
+    // Planes of the GPUs of the other processes
+    mpiSumAll(planeWork.data(), NZ_TOTAL);
+
+    int zStart[N_GPUS+1];
+    balancedStarts(planeWork, zStart);
+    bool changed = false;
+    for(int i = 0; i < N_GPUS; i++){
+        slabWork[i] = 0;
+        for(int z = zStart[i]; z < zStart[i+1]; z++)
+            slabWork[i] += planeWork[z];
+        changed = changed || (zStart[i] != decompZStart[i]);
+    }
+    if(changed)
+        decompBalanceSet(zStart);
+    return changed;
+    #else
+    return false;
+    #endif
+}
+
+
+__host__
+void decompBalanceClearMaps(NodeTypeMap* mapBCFull[N_GPUS], const dim3 grid,
+    const dim3 threads)
+{
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        gpuDecompClearPlanes<<<grid, threads>>>(mapBCFull[i]);
+    }
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaDeviceSynchronize());
+    }
+    getLastCudaError("Clear planes error");
+}
@@ -0,0 +1,94 @@
+/*
+*   @file decompBalance.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Z slabs with thickness balanced by the work of their planes
+*          (DECOMP_Z_BALANCE). The map is first built with uniform slabs, the
+*          work of each plane is counted from it (DECOMP_BALANCE_WORK_* for
+*          each node) and the slabs are set so each one has about the same
+*          work, with at most NZ planes. The map is then built again with the
+*          balanced slabs. The planes of a GPU after its slab are not used
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __DECOMP_BALANCE_H
+#define __DECOMP_BALANCE_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "var.h"
+#include "errorDef.h"
+#include "globalFunctions.h"
+#include "mpiBackend.h"
+#include "partitionDevices.h"
+#include "structs/nodeTypeMap.h"
+
+#if DECOMP_Z_BALANCE && (defined(IBM) || POP_HALO_LAYOUT || !POP_PACKED_HALO)
+#error "DECOMP_Z_BALANCE requires POP_PACKED_HALO, and can not be used with IBM or POP_HALO_LAYOUT"
+#endif
+
+
+/*
+*   @brief Sets the first plane of the z slab of each GPU, in host and in
+*          constant memory of the devices of the process
+*   @param zStart[N_GPUS+1]: first plane of each slab, the last is NZ_TOTAL
+*/
+__host__
+void decompBalanceSet(const int zStart[N_GPUS+1]);
+
+
+/*
+*   @brief Slabs with uniform thickness, NZ_TOTAL/N_GPUS planes
+*   @param zStart[N_GPUS+1]: first plane of each slab to write to
+*/
+__host__
+void decompBalanceUniform(int zStart[N_GPUS+1]);
+
+
+/*
+*   @brief Adds the work of the nodes of each plane of the slab of the
+*          device. Each block must be one row of x (same y and z), as the
+*          grid used for LBM
+*   @param mapBCFull: full boundary conditions map of the GPU
+*   @param work[NZ]: work of each plane to add to (must be zeroed before)
+*/
+__global__
+void gpuDecompPlaneWork(const NodeTypeMap* const mapBCFull, unsigned long long* const work);
+
+
+/*
+*   @brief Sets the nodes in the planes after the slab of the device as not
+*          used, so they are skipped by the boundary conditions and tiles
+*   @param mapBCFull: full boundary conditions map of the GPU
+*/
+__global__
+void gpuDecompClearPlanes(NodeTypeMap* const mapBCFull);
+
+
+/*
+*   @brief Counts the work of each plane of the whole domain from the maps
+*          built with the current slabs and balances the slabs. If they are
+*          changed, they are set and the maps must be built again
+*   @param mapBCFull[N_GPUS]: full boundary conditions map of each GPU
+*   @param grid: grid used for LBM
+*   @param threads: threads used for LBM
+*   @param slabWork[N_GPUS]: work of each balanced slab to write to
+*   @return true if the slabs were changed, false otherwise
+*/
+__host__
+bool decompBalanceSlabs(NodeTypeMap* mapBCFull[N_GPUS], const dim3 grid,
+    const dim3 threads, size_t slabWork[N_GPUS]);
+
+
+/*
+*   @brief Sets the planes after the slab of each GPU as not used
+*   @param mapBCFull[N_GPUS]: full boundary conditions map of each GPU
+*   @param grid: grid used for LBM
+*   @param threads: threads used for LBM
+*/
+__host__
+void decompBalanceClearMaps(NodeTypeMap* mapBCFull[N_GPUS], const dim3 grid,
+    const dim3 threads);
+
+#endif // !__DECOMP_BALANCE_H
@@ -0,0 +1,98 @@
+/*
+*   @file decomposition.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Choice of the partitions of the grid among the GPUs in x, y and z 
+*          (z slabs, pencils or blocks), in compile time. Each GPU has the 
+*          same partition size (z slabs may be balanced in runtime, 
+*          DECOMP_Z_BALANCE) and the GPUs are numbered with x first, so z 
+*          slabs keep the previous numbering
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __DECOMPOSITION_H
+#define __DECOMPOSITION_H
+
+
+/*
+*   @brief Halo area of one partition, the nodes in its faces shared with 
+*          other GPUs. The populations crossing the GPUs are proportional to it
+*   @param px, py, pz: partitions in x, y and z
+*   @param nx, ny, nz: size of the grid
+*   @return halo area, in nodes
+*/
+constexpr long long decompHaloArea(const int px, const int py, const int pz, 
+    const int nx, const int ny, const int nz)
+{
+    return (px > 1 ? 2LL*(ny/py)*(nz/pz) : 0) 
+        + (py > 1 ? 2LL*(nx/px)*(nz/pz) : 0)
+        + (pz > 1 ? 2LL*(nx/px)*(ny/py) : 0);
+}
+
+
+/*
+*   @brief Checks if the partitions divide the grid among the GPUs, with at 
+*          least two nodes in each direction of a partition
+*   @param px, py, pz: partitions in x, y and z
+*   @param nGpus: number of GPUs
+*   @param nx, ny, nz: size of the grid
+*   @param slabsOnly: only z slabs are valid
+*   @return true if valid, false otherwise
+*/
+constexpr bool decompIsValid(const int px, const int py, const int pz, const int nGpus,
+    const int nx, const int ny, const int nz, const bool slabsOnly)
+{
+    return px*py*pz == nGpus && nx % px == 0 && ny % py == 0 && nz % pz == 0
+        && nx/px >= 2 && ny/py >= 2 && nz/pz >= 2
+        && (!slabsOnly || (px == 1 && py == 1));
+}
+
+
+/*
+*   @brief Partitions in axis of the valid decomposition with minimum halo 
+*          area. In ties, z slabs are preferred (contiguous planes), then 
+*          pencils in y and z
+*   @param axis: 0 for x, 1 for y, 2 for z
+*   @param nGpus: number of GPUs
+*   @param nx, ny, nz: size of the grid
+*   @param slabsOnly: only z slabs are valid
+*   @return partitions in axis, 0 if there is no valid decomposition
+*/
+constexpr int decompSelect(const int axis, const int nGpus, 
+    const int nx, const int ny, const int nz, const bool slabsOnly)
+{
+    int best[3] = {0, 0, 0};
+    long long bestArea = -1;
+    for(int pz = nGpus; pz >= 1; pz--){
+        for(int py = nGpus/pz; py >= 1; py--){
+            const int px = nGpus/(pz*py);
+            if(!decompIsValid(px, py, pz, nGpus, nx, ny, nz, slabsOnly))
+                continue;
+            const long long area = decompHaloArea(px, py, pz, nx, ny, nz);
+            if(bestArea < 0 || area < bestArea){
+                bestArea = area;
+                best[0] = px;
+                best[1] = py;
+                best[2] = pz;
+            }
+        }
+    }
+    return best[axis];
+}
+
+
+/*
+*   @brief Planes allocated for each z slab with balanced thickness 
+*          (DECOMP_Z_BALANCE), the uniform thickness with extra planes, at
+*          most the whole grid
+*   @param nz: size of the grid in z
+*   @param pz: partitions in z
+*   @param extra: extra planes, in % of the uniform thickness
+*   @return planes of each slab
+*/
+constexpr int decompBalanceNZ(const int nz, const int pz, const int extra)
+{
+    return (((nz/pz)*(100+extra)+99)/100 < nz) ? ((nz/pz)*(100+extra)+99)/100 : nz;
+}
+
+#endif // !__DECOMPOSITION_H
@@ -0,0 +1,218 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "domainDecomposition.h"
+
+
+/*
+*   @brief Nodes in axis where the populations with velocity component c 
+*          crossing in direction dir are streamed to (periodic in GPU). It is
+*          the opposite side of the partition, if the population crosses in
+*          axis, otherwise the nodes it reaches without crossing
+*   @param dir: direction in axis (-1, 0 or 1)
+*   @param c: velocity component in axis
+*   @param n: number of nodes in axis
+*   @param start: first node to write to
+*   @param end: last node + 1 to write to
+*/
+__host__
+static void crossingRange(const int dir, const int c, const int n, int* start, int* end)
+{
+    if(dir != 0){
+        *start = (dir > 0) ? 0 : n-1;
+        *end = *start+1;
+    }
+    else{
+        *start = (c > 0) ? 1 : 0;
+        *end = (c < 0) ? n-1 : n;
+    }
+}
+
+
+/*
+*   @brief Shift in axis of the neighbor partition in direction. All 
+*          directions reach the same partition with one partition in axis, 
+*          and both sides with two partitions
+*   @param dir: direction in axis (-1, 0 or 1)
+*   @param p: number of partitions in axis
+*   @return shift of the partition (-1, 0 or 1)
+*/
+__host__
+static int linkShift(const int dir, const int p)
+{
+    return (p == 1) ? 0 : ((p == 2) ? (dir != 0) : dir);
+}
+
+
+/*
+*   @brief Nodes in axis of the population sent in link, the union of its 
+*          nodes in the exchanges with the link shift
+*   @param shift: link shift in axis
+*   @param p: number of partitions in axis
+*   @param c: velocity component in axis
+*   @param n: number of nodes in axis
+*   @param start: first node to write to
+*   @param end: last node + 1 to write to
+*   @return true if the population is sent in link, false otherwise
+*/
+__host__
+static bool linkRange(const int shift, const int p, const int c, const int n, 
+    int* start, int* end)
+{
+    // Crossing or not, the population stays in the same partitions in axis
+    if(p == 1){
+        *start = 0;
+        *end = n;
+        return true;
+    }
+    if(shift == 0){
+        crossingRange(0, c, n, start, end);
+        return true;
+    }
+    // With two partitions, crossing to both sides reaches the neighbor
+    if(c == 0 || (p > 2 && c != shift))
+        return false;
+    crossingRange(c, c, n, start, end);
+    return true;
+}
+
+
+/*
+*   @brief Adds segment of population, after the last one
+*   @param segments: segments to add to
+*   @param nSegments: number of segments, incremented
+*   @param count: number of values, incremented
+*   @param pop: population number
+*   @param start: first node in x, y and z
+*   @param end: last node + 1 in x, y and z
+*/
+__host__
+static void addSegment(HaloSegment* segments, int* nSegments, size_t* count,
+    const int pop, const int start[3], const int end[3])
+{
+    HaloSegment* seg = &segments[*nSegments];
+    seg->pop = pop;
+    for(int a = 0; a < 3; a++){
+        seg->start[a] = start[a];
+        seg->end[a] = end[a];
+    }
+    seg->offset = *count;
+    *count += (size_t)(end[0]-start[0])*(end[1]-start[1])*(end[2]-start[2]);
+    (*nSegments)++;
+}
+
+
+__host__
+void domainDecompositionSetup(DomainDecomposition* decomp)
+{
+    const int n[3] = {NX, NY, NZ};
+    const int p[3] = {DECOMP_PX, DECOMP_PY, DECOMP_PZ};
+
+    decomp->nLinks = 0;
+    decomp->totalCount = 0;
+    int e = 0;
+    for(int dz = -1; dz <= 1; dz++){
+        for(int dy = -1; dy <= 1; dy++){
+            for(int dx = -1; dx <= 1; dx++){
+                if(dx == 0 && dy == 0 && dz == 0)
+                    continue;
+                const int dir[3] = {dx, dy, dz};
+                NeighborExchange* exchange = &(decomp->exchanges[e++]);
+                exchange->nSegments = 0;
+                exchange->count = 0;
+                exchange->link = -1;
+                for(int a = 0; a < 3; a++)
+                    exchange->dir[a] = dir[a];
+
+                // Populations crossing in all non zero components of direction
+                for(int i = 1; i < Q; i++){
+                    const int c[3] = {velCx(i), velCy(i), velCz(i)};
+                    int start[3], end[3];
+                    bool crosses = true;
+                    for(int a = 0; a < 3; a++){
+                        crosses = crosses && (dir[a] == 0 || c[a] == dir[a]);
+                        crossingRange(dir[a], c[a], n[a], &start[a], &end[a]);
+                    }
+                    if(crosses)
+                        addSegment(exchange->segments, &(exchange->nSegments), 
+                            &(exchange->count), i, start, end);
+                }
+
+                const int shift[3] = {linkShift(dx, p[0]), linkShift(dy, p[1]), linkShift(dz, p[2])};
+                if((shift[0] == 0 && shift[1] == 0 && shift[2] == 0) || exchange->count == 0)
+                    continue;
+                for(int l = 0; l < decomp->nLinks; l++){
+                    const HaloLink* link = &(decomp->links[l]);
+                    if(link->shift[0] == shift[0] && link->shift[1] == shift[1] 
+                            && link->shift[2] == shift[2])
+                        exchange->link = l;
+                }
+                if(exchange->link >= 0)
+                    continue;
+
+                // New link, with the populations of all exchanges with its shift
+                HaloLink* link = &(decomp->links[decomp->nLinks]);
+                link->nSegments = 0;
+                link->count = 0;
+                for(int a = 0; a < 3; a++)
+                    link->shift[a] = shift[a];
+                for(int i = 1; i < Q; i++){
+                    const int c[3] = {velCx(i), velCy(i), velCz(i)};
+                    int start[3], end[3];
+                    bool sent = true;
+                    for(int a = 0; a < 3; a++)
+                        sent = sent && linkRange(shift[a], p[a], c[a], n[a], &start[a], &end[a]);
+                    if(sent)
+                        addSegment(link->segments, &(link->nSegments), &(link->count),
+                            i, start, end);
+                }
+                exchange->link = decomp->nLinks;
+                decomp->totalCount += link->count;
+                decomp->nLinks++;
+            }
+        }
+    }
+}
+
+
+__host__
+int neighborExchangeGPU(const NeighborExchange* exchange, const int gpuNumber)
+{
+    return decompShift(gpuNumber, exchange->dir[0], exchange->dir[1], exchange->dir[2]);
+}
+
+
+__host__
+HaloLink haloLinkGPU(const HaloLink* link, const int gpuNumber)
+{
+    HaloLink linkGPU = *link;
+    #if DECOMP_Z_BALANCE
+    const int shiftZ = decompNZ(gpuNumber)-NZ;
+    for(int s = 0; s < linkGPU.nSegments; s++){
+        HaloSegment* seg = &(linkGPU.segments[s]);
+        if(seg->start[2] == NZ-1){
+            seg->start[2] += shiftZ;
+            seg->end[2] += shiftZ;
+        }
+    }
+    #endif
+    return linkGPU;
+}
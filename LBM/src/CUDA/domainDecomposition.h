@@ -0,0 +1,101 @@
+/*
+*   @file domainDecomposition.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Neighbor exchanges of the partitions of the grid among the GPUs
+*          (DECOMP_PX, DECOMP_PY and DECOMP_PZ), for each face, edge and 
+*          corner. The streaming is periodic in each GPU, so the populations 
+*          crossing a face, edge or corner are streamed to the opposite side
+*          of the partition, in the same nodes they must reach in the 
+*          neighbor. They are exchanged in links, one for each neighbor shift,
+*          with the populations of all exchanges to the same neighbor
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __DOMAIN_DECOMPOSITION_H
+#define __DOMAIN_DECOMPOSITION_H
+
+#include "var.h"
+#include "globalFunctions.h"
+
+// Faces, edges and corners of a partition
+#define DECOMP_N_DIRS (26)
+
+
+/*
+*   Nodes of a population in an exchange, box [start, end) in x, y and z
+*/
+typedef struct haloSegment {
+    int pop;            // population number
+    int start[3];       // first node in x, y and z
+    int end[3];         // last node + 1 in x, y and z
+    size_t offset;      // position of first value in buffer
+} HaloSegment;
+
+
+/*
+*   Exchange through a face, edge or corner of the partition
+*/
+typedef struct neighborExchange {
+    int dir[3];                     // direction, -1, 0 or 1 in x, y and z
+    int nSegments;                  // number of populations crossing
+    HaloSegment segments[Q];        // nodes of each population crossing
+    size_t count;                   // number of values
+    int link;                       // link with the neighbor, -1 if nothing
+                                    // is sent (same GPU or no populations)
+} NeighborExchange;
+
+
+/*
+*   Exchanges to the same neighbor, packed in one buffer. Each population 
+*   has one segment, the union of its nodes in the exchanges
+*/
+typedef struct haloLink {
+    int shift[3];                   // shift of the neighbor partition
+    int nSegments;                  // number of populations crossing
+    HaloSegment segments[Q];        // nodes of each population crossing
+    size_t count;                   // number of values (buffer size)
+} HaloLink;
+
+
+/*
+*   Exchanges of a partition, the same for all GPUs
+*/
+typedef struct domainDecomposition {
+    NeighborExchange exchanges[DECOMP_N_DIRS];  // faces, edges and corners
+    int nLinks;                                 // number of links
+    HaloLink links[DECOMP_N_DIRS];              // links with other GPUs
+    size_t totalCount;                          // values in all links
+} DomainDecomposition;
+
+
+/*
+*   @brief Builds the exchanges and links of the partitions
+*   @param decomp: decomposition to setup
+*/
+__host__
+void domainDecompositionSetup(DomainDecomposition* decomp);
+
+
+/*
+*   @brief Neighbor GPU of an exchange
+*   @param exchange: exchange to use
+*   @param gpuNumber: GPU number
+*   @return neighbor GPU number
+*/
+__host__
+int neighborExchangeGPU(const NeighborExchange* exchange, const int gpuNumber);
+
+
+/*
+*   @brief Link of a GPU. With balanced z slabs (DECOMP_Z_BALANCE) the GPU
+*          may have less than NZ planes, so the segments in the last plane
+*          (NZ-1) are moved to the last plane of its slab
+*   @param link: link of the partitions
+*   @param gpuNumber: GPU number
+*   @return link of the GPU
+*/
+__host__
+HaloLink haloLinkGPU(const HaloLink* link, const int gpuNumber);
+
+#endif // !__DOMAIN_DECOMPOSITION_H
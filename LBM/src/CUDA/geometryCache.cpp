@@ -0,0 +1,607 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "geometryCache.h"
+#include "partitionDevices.h"
+
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// Identifier of cache files
+#define GEOMETRY_CACHE_MAGIC "LBMGEOC"
+
+
+/*
+*   Header of the cache file
+*/
+typedef struct geometryCacheHeader {
+    char magic[8];      // GEOMETRY_CACHE_MAGIC
+    uint32_t version;   // GEOMETRY_CACHE_VERSION
+    uint32_t nSections; // number of sections
+    uint64_t hash;      // hash of the configuration
+    uint64_t size;      // size of file, in bytes
+} GeometryCacheHeader;
+
+
+/*
+*   Group of boundary conditions nodes, as in file
+*/
+typedef struct geometryCacheBCGroup {
+    unsigned char scheme;
+    unsigned char direction;
+    unsigned char geometry;
+    unsigned char pad[5];
+    uint64_t first;
+    uint64_t count;
+} GeometryCacheBCGroup;
+
+
+/*
+*   @brief Adds bytes to FNV-1a hash
+*   @param h: current hash
+*   @param data: bytes to add
+*   @param size: number of bytes
+*   @return updated hash
+*/
+__host__
+static uint64_t hashBytes(uint64_t h, const void* data, const size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for(size_t i = 0; i < size; i++)
+    {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+template <typename T>
+__host__
+static uint64_t hashValue(const uint64_t h, const T value)
+{
+    return hashBytes(h, &value, sizeof(T));
+}
+
+__host__
+static uint64_t hashString(const uint64_t h, const char* str)
+{
+    return hashBytes(h, str, strlen(str)+1);
+}
+
+
+/*
+*   @brief Hash of the configuration that defines the geometry
+*   @return hash
+*/
+__host__
+static uint64_t geometryCacheHash()
+{
+    uint64_t h = 14695981039346656037ULL;
+    h = hashString(h, GEOMETRY_CACHE_TAG);
+    h = hashValue(h, (int)GEOMETRY_CACHE_VERSION);
+
+    // Domain and lattice
+    h = hashValue(h, NX);
+    h = hashValue(h, NY);
+    h = hashValue(h, NZ);
+    h = hashValue(h, NX_TOTAL);
+    h = hashValue(h, NY_TOTAL);
+    h = hashValue(h, NZ_TOTAL);
+    h = hashValue(h, N_GPUS);
+    h = hashValue(h, DECOMP_PX);
+    h = hashValue(h, DECOMP_PY);
+    h = hashValue(h, DECOMP_PZ);
+    h = hashValue(h, (bool)DECOMP_Z_BALANCE);
+    #if DECOMP_Z_BALANCE
+    h = hashValue(h, DECOMP_BALANCE_EXTRA);
+    h = hashValue(h, DECOMP_BALANCE_WORK_SOLID);
+    h = hashValue(h, DECOMP_BALANCE_WORK_FLUID);
+    h = hashValue(h, DECOMP_BALANCE_WORK_BC);
+    // Slabs are uniform with partitions in the same device
+    h = hashValue(h, partitionDevicesSharedAny());
+    #endif
+    h = hashValue(h, (int)Q);
+    h = hashValue(h, sizeof(dfloat));
+    h = hashValue(h, sizeof(NodeTypeMap));
+
+    // Boundary conditions map
+    h = hashValue(h, (bool)SPONGE_LAYER);
+    #if SPONGE_LAYER
+    h = hashValue(h, SPONGE_WIDTH_W);
+    h = hashValue(h, SPONGE_WIDTH_E);
+    h = hashValue(h, SPONGE_WIDTH_S);
+    h = hashValue(h, SPONGE_WIDTH_N);
+    h = hashValue(h, SPONGE_WIDTH_B);
+    h = hashValue(h, SPONGE_WIDTH_F);
+    #endif
+    h = hashValue(h, (bool)GEOMETRY_SDF);
+    h = hashValue(h, (bool)GEOMETRY_MESH);
+    #if GEOMETRY_MESH
+    h = hashString(h, GEOMETRY_MESH_FILE);
+    h = hashValue(h, GEOMETRY_MESH_SCALE);
+    h = hashValue(h, GEOMETRY_MESH_OFFSET_X);
+    h = hashValue(h, GEOMETRY_MESH_OFFSET_Y);
+    h = hashValue(h, GEOMETRY_MESH_OFFSET_Z);
+    // Mesh file may change without compiling
+    struct stat meshStat;
+    if(stat(GEOMETRY_MESH_FILE, &meshStat) == 0)
+    {
+        h = hashValue(h, (int64_t)meshStat.st_size);
+        h = hashValue(h, (int64_t)meshStat.st_mtime);
+    }
+    #endif
+
+    // IBM particles and Euler nodes
+    #ifdef IBM
+    h = hashValue(h, (int)NUM_PARTICLES);
+    h = hashValue(h, (dfloat)PARTICLE_DIAMETER);
+    h = hashValue(h, (dfloat)MESH_SCALE);
+    h = hashValue(h, (int)MESH_COULOMB);
+    h = hashValue(h, sizeof(ParticleCenter));
+    h = hashValue(h, sizeof(ParticleNode));
+    h = hashValue(h, (bool)IBM_EULER_OPTIMIZATION);
+    h = hashValue(h, (dfloat)IBM_EULER_SHELL_THICKNESS);
+    h = hashValue(h, (dfloat)IBM_EULER_UPDATE_DIST);
+    h = hashValue(h, (dfloat)P_DIST);
+    h = hashValue(h, (int)MACR_BORDER_NODES);
+    #endif
+
+    return h;
+}
+
+
+/*
+*   @brief Adds section to cache data
+*   @param cache: geometry cache
+*   @param id: section define
+*   @param gpu: GPU number of section
+*   @param size: size of section content, in bytes
+*   @return pointer to section content to write to, valid until next section
+*/
+__host__
+static char* geometryCacheAddSection(GeometryCache* cache, const uint32_t id,
+    const uint32_t gpu, const size_t size)
+{
+    if(cache->data.size() == 0)
+        cache->data.resize(sizeof(GeometryCacheHeader), 0);
+
+    GeometryCacheSection section;
+    section.id = id;
+    section.gpu = gpu;
+    section.size = size;
+    const size_t offset = cache->data.size();
+    const size_t paddedSize = (size+7)/8*8;
+    cache->data.resize(offset+sizeof(GeometryCacheSection)+paddedSize, 0);
+    memcpy(&(cache->data[offset]), &section, sizeof(GeometryCacheSection));
+    ((GeometryCacheHeader*)cache->data.data())->nSections++;
+
+    return &(cache->data[offset+sizeof(GeometryCacheSection)]);
+}
+
+
+/*
+*   @brief Finds section in cache data
+*   @param cache: geometry cache
+*   @param id: section define
+*   @param gpu: GPU number of section
+*   @param size: size of section content to write to
+*   @return pointer to section content, nullptr if not found
+*/
+__host__
+static const char* geometryCacheFindSection(const GeometryCache* cache, 
+    const uint32_t id, const uint32_t gpu, size_t* size)
+{
+    if(!cache->loaded)
+        return nullptr;
+
+    size_t offset = sizeof(GeometryCacheHeader);
+    while(offset+sizeof(GeometryCacheSection) <= cache->data.size())
+    {
+        GeometryCacheSection section;
+        memcpy(&section, &(cache->data[offset]), sizeof(GeometryCacheSection));
+        offset += sizeof(GeometryCacheSection);
+        if(section.size > cache->data.size()-offset)
+            return nullptr;
+        if(section.id == id && section.gpu == gpu)
+        {
+            *size = section.size;
+            return &(cache->data[offset]);
+        }
+        offset += (section.size+7)/8*8;
+    }
+    return nullptr;
+}
+
+
+template <typename T>
+__host__
+static void writeArray(char** dst, const T* src, const size_t n)
+{
+    // cudaMemcpyDefault, so src may be in device
+    checkCudaErrors(cudaMemcpy(*dst, src, n*sizeof(T), cudaMemcpyDefault));
+    *dst += n*sizeof(T);
+}
+
+template <typename T>
+__host__
+static void readArray(const char** src, T* dst, const size_t n)
+{
+    // cudaMemcpyDefault, so dst may be in device
+    checkCudaErrors(cudaMemcpy(dst, *src, n*sizeof(T), cudaMemcpyDefault));
+    *src += n*sizeof(T);
+}
+
+
+__host__
+bool geometryCacheSetup(GeometryCache* cache)
+{
+    cache->hash = geometryCacheHash();
+    char hashStr[17];
+    snprintf(hashStr, sizeof(hashStr), "%016llx", (unsigned long long)cache->hash);
+    cache->filename = std::string(PATH_FILES) + "/geometry_" + hashStr + ".cache";
+    #if MPI_BACKEND
+    // Each process builds and stores only the GPUs of it
+    cache->filename = std::string(PATH_FILES) + "/geometry_" + hashStr + "_rank" 
+        + std::to_string(gpuBegin()) + ".cache";
+    #endif
+    cache->loaded = false;
+    cache->store = true;
+    cache->data.clear();
+
+    FILE* file = fopen(cache->filename.c_str(), "rb");
+    if(file == nullptr)
+    {
+        printf("Geometry cache %s not found, geometry will be built\n", 
+            cache->filename.c_str());
+        fflush(stdout);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    const long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // Whole file in a single read
+    bool valid = fileSize >= (long)sizeof(GeometryCacheHeader);
+    if(valid)
+    {
+        cache->data.resize(fileSize);
+        valid = fread(cache->data.data(), 1, fileSize, file) == (size_t)fileSize;
+    }
+    fclose(file);
+    if(valid)
+    {
+        const GeometryCacheHeader* header = (const GeometryCacheHeader*)cache->data.data();
+        valid = (strncmp(header->magic, GEOMETRY_CACHE_MAGIC, sizeof(header->magic)) == 0
+            && header->version == GEOMETRY_CACHE_VERSION
+            && header->hash == cache->hash
+            && header->size == (uint64_t)fileSize);
+    }
+    if(!valid)
+    {
+        printf("Geometry cache %s is invalid, geometry will be built\n", 
+            cache->filename.c_str());
+        fflush(stdout);
+        cache->data.clear();
+        return false;
+    }
+
+    cache->loaded = true;
+    cache->store = false;
+    printf("Geometry cache %s loaded (%.2f MB)\n", cache->filename.c_str(), 
+        fileSize/(1024.0*1024.0));
+    fflush(stdout);
+    return true;
+}
+
+
+__host__
+void geometryCacheSave(GeometryCache* cache)
+{
+    if(!cache->store || cache->data.size() == 0)
+        return;
+
+    GeometryCacheHeader* header = (GeometryCacheHeader*)cache->data.data();
+    memcpy(header->magic, GEOMETRY_CACHE_MAGIC, sizeof(header->magic));
+    header->version = GEOMETRY_CACHE_VERSION;
+    header->hash = cache->hash;
+    header->size = cache->data.size();
+
+    // Written to temporary file, so a partial file is never loaded
+    const std::string tmpFilename = cache->filename + ".tmp";
+    FILE* file = fopen(tmpFilename.c_str(), "wb");
+    if(file == nullptr)
+    {
+        printf("Unable to write geometry cache %s\n", tmpFilename.c_str());
+        fflush(stdout);
+        return;
+    }
+    const bool written = fwrite(cache->data.data(), 1, cache->data.size(), file) 
+        == cache->data.size();
+    fclose(file);
+    if(!written || rename(tmpFilename.c_str(), cache->filename.c_str()) != 0)
+    {
+        printf("Unable to write geometry cache %s\n", cache->filename.c_str());
+        remove(tmpFilename.c_str());
+    }
+    else
+    {
+        printf("Geometry cache %s saved (%.2f MB)\n", cache->filename.c_str(),
+            cache->data.size()/(1024.0*1024.0));
+    }
+    fflush(stdout);
+    cache->store = false;
+}
+
+
+__host__
+void geometryCacheFree(GeometryCache* cache)
+{
+    std::vector<char>().swap(cache->data);
+    cache->store = false;
+}
+
+
+__host__
+bool geometryCacheLoadParticles(GeometryCache* cache, Particle particles[NUM_PARTICLES])
+{
+    size_t size = 0;
+    const char* src = geometryCacheFindSection(cache, GEOMETRY_CACHE_SECTION_PARTICLES, 0, &size);
+    if(src == nullptr)
+        return false;
+
+    // Number of nodes and center of each particle, then the nodes
+    size_t expectedSize = NUM_PARTICLES*(sizeof(unsigned int)+sizeof(ParticleCenter));
+    if(size < expectedSize)
+        return false;
+    for(int i = 0; i < NUM_PARTICLES; i++)
+    {
+        unsigned int numNodes;
+        memcpy(&numNodes, src+i*sizeof(unsigned int), sizeof(unsigned int));
+        expectedSize += numNodes*sizeof(ParticleNode);
+    }
+    if(size != expectedSize)
+        return false;
+
+    for(int i = 0; i < NUM_PARTICLES; i++)
+        readArray(&src, &(particles[i].numNodes), 1);
+    for(int i = 0; i < NUM_PARTICLES; i++)
+        readArray(&src, &(particles[i].pCenter), 1);
+    for(int i = 0; i < NUM_PARTICLES; i++)
+    {
+        particles[i].nodes = (ParticleNode*)malloc(sizeof(ParticleNode)*particles[i].numNodes);
+        readArray(&src, particles[i].nodes, particles[i].numNodes);
+    }
+    return true;
+}
+
+
+__host__
+void geometryCacheStoreParticles(GeometryCache* cache, const Particle particles[NUM_PARTICLES])
+{
+    if(!cache->store)
+        return;
+
+    size_t size = NUM_PARTICLES*(sizeof(unsigned int)+sizeof(ParticleCenter));
+    for(int i = 0; i < NUM_PARTICLES; i++)
+        size += particles[i].numNodes*sizeof(ParticleNode);
+
+    char* dst = geometryCacheAddSection(cache, GEOMETRY_CACHE_SECTION_PARTICLES, 0, size);
+    for(int i = 0; i < NUM_PARTICLES; i++)
+        writeArray(&dst, &(particles[i].numNodes), 1);
+    for(int i = 0; i < NUM_PARTICLES; i++)
+        writeArray(&dst, &(particles[i].pCenter), 1);
+    for(int i = 0; i < NUM_PARTICLES; i++)
+        writeArray(&dst, particles[i].nodes, particles[i].numNodes);
+}
+
+
+__host__
+bool geometryCacheLoadBC(GeometryCache* cache, const int gpuNumber,
+    NodeTypeMap* mapBCFull, BoundaryConditionsInfo* bcInfo)
+{
+    size_t size = 0;
+    const char* src = geometryCacheFindSection(cache, GEOMETRY_CACHE_SECTION_BC, gpuNumber, &size);
+    if(src == nullptr)
+        return false;
+
+    // Totals, then groups, map, indexes and links
+    uint64_t totals[4];
+    if(size < sizeof(totals))
+        return false;
+    memcpy(totals, src, sizeof(totals));
+    const size_t totalBCNodes = totals[0];
+    const size_t totalInterpBBLinks = totals[2];
+    const unsigned int totalBCGroups = (unsigned int)totals[3];
+    if(totalBCGroups > BC_GROUPS_MAX || size != sizeof(totals) 
+        + totalBCGroups*sizeof(GeometryCacheBCGroup) + MEM_SIZE_MAP_BC_FULL
+        + totalBCNodes*sizeof(size_t) + totalInterpBBLinks*(sizeof(size_t)+sizeof(float)))
+        return false;
+    src += sizeof(totals);
+
+    bcInfo->totalBCNodes = totalBCNodes;
+    bcInfo->totalNonLocalBCNodes = totals[1];
+    bcInfo->totalBCGroups = totalBCGroups;
+    for(unsigned int g = 0; g < totalBCGroups; g++)
+    {
+        GeometryCacheBCGroup cacheGroup;
+        readArray(&src, &cacheGroup, 1);
+        BCGroup* group = &(bcInfo->bcGroups[g]);
+        group->scheme = cacheGroup.scheme;
+        group->direction = cacheGroup.direction;
+        group->geometry = cacheGroup.geometry;
+        group->first = cacheGroup.first;
+        group->count = cacheGroup.count;
+        #if BC_GROUPS_TIMING
+        checkCudaErrors(cudaEventCreate(&(group->start)));
+        checkCudaErrors(cudaEventCreate(&(group->stop)));
+        group->timeElapsed = 0;
+        #endif
+    }
+
+    readArray(&src, (uint32_t*)mapBCFull, NUMBER_LBM_NODES);
+
+    bcInfo->idxBCNodes = nullptr;
+    bcInfo->allocateIdxBC();
+    if(totalBCNodes > 0)
+        readArray(&src, bcInfo->idxBCNodes, totalBCNodes);
+
+    bcInfo->totalInterpBBLinks = totalInterpBBLinks;
+    bcInfo->idxInterpBBLinks = nullptr;
+    bcInfo->qInterpBBLinks = nullptr;
+    if(totalInterpBBLinks > 0)
+    {
+        bcInfo->idxInterpBBLinks = (size_t*)simMalloc(
+            totalInterpBBLinks*sizeof(size_t), IN_VIRTUAL);
+        bcInfo->qInterpBBLinks = (float*)simMalloc(
+            totalInterpBBLinks*sizeof(float), IN_VIRTUAL);
+        readArray(&src, bcInfo->idxInterpBBLinks, totalInterpBBLinks);
+        readArray(&src, bcInfo->qInterpBBLinks, totalInterpBBLinks);
+    }
+    return true;
+}
+
+
+__host__
+void geometryCacheStoreBC(GeometryCache* cache, const int gpuNumber,
+    const NodeTypeMap* mapBCFull, const BoundaryConditionsInfo* bcInfo)
+{
+    if(!cache->store)
+        return;
+
+    const uint64_t totals[4] = {bcInfo->totalBCNodes, bcInfo->totalNonLocalBCNodes,
+        bcInfo->totalInterpBBLinks, bcInfo->totalBCGroups};
+    const size_t size = sizeof(totals) + bcInfo->totalBCGroups*sizeof(GeometryCacheBCGroup) 
+        + MEM_SIZE_MAP_BC_FULL + bcInfo->totalBCNodes*sizeof(size_t) 
+        + bcInfo->totalInterpBBLinks*(sizeof(size_t)+sizeof(float));
+
+    char* dst = geometryCacheAddSection(cache, GEOMETRY_CACHE_SECTION_BC, gpuNumber, size);
+    writeArray(&dst, totals, 4);
+    for(unsigned int g = 0; g < bcInfo->totalBCGroups; g++)
+    {
+        const BCGroup* group = &(bcInfo->bcGroups[g]);
+        GeometryCacheBCGroup cacheGroup = {};
+        cacheGroup.scheme = group->scheme;
+        cacheGroup.direction = group->direction;
+        cacheGroup.geometry = group->geometry;
+        cacheGroup.first = group->first;
+        cacheGroup.count = group->count;
+        writeArray(&dst, &cacheGroup, 1);
+    }
+    writeArray(&dst, (const uint32_t*)mapBCFull, NUMBER_LBM_NODES);
+    if(bcInfo->totalBCNodes > 0)
+        writeArray(&dst, bcInfo->idxBCNodes, bcInfo->totalBCNodes);
+    if(bcInfo->totalInterpBBLinks > 0)
+    {
+        writeArray(&dst, bcInfo->idxInterpBBLinks, bcInfo->totalInterpBBLinks);
+        writeArray(&dst, bcInfo->qInterpBBLinks, bcInfo->totalInterpBBLinks);
+    }
+}
+
+
+__host__
+bool geometryCacheLoadDecomp(GeometryCache* cache, int zStart[N_GPUS+1])
+{
+    size_t size = 0;
+    const char* src = geometryCacheFindSection(cache, GEOMETRY_CACHE_SECTION_DECOMP, 0, &size);
+    if(src == nullptr || size != (N_GPUS+1)*sizeof(int32_t))
+        return false;
+
+    int32_t cacheStart[N_GPUS+1];
+    memcpy(cacheStart, src, sizeof(cacheStart));
+    for(int i = 0; i < N_GPUS+1; i++)
+        zStart[i] = cacheStart[i];
+    return true;
+}
+
+
+__host__
+void geometryCacheStoreDecomp(GeometryCache* cache, const int zStart[N_GPUS+1])
+{
+    if(!cache->store)
+        return;
+
+    int32_t cacheStart[N_GPUS+1];
+    for(int i = 0; i < N_GPUS+1; i++)
+        cacheStart[i] = zStart[i];
+    char* dst = geometryCacheAddSection(cache, GEOMETRY_CACHE_SECTION_DECOMP, 0, 
+        sizeof(cacheStart));
+    memcpy(dst, cacheStart, sizeof(cacheStart));
+}
+
+
+#if IBM_EULER_OPTIMIZATION
+__host__
+bool geometryCacheLoadEulerNodes(GeometryCache* cache,
+    ParticleEulerNodesUpdate* pEulerNodes, ParticleCenter p[NUM_PARTICLES])
+{
+    // Number of nodes and fixed nodes, then indexes and masks of nodes
+    const char* src[N_GPUS];
+    uint32_t counts[N_GPUS][2];
+    for(int i = 0; i < N_GPUS; i++)
+    {
+        size_t size = 0;
+        src[i] = geometryCacheFindSection(cache, GEOMETRY_CACHE_SECTION_EULER_NODES, i, &size);
+        if(src[i] == nullptr || size < sizeof(counts[i]))
+            return false;
+        memcpy(counts[i], src[i], sizeof(counts[i]));
+        if(size != sizeof(counts[i]) + counts[i][0]*(sizeof(size_t)+sizeof(uint32_t)))
+            return false;
+        src[i] += sizeof(counts[i]);
+    }
+
+    pEulerNodes->allocateEulerNodes(p);
+    for(int i = 0; i < N_GPUS; i++)
+    {
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        pEulerNodes->currEulerNodes[i] = counts[i][0];
+        pEulerNodes->eulerFixedNodes[i] = counts[i][1];
+        readArray(&(src[i]), pEulerNodes->eulerIndexesUpdate[i], counts[i][0]);
+        const uint32_t* masks = (const uint32_t*)src[i];
+        for(unsigned int n = 0; n < counts[i][0]; n++)
+            pEulerNodes->eulerMaskArray[i][pEulerNodes->eulerIndexesUpdate[i][n]] = masks[n];
+    }
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
+    return true;
+}
+
+
+__host__
+void geometryCacheStoreEulerNodes(GeometryCache* cache,
+    const ParticleEulerNodesUpdate* pEulerNodes)
+{
+    if(!cache->store)
+        return;
+
+    for(int i = 0; i < N_GPUS; i++)
+    {
+        const uint32_t counts[2] = {pEulerNodes->currEulerNodes[i], 
+            pEulerNodes->eulerFixedNodes[i]};
+        const size_t size = sizeof(counts) + counts[0]*(sizeof(size_t)+sizeof(uint32_t));
+        char* dst = geometryCacheAddSection(cache, GEOMETRY_CACHE_SECTION_EULER_NODES, i, size);
+        writeArray(&dst, counts, 2);
+        writeArray(&dst, pEulerNodes->eulerIndexesUpdate[i], counts[0]);
+        uint32_t* masks = (uint32_t*)dst;
+        for(unsigned int n = 0; n < counts[0]; n++)
+            masks[n] = pEulerNodes->eulerMaskArray[i][pEulerNodes->eulerIndexesUpdate[i][n]];
+    }
+}
+#endif
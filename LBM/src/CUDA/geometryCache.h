@@ -0,0 +1,183 @@
+/*
+*   @file geometryCache.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Cache of the built geometry in disk (GEOMETRY_CACHE): boundary
+*          conditions map and info of each GPU, IBM particles, Euler nodes and
+*          balanced z slabs.
+*          The file is named by a hash of the configuration and loaded with a
+*          single read, so repeated runs of the same case skip building them
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __GEOMETRY_CACHE_H
+#define __GEOMETRY_CACHE_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+#include "globalFunctions.h"
+#include "mpiBackend.h"
+#include "structs/nodeTypeMap.h"
+#include "structs/boundaryConditionsInfo.h"
+#include "IBM/structs/particle.h"
+#include "IBM/structs/particleEulerNodesUpdate.h"
+
+// Version of the file layout, change it when the layout is changed
+#define GEOMETRY_CACHE_VERSION (1)
+
+// Sections of the file
+#define GEOMETRY_CACHE_SECTION_PARTICLES (1)
+#define GEOMETRY_CACHE_SECTION_BC (2)
+#define GEOMETRY_CACHE_SECTION_EULER_NODES (3)
+#define GEOMETRY_CACHE_SECTION_DECOMP (4)
+
+
+/*
+*   Header of each section of the file. The content of the section follows
+*   it, padded to 8 bytes
+*/
+typedef struct geometryCacheSection {
+    uint32_t id;        // section define (GEOMETRY_CACHE_SECTION_*)
+    uint32_t gpu;       // GPU number of section
+    uint64_t size;      // size of section content, in bytes
+} GeometryCacheSection;
+
+
+/*
+*   Geometry cache, with the sections loaded from file or to save to it
+*/
+typedef struct geometryCache {
+    uint64_t hash;              // hash of the configuration
+    std::string filename;       // cache file
+    bool loaded;                // file with same hash was loaded
+    bool store;                 // sections must be stored and saved
+    std::vector<char> data;     // sections, as in file
+
+    geometryCache()
+    {
+        hash = 0;
+        loaded = false;
+        store = false;
+    }
+} GeometryCache;
+
+
+/*
+*   @brief Evaluates the hash of the configuration and loads the cache file
+*          with this hash, if it exists. Otherwise, the built geometry will
+*          be stored in the cache
+*   @param cache: cache to setup
+*   @return true if cache file was loaded, false otherwise
+*/
+__host__
+bool geometryCacheSetup(GeometryCache* cache);
+
+
+/*
+*   @brief Saves stored sections to cache file, if not loaded from it
+*   @param cache: cache to save
+*/
+__host__
+void geometryCacheSave(GeometryCache* cache);
+
+
+/*
+*   @brief Frees cache sections
+*   @param cache: cache to free
+*/
+__host__
+void geometryCacheFree(GeometryCache* cache);
+
+
+/*
+*   @brief Loads IBM particles from cache
+*   @param cache: geometry cache
+*   @param particles: particles to write to, its nodes are allocated
+*   @return true if particles were loaded, false otherwise
+*/
+__host__
+bool geometryCacheLoadParticles(GeometryCache* cache, Particle particles[NUM_PARTICLES]);
+
+
+/*
+*   @brief Stores IBM particles in cache
+*   @param cache: geometry cache
+*   @param particles: particles to store
+*/
+__host__
+void geometryCacheStoreParticles(GeometryCache* cache, const Particle particles[NUM_PARTICLES]);
+
+
+/*
+*   @brief Loads boundary conditions map and info of a GPU from cache
+*   @param cache: geometry cache
+*   @param gpuNumber: GPU number
+*   @param mapBCFull: full boundary conditions map of the GPU to write to
+*   @param bcInfo: boundary conditions info to setup, its indexes and links
+*                  are allocated
+*   @return true if map and info were loaded, false otherwise
+*/
+__host__
+bool geometryCacheLoadBC(GeometryCache* cache, const int gpuNumber,
+    NodeTypeMap* mapBCFull, BoundaryConditionsInfo* bcInfo);
+
+
+/*
+*   @brief Stores boundary conditions map and info of a GPU in cache
+*   @param cache: geometry cache
+*   @param gpuNumber: GPU number
+*   @param mapBCFull: full boundary conditions map of the GPU
+*   @param bcInfo: boundary conditions info of the GPU
+*/
+__host__
+void geometryCacheStoreBC(GeometryCache* cache, const int gpuNumber,
+    const NodeTypeMap* mapBCFull, const BoundaryConditionsInfo* bcInfo);
+
+
+/*
+*   @brief Loads the first plane of the z slab of each GPU from cache 
+*          (DECOMP_Z_BALANCE)
+*   @param cache: geometry cache
+*   @param zStart[N_GPUS+1]: first plane of each slab to write to
+*   @return true if slabs were loaded, false otherwise
+*/
+__host__
+bool geometryCacheLoadDecomp(GeometryCache* cache, int zStart[N_GPUS+1]);
+
+
+/*
+*   @brief Stores the first plane of the z slab of each GPU in cache
+*          (DECOMP_Z_BALANCE)
+*   @param cache: geometry cache
+*   @param zStart[N_GPUS+1]: first plane of each slab
+*/
+__host__
+void geometryCacheStoreDecomp(GeometryCache* cache, const int zStart[N_GPUS+1]);
+
+
+#if IBM_EULER_OPTIMIZATION
+/*
+*   @brief Loads Euler nodes to update of all GPUs from cache
+*   @param cache: geometry cache
+*   @param pEulerNodes: Euler nodes to initialize
+*   @param p: simulation particles, as stored
+*   @return true if Euler nodes were loaded, false otherwise
+*/
+__host__
+bool geometryCacheLoadEulerNodes(GeometryCache* cache,
+    ParticleEulerNodesUpdate* pEulerNodes, ParticleCenter p[NUM_PARTICLES]);
+
+
+/*
+*   @brief Stores Euler nodes to update of all GPUs in cache
+*   @param cache: geometry cache
+*   @param pEulerNodes: initialized Euler nodes
+*/
+__host__
+void geometryCacheStoreEulerNodes(GeometryCache* cache,
+    const ParticleEulerNodesUpdate* pEulerNodes);
+#endif
+
+#endif // !__GEOMETRY_CACHE_H
@@ -0,0 +1,534 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "geometryMesh.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <stdint.h>
+
+// Offset of the lines of voxelization, so they do not cross the mesh
+// exactly in its edges or vertices
+#define MESH_LINE_EPS (1.2345e-5)
+
+
+__host__
+void triangleMesh::updateBoundingBox()
+{
+    this->bbMin = dfloat3(1e30, 1e30, 1e30);
+    this->bbMax = dfloat3(-1e30, -1e30, -1e30);
+    for(const Triangle& t : this->tris){
+        for(const dfloat3* v : {&t.v0, &t.v1, &t.v2}){
+            this->bbMin.x = myMin(this->bbMin.x, v->x);
+            this->bbMin.y = myMin(this->bbMin.y, v->y);
+            this->bbMin.z = myMin(this->bbMin.z, v->z);
+            this->bbMax.x = myMax(this->bbMax.x, v->x);
+            this->bbMax.y = myMax(this->bbMax.y, v->y);
+            this->bbMax.z = myMax(this->bbMax.z, v->z);
+        }
+    }
+}
+
+
+/* ---------------------------------- LOAD ---------------------------------- */
+
+__host__
+bool meshLoadSTLBinary(std::ifstream& file, const size_t fileSize, TriangleMesh* mesh)
+{
+    char header[80];
+    uint32_t nTris = 0;
+    file.read(header, 80);
+    file.read((char*)&nTris, sizeof(uint32_t));
+    if(fileSize != 84 + (size_t)nTris*50)
+        return false;
+
+    mesh->tris.resize(nTris);
+    // normal (3 floats), vertices (9 floats) and attribute (2 bytes)
+    char buffer[50];
+    for(uint32_t i = 0; i < nTris; i++){
+        file.read(buffer, 50);
+        float v[9];
+        memcpy(v, buffer+12, sizeof(float)*9);
+        mesh->tris[i].v0 = dfloat3(v[0], v[1], v[2]);
+        mesh->tris[i].v1 = dfloat3(v[3], v[4], v[5]);
+        mesh->tris[i].v2 = dfloat3(v[6], v[7], v[8]);
+    }
+    return (bool)file;
+}
+
+
+__host__
+bool meshLoadSTLASCII(std::ifstream& file, TriangleMesh* mesh)
+{
+    std::string word;
+    dfloat3 v[3];
+    int nVertex = 0;
+    while(file >> word){
+        if(word != "vertex")
+            continue;
+        file >> v[nVertex].x >> v[nVertex].y >> v[nVertex].z;
+        nVertex++;
+        if(nVertex == 3){
+            mesh->tris.push_back({v[0], v[1], v[2]});
+            nVertex = 0;
+        }
+    }
+    return mesh->tris.size() > 0;
+}
+
+
+__host__
+bool meshLoadOBJ(std::ifstream& file, TriangleMesh* mesh)
+{
+    std::vector<dfloat3> vertices;
+    std::string line;
+    while(std::getline(file, line)){
+        std::istringstream ss(line);
+        std::string type;
+        ss >> type;
+        if(type == "v"){
+            dfloat3 v;
+            ss >> v.x >> v.y >> v.z;
+            vertices.push_back(v);
+        }
+        else if(type == "f"){
+            // Faces may be polygons (fan triangulated) with "v/vt/vn" indexes,
+            // negative indexes are relative to the last vertex
+            std::vector<long> idxs;
+            std::string token;
+            while(ss >> token){
+                const std::string idxStr = token.substr(0, token.find('/'));
+                char* end;
+                errno = 0;
+                long idx = strtol(idxStr.c_str(), &end, 10);
+                if(idxStr.empty() || *end != '\0' || errno != 0)
+                    return false;
+                idx = (idx < 0) ? (long)vertices.size()+idx : idx-1;
+                if(idx < 0 || idx >= (long)vertices.size())
+                    return false;
+                idxs.push_back(idx);
+            }
+            for(size_t i = 2; i < idxs.size(); i++)
+                mesh->tris.push_back({vertices[idxs[0]], vertices[idxs[i-1]], vertices[idxs[i]]});
+        }
+    }
+    return mesh->tris.size() > 0;
+}
+
+
+__host__
+bool meshLoad(const std::string filename, TriangleMesh* mesh)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if(!file.is_open()){
+        printf("Unable to open mesh file %s\n", filename.c_str());
+        fflush(stdout);
+        return false;
+    }
+    const size_t fileSize = file.tellg();
+    file.seekg(0);
+    mesh->tris.clear();
+
+    std::string ext = filename.substr(filename.find_last_of('.')+1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    bool loaded = false;
+    if(ext == "obj"){
+        loaded = meshLoadOBJ(file, mesh);
+    }
+    else if(ext == "stl"){
+        // Binary files may also start with "solid", so the size is checked first
+        loaded = meshLoadSTLBinary(file, fileSize, mesh);
+        if(!loaded){
+            mesh->tris.clear();
+            file.clear();
+            file.seekg(0);
+            loaded = meshLoadSTLASCII(file, mesh);
+        }
+    }
+
+    if(!loaded){
+        printf("Unable to read mesh file %s (STL or OBJ)\n", filename.c_str());
+        fflush(stdout);
+        return false;
+    }
+    mesh->updateBoundingBox();
+    return true;
+}
+
+
+__host__
+void meshTransform(TriangleMesh* mesh, const dfloat scale, const dfloat3 offset)
+{
+    #pragma omp parallel for
+    for(size_t i = 0; i < mesh->tris.size(); i++){
+        for(dfloat3* v : {&mesh->tris[i].v0, &mesh->tris[i].v1, &mesh->tris[i].v2}){
+            v->x = v->x*scale + offset.x;
+            v->y = v->y*scale + offset.y;
+            v->z = v->z*scale + offset.z;
+        }
+    }
+    mesh->updateBoundingBox();
+}
+/* -------------------------------------------------------------------------- */
+
+
+/* ----------------------------------- BVH ---------------------------------- */
+
+__host__
+void meshBVH::build(const TriangleMesh* mesh)
+{
+    this->mesh = mesh;
+    const size_t nTris = mesh->tris.size();
+    this->triIdx.resize(nTris);
+    this->nodes.clear();
+    this->nodes.reserve(2*(nTris/MESH_BVH_LEAF_SIZE+1));
+
+    std::vector<double> centroids(3*nTris);
+    #pragma omp parallel for
+    for(size_t i = 0; i < nTris; i++){
+        const Triangle& t = mesh->tris[i];
+        centroids[3*i+0] = ((double)t.v0.x + t.v1.x + t.v2.x)/3;
+        centroids[3*i+1] = ((double)t.v0.y + t.v1.y + t.v2.y)/3;
+        centroids[3*i+2] = ((double)t.v0.z + t.v1.z + t.v2.z)/3;
+        this->triIdx[i] = i;
+    }
+
+    // Root node
+    this->nodes.push_back(MeshBVHNode());
+    this->buildNode(0, 0, nTris, centroids);
+}
+
+
+__host__
+void meshBVH::buildNode(const unsigned int nodeIdx, const unsigned int first,
+    const unsigned int count, std::vector<double>& centroids)
+{
+    MeshBVHNode node;
+    for(int d = 0; d < 3; d++){
+        node.bbMin[d] = 1e30f;
+        node.bbMax[d] = -1e30f;
+    }
+    double cMin[3] = {1e30, 1e30, 1e30};
+    double cMax[3] = {-1e30, -1e30, -1e30};
+    for(unsigned int i = first; i < first+count; i++){
+        const unsigned int t = this->triIdx[i];
+        const Triangle& tri = this->mesh->tris[t];
+        for(const dfloat3* v : {&tri.v0, &tri.v1, &tri.v2}){
+            const float p[3] = {(float)v->x, (float)v->y, (float)v->z};
+            for(int d = 0; d < 3; d++){
+                node.bbMin[d] = myMin(node.bbMin[d], p[d]);
+                node.bbMax[d] = myMax(node.bbMax[d], p[d]);
+            }
+        }
+        for(int d = 0; d < 3; d++){
+            cMin[d] = myMin(cMin[d], centroids[3*t+d]);
+            cMax[d] = myMax(cMax[d], centroids[3*t+d]);
+        }
+    }
+
+    if(count <= MESH_BVH_LEAF_SIZE){
+        node.first = first;
+        node.count = count;
+        this->nodes[nodeIdx] = node;
+        return;
+    }
+
+    // Split in the median of centroids in the longest axis
+    int axis = 0;
+    for(int d = 1; d < 3; d++)
+        if(cMax[d]-cMin[d] > cMax[axis]-cMin[axis])
+            axis = d;
+    const unsigned int half = count/2;
+    std::nth_element(this->triIdx.begin()+first, this->triIdx.begin()+first+half,
+        this->triIdx.begin()+first+count, 
+        [&centroids, axis](const unsigned int a, const unsigned int b){
+            return centroids[3*a+axis] < centroids[3*b+axis];
+        });
+
+    // Children are consecutive, the vector may grow in recursion, 
+    // so only indexes are kept
+    const unsigned int left = this->nodes.size();
+    this->nodes.push_back(MeshBVHNode());
+    this->nodes.push_back(MeshBVHNode());
+    node.first = left;
+    node.count = 0;
+    this->nodes[nodeIdx] = node;
+
+    this->buildNode(left, first, half, centroids);
+    this->buildNode(left+1, first+half, count-half, centroids);
+}
+
+
+__host__
+void meshBVH::lineCrossingsX(const double y, const double z, std::vector<double>& xs) const
+{
+    if(this->nodes.size() == 0)
+        return;
+    unsigned int stack[64];
+    int nStack = 0;
+    stack[nStack++] = 0;
+
+    while(nStack > 0){
+        const MeshBVHNode& node = this->nodes[stack[--nStack]];
+        // The line crosses all x, so only y and z are checked
+        if(y < node.bbMin[1] || y > node.bbMax[1] || z < node.bbMin[2] || z > node.bbMax[2])
+            continue;
+        if(node.count == 0){
+            stack[nStack++] = node.first;
+            stack[nStack++] = node.first+1;
+            continue;
+        }
+        for(unsigned int i = node.first; i < node.first+node.count; i++){
+            const Triangle& t = this->mesh->tris[this->triIdx[i]];
+            // Edge functions of the triangle projected in yz plane
+            const double e0 = ((double)t.v1.y-t.v0.y)*(z-t.v0.z) - ((double)t.v1.z-t.v0.z)*(y-t.v0.y);
+            const double e1 = ((double)t.v2.y-t.v1.y)*(z-t.v1.z) - ((double)t.v2.z-t.v1.z)*(y-t.v1.y);
+            const double e2 = ((double)t.v0.y-t.v2.y)*(z-t.v2.z) - ((double)t.v0.z-t.v2.z)*(y-t.v2.y);
+            if(!((e0 >= 0 && e1 >= 0 && e2 >= 0) || (e0 <= 0 && e1 <= 0 && e2 <= 0)))
+                continue;
+            const double area = e0+e1+e2;
+            if(area == 0)
+                continue;
+            // Barycentric interpolation of x
+            xs.push_back((e1*t.v0.x + e2*t.v1.x + e0*t.v2.x)/area);
+        }
+    }
+}
+
+
+__host__
+double meshBVH::segmentHit(const double p[3], const double d[3]) const
+{
+    double tHit = INTERP_BB_Q_NONE;
+    if(this->nodes.size() == 0)
+        return tHit;
+    unsigned int stack[64];
+    int nStack = 0;
+    stack[nStack++] = 0;
+
+    while(nStack > 0){
+        const MeshBVHNode& node = this->nodes[stack[--nStack]];
+        // Slab test of segment with node box
+        double tMin = 0, tMax = (tHit >= 0) ? tHit : 1;
+        bool hitBox = true;
+        for(int a = 0; a < 3 && hitBox; a++){
+            if(d[a] == 0){
+                hitBox = (p[a] >= node.bbMin[a] && p[a] <= node.bbMax[a]);
+                continue;
+            }
+            double t0 = (node.bbMin[a]-p[a])/d[a];
+            double t1 = (node.bbMax[a]-p[a])/d[a];
+            if(t0 > t1)
+                std::swap(t0, t1);
+            tMin = myMax(tMin, t0);
+            tMax = myMin(tMax, t1);
+            hitBox = (tMin <= tMax);
+        }
+        if(!hitBox)
+            continue;
+        if(node.count == 0){
+            stack[nStack++] = node.first;
+            stack[nStack++] = node.first+1;
+            continue;
+        }
+        for(unsigned int i = node.first; i < node.first+node.count; i++){
+            // Moller-Trumbore
+            const Triangle& t = this->mesh->tris[this->triIdx[i]];
+            const double v0[3] = {t.v0.x, t.v0.y, t.v0.z};
+            const double e1[3] = {t.v1.x-v0[0], t.v1.y-v0[1], t.v1.z-v0[2]};
+            const double e2[3] = {t.v2.x-v0[0], t.v2.y-v0[1], t.v2.z-v0[2]};
+            const double h[3] = {d[1]*e2[2]-d[2]*e2[1], d[2]*e2[0]-d[0]*e2[2], d[0]*e2[1]-d[1]*e2[0]};
+            const double det = e1[0]*h[0] + e1[1]*h[1] + e1[2]*h[2];
+            if(fabs(det) < 1e-12)
+                continue;
+            const double invDet = 1/det;
+            const double s[3] = {p[0]-v0[0], p[1]-v0[1], p[2]-v0[2]};
+            const double u = invDet*(s[0]*h[0] + s[1]*h[1] + s[2]*h[2]);
+            if(u < 0 || u > 1)
+                continue;
+            const double qv[3] = {s[1]*e1[2]-s[2]*e1[1], s[2]*e1[0]-s[0]*e1[2], s[0]*e1[1]-s[1]*e1[0]};
+            const double v = invDet*(d[0]*qv[0] + d[1]*qv[1] + d[2]*qv[2]);
+            if(v < 0 || u+v > 1)
+                continue;
+            const double tSeg = invDet*(e2[0]*qv[0] + e2[1]*qv[1] + e2[2]*qv[2]);
+            if(tSeg >= 0 && tSeg <= 1 && (tHit < 0 || tSeg < tHit))
+                tHit = tSeg;
+        }
+    }
+    return tHit;
+}
+/* -------------------------------------------------------------------------- */
+
+
+/* ------------------------------- VOXELIZATION ----------------------------- */
+
+__host__
+char directionFromSigns(const int sx, const int sy, const int sz)
+{
+    // [x+1][y+1][z+1], wall in x<0 is west, y<0 south and z<0 back
+    const char dirs[3][3][3] = {
+        {{SOUTH_WEST_BACK, SOUTH_WEST, SOUTH_WEST_FRONT},
+         {WEST_BACK, WEST, WEST_FRONT},
+         {NORTH_WEST_BACK, NORTH_WEST, NORTH_WEST_FRONT}},
+        {{SOUTH_BACK, SOUTH, SOUTH_FRONT},
+         {BACK, NORTH, FRONT},
+         {NORTH_BACK, NORTH, NORTH_FRONT}},
+        {{SOUTH_EAST_BACK, SOUTH_EAST, SOUTH_EAST_FRONT},
+         {EAST_BACK, EAST, EAST_FRONT},
+         {NORTH_EAST_BACK, NORTH_EAST, NORTH_EAST_FRONT}}
+    };
+    if(sx == 0 && sy == 0 && sz == 0){
+        fprintf(stderr, "Wall direction of null vector\n"); fflush(stderr);
+        exit(-1);
+    }
+    return dirs[(sx > 0)-(sx < 0)+1][(sy > 0)-(sy < 0)+1][(sz > 0)-(sz < 0)+1];
+}
+
+
+__host__
+void meshVoxelize(const MeshBVH& bvh, NodeTypeMap* hMapBC, const int gpuNumber,
+    InterpBBWallDist* wallDist)
+{
+    #ifdef BC_SCHEME_INTERP_BOUNCE_BACK
+    const TriangleMesh* mesh = bvh.mesh;
+    const int xStart = decompOrigin(gpuNumber, 0);
+    const int yStart = decompOrigin(gpuNumber, 1);
+    const int zStart = decompOrigin(gpuNumber, 2);
+    // Nodes from -2 to N+1 in each direction, for the neighbours (and its 
+    // neighbours) of the GPU borders
+    std::vector<unsigned char> solid((size_t)(NX+4)*(NY+4)*(NZ+4), 0);
+    auto isSolid = [&solid](const int x, const int y, const int z){
+        return solid[(NX+4)*((size_t)(NY+4)*(z+2) + (y+2)) + (x+2)];
+    };
+
+    // Inside or outside by parity of crossings of lines in x. Periodic in 
+    // the whole domain, as the streaming
+    #pragma omp parallel for collapse(2) schedule(dynamic, 16)
+    for(int k = 0; k < NZ+4; k++){
+        for(int j = 0; j < NY+4; j++){
+            const int yDomain = (yStart-2+j+NY_TOTAL) % NY_TOTAL;
+            const int zDomain = (zStart-2+k+NZ_TOTAL) % NZ_TOTAL;
+            const double yLine = yDomain+0.5+MESH_LINE_EPS;
+            const double zLine = zDomain+0.5+0.7*MESH_LINE_EPS;
+            if(yLine < mesh->bbMin.y || yLine > mesh->bbMax.y 
+                || zLine < mesh->bbMin.z || zLine > mesh->bbMax.z)
+                continue;
+            std::vector<double> xs;
+            bvh.lineCrossingsX(yLine, zLine, xs);
+            std::sort(xs.begin(), xs.end());
+            for(int i = 0; i < NX+4; i++){
+                const int xDomain = (xStart-2+i+NX_TOTAL) % NX_TOTAL;
+                const size_t nCross = std::lower_bound(xs.begin(), xs.end(), 
+                    xDomain+0.5) - xs.begin();
+                solid[(NX+4)*((size_t)(NY+4)*k + j) + i] = (nCross % 2);
+            }
+        }
+    }
+
+    // Boundary nodes are used nodes with populations coming from solid
+    std::vector<unsigned char> isBoundary(NUMBER_LBM_NODES, 0);
+    #pragma omp parallel for collapse(2)
+    for(int z = 0; z < decompNZ(gpuNumber); z++){
+        for(int y = 0; y < NY; y++){
+            for(int x = 0; x < NX; x++){
+                NodeTypeMap& ntm = hMapBC[idxScalar(x, y, z)];
+                if(isSolid(x, y, z)){
+                    ntm.setIsUsed(false);
+                    ntm.setSchemeBC(BC_NULL);
+                    ntm.setSavePostCol(false);
+                    continue;
+                }
+                if(!ntm.getIsUsed())
+                    continue;
+                for(int i = 1; i < Q; i++){
+                    const int xAdj = x-velCx(i);
+                    const int yAdj = y-velCy(i);
+                    const int zAdj = z-velCz(i);
+                    if(isSolid(xAdj, yAdj, zAdj)){
+                        isBoundary[idxScalar(x, y, z)] = 1;
+                    }
+                    // Interpolation uses the post collision populations of 
+                    // the node opposite to the wall of boundary node
+                    else if(isSolid(xAdj-velCx(i), yAdj-velCy(i), zAdj-velCz(i))){
+                        ntm.setSavePostCol(true);
+                    }
+                }
+            }
+        }
+    }
+
+    wallDist->idxNodes.clear();
+    for(size_t idx = 0; idx < NUMBER_LBM_NODES; idx++)
+        if(isBoundary[idx])
+            wallDist->idxNodes.push_back(idx);
+    const size_t nBoundary = wallDist->idxNodes.size();
+    wallDist->q.assign(nBoundary*Q, INTERP_BB_Q_NONE);
+
+    // Wall distances of the unknown populations
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(size_t n = 0; n < nBoundary; n++){
+        const size_t idx = wallDist->idxNodes[n];
+        const int x = idx % NX;
+        const int y = (idx/NX) % NY;
+        const int z = idx/((size_t)NX*NY);
+        const double p[3] = {xStart+x+0.5, yStart+y+0.5, zStart+z+0.5};
+        int wall[3] = {0, 0, 0};
+        // Nearest solid neighbour, for walls with opposite links cancelling
+        int nearest = 0;
+
+        for(int i = 1; i < Q; i++){
+            if(!isSolid(x-velCx(i), y-velCy(i), z-velCz(i)))
+                continue;
+            // Link from node to the solid neighbour
+            const double d[3] = {(double)-velCx(i), (double)-velCy(i), (double)-velCz(i)};
+            double q = bvh.segmentHit(p, d);
+            // No crossing is a mismatch between voxelization and mesh 
+            // (e.g. mesh not closed), so the wall is assumed halfway
+            if(q < 0)
+                q = 0.5;
+            wallDist->q[n*Q+i] = myMax(q, 1e-6);
+            if(nearest == 0 || wallDist->q[n*Q+i] < wallDist->q[n*Q+nearest])
+                nearest = i;
+            wall[0] -= velCx(i);
+            wall[1] -= velCy(i);
+            wall[2] -= velCz(i);
+        }
+
+        NodeTypeMap& ntm = hMapBC[idx];
+        ntm.map &= ~SPC_INTERP_BB_BITS;
+        ntm.setSchemeBC(BC_SCHEME_INTERP_BOUNCE_BACK);
+        // Solid links in opposite directions (thin walls, gaps of one node)
+        // sum to no direction, so the nearest wall gives it
+        if(wall[0] == 0 && wall[1] == 0 && wall[2] == 0){
+            wall[0] = -velCx(nearest);
+            wall[1] = -velCy(nearest);
+            wall[2] = -velCz(nearest);
+        }
+        ntm.setDirection(directionFromSigns(wall[0], wall[1], wall[2]));
+    }
+    #endif
+}
+/* -------------------------------------------------------------------------- */
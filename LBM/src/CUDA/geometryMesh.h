@@ -0,0 +1,156 @@
+/*
+*   @file geometryMesh.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Boundary conditions map from triangle meshes (STL/OBJ), voxelized
+*          in host with a bounding volume hierarchy (BVH) (GEOMETRY_MESH)
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __GEOMETRY_MESH_H
+#define __GEOMETRY_MESH_H
+
+#include <vector>
+#include <string>
+
+#include "globalFunctions.h"
+#include "structs/nodeTypeMap.h"
+#include "boundaryConditionsSchemes/interpolatedBounceBack.h"
+
+#if GEOMETRY_MESH && !(COMP_INTERP_BOUNCE_BACK || COMP_ALL_BC)
+#error "GEOMETRY_MESH requires interpolated bounce back (COMP_INTERP_BOUNCE_BACK)"
+#endif
+
+// Maximum number of triangles in a leaf of the BVH
+#define MESH_BVH_LEAF_SIZE (4)
+
+
+/*
+*   Struct for triangle of mesh
+*/
+typedef struct triangle {
+    dfloat3 v0;
+    dfloat3 v1;
+    dfloat3 v2;
+} Triangle;
+
+
+/*
+*   Struct for triangle mesh, in lattice units after meshTransform
+*/
+typedef struct triangleMesh {
+    std::vector<Triangle> tris;     // triangles
+    dfloat3 bbMin;                  // bounding box minimum
+    dfloat3 bbMax;                  // bounding box maximum
+
+    /*
+    *   @brief Updates mesh bounding box
+    */
+    __host__
+    void updateBoundingBox();
+} TriangleMesh;
+
+
+/*
+*   Node of BVH. Internal nodes have the children in first and first+1,
+*   leaves have count triangles from first in BVH triangles indexes
+*/
+typedef struct meshBVHNode {
+    float bbMin[3];
+    float bbMax[3];
+    unsigned int first;
+    unsigned int count;     // 0 for internal nodes
+} MeshBVHNode;
+
+
+/*
+*   Bounding volume hierarchy of triangle mesh, for ray queries
+*/
+typedef struct meshBVH {
+    const TriangleMesh* mesh;
+    std::vector<MeshBVHNode> nodes;
+    std::vector<unsigned int> triIdx;  // triangles indexes ordered by leaves
+
+    /*
+    *   @brief Builds BVH of mesh, splitting in the median of the longest axis
+    *   @param mesh: mesh to build BVH for (must be alive while BVH is used)
+    */
+    __host__
+    void build(const TriangleMesh* mesh);
+
+    /*
+    *   @brief Gets all crossings of the line parallel to x with mesh
+    *   @param y: line y value
+    *   @param z: line z value
+    *   @param xs: vector to write the x of crossings to (not sorted)
+    */
+    __host__
+    void lineCrossingsX(const double y, const double z, std::vector<double>& xs) const;
+
+    /*
+    *   @brief Gets the first intersection of segment with mesh
+    *   @param p: segment start
+    *   @param d: segment vector (end is p+d)
+    *   @return segment parameter in [0, 1] of intersection, INTERP_BB_Q_NONE if
+    *           there is none
+    */
+    __host__
+    double segmentHit(const double p[3], const double d[3]) const;
+
+private:
+    __host__
+    void buildNode(const unsigned int nodeIdx, const unsigned int first,
+        const unsigned int count, std::vector<double>& centroids);
+} MeshBVH;
+
+
+/*
+*   @brief Loads triangle mesh from STL (ASCII or binary) or OBJ file,
+*          chosen by file extension
+*   @param filename: mesh file
+*   @param mesh: mesh to write to
+*   @return true if loaded, false otherwise
+*/
+__host__
+bool meshLoad(const std::string filename, TriangleMesh* mesh);
+
+
+/*
+*   @brief Transforms mesh coordinates to lattice units,
+*          p_lattice = p_mesh*scale + offset
+*   @param mesh: mesh to transform
+*   @param scale: scale to apply
+*   @param offset: offset to apply after scaling
+*/
+__host__
+void meshTransform(TriangleMesh* mesh, const dfloat scale, const dfloat3 offset);
+
+
+/*
+*   @brief Voxelizes mesh over the boundary conditions map of a GPU. Nodes
+*          inside mesh are set as not used, fluid nodes with links cut by the
+*          mesh as interpolated bounce back (direction to the wall) and its
+*          wall distances are evaluated. Nodes adjacent to the boundary nodes
+*          save post collision populations
+*   @param bvh: BVH of the mesh
+*   @param hMapBC: full boundary conditions map of the GPU (host)
+*   @param gpuNumber: GPU number
+*   @param wallDist: wall distances of boundary nodes to write to
+*/
+__host__
+void meshVoxelize(const MeshBVH& bvh, NodeTypeMap* hMapBC, const int gpuNumber,
+    InterpBBWallDist* wallDist);
+
+
+/*
+*   @brief Direction define of the vector to the wall (NORTH, SOUTH_WEST, etc.)
+*   @param sx: sign of vector x component (-1, 0 or 1)
+*   @param sy: sign of vector y component (-1, 0 or 1)
+*   @param sz: sign of vector z component (-1, 0 or 1)
+*   @return direction define. The null vector has no direction, so it
+*           exits
+*/
+__host__
+char directionFromSigns(const int sx, const int sy, const int sz);
+
+#endif // !__GEOMETRY_MESH_H
@@ -38,6 +38,18 @@
 #include "IBM/ibmVar.h"
 #include "structs/globalStructs.h"
 
+// Device of each GPU (partition), set by partitionDevicesSetup
+extern unsigned int GPUS_TO_USE[N_GPUS];
+
+#if DECOMP_Z_BALANCE
+// First plane of the z slab of each GPU in the whole domain, the last value
+// is NZ_TOTAL. In host and in constant memory of each device
+extern int decompZStart[N_GPUS+1];
+extern __constant__ int gpuDecompZStart[N_GPUS+1];
+// Planes of the z slab of the device
+extern __constant__ int gpuDecompNZ;
+#endif
+
 /*
 *   @brief Evaluate the population of equilibrium
 *   @param rhow: product between density and population's weight
@@ -131,9 +143,128 @@ size_t __forceinline__ idxScalarWBorder(unsigned int x, unsigned int y, unsigned
 
 
 
+/*
+*   @brief Evaluate the position of the element of a 3D matrix of the whole 
+*          grid ([NX_TOTAL][NY_TOTAL][NZ_TOTAL]) in a 1D array, as the 
+*          macroscopics in host
+*   @param x: x axis value in the whole domain
+*   @param y: y axis value in the whole domain
+*   @param z: z axis value in the whole domain
+*   @return element index
+*/
+__host__ __device__
+size_t __forceinline__ idxScalarGlobal(unsigned int x, unsigned int y, unsigned int z)
+{
+    return NX_TOTAL * ((size_t)NY_TOTAL*z + y) + x;
+}
+
+
+/*
+*   @brief Partition of the GPU in axis (GPUs are numbered with x first)
+*   @param gpuNumber: GPU number
+*   @param axis: 0 for x, 1 for y, 2 for z
+*   @return partition number in axis
+*/
+__host__ __device__
+int __forceinline__ decompCoord(const int gpuNumber, const int axis)
+{
+    return (axis == 0) ? (gpuNumber % DECOMP_PX) : 
+        ((axis == 1) ? ((gpuNumber / DECOMP_PX) % DECOMP_PY) : (gpuNumber / (DECOMP_PX*DECOMP_PY)));
+}
+
+
+/*
+*   @brief First node of the GPU in axis, in the whole domain
+*   @param gpuNumber: GPU number
+*   @param axis: 0 for x, 1 for y, 2 for z
+*   @return node coordinate
+*/
+__host__ __device__
+int __forceinline__ decompOrigin(const int gpuNumber, const int axis)
+{
+    #if DECOMP_Z_BALANCE
+    if(axis == 2){
+        #ifdef __CUDA_ARCH__
+        return gpuDecompZStart[gpuNumber];
+        #else
+        return decompZStart[gpuNumber];
+        #endif
+    }
+    #endif
+    return decompCoord(gpuNumber, axis) * ((axis == 0) ? NX : ((axis == 1) ? NY : NZ));
+}
+
+
+/*
+*   @brief Planes in z of the partition of the GPU. It is NZ, unless the z 
+*          slabs are balanced (DECOMP_Z_BALANCE)
+*   @param gpuNumber: GPU number
+*   @return number of planes
+*/
+__host__ __device__
+int __forceinline__ decompNZ(const int gpuNumber)
+{
+    #if DECOMP_Z_BALANCE
+    return decompOrigin(gpuNumber+1, 2) - decompOrigin(gpuNumber, 2);
+    #else
+    return NZ;
+    #endif
+}
+
+
+/*
+*   @brief Planes in z of the partition of current device, the ones updated
+*          by the kernels. It is NZ, unless the z slabs are balanced 
+*          (DECOMP_Z_BALANCE)
+*   @return number of planes
+*/
+__device__
+int __forceinline__ decompLocalNZ()
+{
+    #if DECOMP_Z_BALANCE
+    return gpuDecompNZ;
+    #else
+    return NZ;
+    #endif
+}
+
+
+/*
+*   @brief GPU with the partition shifted from the one of the GPU (periodic)
+*   @param gpuNumber: GPU number
+*   @param sx, sy, sz: shift of the partition in x, y and z
+*   @return GPU number of the shifted partition
+*/
+__host__ __device__
+int __forceinline__ decompShift(const int gpuNumber, const int sx, const int sy, const int sz)
+{
+    const int px = (decompCoord(gpuNumber, 0) + sx % DECOMP_PX + DECOMP_PX) % DECOMP_PX;
+    const int py = (decompCoord(gpuNumber, 1) + sy % DECOMP_PY + DECOMP_PY) % DECOMP_PY;
+    const int pz = (decompCoord(gpuNumber, 2) + sz % DECOMP_PZ + DECOMP_PZ) % DECOMP_PZ;
+    return px + DECOMP_PX*(py + DECOMP_PY*pz);
+}
+
+
+/*
+*   @brief Evaluate the position of a tile of nodes ([N_TILES_X][NY][NZ]) 
+*         in a 1D array
+*   @param tx: tile number in x (x/N_THREADS)
+*   @param y: y axis value
+*   @param z: z axis value
+*   @return tile index
+*/
+__host__ __device__
+size_t __forceinline__ idxTile(unsigned int tx, unsigned int y, unsigned int z)
+{
+    return N_TILES_X * ((size_t)NY*z + y) + tx;
+}
+
+
 /*
 *   @brief Evaluate the element of the population of a 4D matrix 
-*          ([NX][NY][NZ+1][Q]) in a 1D array
+*          ([NX_POP][NY_POP][NZ_POP][Q]) in a 1D array. With POP_HALO_LAYOUT,
+*          -1 is a valid coordinate (halo node), since the unsigned 
+*          overflow is undone by the halo offset
 *   @param x: x axis value
 *   @param y: y axis value
 *   @param z: z axis value
@@ -143,7 +274,7 @@ size_t __forceinline__ idxScalarWBorder(unsigned int x, unsigned int y, unsigned
 __host__ __device__
 size_t __forceinline__ idxPop(const unsigned int x, const unsigned int y, const unsigned int z, const unsigned int d)
 {
-    return NX*(NY*((size_t)(NZ+1)*d + z) + y) + x;
+    return NX_POP*(NY_POP*((size_t)NZ_POP*d + (z+POP_HALO)) + (y+POP_HALO)) + (x+POP_HALO);
 }
 
 
@@ -0,0 +1,164 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "haloOverlap.h"
+
+
+__host__
+void haloOverlapSetup(HaloOverlap* overlap)
+{
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        // Blocking streams, so the following kernels in default stream 
+        // wait for them
+        checkCudaErrors(cudaStreamCreate(&(overlap->streamBorder[i])));
+        checkCudaErrors(cudaStreamCreate(&(overlap->streamInterior[i])));
+        checkCudaErrors(cudaEventCreateWithFlags(&(overlap->borderDone[i]), 
+            cudaEventDisableTiming));
+    }
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaEventCreate(&(overlap->start)));
+    checkCudaErrors(cudaEventCreate(&(overlap->transferStart)));
+    checkCudaErrors(cudaEventCreate(&(overlap->transferDone)));
+    checkCudaErrors(cudaEventCreate(&(overlap->interiorDone)));
+    overlap->timeTransfer = 0;
+    overlap->timeHidden = 0;
+}
+
+
+__host__
+void haloOverlapFree(HaloOverlap* overlap)
+{
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaStreamDestroy(overlap->streamBorder[i]));
+        checkCudaErrors(cudaStreamDestroy(overlap->streamInterior[i]));
+        checkCudaErrors(cudaEventDestroy(overlap->borderDone[i]));
+    }
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaEventDestroy(overlap->start));
+    checkCudaErrors(cudaEventDestroy(overlap->transferStart));
+    checkCudaErrors(cudaEventDestroy(overlap->transferDone));
+    checkCudaErrors(cudaEventDestroy(overlap->interiorDone));
+}
+
+
+__host__
+void haloOverlapStep(HaloOverlap* overlap,
+    HaloBuffers* halo,
+    const DomainDecomposition* decomp,
+    Populations* pop,
+    Macroscopics* macr,
+    const dim3 grid,
+    const dim3 threads,
+    const dim3 gridTransfer,
+    const dim3 threadsTransfer,
+    const bool save,
+    const int step)
+{
+    // One plane for each border (z=0 and z=NZ-1) and the planes between them.
+    // With pencils or blocks, the faces in x and y cross all planes, so all 
+    // of them are borders and there is no interior to overlap. With balanced
+    // slabs, the last plane and the interior ones are of each GPU
+    dim3 gridPlane = grid;
+    gridPlane.z = DECOMP_Z_SLABS ? 1 : NZ;
+    dim3 gridInterior = grid;
+    const int nzFirst = decompNZ(gpuBegin());
+    const bool interiorFirst = DECOMP_Z_SLABS && nzFirst > 2;
+
+    // Border planes first, they are the only ones streaming to the ghost
+    // plane (or to the opposite face, with packed halo) read by the transfer
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        cudaStream_t stream = overlap->streamBorder[i];
+        if(i == gpuBegin())
+            checkCudaErrors(cudaEventRecord(overlap->start, stream));
+        macrCollisionStream(&pop[i], macr[i], gridPlane, threads, stream, 
+            save, step, 0);
+        if(DECOMP_Z_SLABS && decompNZ(i) > 1)
+            macrCollisionStream(&pop[i], macr[i], gridPlane, threads, stream, 
+                save, step, decompNZ(i)-1);
+        checkCudaErrors(cudaEventRecord(overlap->borderDone[i], stream));
+        getLastCudaError("LBM border kernel error\n");
+    }
+
+    // Interior planes. They write other populations of the border planes 
+    // than the transfer (the ones not crossing the GPUs), so both run 
+    // concurrently
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        gridInterior.z = (DECOMP_Z_SLABS && decompNZ(i) > 2) ? decompNZ(i)-2 : 0;
+        if(gridInterior.z == 0)
+            continue;
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        cudaStream_t stream = overlap->streamInterior[i];
+        macrCollisionStream(&pop[i], macr[i], gridInterior, threads, stream, 
+            save, step, 1);
+        if(i == gpuBegin())
+            checkCudaErrors(cudaEventRecord(overlap->interiorDone, stream));
+        getLastCudaError("LBM interior kernel error\n");
+    }
+
+    #if POP_PACKED_HALO
+    // Pack after the border planes of each GPU are done, in same stream, and
+    // unpack after the copies from all neighbor GPUs
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaEventRecord(overlap->transferStart, overlap->streamBorder[gpuBegin()]));
+    haloExchange(halo, decomp, pop, overlap->streamBorder);
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaEventRecord(overlap->transferDone, overlap->streamBorder[gpuBegin()]));
+    #else
+    // Transfer between each GPU and the next one, as soon as the border 
+    // planes of both are done
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        const int nxt = (i+1)%N_GPUS;
+        cudaStream_t stream = overlap->streamBorder[i];
+        checkCudaErrors(cudaStreamWaitEvent(stream, overlap->borderDone[nxt], 0));
+        if(i == gpuBegin())
+            checkCudaErrors(cudaEventRecord(overlap->transferStart, stream));
+        gpuPopulationsTransfer<<<gridTransfer, threadsTransfer, 0, stream>>>
+            (pop[i].popAux, pop[nxt].popAux);
+        if(i == gpuBegin())
+            checkCudaErrors(cudaEventRecord(overlap->transferDone, stream));
+        getLastCudaError("Mem transfer kernel error\n");
+    }
+    #endif
+    if(!interiorFirst){
+        // No interior, the transfer is not hidden
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+        checkCudaErrors(cudaEventRecord(overlap->interiorDone, overlap->streamBorder[gpuBegin()]));
+    }
+}
+
+
+__host__
+void haloOverlapUpdateTime(HaloOverlap* overlap)
+{
+    float tTransferStart = 0, tTransferDone = 0, tInteriorDone = 0;
+    checkCudaErrors(cudaEventElapsedTime(&tTransferStart, overlap->start, overlap->transferStart));
+    checkCudaErrors(cudaEventElapsedTime(&tTransferDone, overlap->start, overlap->transferDone));
+    checkCudaErrors(cudaEventElapsedTime(&tInteriorDone, overlap->start, overlap->interiorDone));
+    const double tTransfer = tTransferDone - tTransferStart;
+    // Part of transfer before the interior is done
+    const double tHidden = myMin((double)tTransferDone, (double)tInteriorDone) - tTransferStart;
+    overlap->timeTransfer += tTransfer;
+    overlap->timeHidden += myMax(myMin(tHidden, tTransfer), 0.0);
+}
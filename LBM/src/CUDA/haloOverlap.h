@@ -0,0 +1,106 @@
+/*
+*   @file haloOverlap.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Overlap of the transfer of populations between GPUs with the update
+*          of the interior planes (HALO_OVERLAP). The border planes in z of
+*          each GPU are updated first in one stream and transfered as soon as
+*          the borders of the adjacent GPU are done, while the interior
+*          planes are updated in another stream. Only z slabs have interior
+*          planes, with pencils or blocks all planes are borders
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __HALO_OVERLAP_H
+#define __HALO_OVERLAP_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "var.h"
+#include "errorDef.h"
+#include "lbm.h"
+#include "haloPack.h"
+#include "structs/populations.h"
+#include "structs/macroscopics.h"
+
+#if HALO_OVERLAP && POP_HALO_LAYOUT
+#error "HALO_OVERLAP can not be used with POP_HALO_LAYOUT"
+#endif
+
+
+/*
+*   Streams and events of the overlap, with the time of the transfer hidden
+*   by the interior update (first GPU of process)
+*/
+typedef struct haloOverlap {
+    cudaStream_t streamBorder[N_GPUS];      // border planes and transfer
+    cudaStream_t streamInterior[N_GPUS];    // interior planes
+    cudaEvent_t borderDone[N_GPUS];         // border planes updated
+    cudaEvent_t start;                      // events of first GPU of process
+    cudaEvent_t transferStart;
+    cudaEvent_t transferDone;
+    cudaEvent_t interiorDone;
+    double timeTransfer;                    // total time of transfer, in ms
+    double timeHidden;                      // total time of transfer
+                                            // concurrent with interior, in ms
+} HaloOverlap;
+
+
+/*
+*   @brief Creates streams and events of the overlap
+*   @param overlap: overlap to setup
+*/
+__host__
+void haloOverlapSetup(HaloOverlap* overlap);
+
+
+/*
+*   @brief Destroys streams and events of the overlap
+*   @param overlap: overlap to free
+*/
+__host__
+void haloOverlapFree(HaloOverlap* overlap);
+
+
+/*
+*   @brief Updates macroscopics, collides and streams all GPUs and transfers
+*          the populations between them, with the transfer overlapped with
+*          the interior update. Asynchronous, the devices must be
+*          synchronized before the boundary conditions
+*   @param overlap: overlap streams and events
+*   @param halo: packed buffers of each GPU (POP_PACKED_HALO)
+*   @param decomp: domain decomposition (POP_PACKED_HALO)
+*   @param pop: populations of each GPU
+*   @param macr: macroscopics of each GPU
+*   @param grid: grid of gpuMacrCollisionStream (all planes)
+*   @param threads: threads of gpuMacrCollisionStream
+*   @param gridTransfer: grid of gpuPopulationsTransfer
+*   @param threadsTransfer: threads of gpuPopulationsTransfer
+*   @param save: save macroscopics
+*   @param step: simulation step
+*/
+__host__
+void haloOverlapStep(HaloOverlap* overlap,
+    HaloBuffers* halo,
+    const DomainDecomposition* decomp,
+    Populations* pop,
+    Macroscopics* macr,
+    const dim3 grid,
+    const dim3 threads,
+    const dim3 gridTransfer,
+    const dim3 threadsTransfer,
+    const bool save,
+    const int step);
+
+
+/*
+*   @brief Adds the time of the last transfer and the part of it concurrent
+*          with the interior update. Must be called after the devices are
+*          synchronized
+*   @param overlap: overlap to update
+*/
+__host__
+void haloOverlapUpdateTime(HaloOverlap* overlap);
+
+#endif // !__HALO_OVERLAP_H
@@ -0,0 +1,259 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "haloPack.h"
+
+
+__host__
+void haloBuffersAllocation(HaloBuffers* halo, const DomainDecomposition* decomp)
+{
+    // One region for all links, to send and to receive
+    dfloat* send = (dfloat*)simMalloc(sizeof(dfloat)*decomp->totalCount, IN_VIRTUAL);
+    dfloat* recv = (dfloat*)simMalloc(sizeof(dfloat)*decomp->totalCount, IN_VIRTUAL);
+    size_t offset = 0;
+    for(int l = 0; l < decomp->nLinks; l++){
+        halo->send[l] = send + offset;
+        halo->recv[l] = recv + offset;
+        offset += decomp->links[l].count;
+    }
+    #if MPI_BACKEND && !MPI_CUDA_AWARE
+    send = (dfloat*)simMalloc(sizeof(dfloat)*decomp->totalCount, IN_HOST);
+    recv = (dfloat*)simMalloc(sizeof(dfloat)*decomp->totalCount, IN_HOST);
+    for(int l = 0; l < decomp->nLinks; l++){
+        halo->hostSend[l] = send + (halo->send[l] - halo->send[0]);
+        halo->hostRecv[l] = recv + (halo->recv[l] - halo->recv[0]);
+    }
+    #endif
+    checkCudaErrors(cudaEventCreateWithFlags(&(halo->copyDone), cudaEventDisableTiming));
+}
+
+
+__host__
+void haloBuffersFree(HaloBuffers* halo)
+{
+    simFree(halo->send[0], IN_VIRTUAL);
+    simFree(halo->recv[0], IN_VIRTUAL);
+    #if MPI_BACKEND && !MPI_CUDA_AWARE
+    simFree(halo->hostSend[0], IN_HOST);
+    simFree(halo->hostRecv[0], IN_HOST);
+    #endif
+    checkCudaErrors(cudaEventDestroy(halo->copyDone));
+    for(int l = 0; l < DECOMP_N_DIRS; l++){
+        halo->send[l] = nullptr;
+        halo->recv[l] = nullptr;
+        #if MPI_BACKEND
+        halo->hostSend[l] = nullptr;
+        halo->hostRecv[l] = nullptr;
+        #endif
+    }
+}
+
+
+/*
+*   @brief Number of values of a segment
+*   @param seg: segment of link
+*   @return nodes in segment box
+*/
+__host__ __device__ __forceinline__
+size_t haloSegmentCount(const HaloSegment& seg)
+{
+    return (size_t)(seg.end[0]-seg.start[0]) * (seg.end[1]-seg.start[1])
+        * (seg.end[2]-seg.start[2]);
+}
+
+
+/*
+*   @brief Population index of a value of a segment
+*   @param seg: segment of link
+*   @param k: value index in segment
+*   @return population index (idxPop)
+*/
+__device__ __forceinline__
+size_t haloPopIndex(const HaloSegment& seg, const size_t k)
+{
+    const size_t dx = seg.end[0]-seg.start[0];
+    const size_t dy = seg.end[1]-seg.start[1];
+    return idxPop(seg.start[0] + k % dx, seg.start[1] + (k/dx) % dy, 
+        seg.start[2] + k/(dx*dy), seg.pop);
+}
+
+
+/*
+*   @brief Grid of pack and unpack kernels of a link, one row of blocks (y)
+*          for each segment, sized for the largest one
+*   @param link: link to pack or unpack
+*   @return grid of kernels
+*/
+__host__
+static dim3 haloLinkGrid(const HaloLink& link)
+{
+    size_t maxCount = 0;
+    for(int s = 0; s < link.nSegments; s++){
+        const size_t count = haloSegmentCount(link.segments[s]);
+        if(count > maxCount)
+            maxCount = count;
+    }
+    return dim3((unsigned int)((maxCount+HALO_PACK_THREADS-1)/HALO_PACK_THREADS), 
+        link.nSegments, 1);
+}
+
+
+__global__
+void gpuHaloPack(
+    const dfloat* const popAux,
+    dfloat* const buffer,
+    const HaloLink link)
+{
+    const HaloSegment& seg = link.segments[blockIdx.y];
+    const size_t k = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(k >= haloSegmentCount(seg))
+        return;
+
+    buffer[seg.offset + k] = popAux[haloPopIndex(seg, k)];
+}
+
+
+__global__
+void gpuHaloUnpack(
+    dfloat* const popAux,
+    const dfloat* const buffer,
+    const HaloLink link)
+{
+    const HaloSegment& seg = link.segments[blockIdx.y];
+    const size_t k = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(k >= haloSegmentCount(seg))
+        return;
+
+    popAux[haloPopIndex(seg, k)] = buffer[seg.offset + k];
+}
+
+
+#if MPI_BACKEND
+/*
+*   @brief Exchanges the buffers of the GPU of the process with the neighbor
+*          ranks. The receives are posted first and the sends after the 
+*          buffers are packed, each message tagged by its link
+*   @param halo: buffers of each GPU
+*   @param decomp: domain decomposition
+*   @param pop: populations of each GPU
+*   @param streams: stream of each GPU (nullptr for default stream)
+*/
+__host__
+static void haloExchangeMPI(HaloBuffers* halo, const DomainDecomposition* decomp, 
+    Populations* pop, cudaStream_t* streams)
+{
+    const int i = gpuBegin();
+    HaloBuffers* h = &halo[i];
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+    cudaStream_t stream = (streams != nullptr) ? streams[i] : 0;
+    MPI_Request requests[2*DECOMP_N_DIRS];
+
+    // Receives from the neighbor with opposite of link shift
+    for(int l = 0; l < decomp->nLinks; l++){
+        const HaloLink& link = decomp->links[l];
+        const int src = decompShift(i, -link.shift[0], -link.shift[1], -link.shift[2]);
+        dfloat* recv = MPI_CUDA_AWARE ? h->recv[l] : h->hostRecv[l];
+        checkMPIErrors(MPI_Irecv(recv, (int)link.count, MPI_DFLOAT, src, l, 
+            MPI_COMM_WORLD, &requests[l]));
+    }
+
+    for(int l = 0; l < decomp->nLinks; l++){
+        const HaloLink link = haloLinkGPU(&(decomp->links[l]), i);
+        const dim3 nBlocks = haloLinkGrid(link);
+        gpuHaloPack<<<nBlocks, HALO_PACK_THREADS, 0, stream>>>
+            (pop[i].popAux, h->send[l], link);
+        getLastCudaError("Halo pack kernel error\n");
+        if(!MPI_CUDA_AWARE)
+            checkCudaErrors(cudaMemcpyAsync(h->hostSend[l], h->send[l], 
+                sizeof(dfloat)*link.count, cudaMemcpyDeviceToHost, stream));
+    }
+    checkCudaErrors(cudaStreamSynchronize(stream));
+
+    // Sends to the neighbor with link shift
+    for(int l = 0; l < decomp->nLinks; l++){
+        const HaloLink& link = decomp->links[l];
+        const int dst = decompShift(i, link.shift[0], link.shift[1], link.shift[2]);
+        dfloat* send = MPI_CUDA_AWARE ? h->send[l] : h->hostSend[l];
+        checkMPIErrors(MPI_Isend(send, (int)link.count, MPI_DFLOAT, dst, l, 
+            MPI_COMM_WORLD, &requests[decomp->nLinks+l]));
+    }
+    checkMPIErrors(MPI_Waitall(2*decomp->nLinks, requests, MPI_STATUSES_IGNORE));
+
+    for(int l = 0; l < decomp->nLinks; l++){
+        const HaloLink link = haloLinkGPU(&(decomp->links[l]), i);
+        const dim3 nBlocks = haloLinkGrid(link);
+        if(!MPI_CUDA_AWARE)
+            checkCudaErrors(cudaMemcpyAsync(h->recv[l], h->hostRecv[l], 
+                sizeof(dfloat)*link.count, cudaMemcpyHostToDevice, stream));
+        gpuHaloUnpack<<<nBlocks, HALO_PACK_THREADS, 0, stream>>>
+            (pop[i].popAux, h->recv[l], link);
+        getLastCudaError("Halo unpack kernel error\n");
+    }
+}
+#endif
+
+
+__host__
+void haloExchange(HaloBuffers* halo, const DomainDecomposition* decomp, 
+    Populations* pop, cudaStream_t* streams)
+{
+    // With one GPU, the populations crossing the partition are already 
+    // streamed to the opposite side
+    if(N_GPUS <= 1)
+        return;
+
+    #if MPI_BACKEND
+    haloExchangeMPI(halo, decomp, pop, streams);
+    #else
+    // Pack and copy to the neighbor GPUs. The copy is peer to peer if the
+    // devices have access to each other, otherwise staged in host
+    for(int i = 0; i < N_GPUS; i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        cudaStream_t stream = (streams != nullptr) ? streams[i] : 0;
+        for(int l = 0; l < decomp->nLinks; l++){
+            const HaloLink link = haloLinkGPU(&(decomp->links[l]), i);
+            const int dst = decompShift(i, link.shift[0], link.shift[1], link.shift[2]);
+            const dim3 nBlocks = haloLinkGrid(link);
+            gpuHaloPack<<<nBlocks, HALO_PACK_THREADS, 0, stream>>>
+                (pop[i].popAux, halo[i].send[l], link);
+            getLastCudaError("Halo pack kernel error\n");
+            checkCudaErrors(cudaMemcpyPeerAsync(halo[dst].recv[l], GPUS_TO_USE[dst], 
+                halo[i].send[l], GPUS_TO_USE[i], sizeof(dfloat)*link.count, stream));
+        }
+        checkCudaErrors(cudaEventRecord(halo[i].copyDone, stream));
+    }
+
+    // Unpack after the neighbor GPUs copied to this one
+    for(int i = 0; i < N_GPUS; i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        cudaStream_t stream = (streams != nullptr) ? streams[i] : 0;
+        for(int l = 0; l < decomp->nLinks; l++){
+            const HaloLink link = haloLinkGPU(&(decomp->links[l]), i);
+            const int src = decompShift(i, -link.shift[0], -link.shift[1], -link.shift[2]);
+            const dim3 nBlocks = haloLinkGrid(link);
+            checkCudaErrors(cudaStreamWaitEvent(stream, halo[src].copyDone, 0));
+            gpuHaloUnpack<<<nBlocks, HALO_PACK_THREADS, 0, stream>>>
+                (pop[i].popAux, halo[i].recv[l], link);
+            getLastCudaError("Halo unpack kernel error\n");
+        }
+    }
+    #endif
+}
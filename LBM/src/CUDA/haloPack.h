@@ -0,0 +1,132 @@
+/*
+*   @file haloPack.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Transfer of populations between GPUs in packed buffers
+*          (POP_PACKED_HALO). The populations leaving a GPU are streamed to
+*          the opposite side of its partition (periodic in GPU), packed in 
+*          contiguous buffers, one for each link of the domain decomposition,
+*          copied to the neighbor GPUs (peer to peer or staged in host by the
+*          driver, or sent to the neighbor ranks with MPI_BACKEND) and 
+*          unpacked there, in the same nodes.
+*          Pack format, the same for any transport: the segments of the link
+*          in order, each one with the nodes of its box in x, y and z order,
+*          buffer[offset + (z-z0)*dy*dx + (y-y0)*dx + (x-x0)]
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __HALO_PACK_H
+#define __HALO_PACK_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "var.h"
+#include "errorDef.h"
+#include "memArena.h"
+#include "globalFunctions.h"
+#include "domainDecomposition.h"
+#include "mpiBackend.h"
+#include "structs/populations.h"
+
+#if POP_PACKED_HALO && POP_HALO_LAYOUT
+#error "POP_PACKED_HALO can not be used with POP_HALO_LAYOUT"
+#endif
+
+// Threads in block of pack and unpack kernels
+#define HALO_PACK_THREADS (128)
+
+
+/*
+*   Packed buffers of a GPU, to send to and receive from the neighbor GPUs
+*/
+typedef struct haloBuffers {
+    dfloat* send[DECOMP_N_DIRS];    // buffer of each link, to neighbor with
+                                    // link shift
+    dfloat* recv[DECOMP_N_DIRS];    // buffer of each link, from neighbor with
+                                    // opposite of link shift
+    cudaEvent_t copyDone;           // buffers of GPU copied to neighbor GPUs
+    #if MPI_BACKEND
+    dfloat* hostSend[DECOMP_N_DIRS];    // send and receive buffers staged in
+    dfloat* hostRecv[DECOMP_N_DIRS];    // host (without MPI_CUDA_AWARE)
+    #endif
+
+    haloBuffers()
+    {
+        for(int l = 0; l < DECOMP_N_DIRS; l++){
+            send[l] = nullptr;
+            recv[l] = nullptr;
+            #if MPI_BACKEND
+            hostSend[l] = nullptr;
+            hostRecv[l] = nullptr;
+            #endif
+        }
+    }
+} HaloBuffers;
+
+
+/*
+*   @brief Allocates the buffers of the links in current device. Only 
+*          required with more than one GPU, otherwise the streaming is 
+*          already periodic
+*   @param halo: buffers to allocate
+*   @param decomp: domain decomposition
+*/
+__host__
+void haloBuffersAllocation(HaloBuffers* halo, const DomainDecomposition* decomp);
+
+
+/*
+*   @brief Frees the buffers of current device
+*   @param halo: buffers to free
+*/
+__host__
+void haloBuffersFree(HaloBuffers* halo);
+
+
+/*
+*   @brief Packs the populations crossing to the neighbor of link, one 
+*          thread for each value. Grid y is the segment of the link
+*   @param popAux: post streaming populations
+*   @param buffer: buffer of link to write to
+*   @param link: link to pack
+*/
+__global__
+void gpuHaloPack(
+    const dfloat* const popAux,
+    dfloat* const buffer,
+    const HaloLink link
+);
+
+
+/*
+*   @brief Unpacks the populations crossing from the neighbor of link, one
+*          thread for each value. Grid y is the segment of the link
+*   @param popAux: post streaming populations to write to
+*   @param buffer: buffer of link
+*   @param link: link to unpack
+*/
+__global__
+void gpuHaloUnpack(
+    dfloat* const popAux,
+    const dfloat* const buffer,
+    const HaloLink link
+);
+
+
+/*
+*   @brief Transfers the populations crossing the partitions between all 
+*          GPUs: packs, copies to the neighbor GPUs and unpacks, ordered by 
+*          events between the GPUs. Asynchronous. With MPI_BACKEND, the 
+*          buffers of the GPU of the process are exchanged with nonblocking
+*          sends and receives, and only the unpack is asynchronous
+*   @param halo: buffers of each GPU
+*   @param decomp: domain decomposition
+*   @param pop: populations of each GPU
+*   @param streams: stream of each GPU (nullptr for default stream)
+*/
+__host__
+void haloExchange(HaloBuffers* halo, const DomainDecomposition* decomp, 
+    Populations* pop, cudaStream_t* streams);
+
+#endif // !__HALO_PACK_H
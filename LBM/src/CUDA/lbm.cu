@@ -1,34 +1,63 @@
 #include "lbm.h"
 
+template <bool Bulk>
 __global__ 
 void gpuMacrCollisionStream(
     dfloat* const pop,
     dfloat* const popAux,
-    NodeTypeMap* const mapBC,
+    MapBC const mapBC,
+    const unsigned int* const tileList,
     Macroscopics const macr,
     bool const save,
-    int const step)
+    int const step,
+    int const zFirst)
 {
+    #if BULK_TILES
+    // One block for each tile of the list, all of the same class
+    const unsigned int tile = tileList[blockIdx.x];
+    const short unsigned int x = threadIdx.x + blockDim.x * (tile % N_TILES_X);
+    const short unsigned int y = (tile / N_TILES_X) % NY;
+    const short unsigned int z = tile / (N_TILES_X * NY);
+    #else
     const short unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
     const short unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
-    const short unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
-    if (x >= NX || y >= NY || z >= NZ)
+    const short unsigned int z = threadIdx.z + blockDim.z * blockIdx.z + zFirst;
+    #endif
+    // Planes of the GPU (less than NZ in balanced slabs)
+    const short unsigned int nz = decompLocalNZ();
+    if (x >= NX || y >= NY || z >= nz)
         return;
 
     size_t idx = idxScalar(x, y, z);
-    
-    if(!mapBC[idx].getIsUsed())
-        return;
+
+    // Bulk tiles only collide and stream, without reading the map
+    if constexpr(!Bulk){
+        if(!mapBC[idx].getIsUsed())
+            return;
+    }
 
     // Adjacent coordinates
+    #if POP_HALO_LAYOUT
+    // Populations leaving the domain are streamed to the halo nodes (-1 or N)
+    // and moved to the periodic faces by gpuPopulationsHaloCopy
+    const int xp1 = x + 1;
+    const int yp1 = y + 1;
+    const int zp1 = z + 1;
+    const int xm1 = x - 1;
+    const int ym1 = y - 1;
+    const int zm1 = z - 1;
+    #else
     const unsigned short int xp1 = (x + 1) % NX;
     const unsigned short int yp1 = (y + 1) % NY;
-    // +1 due to ghost node in z
-    const unsigned short int zp1 = (z + 1) % (NZ+1);
+    // +POP_GHOST due to ghost node in z. Without it (POP_PACKED_HALO), the
+    // populations leaving the GPU are streamed to the opposite face and
+    // replaced by the ones from the adjacent GPUs in gpuHaloUnpack
+    const unsigned short int zp1 = (z + 1) % (nz+POP_GHOST);
     const unsigned short int xm1 = (NX + x - 1) % NX;
     const unsigned short int ym1 = (NY + y - 1) % NY;
-    // +1 due to ghost node in z
-    const unsigned short int zm1 = ((NZ+1) + z - 1) % (NZ+1);
+    // +POP_GHOST due to ghost node in z
+    const unsigned short int zm1 = ((nz+POP_GHOST) + z - 1) % (nz+POP_GHOST);
+    #endif
 
     // Node populations
     dfloat fNode[Q];
@@ -63,209 +92,32 @@ void gpuMacrCollisionStream(
     #endif
 
     // Calculate macroscopics
-    // rho = sum(f[i])
-    // ux = (sum(f[i]*cx[i])+0.5*fxVar) / rho
-    // uy = (sum(f[i]*cy[i])+0.5*fyVar) / rho
-    // uz = (sum(f[i]*cz[i])+0.5*fzVar) / rho
-    #ifdef D3Q19
-    const dfloat rhoVar = fNode[0] + fNode[1] + fNode[2] + fNode[3] + fNode[4] 
-        + fNode[5] + fNode[6] + fNode[7] + fNode[8] + fNode[9] + fNode[10] 
-        + fNode[11] + fNode[12] + fNode[13] + fNode[14] + fNode[15] + fNode[16] 
-        + fNode[17] + fNode[18];
-    const dfloat invRho = 1/rhoVar;
-    const dfloat uxVar = ((fNode[1] + fNode[7] + fNode[9] + fNode[13] + fNode[15])
-        - (fNode[2] + fNode[8] + fNode[10] + fNode[14] + fNode[16]) + 0.5*fxVar) * invRho;
-    const dfloat uyVar = ((fNode[3] + fNode[7] + fNode[11] + fNode[14] + fNode[17])
-        - (fNode[4] + fNode[8] + fNode[12] + fNode[13] + fNode[18]) + 0.5*fyVar) * invRho;
-    const dfloat uzVar = ((fNode[5] + fNode[9] + fNode[11] + fNode[16] + fNode[18])
-        - (fNode[6] + fNode[10] + fNode[12] + fNode[15] + fNode[17]) + 0.5*fzVar) * invRho;
-    #endif // !D3Q19
-    #ifdef D3Q27
-    const dfloat rhoVar = fNode[0] + fNode[1] + fNode[2] + fNode[3] + fNode[4] 
-        + fNode[5] + fNode[6] + fNode[7] + fNode[8] + fNode[9] + fNode[10] 
-        + fNode[11] + fNode[12] + fNode[13] + fNode[14] + fNode[15] + fNode[16] 
-        + fNode[17] + fNode[18] + fNode[19] + fNode[20] + fNode[21] + fNode[22]
-        + fNode[23] + fNode[24] + fNode[25] + fNode[26];
-        const dfloat invRho = 1/rhoVar;
-    const dfloat uxVar = ((fNode[1] + fNode[7] + fNode[9] + fNode[13] + fNode[15]
-        + fNode[19] + fNode[21] + fNode[23] + fNode[26]) 
-        - (fNode[2] + fNode[8] + fNode[10] + fNode[14] + fNode[16] + fNode[20]
-        + fNode[22] + fNode[24] + fNode[25]) + 0.5*fxVar) * invRho;
-    const dfloat uyVar = ((fNode[3] + fNode[7] + fNode[11] + fNode[14] + fNode[17]
-        + fNode[19] + fNode[21] + fNode[24] + fNode[25])
-        - (fNode[4] + fNode[8] + fNode[12] + fNode[13] + fNode[18] + fNode[20]
-        + fNode[22] + fNode[23] + fNode[26]) + 0.5*fyVar) * invRho;
-    const dfloat uzVar = ((fNode[5] + fNode[9] + fNode[11] + fNode[16] + fNode[18]
-        + fNode[19] + fNode[22] + fNode[23] + fNode[25])
-        - (fNode[6] + fNode[10] + fNode[12] + fNode[15] + fNode[17] + fNode[20]
-        + fNode[21] + fNode[24] + fNode[26]) + 0.5*fzVar) * invRho;
-    #endif // !D3Q27
+    dfloat rhoVar, uxVar, uyVar, uzVar;
+    popMacroscopics(fNode, fxVar, fyVar, fzVar, rhoVar, uxVar, uyVar, uzVar);
 
     // Calculate temporary variables
-      // Calculate temporary variables
     const dfloat p1_muu15 = 1 - 1.5 * (uxVar * uxVar + 
         uyVar * uyVar + uzVar * uzVar);
-    const dfloat rhoW0 = rhoVar * W0;
-    const dfloat rhoW1 = rhoVar * W1;
-    const dfloat rhoW2 = rhoVar * W2;
-#ifdef D3Q27
-    const dfloat rhoW3 = rhoVar * W3;
-#endif
     const dfloat ux3 = 3 * uxVar;
     const dfloat uy3 = 3 * uyVar;
     const dfloat uz3 = 3 * uzVar;
-    const dfloat ux3ux3d2 = ux3*ux3*0.5;
-    const dfloat ux3uy3 = ux3*uy3;
-    const dfloat ux3uz3 = ux3*uz3;
-    const dfloat uy3uy3d2 = uy3*uy3*0.5;
-    const dfloat uy3uz3 = uy3*uz3;
-    const dfloat uz3uz3d2 = uz3*uz3*0.5;
-
-    // Terms to use to recursive calculations
-#ifdef D3Q19
-    dfloat terms[6];
-#endif 
-#ifdef D3Q27
-    dfloat terms[11];
-#endif
-    dfloat multiplyTerm = 1;
-    dfloat auxTerm;
 
     // Collision to fNode:
     // fNode = (1 - 1/TAU)*f1 + (1/TAU)*fEq + (1 - 0.5/TAU)*force ->
     // fNode = (1 - OMEGA)*f1 + OMEGA*fEq + (1 - 0.5*0MEGA)*force->
     // fNode = T_OMEGA * f1 + OMEGA*fEq + TT_OMEGA*force
-
-    // Sequence is:
-    // fNode *= T_OMEGA
-    // fNode += OMEGA*fEq
-    // fNode += TT_OMEGA*force
-
-#pragma unroll
-    for(char i = 0; i < Q; i++)
-        fNode[i] *= T_OMEGA;
-
-    // Calculate equilibrium terms 
-    // terms = 0.5*uc3^2 + uc3
-    // terms[0] -> population 0
-    // terms[1] -> population 1
-    // terms[2] -> population 2
-    // terms[3] -> population 3
-    // terms[4] -> population 4
-    terms[0] = p1_muu15;
-    terms[1] = terms[0] + ( ux3 + ux3ux3d2);
-    terms[2] = terms[0] + (-ux3 + ux3ux3d2);
-    terms[3] = terms[0] + ( uy3 + uy3uy3d2);
-    terms[4] = terms[0] + (-uy3 + uy3uy3d2);
-#ifdef D3Q27
-    // terms[5] -> population 7
-    // terms[6] -> population 8
-    // terms[7] -> population 9
-    // terms[8] -> population 10
-    // terms[9] -> population 11
-    // terms[10] -> population 12
-    terms[5] = terms[1] + ( uy3 + ux3uy3 + uy3uy3d2);
-    terms[6] = terms[2] + (-uy3 + ux3uy3 + uy3uy3d2);
-    terms[7] = terms[1] + ( uz3 + ux3uz3 + uz3uz3d2);
-    terms[8] = terms[2] + (-uz3 + ux3uz3 + uz3uz3d2);
-    terms[9] = terms[3] + ( uz3 + uy3uz3 + uz3uz3d2);
-    terms[10] = terms[4] + (-uz3 + uy3uz3 + uz3uz3d2);
-#endif
-
-    // fNode += OMEGA*fEq
-    multiplyTerm = OMEGA*rhoW0;
-    fNode[0] += multiplyTerm*terms[0];
-    multiplyTerm = OMEGA*rhoW1;
-    fNode[1] += multiplyTerm*terms[1];
-    fNode[2] += multiplyTerm*terms[2];
-    fNode[3] += multiplyTerm*terms[3];
-    fNode[4] += multiplyTerm*terms[4];
-    fNode[5] += multiplyTerm*(terms[0] + ( uz3 + uz3uz3d2));
-    fNode[6] += multiplyTerm*(terms[0] + (-uz3 + uz3uz3d2));
-    multiplyTerm = OMEGA*rhoW2;
-    fNode[7]  += multiplyTerm*(terms[1] + ( uy3 + ux3uy3 + uy3uy3d2));
-    fNode[8]  += multiplyTerm*(terms[2] + (-uy3 + ux3uy3 + uy3uy3d2));
-    fNode[9]  += multiplyTerm*(terms[1] + ( uz3 + ux3uz3 + uz3uz3d2));
-    fNode[10] += multiplyTerm*(terms[2] + (-uz3 + ux3uz3 + uz3uz3d2));
-    fNode[11] += multiplyTerm*(terms[3] + ( uz3 + uy3uz3 + uz3uz3d2));
-    fNode[12] += multiplyTerm*(terms[4] + (-uz3 + uy3uz3 + uz3uz3d2));
-    fNode[13] += multiplyTerm*(terms[1] + (-uy3 - ux3uy3 + uy3uy3d2));
-    fNode[14] += multiplyTerm*(terms[2] + ( uy3 - ux3uy3 + uy3uy3d2));
-    fNode[15] += multiplyTerm*(terms[1] + (-uz3 - ux3uz3 + uz3uz3d2));
-    fNode[16] += multiplyTerm*(terms[2] + ( uz3 - ux3uz3 + uz3uz3d2));
-    fNode[17] += multiplyTerm*(terms[3] + (-uz3 - uy3uz3 + uz3uz3d2));
-    fNode[18] += multiplyTerm*(terms[4] + ( uz3 - uy3uz3 + uz3uz3d2));
-#ifdef D3Q27
-    multiplyTerm = OMEGA*rhoW3;
-    fNode[19] += multiplyTerm*(terms[5] + ( uz3 + ux3uz3 + uy3uz3 + uz3uz3d2));
-    fNode[20] += multiplyTerm*(terms[6] + (-uz3 + ux3uz3 + uy3uz3 + uz3uz3d2));
-    fNode[21] += multiplyTerm*(terms[5] + (-uz3 - ux3uz3 - uy3uz3 + uz3uz3d2));
-    fNode[22] += multiplyTerm*(terms[6] + ( uz3 - ux3uz3 - uy3uz3 + uz3uz3d2));
-    fNode[23] += multiplyTerm*(terms[7] + (-uy3 - ux3uy3 + uy3uy3d2 - uy3uz3));
-    fNode[24] += multiplyTerm*(terms[8] + ( uy3 - ux3uy3 + uy3uy3d2 - uy3uz3));
-    fNode[25] += multiplyTerm*(terms[9] + (-ux3 + ux3ux3d2 - ux3uy3 - ux3uz3));
-    fNode[26] += multiplyTerm*(terms[10] + ( ux3 + ux3ux3d2 - ux3uy3 - ux3uz3));
-#endif
-
-    // calculate force term
-    // term[0] -> population 0
-    // term[1] -> population 1
-    // term[2] -> population 3
-    // term[3] -> population 7
-    // term[4] -> population 9
-    // term[5] -> population 11
-    terms[0] = - FX*ux3 - FY*uy3 - FZ*uz3;
-    terms[1] = terms[0] + (FX*( 3*ux3 + 3));
-    terms[2] = terms[0] + (FY*( 3*uy3 + 3));
-    terms[3] = terms[1] + (FX*( 3*uy3) + FY*( 3*ux3 + 3*uy3 + 3));
-    terms[4] = terms[1] + (FX*( 3*uz3) + FZ*( 3*ux3 + 3*uz3 + 3));
-    terms[5] = terms[2] + (FY*( 3*uz3) + FZ*( 3*uy3 + 3*uz3 + 3));
-#ifdef D3Q27
-    // term[6] -> population 19
-    terms[6] = terms[3] + (FX*( 3*uz3) + FY*( 3*uz3) + FZ*( 3*ux3 + 3*uy3 + 3*uz3 + 3));
-#endif
-
-    // fNode += TT_OMEGA * force
-    multiplyTerm = W0*TT_OMEGA;
-    fNode[0] += multiplyTerm*terms[0];
-    multiplyTerm = W1*TT_OMEGA;
-    fNode[1] += multiplyTerm*terms[1];
-    fNode[2] += multiplyTerm*(terms[1] + (FX*(-6)));
-    fNode[3] += multiplyTerm*terms[2];
-    fNode[4] += multiplyTerm*(terms[2] + (FY*(-6)));
-    auxTerm = terms[0] + (FZ*( 3*uz3 + 3));
-    fNode[5] += multiplyTerm*auxTerm;
-    fNode[6] += multiplyTerm*(auxTerm + (FZ*(-6)));
-    multiplyTerm = W2*TT_OMEGA;
-    fNode[7] += multiplyTerm*terms[3];
-    fNode[8] += multiplyTerm*(terms[3] + (FX*(-6) + FY*(-6)));
-    fNode[9] += multiplyTerm*terms[4];
-    fNode[10] += multiplyTerm*(terms[4] + (FX*(-6) + FZ*(-6)));
-    fNode[11] += multiplyTerm*(terms[5]);
-    fNode[12] += multiplyTerm*(terms[5] + (FY*(-6) + FZ*(-6)));
-    auxTerm = terms[3] + (FX*(-6*uy3) + FY*(-6*ux3 - 6));
-    fNode[13] += multiplyTerm*(auxTerm);
-    fNode[14] += multiplyTerm*(auxTerm + (FX*(-6) + FY*( 6)));
-    auxTerm = terms[4] + (FX*(-6*uz3) + FZ*(-6*ux3 - 6));
-    fNode[15] += multiplyTerm*auxTerm;
-    fNode[16] += multiplyTerm*(auxTerm + (FX*(-6) + FZ*( 6)));
-    auxTerm = terms[5] + (FY*(-6*uz3) + FZ*(-6*uy3 - 6));
-    fNode[17] += multiplyTerm*auxTerm;
-    fNode[18] += multiplyTerm*(auxTerm + (FY*(-6) + FZ*( 6)));
-#ifdef D3Q27
-    multiplyTerm = W3*TT_OMEGA;
-    fNode[19] += multiplyTerm*terms[6];
-    fNode[20] += multiplyTerm*(terms[6] + (FX*(-6) + FY*(-6) + FZ*(-6)));
-    auxTerm = terms[6] + (FX*(-6*uz3) + FY*(-6*uz3) + FZ*(-6*ux3 - 6*uy3 - 6));
-    fNode[21] += multiplyTerm*auxTerm;
-    fNode[22] += multiplyTerm*(auxTerm + (FX*(-6) + FY*(-6) + FZ*( 6)));
-    auxTerm = terms[6] + (FX*(-6*uy3) + FY*(-6*ux3 - 6*uz3 - 6) + FZ*(-6*uy3));
-    fNode[23] += multiplyTerm*auxTerm;
-    fNode[24] += multiplyTerm*(auxTerm + (FX*(-6) + FY*( 6) + FZ*(-6)));
-    auxTerm = terms[6] + (FX*(-6*uy3 - 6*uz3 - 6) + FY*(-6*ux3) + FZ*(-6*ux3));
-    fNode[25] += multiplyTerm*auxTerm;
-    fNode[26] += multiplyTerm*(auxTerm + (FX*( 6) + FY*(-6) + FZ*(-6)));
-#endif
+    // Unrolled in compile time from the velocity set (velocitySetUnroll.h),
+    // with the force term using the constant force FX, FY, FZ
+    popCollision(fNode, rhoVar, ux3, uy3, uz3, p1_muu15, FX, FY, FZ);
+
+    #if SPONGE_LAYER
+    // Absorbing layer, relaxes post collision populations towards target
+    if constexpr(!Bulk){
+        const unsigned char spgLevel = mapBC[idxScalar(x, y, z)].getSpongeLevel();
+        if(spgLevel != 0)
+            spongeRelax(fNode, spgLevel);
+    }
+    #endif
 
 
     if (save)
@@ -286,44 +138,123 @@ void gpuMacrCollisionStream(
 
     // Save post collision populations of boundary conditions nodes
     idx = idxScalar(x, y, z);
-    if(mapBC[idx].getSavePostCol())  
+    if(!Bulk && mapBC[idx].getSavePostCol())  
     {
-        #pragma unroll
-        for (char i = 0; i < Q; i++)
-            pop[idxPop(x, y, z, i)] = fNode[i];
+        #if BC_POST_COL_BUFFER
+        // Compact buffer, so pop is only read. Without buffer in device 
+        // (shared by partitions), no node has a slot
+        const unsigned int slot = postColSlot(x, y, z);
+        if(slot != POST_COL_NO_SLOT){
+            #pragma unroll
+            for (char i = 0; i < Q; i++)
+                gpuPostColBuffer[gpuPostColTotal*i + slot] = fNode[i];
+        }
+        else
+        #endif
+        {
+            #pragma unroll
+            for (char i = 0; i < Q; i++)
+                pop[idxPop(x, y, z, i)] = fNode[i];
+        }
     }
 
     // Streaming to popAux
     // popAux(x+cx, y+cy, z+cz, i) = pop(x, y, z, i) 
     // The populations that shoudn't be streamed will be changed by the boundary conditions
-    popAux[idxPop(x, y, z, 0)] = fNode[0];
-    popAux[idxPop(xp1, y, z, 1)] = fNode[1];
-    popAux[idxPop(xm1, y, z, 2)] = fNode[2];
-    popAux[idxPop(x, yp1, z, 3)] = fNode[3];
-    popAux[idxPop(x, ym1, z, 4)] = fNode[4];
-    popAux[idxPop(x, y, zp1, 5)] = fNode[5];
-    popAux[idxPop(x, y, zm1, 6)] = fNode[6];
-    popAux[idxPop(xp1, yp1, z, 7)] = fNode[7];
-    popAux[idxPop(xm1, ym1, z, 8)] = fNode[8];
-    popAux[idxPop(xp1, y, zp1, 9)] = fNode[9];
-    popAux[idxPop(xm1, y, zm1, 10)] = fNode[10];
-    popAux[idxPop(x, yp1, zp1, 11)] = fNode[11];
-    popAux[idxPop(x, ym1, zm1, 12)] = fNode[12];
-    popAux[idxPop(xp1, ym1, z, 13)] = fNode[13];
-    popAux[idxPop(xm1, yp1, z, 14)] = fNode[14];
-    popAux[idxPop(xp1, y, zm1, 15)] = fNode[15];
-    popAux[idxPop(xm1, y, zp1, 16)] = fNode[16];
-    popAux[idxPop(x, yp1, zm1, 17)] = fNode[17];
-    popAux[idxPop(x, ym1, zp1, 18)] = fNode[18];
-    #ifdef D3Q27
-    popAux[idxPop(xp1, yp1, zp1, 19)] = fNode[19];
-    popAux[idxPop(xm1, ym1, zm1, 20)] = fNode[20];
-    popAux[idxPop(xp1, yp1, zm1, 21)] = fNode[21];
-    popAux[idxPop(xm1, ym1, zp1, 22)] = fNode[22];
-    popAux[idxPop(xp1, ym1, zp1, 23)] = fNode[23];
-    popAux[idxPop(xm1, yp1, zm1, 24)] = fNode[24];
-    popAux[idxPop(xm1, yp1, zp1, 25)] = fNode[25];
-    popAux[idxPop(xp1, ym1, zm1, 26)] = fNode[26];
+    popStream(popAux, fNode, x, y, z, xp1, yp1, zp1, xm1, ym1, zm1);
+}
+
+
+__global__
+void gpuBuildTileClass(
+    NodeTypeMap* const mapBC,
+    unsigned char* const tileClass)
+{
+    const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
+    const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
+    const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
+
+    // Nodes outside the domain do not change the tile class
+    bool isBulk = true;
+    bool isSolid = true;
+    if(x < NX && y < NY && z < NZ){
+        NodeTypeMap nodeMap = mapBC[idxScalar(x, y, z)];
+        isBulk = nodeMap.isBulk();
+        isSolid = !nodeMap.getIsUsed();
+    }
+    // All threads of block must reach the reductions
+    const bool allBulk = __syncthreads_and(isBulk);
+    const bool allSolid = __syncthreads_and(isSolid);
+
+    if(threadIdx.x != 0 || y >= NY || z >= NZ)
+        return;
+    tileClass[idxTile(blockIdx.x, y, z)] = 
+        allSolid ? TILE_SOLID : (allBulk ? TILE_BULK : TILE_MIXED);
+}
+
+
+__host__
+void buildTileList(Populations* pop)
+{
+    #if BULK_TILES
+    unsigned char* hTileClass = (unsigned char*)malloc(MEM_SIZE_TILE_CLASS);
+    unsigned int* hTileList = (unsigned int*)malloc(MEM_SIZE_TILE_LIST);
+    checkCudaErrors(cudaMemcpy(hTileClass, pop->tileClass, MEM_SIZE_TILE_CLASS, 
+        cudaMemcpyDefault));
+
+    // Bulk tiles and then mixed tiles, each in the order of idxTile (so 
+    // sorted by z). Solid tiles are left out
+    const unsigned char classes[2] = {TILE_BULK, TILE_MIXED};
+    size_t n = 0;
+    for(int c = 0; c < 2; c++){
+        size_t* planeFirst = pop->tilePlaneFirst + c*(NZ+1);
+        for(int z = 0; z < NZ; z++){
+            planeFirst[z] = n;
+            for(size_t t = idxTile(0, 0, z); t < idxTile(0, 0, z+1); t++)
+                if(hTileClass[t] == classes[c])
+                    hTileList[n++] = (unsigned int)t;
+        }
+        planeFirst[NZ] = n;
+    }
+    checkCudaErrors(cudaMemcpy(pop->tileList, hTileList, n*sizeof(unsigned int), 
+        cudaMemcpyDefault));
+
+    free(hTileClass);
+    free(hTileList);
+    #endif
+}
+
+
+__host__
+void macrCollisionStream(
+    Populations* pop,
+    Macroscopics macr,
+    const dim3 grid,
+    const dim3 threads,
+    const cudaStream_t stream,
+    const bool save,
+    const int step,
+    const int zFirst)
+{
+    #if BULK_TILES
+    // One kernel for each class, with the tiles of the planes of grid
+    const int zLast = myMin(zFirst + (int)grid.z, NZ);
+    for(int c = 0; c < 2; c++){
+        const size_t* planeFirst = pop->tilePlaneFirst + c*(NZ+1);
+        const size_t nTiles = planeFirst[zLast] - planeFirst[zFirst];
+        if(nTiles == 0)
+            continue;
+        const unsigned int* tiles = pop->tileList + planeFirst[zFirst];
+        if(c == 0)
+            gpuMacrCollisionStream<true><<<(unsigned int)nTiles, threads, 0, stream>>>
+                (pop->pop, pop->popAux, pop->mapBC, tiles, macr, save, step, zFirst);
+        else
+            gpuMacrCollisionStream<false><<<(unsigned int)nTiles, threads, 0, stream>>>
+                (pop->pop, pop->popAux, pop->mapBC, tiles, macr, save, step, zFirst);
+    }
+    #else
+    gpuMacrCollisionStream<false><<<grid, threads, 0, stream>>>
+        (pop->pop, pop->popAux, pop->mapBC, nullptr, macr, save, step, zFirst);
     #endif
 }
 
@@ -336,12 +267,13 @@ void gpuUpdateMacr(
     const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
     const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
     const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
-    if (x >= NX || y >= NY || z >= NZ)
+    if (x >= NX || y >= NY || z >= decompLocalNZ())
         return;
 
     size_t idx_s = idxScalarWBorder(x, y, z);
     // load populations
     dfloat fNode[Q];
+    #pragma unroll
     for (unsigned char i = 0; i < Q; i++)
         fNode[i] = pop.pop[idxPop(x, y, z, i)];
 
@@ -360,39 +292,8 @@ void gpuUpdateMacr(
     // ux = sum(f[i]*cx[i] + Fx/2) / rho
     // uy = sum(f[i]*cy[i] + Fy/2) / rho
     // uz = sum(f[i]*cz[i] + Fz/2) / rho
-    #ifdef D3Q19
-    const dfloat rhoVar = fNode[0] + fNode[1] + fNode[2] + fNode[3] + fNode[4] 
-        + fNode[5] + fNode[6] + fNode[7] + fNode[8] + fNode[9] + fNode[10] 
-        + fNode[11] + fNode[12] + fNode[13] + fNode[14] + fNode[15] + fNode[16] 
-        + fNode[17] + fNode[18];
-    const dfloat invRho = 1/rhoVar;
-    const dfloat uxVar = ((fNode[1] + fNode[7] + fNode[9] + fNode[13] + fNode[15])
-        - (fNode[2] + fNode[8] + fNode[10] + fNode[14] + fNode[16]) + 0.5*fxVar) * invRho;
-    const dfloat uyVar = ((fNode[3] + fNode[7] + fNode[11] + fNode[14] + fNode[17])
-        - (fNode[4] + fNode[8] + fNode[12] + fNode[13] + fNode[18]) + 0.5*fyVar) * invRho;
-    const dfloat uzVar = ((fNode[5] + fNode[9] + fNode[11] + fNode[16] + fNode[18])
-        - (fNode[6] + fNode[10] + fNode[12] + fNode[15] + fNode[17]) + 0.5*fzVar) * invRho;
-    #endif // !D3Q19
-    #ifdef D3Q27
-    const dfloat rhoVar = fNode[0] + fNode[1] + fNode[2] + fNode[3] + fNode[4] 
-        + fNode[5] + fNode[6] + fNode[7] + fNode[8] + fNode[9] + fNode[10] 
-        + fNode[11] + fNode[12] + fNode[13] + fNode[14] + fNode[15] + fNode[16] 
-        + fNode[17] + fNode[18] + fNode[19] + fNode[20] + fNode[21] + fNode[22]
-        + fNode[23] + fNode[24] + fNode[25] + fNode[26];
-        const dfloat invRho = 1/rhoVar;
-    const dfloat uxVar = ((fNode[1] + fNode[7] + fNode[9] + fNode[13] + fNode[15]
-        + fNode[19] + fNode[21] + fNode[23] + fNode[26]) 
-        - (fNode[2] + fNode[8] + fNode[10] + fNode[14] + fNode[16] + fNode[20]
-        + fNode[22] + fNode[24] + fNode[25]) + 0.5*fxVar) * invRho;
-    const dfloat uyVar = ((fNode[3] + fNode[7] + fNode[11] + fNode[14] + fNode[17]
-        + fNode[19] + fNode[21] + fNode[24] + fNode[25])
-        - (fNode[4] + fNode[8] + fNode[12] + fNode[13] + fNode[18] + fNode[20]
-        + fNode[22] + fNode[23] + fNode[26]) + 0.5*fyVar) * invRho;
-    const dfloat uzVar = ((fNode[5] + fNode[9] + fNode[11] + fNode[16] + fNode[18]
-        + fNode[19] + fNode[22] + fNode[23] + fNode[25])
-        - (fNode[6] + fNode[10] + fNode[12] + fNode[15] + fNode[17] + fNode[20]
-        + fNode[21] + fNode[24] + fNode[26]) + 0.5*fzVar) * invRho;
-    #endif // !D3Q27
+    dfloat rhoVar, uxVar, uyVar, uzVar;
+    popMacroscopics(fNode, fxVar, fyVar, fzVar, rhoVar, uxVar, uyVar, uzVar);
     macr.rho[idx_s] = rhoVar;
     macr.u.x[idx_s] = uxVar;
     macr.u.y[idx_s] = uyVar;
@@ -401,7 +302,7 @@ void gpuUpdateMacr(
 
 
 __global__
-void gpuApplyBC(NodeTypeMap* mapBC,  
+void gpuApplyBC(MapBC mapBC,  
     dfloat* popPostStream,
     dfloat* popPostCol,
     size_t* idxsBCNodes,
@@ -417,7 +318,243 @@ void gpuApplyBC(NodeTypeMap* mapBC,
     const unsigned int y = (idx/NX) % NY;
     const unsigned int z = idx/(NX*NY);
 
-    gpuBoundaryConditions(&(mapBC[idx]), popPostStream, popPostCol, x, y, z);
+    NodeTypeMap nodeMap = mapBC[idx];
+    gpuBoundaryConditions(&nodeMap, popPostStream, popPostCol, x, y, z);
+}
+
+template <unsigned char SCHEME>
+__global__
+void gpuApplyBCGroup(MapBC mapBC, 
+    dfloat* popPostStream,
+    dfloat* popPostCol,
+    size_t* idxGroupNodes,
+    size_t totalGroupNodes)
+{
+    const unsigned int i = threadIdx.x + blockDim.x * blockIdx.x;
+
+    if(i >= totalGroupNodes)
+        return;
+    // converts 1D index to 3D location
+    const size_t idx = idxGroupNodes[i];
+    const unsigned int x = idx % NX;
+    const unsigned int y = (idx/NX) % NY;
+    const unsigned int z = idx/(NX*NY);
+
+    NodeTypeMap nodeMap = mapBC[idx];
+    gpuBoundaryConditionsScheme<SCHEME>(&nodeMap, popPostStream, popPostCol, x, y, z);
+}
+
+
+__host__
+void applyBCGroups(BoundaryConditionsInfo* bcInfo,
+    MapBC mapBC, 
+    dfloat* popPostStream,
+    dfloat* popPostCol,
+    const cudaStream_t stream)
+{
+    const dim3 threads(32, 1, 1);
+    for(unsigned int g = 0; g < bcInfo->totalBCGroups; g++)
+    {
+        BCGroup* group = &(bcInfo->bcGroups[g]);
+        const dim3 grid((unsigned int)((group->count+31)/32), 1, 1);
+        size_t* idxGroup = bcInfo->idxBCNodes + group->first;
+
+        #if BC_GROUPS_TIMING
+        checkCudaErrors(cudaEventRecord(group->start, stream));
+        #endif
+        switch(group->scheme)
+        {
+        #ifdef BC_SCHEME_BOUNCE_BACK
+        case BC_SCHEME_BOUNCE_BACK:
+            gpuApplyBCGroup<BC_SCHEME_BOUNCE_BACK><<<grid, threads, 0, stream>>>
+                (mapBC, popPostStream, popPostCol, idxGroup, group->count);
+            break;
+        #endif
+        #ifdef BC_SCHEME_VEL_BOUNCE_BACK
+        case BC_SCHEME_VEL_BOUNCE_BACK:
+            gpuApplyBCGroup<BC_SCHEME_VEL_BOUNCE_BACK><<<grid, threads, 0, stream>>>
+                (mapBC, popPostStream, popPostCol, idxGroup, group->count);
+            break;
+        #endif
+        #ifdef BC_SCHEME_VEL_ZOUHE
+        case BC_SCHEME_VEL_ZOUHE:
+            gpuApplyBCGroup<BC_SCHEME_VEL_ZOUHE><<<grid, threads, 0, stream>>>
+                (mapBC, popPostStream, popPostCol, idxGroup, group->count);
+            break;
+        #endif
+        #ifdef BC_SCHEME_PRES_ZOUHE
+        case BC_SCHEME_PRES_ZOUHE:
+            gpuApplyBCGroup<BC_SCHEME_PRES_ZOUHE><<<grid, threads, 0, stream>>>
+                (mapBC, popPostStream, popPostCol, idxGroup, group->count);
+            break;
+        #endif
+        #ifdef BC_SCHEME_FREE_SLIP
+        case BC_SCHEME_FREE_SLIP:
+            gpuApplyBCGroup<BC_SCHEME_FREE_SLIP><<<grid, threads, 0, stream>>>
+                (mapBC, popPostStream, popPostCol, idxGroup, group->count);
+            break;
+        #endif
+        #ifdef BC_SCHEME_SYMMETRY
+        case BC_SCHEME_SYMMETRY:
+            gpuApplyBCGroup<BC_SCHEME_SYMMETRY><<<grid, threads, 0, stream>>>
+                (mapBC, popPostStream, popPostCol, idxGroup, group->count);
+            break;
+        #endif
+        case BC_SCHEME_SPECIAL:
+            gpuApplyBCGroup<BC_SCHEME_SPECIAL><<<grid, threads, 0, stream>>>
+                (mapBC, popPostStream, popPostCol, idxGroup, group->count);
+            break;
+        #ifdef BC_SCHEME_OUTFLOW_CONVECTIVE
+        case BC_SCHEME_OUTFLOW_CONVECTIVE:
+        #endif
+        #ifdef BC_SCHEME_OUTFLOW_NON_REFLECTING
+        case BC_SCHEME_OUTFLOW_NON_REFLECTING:
+        #endif
+        #if defined(BC_SCHEME_OUTFLOW_CONVECTIVE) || defined(BC_SCHEME_OUTFLOW_NON_REFLECTING)
+            gpuApplyOutflowBC<<<grid, threads, 0, stream>>>
+                (mapBC, popPostStream, idxGroup, 
+                bcInfo->popOutflowPrev + (group->first - bcInfo->firstOutflowNode),
+                bcInfo->totalOutflowNodes, group->count);
+            break;
+        #endif
+        default:
+            break;
+        }
+        #if BC_GROUPS_TIMING
+        checkCudaErrors(cudaEventRecord(group->stop, stream));
+        #endif
+    }
+}
+
+
+__host__
+void applyBC(BoundaryConditionsInfo* bcInfo,
+    Populations* pop,
+    const dim3 gridBC,
+    const cudaStream_t stream)
+{
+    const dim3 threadsBC(32, 1, 1);
+    #ifdef BC_SCHEME_SYMMETRY
+    // Mirrored populations from other partitions, before the boundary 
+    // conditions of their nodes overwrite them
+    if(bcInfo->totalSymLinks > 0){
+        gpuSymmetryLinksGather<<<(unsigned int)((bcInfo->totalSymLinks+31)/32), threadsBC, 0, stream>>>
+            (pop->popAux, bcInfo->idxSymSrc, bcInfo->popSymLinks, bcInfo->totalSymLinks);
+    }
+    #endif
+    #if BC_GROUPS
+    // One kernel for each group, without divergence in the schemes
+    applyBCGroups(bcInfo, pop->mapBC, pop->popAux, pop->pop, stream);
+    #else
+    if(bcInfo->totalBCNodes > 0){
+        gpuApplyBC<<<gridBC, threadsBC, 0, stream>>>
+            (pop->mapBC, pop->popAux, pop->pop, 
+            bcInfo->idxBCNodes, bcInfo->totalBCNodes);
+    }
+    // Outflow nodes are skipped by gpuApplyBC
+    if(bcInfo->totalOutflowNodes > 0){
+        gpuApplyOutflowBC<<<(unsigned int)((bcInfo->totalOutflowNodes+31)/32), threadsBC, 0, stream>>>
+            (pop->mapBC, pop->popAux, 
+            bcInfo->idxBCNodes + bcInfo->firstOutflowNode,
+            bcInfo->popOutflowPrev, bcInfo->totalOutflowNodes,
+            bcInfo->totalOutflowNodes);
+    }
+    #endif
+    if(bcInfo->totalInterpBBLinks > 0){
+        gpuApplyInterpBB<<<(unsigned int)((bcInfo->totalInterpBBLinks+31)/32), threadsBC, 0, stream>>>
+            (pop->popAux, pop->pop, bcInfo->idxInterpBBLinks, 
+            bcInfo->qInterpBBLinks, bcInfo->totalInterpBBLinks);
+    }
+    #ifdef BC_SCHEME_SYMMETRY
+    if(bcInfo->totalSymLinks > 0){
+        gpuSymmetryLinksScatter<<<(unsigned int)((bcInfo->totalSymLinks+31)/32), threadsBC, 0, stream>>>
+            (pop->popAux, bcInfo->idxSymLinks, bcInfo->popSymLinks, bcInfo->totalSymLinks);
+    }
+    #endif
+    getLastCudaError("BC kernel error\n");
+}
+
+
+__global__
+void gpuApplyInterpBB(
+    dfloat* popPostStream,
+    dfloat* popPostCol,
+    size_t* idxLinks,
+    float* qLinks,
+    size_t totalLinks)
+{
+    #ifdef BC_SCHEME_INTERP_BOUNCE_BACK
+    const size_t i = threadIdx.x + blockDim.x * blockIdx.x;
+
+    if(i >= totalLinks)
+        return;
+    gpuBCInterpolatedBounceBack(idxLinks[i], qLinks[i], popPostStream, popPostCol);
+    #endif
+}
+
+__global__
+void gpuApplyOutflowBC(MapBC mapBC,
+    dfloat* popPostStream,
+    size_t* idxOutflowNodes,
+    dfloat* popOutflowPrev,
+    size_t strideOutflowPrev,
+    size_t totalOutflowNodes)
+{
+    #if defined(BC_SCHEME_OUTFLOW_CONVECTIVE) || defined(BC_SCHEME_OUTFLOW_NON_REFLECTING)
+    const size_t i = threadIdx.x + blockDim.x * blockIdx.x;
+
+    if(i >= totalOutflowNodes)
+        return;
+    // converts 1D index to 3D location
+    const size_t idx = idxOutflowNodes[i];
+    const unsigned int x = idx % NX;
+    const unsigned int y = (idx/NX) % NY;
+    const unsigned int z = idx/(NX*NY);
+
+    NodeTypeMap nodeMap = mapBC[idx];
+    switch(nodeMap.getSchemeBC())
+    {
+    #ifdef BC_SCHEME_OUTFLOW_CONVECTIVE
+    case BC_SCHEME_OUTFLOW_CONVECTIVE:
+        gpuBCOutflowConvective(nodeMap.getDirection(), popPostStream, 
+            &(popOutflowPrev[i]), strideOutflowPrev, x, y, z);
+        break;
+    #endif
+    #ifdef BC_SCHEME_OUTFLOW_NON_REFLECTING
+    case BC_SCHEME_OUTFLOW_NON_REFLECTING:
+        gpuBCOutflowNonReflecting(nodeMap.getDirection(), RHO_BC[nodeMap.getRhoIdx()],
+            popPostStream, &(popOutflowPrev[i]), strideOutflowPrev, x, y, z);
+        break;
+    #endif
+    default:
+        break;
+    }
+    #endif
+}
+
+
+__global__
+void gpuInitOutflowBC(MapBC mapBC,
+    dfloat* pop,
+    size_t* idxOutflowNodes,
+    dfloat* popOutflowPrev,
+    size_t totalOutflowNodes)
+{
+    #if defined(BC_SCHEME_OUTFLOW_CONVECTIVE) || defined(BC_SCHEME_OUTFLOW_NON_REFLECTING)
+    const size_t i = threadIdx.x + blockDim.x * blockIdx.x;
+
+    if(i >= totalOutflowNodes)
+        return;
+    // converts 1D index to 3D location
+    const size_t idx = idxOutflowNodes[i];
+    const unsigned int x = idx % NX;
+    const unsigned int y = (idx/NX) % NY;
+    const unsigned int z = idx/(NX*NY);
+
+    NodeTypeMap nodeMap = mapBC[idx];
+    gpuBCOutflowInit(nodeMap.getSchemeBC(), nodeMap.getDirection(), pop, 
+        &(popOutflowPrev[i]), totalOutflowNodes, x, y, z);
+    #endif
 }
 
 __global__
@@ -429,6 +566,12 @@ void gpuPopulationsTransfer(
     const unsigned short int y = threadIdx.y + blockDim.y * blockIdx.y;
     const unsigned short int zMax = NZ-1;
     const unsigned short int zRead = NZ;
+    // Populations with cz=-1 are streamed to the halo in z=-1 with halo layout
+    #if POP_HALO_LAYOUT
+    const int zReadM = -1;
+    #else
+    const int zReadM = NZ;
+    #endif
 
     if (x >= NX || y >= NY)
         return;
@@ -436,7 +579,8 @@ void gpuPopulationsTransfer(
     // This takes into account that the populations are "teleported"
     // from one side of domain to another. So the population with cz=-1
     // in z = 0 is streamed to z = NZ-1.
-    // All populations streamed outside the GPU are at NZ (ghost node)
+    // All populations streamed outside the GPU are at NZ (ghost node),
+    // or at -1 for cz=-1 with halo layout
     // In this way, to retrieve a population that should have been sent 
     // to the adjacent node, but was "teleported", the part of the domain 
     // to which it was streamed must be read.
@@ -444,37 +588,7 @@ void gpuPopulationsTransfer(
     // so the higher level of popBase must be streamed to the lower level of
     // popNext and vice versa
 
-    // pop[5] -> cz = 1; pop[6] -> cz = -1
-    popPostStreamBase[idxPop(x, y, zMax, 6)] = popPostStreamNxt[idxPop(x, y, zRead, 6)];
-    popPostStreamNxt[idxPop(x, y, 0, 5)] = popPostStreamBase[idxPop(x, y, zRead, 5)];    
-    // pop[9] -> cz = 1; pop[10] -> cz = -1;
-    popPostStreamBase[idxPop(x, y, zMax, 10)] = popPostStreamNxt[idxPop(x, y, zRead, 10)];
-    popPostStreamNxt[idxPop(x, y, 0, 9)] = popPostStreamBase[idxPop(x, y, zRead, 9)];    
-    // pop[11] -> cz = 1; pop[12] -> cz = -1;
-    popPostStreamBase[idxPop(x, y, zMax, 12)] = popPostStreamNxt[idxPop(x, y, zRead, 12)];
-    popPostStreamNxt[idxPop(x, y, 0, 11)] = popPostStreamBase[idxPop(x, y, zRead, 11)];    
-    // pop[16] -> cz = 1; pop[15] -> cz = -1
-    popPostStreamBase[idxPop(x, y, zMax, 15)] = popPostStreamNxt[idxPop(x, y, zRead, 15)];
-    popPostStreamNxt[idxPop(x, y, 0, 16)] = popPostStreamBase[idxPop(x, y, zRead, 16)];    
-    // pop[18] -> cz = 1; pop[17] -> cz = -1
-    popPostStreamBase[idxPop(x, y, zMax, 17)] =   popPostStreamNxt[idxPop(x, y, zRead, 17)];
-    popPostStreamNxt[idxPop(x, y, 0, 18)] = popPostStreamBase[idxPop(x, y, zRead, 18)];
-
-#ifdef D3Q27
-    // pop[19] -> cz = 1; pop[20] -> cz = -1;
-    popPostStreamBase[idxPop(x, y, zMax, 20)] = popPostStreamNxt[idxPop(x, y, zRead, 20)];
-    popPostStreamNxt[idxPop(x, y, 0, 19)] = popPostStreamBase[idxPop(x, y, zRead, 19)];
-
-    // pop[22] -> cz = 1; pop[21] -> cz = -1;
-    popPostStreamBase[idxPop(x, y, zMax, 21)] = popPostStreamNxt[idxPop(x, y, zRead, 21)];
-    popPostStreamNxt[idxPop(x, y, 0, 22)] = popPostStreamBase[idxPop(x, y, zRead, 22)];
-
-    // pop[23] -> cz = 1; pop[24] -> cz = -1;
-    popPostStreamBase[idxPop(x, y, zMax, 24)] = popPostStreamNxt[idxPop(x, y, zRead, 24)];
-    popPostStreamNxt[idxPop(x, y, 0, 23)] = popPostStreamBase[idxPop(x, y, zRead, 23)];
-
-    // pop[25] -> cz = 1; pop[26] -> cz = -1;
-    popPostStreamBase[idxPop(x, y, zMax, 26)] = popPostStreamNxt[idxPop(x, y, zRead, 26)];
-    popPostStreamNxt[idxPop(x, y, 0, 25)] = popPostStreamBase[idxPop(x, y, zRead, 25)];
-    #endif
+    // Populations with cz=-1 go from next to base and with cz=1 from base
+    // to next, unrolled in compile time from the velocity set
+    popTransfer(popPostStreamBase, popPostStreamNxt, x, y, zMax, zRead, zReadM);
 }
\ No newline at end of file
@@ -14,30 +14,93 @@
 
 #include "structs/macroscopics.h"
 #include "structs/macrProc.h"
+#include "structs/populations.h"
 #include "boundaryConditionsHandler.h"
+#include "structs/boundaryConditionsInfo.h"
 #include "NNF/nnf.h"
+#include "spongeLayer.h"
+#include "mapBCPalette.h"
+#include "postColBuffer.h"
+#include "velocitySets/velocitySetUnroll.h"
 
 
 /*
-*   @brief Updates macroscopics and then performs collision and streaming
+*   @brief Updates macroscopics and then performs collision and streaming.
+*          With BULK_TILES, each block is a tile of tileList, and Bulk 
+*          compiles the kernel of bulk tiles, without reading the map
 *   @param pop: populations to use
 *   @param popAux: auxiliary populations to stream to
-*   @param mapBC: boundary conditions map
+*   @param mapBC: boundary conditions map (palette indexes with MAP_BC_PALETTE)
+*   @param tileList: tiles of the blocks (used only with BULK_TILES)
 *   @param macr: macroscopics to use/update
 *   @param save: save macroscopics
 *   @param step: simulation step
+*   @param zFirst: first z plane of the grid (to update only some planes)
 */
+template <bool Bulk>
 __global__
 void gpuMacrCollisionStream(
     dfloat* const pop,
     dfloat* const popAux,
-    NodeTypeMap* const mapBC,
+    MapBC const mapBC,
+    const unsigned int* const tileList,
     Macroscopics const macr,
     bool const save,
-    int const step
+    int const step,
+    int const zFirst
+);
+
+
+/*
+*   @brief Launches gpuMacrCollisionStream for the planes of grid. With 
+*          BULK_TILES, one kernel for bulk tiles and one for mixed tiles
+*   @param pop: populations to use
+*   @param macr: macroscopics to use/update
+*   @param grid: grid of the planes to update (grid.z planes from zFirst)
+*   @param threads: threads of the blocks (N_THREADS in x)
+*   @param stream: stream to launch in
+*   @param save: save macroscopics
+*   @param step: simulation step
+*   @param zFirst: first z plane to update
+*/
+__host__
+void macrCollisionStream(
+    Populations* pop,
+    Macroscopics macr,
+    const dim3 grid,
+    const dim3 threads,
+    const cudaStream_t stream,
+    const bool save,
+    const int step,
+    const int zFirst
+);
+
+
+/*
+*   @brief Classifies the tiles of nodes as bulk, mixed or solid, so bulk 
+*          tiles skip the map in gpuMacrCollisionStream. Must be launched with
+*          the same grid and threads as gpuMacrCollisionStream, after the 
+*          map is built
+*   @param mapBC: boundary conditions map (palette indexes with MAP_BC_PALETTE)
+*   @param tileClass: class of each tile to write
+*/
+__global__
+void gpuBuildTileClass(
+    NodeTypeMap* const mapBC,
+    unsigned char* const tileClass
 );
 
 
+/*
+*   @brief Builds the list of bulk and mixed tiles of the populations, and 
+*          the first tile of each plane, from the classes of the tiles 
+*          (BULK_TILES)
+*   @param pop: populations with tile classes built by gpuBuildTileClass
+*/
+__host__
+void buildTileList(Populations* pop);
+
+
 /*
 *   @brief Update macroscopics of all nodes
 *   @param pop: populations to use
@@ -59,13 +122,121 @@ void gpuUpdateMacr(
 *   @param totalBCNodes: total number of nodes boundary conditions
 */
 __global__
-void gpuApplyBC(NodeTypeMap* mapBC, 
+void gpuApplyBC(MapBC mapBC, 
     dfloat* popPostStream,
     dfloat* popPostCol,
     size_t* idxsBCNodes,
     size_t totalBCNodes
 );
 
+/*
+*   @brief Applies boundary conditions of a group of nodes with same scheme,
+*          direction and geometry, with the scheme given in compile time
+*   @param mapBC: boundary conditions map
+*   @param popPostStream: populations post streaming to update
+*   @param popPostCol: populations post collision to use
+*   @param idxGroupNodes: scalar indexes of group nodes
+*   @param totalGroupNodes: total number of group nodes
+*/
+template <unsigned char SCHEME>
+__global__
+void gpuApplyBCGroup(MapBC mapBC, 
+    dfloat* popPostStream,
+    dfloat* popPostCol,
+    size_t* idxGroupNodes,
+    size_t totalGroupNodes
+);
+
+
+/*
+*   @brief Applies boundary conditions of all groups of nodes, one kernel 
+*          for each group (with BC_GROUPS_TIMING, the kernels are timed)
+*   @param bcInfo: boundary conditions info of the GPU
+*   @param mapBC: boundary conditions map
+*   @param popPostStream: populations post streaming to update
+*   @param popPostCol: populations post collision to use
+*   @param stream: stream to launch the kernels (0 for default stream)
+*/
+__host__
+void applyBCGroups(BoundaryConditionsInfo* bcInfo,
+    MapBC mapBC, 
+    dfloat* popPostStream,
+    dfloat* popPostCol,
+    const cudaStream_t stream
+);
+
+
+/*
+*   @brief Applies all boundary conditions of the GPU: its groups of nodes 
+*          (BC_GROUPS) or all its nodes and the outflow ones, then the links
+*          of interpolated bounce back. Asynchronous
+*   @param bcInfo: boundary conditions info of the GPU
+*   @param pop: populations of the GPU, post streaming in popAux
+*   @param gridBC: grid of gpuApplyBC (without BC_GROUPS)
+*   @param stream: stream to launch the kernels (0 for default stream)
+*/
+__host__
+void applyBC(BoundaryConditionsInfo* bcInfo,
+    Populations* pop,
+    const dim3 gridBC,
+    const cudaStream_t stream
+);
+
+
+/*
+*   @brief Applies interpolated bounce back, one thread for each link cut by 
+*          the wall, with the wall distances evaluated in setup
+*   @param popPostStream: populations post streaming to update
+*   @param popPostCol: populations post collision to use
+*   @param idxLinks: links of interpolated bounce back (idxScalar*Q + population)
+*   @param qLinks: wall distances of the links
+*   @param totalLinks: total number of links
+*/
+__global__
+void gpuApplyInterpBB(
+    dfloat* popPostStream,
+    dfloat* popPostCol,
+    size_t* idxLinks,
+    float* qLinks,
+    size_t totalLinks
+);
+
+/*
+*   @brief Applies outflow boundary conditions, one thread for each outflow 
+*          node, with the values of previous step in the outflow buffer
+*   @param mapBC: boundary conditions map
+*   @param popPostStream: populations post streaming to update
+*   @param idxOutflowNodes: scalar indexes of outflow nodes
+*   @param popOutflowPrev: values of previous step of the outflow nodes
+*   @param strideOutflowPrev: stride between values of a node in buffer
+*   @param totalOutflowNodes: total number of outflow nodes
+*/
+__global__
+void gpuApplyOutflowBC(MapBC mapBC,
+    dfloat* popPostStream,
+    size_t* idxOutflowNodes,
+    dfloat* popOutflowPrev,
+    size_t strideOutflowPrev,
+    size_t totalOutflowNodes
+);
+
+/*
+*   @brief Initializes the values of previous step of outflow nodes from 
+*          the populations
+*   @param mapBC: boundary conditions map
+*   @param pop: populations to use
+*   @param idxOutflowNodes: scalar indexes of outflow nodes
+*   @param popOutflowPrev: values of previous step of the outflow nodes
+*   @param totalOutflowNodes: total number of outflow nodes
+*/
+__global__
+void gpuInitOutflowBC(MapBC mapBC,
+    dfloat* pop,
+    size_t* idxOutflowNodes,
+    dfloat* popOutflowPrev,
+    size_t totalOutflowNodes
+);
+
 /*
 *   @brief Transfers populations from one GPU to another, with the plane dividing
 *       both domains being between the lower level (z=0) of the population "base"
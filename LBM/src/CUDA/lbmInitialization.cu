@@ -49,12 +49,13 @@ __global__
 void gpuInitialization(
     Populations pop,
     Macroscopics macr,
-    float* randomNumbers)
+    float* randomNumbers,
+    int gpuNumber)
 {
     int x = threadIdx.x + blockDim.x * blockIdx.x;
     int y = threadIdx.y + blockDim.y * blockIdx.y;
     int z = threadIdx.z + blockDim.z * blockIdx.z;
-    if (x >= NX || y >= NY || z >= NZ+1)
+    if (x >= NX || y >= NY || z >= NZ+POP_GHOST)
         return;
 
     size_t index = idxScalarWBorder(x, y, z);
@@ -62,7 +63,7 @@ void gpuInitialization(
     dfloat rho, ux, uy, uz;
     // Is inside physical domain
     if(z < NZ){
-        gpuMacrInitValue(&macr, randomNumbers, x, y, z);
+        gpuMacrInitValue(&macr, randomNumbers, x, y, z, gpuNumber);
         rho = macr.rho[index];
         ux = macr.u.x[index];
         uy = macr.u.y[index];
@@ -94,12 +95,18 @@ __device__
 void gpuMacrInitValue(
     Macroscopics* macr,
     float* randomNumbers,
-    int x, int y, int z)
+    int x, int y, int z,
+    int gpuNumber)
 {
+    // Location in the whole domain
+    const int xDomain = x + decompOrigin(gpuNumber, 0);
+    const int yDomain = y + decompOrigin(gpuNumber, 1);
+    const int zDomain = z + decompOrigin(gpuNumber, 2);
+
     // +MACR_BORDER_NODES because of the ghost nodes
-    macr->rho[idxScalarWBorder(x, y, z)] = RHO_0 + (3.0/16.0)*RHO_0*U_MAX*U_MAX*(cos(2*(x+0.5) / L) + cos(2*(y+0.5) / L))*(cos(2*(z+0.5) / L) + 2.0);
-	macr->u.x[idxScalarWBorder(x, y, z)] = U_MAX * sin((x+0.5) / L) * cos((y+0.5) / L) * cos((z+0.5) / L);
-	macr->u.y[idxScalarWBorder(x, y, z)] = - U_MAX * cos((x+0.5) / L) * sin((y+0.5) / L) * cos((z+0.5) / L);
+    macr->rho[idxScalarWBorder(x, y, z)] = RHO_0 + (3.0/16.0)*RHO_0*U_MAX*U_MAX*(cos(2*(xDomain+0.5) / L) + cos(2*(yDomain+0.5) / L))*(cos(2*(zDomain+0.5) / L) + 2.0);
+	macr->u.x[idxScalarWBorder(x, y, z)] = U_MAX * sin((xDomain+0.5) / L) * cos((yDomain+0.5) / L) * cos((zDomain+0.5) / L);
+	macr->u.y[idxScalarWBorder(x, y, z)] = - U_MAX * cos((xDomain+0.5) / L) * sin((yDomain+0.5) / L) * cos((zDomain+0.5) / L);
 	macr->u.z[idxScalarWBorder(x, y, z)] = 0.0;
 
     #ifdef IBM
@@ -40,12 +40,14 @@ void initializationRandomNumbers(
 *   @param macr: macroscopics to be initialized by "gpuMacrInitValue"
 *   @param randomNumbers: vector of random numbers (size is NX*NY*NZ)
 *                         useful for turbulence 
+*   @param gpuNumber: GPU number
 */
 __global__
 void gpuInitialization(
     Populations pop,
     Macroscopics macr,
-    float* randomNumbers
+    float* randomNumbers,
+    int gpuNumber
 );
 
 
@@ -55,13 +57,15 @@ void gpuInitialization(
 *   @param macr: macroscopics to initialize
 *   @param randomNumbers: vector of random numbers (size is NX*NY*NZ)
 *                         useful for turbulence
-*   @param x, y, z: location
+*   @param x, y, z: location in GPU
+*   @param gpuNumber: GPU number, for the location in the whole domain
 */
 __device__
 void gpuMacrInitValue(
     Macroscopics* macr,
     float* randomNumbers,
-    int x, int y, int z
+    int x, int y, int z,
+    int gpuNumber
 );
 
 
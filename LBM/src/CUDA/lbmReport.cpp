@@ -180,6 +180,16 @@ std::string getSimInfoString(SimInfo* info)
     #ifdef D3Q27
     strSimInfo << "       Velocity set: D3Q27\n";
     #endif // !D3Q27
+    #if POP_HALO_LAYOUT
+    strSimInfo << " Populations layout: halo\n";
+    #else
+    strSimInfo << " Populations layout: modulo\n";
+    #endif
+    #if MAP_BC_PALETTE
+    strSimInfo << "             Map BC: palette (8 bits)\n";
+    #else
+    strSimInfo << "             Map BC: full (32 bits)\n";
+    #endif
     #ifdef SINGLE_PRECISION
         strSimInfo << "          Precision: float\n";
     #else
@@ -188,13 +198,34 @@ std::string getSimInfoString(SimInfo* info)
     strSimInfo << "                 NX: " << NX << "\n";
     strSimInfo << "                 NY: " << NY << "\n";
     strSimInfo << "                 NZ: " << NZ << "\n";
+    strSimInfo << "           NX_TOTAL: " << NX_TOTAL << "\n";
+    strSimInfo << "           NY_TOTAL: " << NY_TOTAL << "\n";
     strSimInfo << "           NZ_TOTAL: " << NZ_TOTAL << "\n";
+    strSimInfo << "      Decomposition: " << DECOMP_PX << "x" << DECOMP_PY << "x" 
+        << DECOMP_PZ << "\n";
+    #if DECOMP_Z_BALANCE
+    strSimInfo << "     Balanced slabs: NZ is the maximum, +" << DECOMP_BALANCE_EXTRA 
+        << "% of uniform\n";
+    #endif
     strSimInfo << std::scientific << std::setprecision(6);
     strSimInfo << "                Tau: " << TAU << "\n";
     strSimInfo << "               Umax: " << U_MAX << "\n";
     strSimInfo << "                 FX: " << FX << "\n";
     strSimInfo << "                 FY: " << FY << "\n";
     strSimInfo << "                 FZ: " << FZ << "\n";
+    #if SPONGE_LAYER
+    strSimInfo << std::setprecision(3);
+    strSimInfo << "       Sponge layer: W " << SPONGE_WIDTH_W << ", E " << SPONGE_WIDTH_E
+        << ", S " << SPONGE_WIDTH_S << ", N " << SPONGE_WIDTH_N << ", B " << SPONGE_WIDTH_B 
+        << ", F " << SPONGE_WIDTH_F << " (sigma max " << SPONGE_SIGMA_MAX << ")\n";
+    strSimInfo << std::setprecision(6);
+    #endif
+    #if GEOMETRY_MESH
+    strSimInfo << "      Geometry mesh: " << GEOMETRY_MESH_FILE << " (scale " << GEOMETRY_MESH_SCALE << ")\n";
+    #endif
+    #if GEOMETRY_CACHE
+    strSimInfo << "     Geometry cache: " << GEOMETRY_CACHE_TAG << " (tag)\n";
+    #endif
     strSimInfo << "       Report steps: " << DATA_REPORT << "\n";
     strSimInfo << "         Save steps: " << MACR_SAVE << "\n";
     strSimInfo << "             Nsteps: " << info->totalSteps << "\n";
@@ -309,7 +340,7 @@ std::string getSimInfoString(SimInfo* info)
     strSimInfo << "\t           IBM_BC_Z_E:"<< IBM_BC_Z_E <<  "\n";
     #endif
     strSimInfo << "--------------------------------- IBM Derivative Properties --------------------\n";
-    constexpr dfloat VolumeConcentration  =  NUM_PARTICLES * ((PARTICLE_DIAMETER/2)*(PARTICLE_DIAMETER/2)*(PARTICLE_DIAMETER/2)*M_PI*4.0/3.0)/(NX*NY*NZ_TOTAL);
+    constexpr dfloat VolumeConcentration  =  NUM_PARTICLES * ((PARTICLE_DIAMETER/2)*(PARTICLE_DIAMETER/2)*(PARTICLE_DIAMETER/2)*M_PI*4.0/3.0)/(NX_TOTAL*NY_TOTAL*NZ_TOTAL);
     constexpr dfloat LengthScale = PARTICLE_DIAMETER;
     constexpr dfloat densityRatio = PARTICLE_DENSITY / FLUID_DENSITY ;
     #ifdef POWERLAW
@@ -381,3 +412,196 @@ void printSimInfo(
 {
     printf(getSimInfoString(info).c_str()); fflush(stdout);
 }
+
+
+void printMemoryBudget()
+{
+    // populations and its halo buffers (send and receive)
+    const size_t memPop = 2*MEM_SIZE_POP + 2*MEM_SIZE_HALO_BUFFER;
+    const size_t memMacr = Macroscopics::macrMemSize(IN_VIRTUAL, MACR_FIELDS_DEVICE);
+    #ifdef IBM
+    // Auxiliary velocities and forces
+    const size_t memIBM = 6*MEM_SIZE_IBM_SCALAR;
+    #else
+    const size_t memIBM = 0;
+    #endif
+    const size_t memSums = (DATA_REDUCTION_GPU ? MEM_SIZE_MACR_PROC_SUMS : 0);
+    const size_t memMap = MEM_SIZE_MAP_BC + MEM_SIZE_TILE_CLASS + MEM_SIZE_TILE_LIST;
+    const size_t memDevice = memPop + memMap + memMacr + memIBM + memSums;
+
+    const size_t memHostCurr = (MACR_HOST_REQUIRED ? 
+        Macroscopics::macrMemSize(IN_HOST, MACR_FIELDS_HOST) : 0);
+    const size_t memHostOld = (MACR_HOST_OLD ? 
+        Macroscopics::macrMemSize(IN_HOST, MACR_FIELDS_HOST) : 0);
+    const size_t memHost = memHostCurr + memHostOld;
+
+    printf("------------------------------- MEMORY BUDGET (MB) -----------------------------\n");
+    printf("       Device (per GPU)\n");
+    printf("            Populations: %12.2f\n", (double)memPop/BYTES_PER_MB);
+    printf("    Boundary conditions: %12.2f\n", (double)memMap/BYTES_PER_MB);
+    printf("           Macroscopics: %12.2f\n", (double)memMacr/BYTES_PER_MB);
+    printf("       IBM macroscopics: %12.2f\n", (double)memIBM/BYTES_PER_MB);
+    printf("      Treated data sums: %12.2f\n", (double)memSums/BYTES_PER_MB);
+    printf("                  Total: %12.2f\n", (double)memDevice/BYTES_PER_MB);
+    printf("         Total all GPUs: %12.2f\n", (double)(memDevice*N_GPUS)/BYTES_PER_MB);
+    printf("       Host\n");
+    printf("   Macroscopics current: %12.2f\n", (double)memHostCurr/BYTES_PER_MB);
+    printf("       Macroscopics old: %12.2f\n", (double)memHostOld/BYTES_PER_MB);
+    printf("                  Total: %12.2f\n", (double)memHost/BYTES_PER_MB);
+    fflush(stdout);
+}
+
+
+void printTilesReport(Populations* pop)
+{
+    #if BULK_TILES
+    unsigned char* hTileClass = (unsigned char*)malloc(MEM_SIZE_TILE_CLASS);
+    size_t nTiles[3] = {0, 0, 0};
+    size_t nNodes[3] = {0, 0, 0};
+
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaMemcpy(hTileClass, pop[i].tileClass, 
+            MEM_SIZE_TILE_CLASS, cudaMemcpyDefault));
+        for(size_t t = 0; t < NUMBER_TILES; t++){
+            // Last tile in x may have less nodes
+            const int tx = t % N_TILES_X;
+            const size_t nodesTile = myMin(N_THREADS, NX - tx*N_THREADS);
+            nTiles[hTileClass[t]]++;
+            nNodes[hTileClass[t]] += nodesTile;
+        }
+    }
+    free(hTileClass);
+    // Tiles of the GPUs of the other processes
+    mpiSumAll(nTiles, 3);
+    mpiSumAll(nNodes, 3);
+    if(!isRootProcess()){
+        return;
+    }
+
+    // Bulk and solid tiles do not read the map, bulk and mixed tiles read 
+    // its index in the list
+    const size_t bytesSaved = (nNodes[TILE_BULK] + nNodes[TILE_SOLID])*sizeof(NodeTypeMap);
+    const size_t bytesTiles = (nTiles[TILE_BULK] + nTiles[TILE_MIXED])*sizeof(unsigned int);
+
+    printf("------------------------------- TILES (ALL GPUS) -------------------------------\n");
+    printf("                   Bulk: %12lu tiles (%6.2f%% of nodes)\n", nTiles[TILE_BULK], 
+        100.0*nNodes[TILE_BULK]/TOTAL_NUMBER_LBM_NODES);
+    printf("                  Mixed: %12lu tiles (%6.2f%% of nodes)\n", nTiles[TILE_MIXED], 
+        100.0*nNodes[TILE_MIXED]/TOTAL_NUMBER_LBM_NODES);
+    printf("                  Solid: %12lu tiles (%6.2f%% of nodes)\n", nTiles[TILE_SOLID], 
+        100.0*nNodes[TILE_SOLID]/TOTAL_NUMBER_LBM_NODES);
+    printf("  Map traffic saved (MB/step): %8.2f (tiles list read: %.2f)\n",
+        (double)bytesSaved/BYTES_PER_MB, (double)bytesTiles/BYTES_PER_MB);
+    fflush(stdout);
+    #endif
+}
+
+
+/*
+*   @brief Name of boundary condition scheme
+*   @param scheme: scheme define
+*   @return scheme name
+*/
+const char* bcSchemeName(const unsigned char scheme)
+{
+    switch(scheme)
+    {
+    #ifdef BC_SCHEME_VEL_ZOUHE
+    case BC_SCHEME_VEL_ZOUHE: return "vel Zou-He";
+    #endif
+    #ifdef BC_SCHEME_VEL_BOUNCE_BACK
+    case BC_SCHEME_VEL_BOUNCE_BACK: return "vel bounce back";
+    #endif
+    #ifdef BC_SCHEME_PRES_ZOUHE
+    case BC_SCHEME_PRES_ZOUHE: return "pres Zou-He";
+    #endif
+    #ifdef BC_SCHEME_FREE_SLIP
+    case BC_SCHEME_FREE_SLIP: return "free slip";
+    #endif
+    #ifdef BC_SCHEME_BOUNCE_BACK
+    case BC_SCHEME_BOUNCE_BACK: return "bounce back";
+    #endif
+    #ifdef BC_SCHEME_SYMMETRY
+    case BC_SCHEME_SYMMETRY: return "symmetry";
+    #endif
+    #ifdef BC_SCHEME_OUTFLOW_CONVECTIVE
+    case BC_SCHEME_OUTFLOW_CONVECTIVE: return "convective outflow";
+    #endif
+    #ifdef BC_SCHEME_OUTFLOW_NON_REFLECTING
+    case BC_SCHEME_OUTFLOW_NON_REFLECTING: return "non reflecting outflow";
+    #endif
+    case BC_SCHEME_SPECIAL: return "special";
+    default: return "unknown";
+    }
+}
+
+
+void printBCGroupsReport(BoundaryConditionsInfo* bcInfos, const int stepsTimed)
+{
+    printf("------------------------- BOUNDARY CONDITIONS GROUPS ---------------------------\n");
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        printf("  GPU %d: %lu nodes in %u groups\n", i, bcInfos[i].totalBCNodes,
+            bcInfos[i].totalBCGroups);
+        for(unsigned int g = 0; g < bcInfos[i].totalBCGroups; g++){
+            const BCGroup* group = &(bcInfos[i].bcGroups[g]);
+            printf("    %-18s dir %2d geo %d: %10lu nodes", bcSchemeName(group->scheme), 
+                group->direction, group->geometry, group->count);
+            #if BC_GROUPS_TIMING
+            if(stepsTimed > 0)
+                printf(" %10.4f ms/step", group->timeElapsed/stepsTimed);
+            #endif
+            printf("\n");
+        }
+    }
+    fflush(stdout);
+}
+
+
+void printHaloOverlapReport(const double timeTransfer, const double timeHidden, 
+    const int stepsTimed)
+{
+    printf("------------------------------- HALO OVERLAP -----------------------------------\n");
+    if(stepsTimed <= 0 || timeTransfer <= 0){
+        printf("  No transfer timed\n");
+        fflush(stdout);
+        return;
+    }
+    printf("  Transfer: %10.4f ms/step\n", timeTransfer/stepsTimed);
+    printf("  Hidden:   %10.4f ms/step (%.1f%% overlap)\n", timeHidden/stepsTimed, 
+        100*timeHidden/timeTransfer);
+    fflush(stdout);
+}
+
+
+void printDecompositionReport(const int nLinks, const size_t totalCount)
+{
+    printf("---------------------------- DOMAIN DECOMPOSITION ------------------------------\n");
+    printf("  Partitions (x, y, z): %d x %d x %d, each %d x %d x %d nodes\n",
+        DECOMP_PX, DECOMP_PY, DECOMP_PZ, NX, NY, NZ);
+    printf("  Links to neighbors:   %d\n", nLinks);
+    printf("  Halo per GPU:         %zu populations (%.3f MB)\n", totalCount,
+        totalCount*sizeof(dfloat)/1e6);
+    fflush(stdout);
+}
+
+
+void printDecompBalanceReport(const size_t slabWork[N_GPUS])
+{
+    size_t totalWork = 0;
+    size_t maxWork = 0;
+    for(int i = 0; i < N_GPUS; i++){
+        totalWork += slabWork[i];
+        maxWork = (slabWork[i] > maxWork) ? slabWork[i] : maxWork;
+    }
+    const double meanWork = (double)totalWork/N_GPUS;
+
+    printf("---------------------------- BALANCED Z SLABS ----------------------------------\n");
+    for(int i = 0; i < N_GPUS; i++){
+        printf("  GPU %d: planes %5d to %5d (%5d planes), work %14zu\n", i,
+            decompOrigin(i, 2), decompOrigin(i, 2)+decompNZ(i)-1, decompNZ(i), 
+            slabWork[i]);
+    }
+    if(meanWork > 0)
+        printf("  Imbalance (max/mean): %.2f%%\n", 100.0*maxWork/meanWork);
+    fflush(stdout);
+}
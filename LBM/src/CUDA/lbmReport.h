@@ -18,9 +18,12 @@
 #include "globalFunctions.h"
 #include "errorDef.h"
 #include "structs/macroscopics.h"
+#include "structs/macrProc.h"
 #include "structs/populations.h"
 #include "structs/simInfo.h"
+#include "structs/boundaryConditionsInfo.h"
 #include "IBM/ibmVar.h"
+#include "mpiBackend.h"
 
 
 
@@ -111,4 +114,64 @@ void printSimInfo(
 );
 
 
+/*
+*   Print memory budget of the simulation, in device (per GPU) and in host.
+*   Host macroscopics are lazily allocated, so they are the maximum used
+*/
+void printMemoryBudget();
+
+
+/*
+*   Print the classification of tiles of nodes (BULK_TILES) of all GPUs and
+*   the boundary conditions map traffic saved per step by bulk and solid tiles
+*
+*   @param pop: populations of each GPU, with tiles already classified
+*/
+void printTilesReport(Populations* pop);
+
+
+
+/*
+*   Print the groups of boundary conditions nodes (same scheme, direction and
+*   geometry) of all GPUs, with the number of nodes and, with BC_GROUPS_TIMING,
+*   the mean time of each group per step
+*
+*   @param bcInfos: boundary conditions info of each GPU
+*   @param stepsTimed: number of steps timed (0 to print only the nodes)
+*/
+void printBCGroupsReport(BoundaryConditionsInfo* bcInfos, const int stepsTimed);
+
+
+/*
+*   Print the overlap of the transfer of populations between GPUs with the
+*   update of the interior planes (HALO_OVERLAP), as the percentage of the 
+*   transfer time hidden by the interior update
+*
+*   @param timeTransfer: total time of transfer, in ms
+*   @param timeHidden: total time of transfer concurrent with interior, in ms
+*   @param stepsTimed: number of steps timed
+*/
+void printHaloOverlapReport(const double timeTransfer, const double timeHidden, 
+    const int stepsTimed);
+
+
+/*
+*   Print the partitions of the grid among the GPUs and the populations 
+*   crossing each partition in a step
+*
+*   @param nLinks: number of neighbor partitions sent to
+*   @param totalCount: populations sent by each GPU in a step
+*/
+void printDecompositionReport(const int nLinks, const size_t totalCount);
+
+
+/*
+*   Print the z slabs balanced by the work of their planes (DECOMP_Z_BALANCE),
+*   with the planes and work of each GPU and the imbalance, as the percentage
+*   of the maximum work over the mean work
+*
+*   @param slabWork: work of the slab of each GPU
+*/
+void printDecompBalanceReport(const size_t slabWork[N_GPUS]);
+
 #endif // __LBM_REPORT_H
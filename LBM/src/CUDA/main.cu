@@ -25,19 +25,32 @@
 #include <cuda_runtime.h>
 
 #include "treatData.h"
+#include "treatDataGPU.h"
 #include "lbmReport.h"
 #include "lbm.h"
+#include "popHalo.h"
+#include "memArena.h"
 #include "lbmInitialization.h"
 #include "simCheckpoint.h"
 #include "boundaryConditionsBuilder.h"
+#include "geometryMesh.h"
+#include "geometryCache.h"
 #include "structs/boundaryConditionsInfo.h"
+#include "bcInfoCompaction.h"
+#include "haloOverlap.h"
+#include "haloPack.h"
+#include "mpiBackend.h"
+#include "decompBalance.h"
+#include "partitionDevices.h"
+#include "stepGraph.h"
 
 #include "IBM/ibm.h"
 #include "IBM/ibmParticlesCreation.h"
 #include "IBM/ibmTreatData.h"
+#include "IBM/ibmMovingFrame.h"
 
 
-int main()
+int main(int argc, char* argv[])
 {
     // Variables declaration
     Populations* pop;
@@ -55,13 +68,20 @@ int main()
     ParticlesSoA particlesSoA;
     Particle particles[NUM_PARTICLES];
     ParticleEulerNodesUpdate pEulerNodes;
+    IBMMovingFrame movingFrame;
 
     IBMProc ibmProcessData;
     IBMMacrsAux ibmMacrsAux;
+    IBMBorderBuffers ibmBorder[N_GPUS];
     #ifdef IBM
     allocateIBMProc(&ibmProcessData);
     #endif
 
+    // One process for each GPU with MPI_BACKEND
+    mpiBackendInit(&argc, &argv);
+    // Device of each GPU, from arguments or GPUS_TO_USE_DEFAULT
+    partitionDevicesSetup(argc, argv);
+
     // Setup saving folder
     folderSetup();
 
@@ -70,22 +90,16 @@ int main()
     processData.macrCurr = &macrCPUCurrent;
     processData.macrOld = &macrCPUOld;
     
-    // Number of devices
-    checkCudaErrors(cudaGetDeviceCount(&info.numDevices));
-    // if(N_GPUS > info.numDevices){
-    //     printf("N_GPUS is higher than the number of detected GPUS\n");
-    //     printf("N_GPUS: %d\n", N_GPUS);
-    //     printf("Number of devices: %d\n", info.numDevices);
-    //     return -1;
-    // }
+    // Number of GPUs, the devices of them are checked by partitionDevicesSetup
     info.numDevices = N_GPUS;
 
     /* ------------------------- ALLOCATION FOR CPU ------------------------- */
+    // Reserve memory arenas of each GPU and of host
+    memArenaSetup();
     info.devices = (cudaDeviceProp*) malloc(sizeof(cudaDeviceProp)*N_GPUS);
     bcInfos = (BoundaryConditionsInfo*) malloc(sizeof(BoundaryConditionsInfo)*N_GPUS);
     gridsBC = (dim3*) malloc(sizeof(dim3)*N_GPUS);
-    macrCPUCurrent.macrAllocation(IN_HOST);
-    macrCPUOld.macrAllocation(IN_HOST);
+    // Host macroscopics are only allocated in their first use
     pop = (Populations*) malloc(sizeof(Populations) * N_GPUS);
     macr = (Macroscopics*) malloc(sizeof(Macroscopics) * N_GPUS);
     randomNumbers = (float**)malloc(sizeof(float*) * N_GPUS);
@@ -98,7 +112,7 @@ int main()
     cudaStream_t streamsIBM[N_GPUS];
     #endif
 
-    for(int i = 0; i < N_GPUS; i++)
+    for(int i = gpuBegin(); i < gpuEnd(); i++)
     {
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
         checkCudaErrors(cudaGetDeviceProperties(&(info.devices[i]), GPUS_TO_USE[i]));
@@ -109,29 +123,61 @@ int main()
         #endif
 
         pop[i].popAllocation();
-        macr[i].macrAllocation(IN_VIRTUAL);
+        macr[i].macrAllocation(IN_VIRTUAL, MACR_FIELDS_DEVICE);
         if(RANDOM_NUMBERS)
         {
-            checkCudaErrors(cudaMallocManaged((void**)&randomNumbers[i], 
-                sizeof(float)*NUMBER_LBM_NODES));
+            randomNumbers[i] = (float*)simMalloc(sizeof(float)*NUMBER_LBM_NODES, IN_VIRTUAL);
             initializationRandomNumbers(randomNumbers[i], CURAND_SEED);
             checkCudaErrors(cudaDeviceSynchronize());
             getLastCudaError("random numbers transfer error");
         }
     }
+    // Devices of the GPUs of the other processes, for the report
+    mpiGatherDevices(info.devices);
+    processData.allocateMacrProc();
     getLastCudaError("LBM setup error");
     /* ---------------------------------------------------------------------- */
 
+    // Geometry built in a previous run with the same configuration
+    GeometryCache geometryCache;
+    #if GEOMETRY_CACHE
+    geometryCacheSetup(&geometryCache);
+    #endif
+
+    #if DECOMP_Z_BALANCE
+    // Balanced slabs of the cached geometry, otherwise uniform slabs until
+    // the map is built
+    int zStart[N_GPUS+1];
+    size_t slabWork[N_GPUS] = {0};
+    if(!geometryCacheLoadDecomp(&geometryCache, zStart))
+        decompBalanceUniform(zStart);
+    decompBalanceSet(zStart);
+    #endif
+
     /* ------------------ IBM ALLOCATION AND CONFIGURATION ------------------ */
     #ifdef IBM
     printf("-------------------------------- IBM INFORMATION -------------------------------\n");
 
-    printf("Creating particles...\t"); fflush(stdout);
-    createParticles(particles);
-    printf("Particles created!\n"); fflush(stdout);
+    if(geometryCacheLoadParticles(&geometryCache, particles)){
+        if(isRootProcess()){
+            printf("Particles loaded from geometry cache\n"); fflush(stdout);
+        }
+    }
+    else{
+        printf("Creating particles...\t"); fflush(stdout);
+        createParticles(particles);
+        printf("Particles created!\n"); fflush(stdout);
+        geometryCacheStoreParticles(&geometryCache, particles);
+    }
 
     particlesSoA.updateParticlesAsSoA(particles);
     ibmMacrsAux.ibmMacrsAuxAllocation();
+    #if IBM_MOVING_FRAME
+    movingFrameSetup(&movingFrame, particlesSoA);
+    #endif
+    #if IBM_BORDER_PACK
+    ibmBorderBuffersAllocation(ibmBorder);
+    #endif
     getLastCudaError("IBM setup error");
 
     ibmProcessData.step = &step;
@@ -147,35 +193,226 @@ int main()
     // Grid and threads for memory transfers in multiGPUS
     dim3 gridTransfer(grid.x, grid.y, 1);
     dim3 threadsTransfer(N_THREADS, 1, 1);
+    #if POP_HALO_LAYOUT
+    // Grid for periodic faces of populations halo
+    dim3 gridHalo((N_HALO_PERIMETER+N_THREADS-1)/N_THREADS, N_HALO_PLANES, 1);
+    dim3 threadsHalo(N_THREADS, 1, 1);
+    #endif
     /* ---------------------------------------------------------------------- */
 
     /* ------------------------------- REPORT ------------------------------- */
-    printSimInfo(&info);
-    saveSimInfo(&info);
+    if(isRootProcess()){
+        printSimInfo(&info);
+        saveSimInfo(&info);
+        printMemoryBudget();
+    }
     /* ---------------------------------------------------------------------- */
 
 
     /* ----------------- BOUNDARY CONDITIONS INITIALIZATION ----------------- */
-    // Divide in two fors to allow kernels of "gpuBuilBoundaryConditions"
-    // to run in parallel. Otherwise they would run sequentially
-    for(int i = 0; i < N_GPUS; i++){
+    // Full map (32 bits per node) to build boundary conditions. With palette,
+    // it is built in auxiliary populations, not initialized yet
+    NodeTypeMap* mapBCFull[N_GPUS];
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        #if MAP_BC_PALETTE
+        mapBCFull[i] = (NodeTypeMap*)pop[i].popAux;
+        #else
+        mapBCFull[i] = pop[i].mapBC;
+        #endif
+    }
+
+    // Map and boundary conditions info from geometry cache, if all GPUs of
+    // the process are in it. Otherwise they are built. The arenas are marked,
+    // so the arrays loaded are carved again if the cache is not used
+    MemArenaMark bcArenaMarks[N_GPUS];
+    memArenaMarkDevices(bcArenaMarks);
+    int nBCCached = gpuBegin();
+    while(nBCCached < gpuEnd()){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[nBCCached]));
+        if(!geometryCacheLoadBC(&geometryCache, nBCCached, mapBCFull[nBCCached], &bcInfos[nBCCached]))
+            break;
+        nBCCached++;
+    }
+    size_t nNotCached = gpuEnd()-nBCCached;
+    #if DECOMP_Z_BALANCE
+    // Slabs are balanced with the planes of all processes, so all of them 
+    // build the map if any is not cached
+    mpiSumAll(&nNotCached, 1);
+    #endif
+    const bool bcCached = (nNotCached == 0);
+    if(bcCached){
+        if(isRootProcess()){
+            printf("Boundary conditions loaded from geometry cache\n"); fflush(stdout);
+        }
+    }
+    else{
+        // GPUs already loaded are built again
+        for(int i = gpuBegin(); i < nBCCached; i++){
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            bcInfos[i].freeInterpBBLinks();
+            bcInfos[i].freeIdxBC();
+        }
+        memArenaReleaseDevices(bcArenaMarks);
+    }
+
+    #if GEOMETRY_MESH
+    // Mesh to voxelize over the built map of each GPU, in host
+    InterpBBWallDist meshWallDist[N_GPUS];
+    TriangleMesh mesh;
+    MeshBVH meshBVH;
+    if(!bcCached){
+        if(!meshLoad(GEOMETRY_MESH_FILE, &mesh)){
+            printf("Unable to load geometry mesh %s\n", GEOMETRY_MESH_FILE);
+            mpiBackendAbort(-1);
+        }
+        meshTransform(&mesh, GEOMETRY_MESH_SCALE, dfloat3(GEOMETRY_MESH_OFFSET_X,
+            GEOMETRY_MESH_OFFSET_Y, GEOMETRY_MESH_OFFSET_Z));
+        meshBVH.build(&mesh);
+    }
+    #endif
+
+    // With DECOMP_Z_BALANCE, the map is built with the current slabs, which
+    // are then balanced by its work and the map is built again if they changed
+    bool buildMap = !bcCached;
+    for(int pass = 0; buildMap; pass++){
+        // Divide in two fors to allow kernels of "gpuBuilBoundaryConditions"
+        // to run in parallel. Otherwise they would run sequentially
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            gpuBuildBoundaryConditions<<<grid, threads>>>(mapBCFull[i], i);
+        }
+        for (int i = gpuBegin(); i < gpuEnd(); i++) {
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            cudaDeviceSynchronize();
+        }
+        getLastCudaError("Initialization error");
+
+        #if GEOMETRY_MESH
+        NodeTypeMap* hMapBCMesh;
+        checkCudaErrors(cudaMallocHost((void**)(&hMapBCMesh), MEM_SIZE_MAP_BC_FULL));
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
+            checkCudaErrors(cudaMemcpy(hMapBCMesh, mapBCFull[i], MEM_SIZE_MAP_BC_FULL, cudaMemcpyDefault));
+            meshVoxelize(meshBVH, hMapBCMesh, i, &meshWallDist[i]);
+            checkCudaErrors(cudaMemcpy(mapBCFull[i], hMapBCMesh, MEM_SIZE_MAP_BC_FULL, cudaMemcpyDefault));
+            printf("Geometry mesh GPU %d: %zu boundary nodes\n", i, meshWallDist[i].idxNodes.size());
+        }
+        cudaFreeHost(hMapBCMesh);
+        printf("Geometry mesh %s: %zu triangles, bounding box (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f)\n",
+            GEOMETRY_MESH_FILE, mesh.tris.size(), mesh.bbMin.x, mesh.bbMin.y, mesh.bbMin.z,
+            mesh.bbMax.x, mesh.bbMax.y, mesh.bbMax.z);
+        fflush(stdout);
+        #endif
+
+        #if SPONGE_LAYER
+        // After the geometry, so only nodes without boundary condition are sponge
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            gpuBuildSpongeLayer<<<grid, threads>>>(mapBCFull[i], i);
+        }
+        for (int i = gpuBegin(); i < gpuEnd(); i++) {
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            cudaDeviceSynchronize();
+        }
+        getLastCudaError("Sponge layer error");
+        #endif
+
+        buildMap = false;
+        #if DECOMP_Z_BALANCE
+        if(pass == 0)
+            buildMap = decompBalanceSlabs(mapBCFull, grid, threads, slabWork);
+        #endif
+    }
+
+    #if DECOMP_Z_BALANCE
+    if(!bcCached){
+        // Planes after the slab of each GPU are not used
+        decompBalanceClearMaps(mapBCFull, grid, threads);
+        geometryCacheStoreDecomp(&geometryCache, decompZStart);
+        if(isRootProcess())
+            printDecompBalanceReport(slabWork);
+    }
+    #endif
+
+    #if BULK_TILES
+    // Classify tiles of nodes, so bulk tiles run the LBM kernel without map
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
-        gpuBuildBoundaryConditions<<<grid, threads>>>(pop[i].mapBC, i);
+        gpuBuildTileClass<<<grid, threads>>>(mapBCFull[i], pop[i].tileClass);
     }
-    for (int i = 0; i < N_GPUS; i++) {
+    for (int i = gpuBegin(); i < gpuEnd(); i++) {
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
         cudaDeviceSynchronize();
     }
-    getLastCudaError("Initialization error");
+    getLastCudaError("Tiles classification error");
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        buildTileList(&pop[i]);
+    }
+    printTilesReport(pop);
+    #endif
 
-    // Build auxiliary informations of boundary conditions for each GPU
+    // Build auxiliary informations of boundary conditions for each GPU.
+    // The map is copied to host only if it is required there
+    #if MAP_BC_IN_HOST
     NodeTypeMap* hMapBC;
-    checkCudaErrors(cudaMallocHost((void**)(&hMapBC), MEM_SIZE_MAP_BC));
-    for(int i = 0; i < N_GPUS; i++){
-        checkCudaErrors(cudaMemcpy(hMapBC, pop[i].mapBC, MEM_SIZE_MAP_BC, cudaMemcpyDefault));
-        bcInfos[i].setupBoundaryConditionsInfo(hMapBC);
+    checkCudaErrors(cudaMallocHost((void**)(&hMapBC), MEM_SIZE_MAP_BC_FULL));
+    #endif
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        #if MAP_BC_IN_HOST
+        checkCudaErrors(cudaMemcpy(hMapBC, mapBCFull[i], MEM_SIZE_MAP_BC_FULL, cudaMemcpyDefault));
+        #endif
+        if(!bcCached){
+            #if BC_INFO_DEVICE
+            setupBoundaryConditionsInfoDevice(&bcInfos[i], mapBCFull[i]);
+            #else
+            bcInfos[i].setupBoundaryConditionsInfo(hMapBC);
+            #endif
+            // Wall distances of interpolated bounce back, evaluated only once
+            #if GEOMETRY_MESH
+            bcInfos[i].setupInterpBBLinks(&meshWallDist[i]);
+            #elif GEOMETRY_SDF
+            InterpBBWallDist sdfWallDist;
+            interpBBWallDistSDF(hMapBC, i, builderSignedDistance, &sdfWallDist);
+            bcInfos[i].setupInterpBBLinks(&sdfWallDist);
+            #endif
+            geometryCacheStoreBC(&geometryCache, i, mapBCFull[i], &bcInfos[i]);
+        }
+        // Buffer of outflow nodes, not stored in cache
+        bcInfos[i].setupOutflowBC();
+        // Links of symmetry, from the final partitions
+        #ifdef BC_SCHEME_SYMMETRY
+        setupSymmetryLinks(&bcInfos[i], mapBCFull[i], grid, threads, i);
+        #endif
+        // Buffer of post collision populations, from the full map
+        #if BC_POST_COL_BUFFER
+        setupPostColBufferDevice(&bcInfos[i], mapBCFull[i]);
+        postColBufferUpload(bcInfos[i].popPostColBC, bcInfos[i].slotPostCol, 
+            bcInfos[i].totalPostColNodes);
+        printf("Post collision buffer GPU %d: %zu nodes\n", i, bcInfos[i].totalPostColNodes);
+        #endif
+        #if GEOMETRY_MESH || GEOMETRY_SDF
+        printf("Interpolated bounce back GPU %d: %zu links\n", i, bcInfos[i].totalInterpBBLinks);
+        #endif
+        #if MAP_BC_PALETTE
+        // Palette is shared by all GPUs, so previous indexes are still valid
+        mapBCPaletteBuild(mapBCFull[i], pop[i].mapBC.idx);
+        #endif
     }
+    #if MAP_BC_IN_HOST
     cudaFreeHost(hMapBC);
+    #endif
+    #if MAP_BC_PALETTE
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        mapBCPaletteUpload();
+    }
+    printf("Boundary conditions map palette: %u node types\n", mapBCPaletteSize());
+    fflush(stdout);
+    #endif
+    #if BC_GROUPS
+    printBCGroupsReport(bcInfos, 0);
+    #endif
     /* ---------------------------------------------------------------------- */
 
     /* ------------------------- LBM INITIALIZATION ------------------------- */
@@ -189,49 +426,104 @@ int main()
         step = INI_STEP;
         dim3 gridInit = grid;
         // Initialize ghost nodes
-        gridInit.z += 1;
-        for(int i = 0; i < N_GPUS; i++){
+        gridInit.z += POP_GHOST;
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
             // Initialize populations
-            gpuInitialization<<<gridInit, threads>>>(pop[i], macr[i], randomNumbers[i]);
+            gpuInitialization<<<gridInit, threads>>>(pop[i], macr[i], randomNumbers[i], i);
             checkCudaErrors(cudaDeviceSynchronize());
         }
         getLastCudaError("Initialization error");
     }
+    // Outflow values of previous step, from initial or loaded populations
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        if(bcInfos[i].totalOutflowNodes <= 0)
+            continue;
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        gpuInitOutflowBC<<<(unsigned int)((bcInfos[i].totalOutflowNodes+31)/32), 32>>>
+            (pop[i].mapBC, pop[i].pop, bcInfos[i].idxBCNodes + bcInfos[i].firstOutflowNode,
+            bcInfos[i].popOutflowPrev, bcInfos[i].totalOutflowNodes);
+        checkCudaErrors(cudaDeviceSynchronize());
+        getLastCudaError("Outflow initialization error");
+    }
     int first_step = step;
     /* ---------------------------------------------------------------------- */
 
     // Initialize Euler nodes for optimization
+    // Euler nodes in cache are from created particles, not from checkpoint
     #if IBM_EULER_OPTIMIZATION
-    pEulerNodes.initializeEulerNodes(particlesSoA.pCenterArray);
+    if(LOAD_CHECKPOINT || !geometryCacheLoadEulerNodes(&geometryCache, &pEulerNodes, 
+            particlesSoA.pCenterArray)){
+        pEulerNodes.initializeEulerNodes(particlesSoA.pCenterArray);
+        if(!LOAD_CHECKPOINT)
+            geometryCacheStoreEulerNodes(&geometryCache, &pEulerNodes);
+    }
     #endif
 
-    for(int i = 0; i < N_GPUS; i++){
+    // Geometry is only cached in first run with this configuration
+    geometryCacheSave(&geometryCache);
+    geometryCacheFree(&geometryCache);
+
+    // Memory footprint, after all arrays are allocated
+    memArenaReport();
+
+    #if MACR_HOST_OLD
+    macrCPUCurrent.macrAllocationLazy(IN_HOST, MACR_FIELDS_HOST);
+    macrCPUOld.macrAllocationLazy(IN_HOST, MACR_FIELDS_HOST);
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
-        size_t baseIdx = i*NUMBER_LBM_NODES;
-        macrCPUCurrent.copyMacr(&macr[i], baseIdx, 0, false);
+        macrCPUCurrent.copyMacrPartition(&macr[i], i);
         checkCudaErrors(cudaDeviceSynchronize());
     }
     macrCPUOld.copyMacr(&macrCPUCurrent, 0, 0, true);
+    #endif
 
-    // Grid and thread definition for boundary conditions
-    for(int i = 0; i < N_GPUS; i++)
+    // Grid definition for boundary conditions (32 threads in block)
+    for(int i = gpuBegin(); i < gpuEnd(); i++)
         gridsBC[i] = dim3(((bcInfos[i].totalBCNodes%32)? (bcInfos[i].totalBCNodes/32+1) : 
                 (bcInfos[i].totalBCNodes/32)), 1, 1); // TODO
 
-    dim3 threadsBC(32, 1, 1);
+    // Neighbors of each partition and packed buffers of populations 
+    // crossing the GPUs
+    DomainDecomposition decomp;
+    domainDecompositionSetup(&decomp);
+    if(isRootProcess())
+        printDecompositionReport(decomp.nLinks, decomp.totalCount);
+    HaloBuffers haloBuffers[N_GPUS];
+    #if POP_PACKED_HALO
+    for(int i = gpuBegin(); i < gpuEnd() && N_GPUS > 1; i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        haloBuffersAllocation(&haloBuffers[i], &decomp);
+    }
+    #endif
+
+    #if HALO_OVERLAP
+    HaloOverlap haloOverlap;
+    haloOverlapSetup(&haloOverlap);
+    #endif
+
+    #if STEP_GRAPH
+    // Graphs of the step, recorded in the first steps
+    StepGraph stepGraph;
+    stepGraphSetup(&stepGraph);
+    #if HALO_OVERLAP
+    HaloOverlap* stepOverlap = &haloOverlap;
+    #else
+    HaloOverlap* stepOverlap = nullptr;
+    #endif
+    #endif
 
     // Free random numbers
     if (RANDOM_NUMBERS) {
-        for (int i = 0; i < N_GPUS; i++) {
+        for (int i = gpuBegin(); i < gpuEnd(); i++) {
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
-            cudaFree(randomNumbers[i]);
+            simFree(randomNumbers[i], IN_VIRTUAL);
         }
         free(randomNumbers);
     }
 
     // Timing
-    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
     cudaEvent_t start, stop, start_step, stop_step;
     int last_step_sync = step;
     checkCudaErrors(cudaEventCreate(&start));
@@ -269,12 +561,39 @@ int main()
         save_macr_to_array = rep || save || repIBM || ((step+1)>=(int)N_STEPS);
         #endif
 
+        #if STEP_GRAPH
+        // LBM solver, transfer and boundary conditions of all GPUs, from the
+        // graph of the step
+        stepGraphLaunch(&stepGraph, stepOverlap, haloBuffers, &decomp, pop, macr,
+            bcInfos, gridsBC, grid, threads, gridTransfer, threadsTransfer, 
+            save_macr_to_array, step);
+        // Only synchronized when the step is used by host or by kernels out
+        // of the graph (IBM)
+        #ifdef IBM
+        stepGraphSync(&stepGraph);
+        #else
+        if(save || rep || checkpoint || (step+1) >= (int)N_STEPS)
+            stepGraphSync(&stepGraph);
+        #endif
+        for(int i = gpuBegin(); i < gpuEnd(); i++)
+            pop[i].swapPop();
+        #else
+        #if HALO_OVERLAP
+        // LBM solver, with the transfer of the border planes overlapped 
+        // with the interior update
+        haloOverlapStep(&haloOverlap, haloBuffers, &decomp, pop, macr, grid, threads, 
+            gridTransfer, threadsTransfer, save_macr_to_array, step);
+        for(int i = gpuBegin(); i < gpuEnd(); i++) {
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            checkCudaErrors(cudaDeviceSynchronize());
+        }
+        haloOverlapUpdateTime(&haloOverlap);
+        #else
         // LBM solver
-        for(int i = 0; i < N_GPUS; i++){
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
-            gpuMacrCollisionStream<<<grid, threads>>>
-                (pop[i].pop, pop[i].popAux, pop[i].mapBC, macr[i],
-                save_macr_to_array, step);
+            macrCollisionStream(&pop[i], macr[i], grid, threads, 0, 
+                save_macr_to_array, step, 0);
             //checkCudaErrors(cudaDeviceSynchronize());
             getLastCudaError("LBM kernel error\n");
         }
@@ -286,13 +605,36 @@ int main()
         #endif
         */
 
-        for(int i = 0; i < N_GPUS; i++) {
+        #if !POP_PACKED_HALO
+        // The ghost nodes transfer reads the populations of the next GPU
+        for(int i = gpuBegin(); i < gpuEnd(); i++) {
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
             checkCudaErrors(cudaDeviceSynchronize());
         }
+        #endif
 
+        #if POP_HALO_LAYOUT
+        // Populations streamed to halo nodes to periodic faces
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            gpuPopulationsHaloCopy<<<gridHalo, threadsHalo>>>(pop[i].popAux);
+            getLastCudaError("Halo copy kernel error\n");
+        }
+        for(int i = gpuBegin(); i < gpuEnd(); i++) {
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            checkCudaErrors(cudaDeviceSynchronize());
+        }
+        #endif
+
+        #if POP_PACKED_HALO
+        // Populations crossing the GPUs transfer, in packed buffers. It is in
+        // the default stream of each GPU, after its LBM kernel and before its
+        // boundary conditions, and the unpack waits the copy of the neighbor
+        // GPUs with events, so no synchronization is required
+        haloExchange(haloBuffers, &decomp, pop, nullptr);
+        #else
         // Populations ghost nodes transfer
-        for(int i = 0; i < N_GPUS; i++){
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
             int nxt = (i+1)%N_GPUS;
             gpuPopulationsTransfer<<<gridTransfer, threadsTransfer>>>
@@ -300,24 +642,25 @@ int main()
             checkCudaErrors(cudaDeviceSynchronize());
             getLastCudaError("Mem transfer kernel error\n");
         }
+        #endif
+        #endif
 
         // Boundary conditions
-        for(int i = 0; i < N_GPUS; i++){
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
-            if(bcInfos[i].totalBCNodes > 0){
-                gpuApplyBC<<<gridsBC[i], threadsBC>>>
-                    (pop[i].mapBC, pop[i].popAux, pop[i].pop, 
-                    bcInfos[i].idxBCNodes, bcInfos[i].totalBCNodes);
-            }
-            getLastCudaError("BC kernel error\n");
+            applyBC(&bcInfos[i], &pop[i], gridsBC[i], 0);
         }
 
         // Synchronize and swap populations
-        for (int i = 0; i < N_GPUS; i++) {
+        for (int i = gpuBegin(); i < gpuEnd(); i++) {
             checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
             checkCudaErrors(cudaDeviceSynchronize());
+            #if BC_GROUPS && BC_GROUPS_TIMING
+            bcInfos[i].updateBCGroupsTime();
+            #endif
             pop[i].swapPop();
         }
+        #endif
 
         // IBM
         #ifdef IBM
@@ -338,7 +681,18 @@ int main()
         immersedBoundaryMethod(
             particlesSoA, macr, ibmMacrsAux, pop, grid, threads,
             streamsLBM, streamsIBM, step, 
-            &pEulerNodes);
+            &pEulerNodes, ibmBorder);
+
+        // Follow particle, shifting domain if required
+        #if IBM_MOVING_FRAME
+        if(movingFrameUpdate(&movingFrame, particlesSoA, pop, macr, ibmMacrsAux,
+            grid, threads, step))
+        {
+            #if IBM_EULER_OPTIMIZATION
+            pEulerNodes.checkParticlesMovement();
+            #endif
+        }
+        #endif
 
         // Save particles informations
         if(IBM_PARTICLES_SAVE && !(step % IBM_PARTICLES_SAVE)){
@@ -353,20 +707,23 @@ int main()
             fflush(stdout);
 
             // Timing between syncs
-            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
             checkCudaErrors(cudaEventRecord(stop_step, 0));
             checkCudaErrors(cudaEventSynchronize(stop_step));
             float elapsedTime;
             checkCudaErrors(cudaEventElapsedTime(&(elapsedTime), start_step, stop_step));
             
             elapsedTime *= 0.001;
+            // Slowest process
+            elapsedTime = mpiMaxAll(elapsedTime);
             // Calculate MLUPS
-            size_t nodesUpdatedSync = (step-last_step_sync) * NUMBER_LBM_NODES * N_GPUS;
+            size_t nodesUpdatedSync = (step-last_step_sync) * TOTAL_NUMBER_LBM_NODES;
             info.MLUPS = (nodesUpdatedSync / 1e6) / elapsedTime;
             info.timeElapsed += elapsedTime;
             last_step_sync = step;
             // Save simulation info
-            saveSimInfo(&info);
+            if(isRootProcess())
+                saveSimInfo(&info);
             
             //printf("                  MLUPS: %f\n", info.MLUPS);
             //printf("       Elapsed time (s): %f\n", info.timeElapsed);
@@ -380,12 +737,20 @@ int main()
 
             checkCudaErrors(cudaEventRecord(start_step, 0));
 
-            if(rep)
-                macrCPUOld.copyMacr(&macrCPUCurrent, 0, 0, true);
-            for(int i = 0; i < N_GPUS; i++){
-                checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
-                macrCPUCurrent.copyMacr(&macr[i], NUMBER_LBM_NODES*i);
-                checkCudaErrors(cudaDeviceSynchronize());
+            // With reductions in GPU, report does not require macroscopics in host.
+            // IBM report only uses particles values
+            if(save || (rep && !DATA_REDUCTION_GPU))
+            {
+                macrCPUCurrent.macrAllocationLazy(IN_HOST, MACR_FIELDS_HOST);
+                #if MACR_HOST_OLD
+                if(rep)
+                    macrCPUOld.copyMacr(&macrCPUCurrent, 0, 0, true);
+                #endif
+                for(int i = gpuBegin(); i < gpuEnd(); i++){
+                    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+                    macrCPUCurrent.copyMacrPartition(&macr[i], i);
+                    checkCudaErrors(cudaDeviceSynchronize());
+                }
             }
 
             // for(int z = 0; z < NZ_TOTAL; z++)
@@ -403,35 +768,51 @@ int main()
         }
 
         if(checkpoint){
-            printf("\n--------------------------- Saving checkpoint %06d ---------------------------\n", step);
-            fflush(stdout);
+            if(isRootProcess()){
+                printf("\n--------------------------- Saving checkpoint %06d ---------------------------\n", step);
+                fflush(stdout);
+            }
+            // Each process saves its GPUs
             saveSimCheckpoint(pop, macr, particlesSoA, &step);
             // Save info as well (to know when it stopped, conf, etc.)
-            saveSimInfo(&info);
+            if(isRootProcess())
+                saveSimInfo(&info);
         }
         // Save macroscopics
         if(save)
         {
-            printf("\n---------------------------- Saving in step %06d -----------------------------\n", step); 
-            fflush(stdout);
-            saveAllMacrBin(&macrCPUCurrent, step);
+            // Partitions of the other processes, to save the whole domain
+            mpiGatherMacr(&macrCPUCurrent);
+            if(isRootProcess()){
+                printf("\n---------------------------- Saving in step %06d -----------------------------\n", step); 
+                fflush(stdout);
+                saveAllMacrBin(&macrCPUCurrent, step);
+            }
         }
 
         // Report data
         if(rep)
         {
+            #if DATA_REDUCTION_GPU
+            treatDataGPU(&processData, macr, grid, threads);
+            #else
             treatData(&processData);
-            printTreatData(&processData); 
-            fflush(stdout);
-            if(DATA_SAVE)
-            {
-                saveTreatData(&processData);
+            #endif
+            // Treated data is reduced among all processes
+            if(isRootProcess()){
+                printTreatData(&processData); 
+                fflush(stdout);
+                if(DATA_SAVE)
+                {
+                    saveTreatData(&processData);
+                }
             }
             if(DATA_STOP)
             {
                 if(stopSim(&processData))
                 {
-                    printf("Stopping because of LBM\n");
+                    if(isRootProcess())
+                        printf("Stopping because of LBM\n");
                     break;
                 }
             }
@@ -461,7 +842,7 @@ int main()
     /* ---------------------------------------------------------------------- */
 
     // Timing
-    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[0]));
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
     checkCudaErrors(cudaEventRecord(stop, 0));
     checkCudaErrors(cudaEventSynchronize(stop));
     checkCudaErrors(cudaEventElapsedTime(&(info.timeElapsed), start, stop));
@@ -472,17 +853,29 @@ int main()
     checkCudaErrors(cudaEventDestroy(stop));
 
     info.timeElapsed *= 0.001;
+    // Slowest process
+    info.timeElapsed = mpiMaxAll(info.timeElapsed);
 
     // Save final macroscopics
-    for(int i = 0; i < N_GPUS; i++){
-        macrCPUCurrent.copyMacr(&macr[i], NUMBER_LBM_NODES*i);
+    #if MACR_SAVE_LAST
+    macrCPUCurrent.macrAllocationLazy(IN_HOST, MACR_FIELDS_HOST);
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        macrCPUCurrent.copyMacrPartition(&macr[i], i);
     }
-    saveAllMacrBin(&macrCPUCurrent, step);
+    mpiGatherMacr(&macrCPUCurrent);
+    if(isRootProcess())
+        saveAllMacrBin(&macrCPUCurrent, step);
     checkCudaErrors(cudaDeviceSynchronize());
+    #endif
 
     // Save final IBM values
     #ifdef IBM
     saveParticlesInfo(particlesSoA, step, IBM_PARTICLES_NODES_SAVE);
+    #if IBM_MOVING_FRAME
+    printf("Moving frame shift in z: %d (last frame velocity %e)\n", 
+        movingFrame.totalShift, movingFrame.velZ);
+    #endif
     if(IBM_DATA_SAVE){
         saveTreatDataIBM(&ibmProcessData);
     }
@@ -490,30 +883,46 @@ int main()
 
     // Evaluate performance
     info.totalSteps = step - first_step;
-    size_t nodesUpdated = info.totalSteps * NUMBER_LBM_NODES * N_GPUS;
+    size_t nodesUpdated = info.totalSteps * TOTAL_NUMBER_LBM_NODES;
     info.MLUPS = (nodesUpdated / 1e6) / info.timeElapsed;
     // bandwidth for AB scheme and does not consider macroscopics transfers
     info.bandwidth = MEM_SIZE_POP*2.0*N_GPUS / (info.timeElapsed*BYTES_PER_GB) 
         * info.totalSteps;
 
+    #if BC_GROUPS && BC_GROUPS_TIMING
+    printBCGroupsReport(bcInfos, info.totalSteps);
+    #endif
+    #if STEP_GRAPH
+    if(isRootProcess())
+        printf("Step graphs recorded: %d\n", stepGraph.nRecorded);
+    stepGraphFree(&stepGraph);
+    #endif
+    #if HALO_OVERLAP
+    if(isRootProcess())
+        printHaloOverlapReport(haloOverlap.timeTransfer, haloOverlap.timeHidden, info.totalSteps);
+    haloOverlapFree(&haloOverlap);
+    #endif
+
     // Save last checkpoint, if required
     if(CHECKPOINT_SAVE != 0)
             saveSimCheckpoint(pop, macr, particlesSoA, &step);
-    // Save simulation info
-    saveSimInfo(&info);
+    if(isRootProcess()){
+        // Save simulation info
+        saveSimInfo(&info);
 
-    // Report data (last calculated one)
-    if(DATA_REPORT)
-    {
-        printTreatData(&processData);
-        if(DATA_SAVE)
-            saveTreatData(&processData);
+        // Report data (last calculated one)
+        if(DATA_REPORT)
+        {
+            printTreatData(&processData);
+            if(DATA_SAVE)
+                saveTreatData(&processData);
+        }
+        printSimInfo(&info);
     }
-    printSimInfo(&info);
 
     /* ---------------------------- FREE MEMORY ----------------------------- */
     // Free memory for each GPU
-    for(int i = 0; i < N_GPUS; i++)
+    for(int i = gpuBegin(); i < gpuEnd(); i++)
     {
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
         checkCudaErrors(cudaStreamDestroy(streamsLBM[i]));
@@ -523,13 +932,22 @@ int main()
         pop[i].popFree();
         macr[i].macrFree();
         bcInfos[i].freeIdxBC();
+        bcInfos[i].freeInterpBBLinks();
+        bcInfos[i].freeOutflowBC();
+        bcInfos[i].freePostColBuffer();
+        bcInfos[i].freeSymmetryLinks();
+        if(haloBuffers[i].send[0] != nullptr)
+            haloBuffersFree(&haloBuffers[i]);
     }
 
     // Free CPU variables
     free(pop);
     free(macr);
-    macrCPUCurrent.macrFree();
-    macrCPUOld.macrFree();
+    if(macrCPUCurrent.isAllocated())
+        macrCPUCurrent.macrFree();
+    if(macrCPUOld.isAllocated())
+        macrCPUOld.macrFree();
+    processData.freeMacrProc();
     free(info.devices);
     free(bcInfos);
     free(gridsBC);
@@ -541,13 +959,24 @@ int main()
     }
     particlesSoA.freeNodesAndCenters();
     ibmMacrsAux.ibmMacrsAuxFree();
+    #if IBM_BORDER_PACK
+    ibmBorderBuffersFree(ibmBorder);
+    #endif
+    #if IBM_MOVING_FRAME
+    movingFrameFree(&movingFrame);
+    #endif
     #if IBM_EULER_OPTIMIZATION
     pEulerNodes.freeEulerNodes();
     #endif
     #endif
+
+    // Free arenas, with all arrays allocated from them
+    memArenaFreeAll();
     /* ---------------------------------------------------------------------- */
 
     fflush(stdout);
 
+    mpiBackendFinalize();
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "mapBCPalette.h"
+
+#include <unordered_map>
+
+#if MAP_BC_PALETTE
+__constant__ uint32_t gpuMapBCPalette[MAP_BC_PALETTE_SIZE];
+#endif
+
+// Palette being built in host
+static uint32_t hMapBCPalette[MAP_BC_PALETTE_SIZE];
+static std::unordered_map<uint32_t, unsigned char> hMapBCPaletteIdx;
+
+
+/*
+*   @brief First entry of node type in the hash table
+*   @param map: node type
+*   @return entry index
+*/
+__device__ __forceinline__
+unsigned int mapBCPaletteHash(const uint32_t map)
+{
+    return (map * 2654435761u) % MAP_BC_PALETTE_HASH;
+}
+
+
+__global__
+void gpuMapBCPaletteInsert(
+    NodeTypeMap* const mapBC,
+    unsigned long long int* const table,
+    int* const overflow)
+{
+    const size_t i = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(i >= NUMBER_LBM_NODES)
+        return;
+    const uint32_t map = mapBC[i].map;
+    const unsigned long long int key = (unsigned long long int)map + 1;
+    unsigned int h = mapBCPaletteHash(map);
+    for(unsigned int p = 0; p < MAP_BC_PALETTE_HASH; p++){
+        // Most nodes find their type inserted, without atomics
+        if(((volatile unsigned long long int*)table)[h] == key)
+            return;
+        const unsigned long long int old = atomicCAS(&table[h], 0ull, key);
+        if(old == 0 || old == key)
+            return;
+        h = (h + 1) % MAP_BC_PALETTE_HASH;
+    }
+    *overflow = 1;
+}
+
+
+__global__
+void gpuMapBCPaletteIndex(
+    NodeTypeMap* const mapBC,
+    const unsigned long long int* const table,
+    const unsigned char* const tableIdx,
+    unsigned char* const idx)
+{
+    const size_t i = threadIdx.x + (size_t)blockDim.x * blockIdx.x;
+    if(i >= NUMBER_LBM_NODES)
+        return;
+    const uint32_t map = mapBC[i].map;
+    const unsigned long long int key = (unsigned long long int)map + 1;
+    unsigned int h = mapBCPaletteHash(map);
+    // All node types were inserted, so the search ends
+    while(table[h] != key)
+        h = (h + 1) % MAP_BC_PALETTE_HASH;
+    idx[i] = tableIdx[h];
+}
+
+
+__host__
+void mapBCPaletteBuild(NodeTypeMap* mapBC, unsigned char* idx)
+{
+    unsigned long long int* table;
+    unsigned char* tableIdx;
+    int* overflow;
+    checkCudaErrors(cudaMalloc((void**)&table, MAP_BC_PALETTE_HASH*sizeof(unsigned long long int)));
+    checkCudaErrors(cudaMalloc((void**)&tableIdx, MAP_BC_PALETTE_HASH*sizeof(unsigned char)));
+    checkCudaErrors(cudaMalloc((void**)&overflow, sizeof(int)));
+    checkCudaErrors(cudaMemset(table, 0, MAP_BC_PALETTE_HASH*sizeof(unsigned long long int)));
+    checkCudaErrors(cudaMemset(overflow, 0, sizeof(int)));
+
+    const unsigned int blocks = (unsigned int)
+        ((NUMBER_LBM_NODES + MAP_BC_PALETTE_THREADS - 1) / MAP_BC_PALETTE_THREADS);
+    gpuMapBCPaletteInsert<<<blocks, MAP_BC_PALETTE_THREADS>>>(mapBC, table, overflow);
+    getLastCudaError("Palette node types insertion error");
+
+    // Only the node types of the GPU go to host
+    unsigned long long int hTable[MAP_BC_PALETTE_HASH];
+    unsigned char hTableIdx[MAP_BC_PALETTE_HASH];
+    int hOverflow;
+    checkCudaErrors(cudaMemcpy(hTable, table, 
+        MAP_BC_PALETTE_HASH*sizeof(unsigned long long int), cudaMemcpyDeviceToHost));
+    checkCudaErrors(cudaMemcpy(&hOverflow, overflow, sizeof(int), cudaMemcpyDeviceToHost));
+
+    for(unsigned int h = 0; h < MAP_BC_PALETTE_HASH && !hOverflow; h++){
+        if(hTable[h] == 0)
+            continue;
+        const uint32_t map = (uint32_t)(hTable[h] - 1);
+        auto it = hMapBCPaletteIdx.find(map);
+        if(it == hMapBCPaletteIdx.end()){
+            const size_t newIdx = hMapBCPaletteIdx.size();
+            if(newIdx >= MAP_BC_PALETTE_SIZE){
+                hOverflow = 1;
+                break;
+            }
+            hMapBCPalette[newIdx] = map;
+            it = hMapBCPaletteIdx.emplace(map, (unsigned char)newIdx).first;
+        }
+        hTableIdx[h] = it->second;
+    }
+    if(hOverflow){
+        fprintf(stderr, "Boundary conditions map has more than %d node types. "
+            "Disable MAP_BC_PALETTE\n", MAP_BC_PALETTE_SIZE); fflush(stderr);
+        exit(-1);
+    }
+
+    checkCudaErrors(cudaMemcpy(tableIdx, hTableIdx, 
+        MAP_BC_PALETTE_HASH*sizeof(unsigned char), cudaMemcpyHostToDevice));
+    gpuMapBCPaletteIndex<<<blocks, MAP_BC_PALETTE_THREADS>>>(mapBC, table, tableIdx, idx);
+    checkCudaErrors(cudaDeviceSynchronize());
+    getLastCudaError("Palette indexes error");
+
+    checkCudaErrors(cudaFree(table));
+    checkCudaErrors(cudaFree(tableIdx));
+    checkCudaErrors(cudaFree(overflow));
+}
+
+
+__host__
+void mapBCPaletteUpload()
+{
+    #if MAP_BC_PALETTE
+    checkCudaErrors(cudaMemcpyToSymbol(gpuMapBCPalette, hMapBCPalette, 
+        sizeof(uint32_t)*MAP_BC_PALETTE_SIZE));
+    #endif
+}
+
+
+__host__
+unsigned int mapBCPaletteSize()
+{
+    return hMapBCPaletteIdx.size();
+}
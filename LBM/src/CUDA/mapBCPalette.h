@@ -0,0 +1,116 @@
+/*
+*   @file mapBCPalette.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Boundary conditions map compressed as indexes of a palette of 
+*          node types in constant memory (MAP_BC_PALETTE)
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __MAP_BC_PALETTE_H
+#define __MAP_BC_PALETTE_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include <stdint.h>
+
+#include "var.h"
+#include "errorDef.h"
+#include "structs/nodeTypeMap.h"
+
+// Entries of the hash table of node types used to build the palette
+#define MAP_BC_PALETTE_HASH (4*MAP_BC_PALETTE_SIZE)
+// Threads in block of palette kernels
+#define MAP_BC_PALETTE_THREADS (256)
+
+#if MAP_BC_PALETTE
+// Node types of the palette, the same for all GPUs
+extern __constant__ uint32_t gpuMapBCPalette[MAP_BC_PALETTE_SIZE];
+
+/*
+*   Boundary conditions map with one palette index for each node. 
+*   Indexing it returns the NodeTypeMap of the node, so the getters 
+*   are the same as for the full map
+*/
+typedef struct nodeTypeMapPalette {
+    unsigned char* idx;     // palette index of each node
+
+    __host__ __device__
+    nodeTypeMapPalette() //constructor
+    {
+        idx = nullptr;
+    }
+
+    __device__
+    NodeTypeMap __forceinline__ operator[](const size_t i) const
+    {
+        NodeTypeMap ntm;
+        ntm.map = gpuMapBCPalette[idx[i]];
+        return ntm;
+    }
+} NodeTypeMapPalette;
+
+typedef NodeTypeMapPalette MapBC;
+#else
+typedef NodeTypeMap* MapBC;
+#endif
+
+
+/*
+*   @brief Inserts the node types of the full map in the hash table, stored
+*          as map+1 (0 is an empty entry)
+*   @param mapBC: full boundary conditions map of a GPU
+*   @param table[MAP_BC_PALETTE_HASH]: hash table of node types
+*   @param overflow: set if the table is full
+*/
+__global__
+void gpuMapBCPaletteInsert(
+    NodeTypeMap* const mapBC,
+    unsigned long long int* const table,
+    int* const overflow
+);
+
+
+/*
+*   @brief Writes the palette index of each node, from the index of its 
+*          node type in the hash table
+*   @param mapBC: full boundary conditions map of a GPU
+*   @param table[MAP_BC_PALETTE_HASH]: hash table of node types
+*   @param tableIdx[MAP_BC_PALETTE_HASH]: palette index of each entry
+*   @param idx: palette index of each node to write
+*/
+__global__
+void gpuMapBCPaletteIndex(
+    NodeTypeMap* const mapBC,
+    const unsigned long long int* const table,
+    const unsigned char* const tableIdx,
+    unsigned char* const idx
+);
+
+
+/*
+*   @brief Adds the node types of the full map to the palette and writes 
+*          their indexes, in the current device. Only the distinct node 
+*          types are copied to host. Exits if the palette overflows
+*   @param mapBC: full boundary conditions map of a GPU (device)
+*   @param idx: palette index of each node to write (device)
+*/
+__host__
+void mapBCPaletteBuild(NodeTypeMap* mapBC, unsigned char* idx);
+
+
+/*
+*   @brief Copies the palette to the constant memory of current device
+*/
+__host__
+void mapBCPaletteUpload();
+
+
+/*
+*   @brief Number of node types in palette
+*   @return palette size
+*/
+__host__
+unsigned int mapBCPaletteSize();
+
+#endif // !__MAP_BC_PALETTE_H
@@ -0,0 +1,361 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "memArena.h"
+#include "structs/macroscopics.h"
+#include "structs/macrProc.h"
+#include "mpiBackend.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Arenas of each GPU and of host
+MemArena memArenaDevice[N_GPUS];
+MemArena memArenaHost;
+
+
+__host__
+MemArena::memArena()
+{
+    this->varLocation = 0;
+    this->base = nullptr;
+    this->capacity = 0;
+    this->used = 0;
+    this->alignment = MEM_ARENA_ALIGNMENT;
+    this->mapBase = nullptr;
+    this->mapSize = 0;
+    this->nBlocks = 0;
+}
+
+
+__host__
+void MemArena::arenaReserve(size_t capacity, int varLocation)
+{
+    this->varLocation = varLocation;
+    this->used = 0;
+    this->nBlocks = 0;
+
+    switch(varLocation)
+    {
+    case IN_VIRTUAL:
+        this->alignment = MEM_ARENA_ALIGNMENT;
+        this->capacity = capacity;
+        checkCudaErrors(cudaMallocManaged((void**)&(this->base), this->capacity));
+        break;
+    case IN_HOST:
+        // Arrays are pinned one by one, so they must not share pages
+        this->alignment = (MEM_ARENA_HUGE_PAGES ? MEM_ARENA_HUGE_PAGE_SIZE : MEM_ARENA_PAGE_SIZE);
+        if(this->alignment < MEM_ARENA_ALIGNMENT)
+            this->alignment = MEM_ARENA_ALIGNMENT;
+        this->capacity = (capacity + this->alignment - 1) / this->alignment * this->alignment;
+        #if defined(__linux__)
+        // Extra alignment to start the region in a (huge) page
+        this->mapSize = this->capacity + this->alignment;
+        this->mapBase = MAP_FAILED;
+        #if MEM_ARENA_HUGE_PAGES == 2
+        this->mapBase = mmap(nullptr, this->mapSize, PROT_READ | PROT_WRITE, 
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(this->mapBase == MAP_FAILED){
+            printf("Huge pages not available for host arena, using transparent huge pages\n");
+            fflush(stdout);
+        }
+        #endif
+        if(this->mapBase == MAP_FAILED){
+            this->mapBase = mmap(nullptr, this->mapSize, PROT_READ | PROT_WRITE, 
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(this->mapBase == MAP_FAILED){
+                printf("Error reserving host arena of %zu bytes\n", this->mapSize);
+                fflush(stdout);
+                exit(-1);
+            }
+            #if MEM_ARENA_HUGE_PAGES
+            madvise(this->mapBase, this->mapSize, MADV_HUGEPAGE);
+            #endif
+        }
+        this->base = (char*)(((size_t)this->mapBase + this->alignment - 1) 
+            / this->alignment * this->alignment);
+        #else
+        // Without mmap, the whole region is pinned at once
+        this->mapBase = nullptr;
+        checkCudaErrors(cudaMallocHost((void**)&(this->base), this->capacity));
+        #endif
+        break;
+    default:
+        break;
+    }
+}
+
+
+__host__
+void* MemArena::arenaAlloc(size_t size)
+{
+    if(this->nBlocks >= MEM_ARENA_MAX_BLOCKS){
+        printf("Error: more than %d arrays in memory arena\n", MEM_ARENA_MAX_BLOCKS);
+        fflush(stdout);
+        exit(-1);
+    }
+    const size_t sizeAligned = (size + this->alignment - 1) / this->alignment * this->alignment;
+    MemArenaBlock* block = &(this->blocks[this->nBlocks]);
+    block->size = sizeAligned;
+    block->overflow = (this->used + sizeAligned > this->capacity);
+
+    if(!block->overflow){
+        block->ptr = this->base + this->used;
+        this->used += sizeAligned;
+        #if defined(__linux__)
+        // Pin only the arrays carved, so unused region is not committed
+        if(this->varLocation == IN_HOST)
+            checkCudaErrors(cudaHostRegister(block->ptr, sizeAligned, cudaHostRegisterPortable));
+        #endif
+    }
+    else{
+        // Does not fit in the region, allocate it apart
+        if(this->varLocation == IN_HOST)
+            checkCudaErrors(cudaMallocHost((void**)&(block->ptr), sizeAligned));
+        else
+            checkCudaErrors(cudaMallocManaged((void**)&(block->ptr), sizeAligned));
+    }
+    this->nBlocks++;
+
+    return block->ptr;
+}
+
+
+__host__
+MemArenaMark MemArena::arenaMark()
+{
+    MemArenaMark mark;
+    mark.used = this->used;
+    mark.nBlocks = this->nBlocks;
+    return mark;
+}
+
+
+__host__
+void MemArena::arenaRelease(const MemArenaMark mark)
+{
+    for(unsigned int i = mark.nBlocks; i < this->nBlocks; i++){
+        MemArenaBlock* block = &(this->blocks[i]);
+        if(block->overflow){
+            if(this->varLocation == IN_HOST)
+                checkCudaErrors(cudaFreeHost(block->ptr));
+            else
+                checkCudaErrors(cudaFree(block->ptr));
+        }
+        #if defined(__linux__)
+        else if(this->varLocation == IN_HOST){
+            checkCudaErrors(cudaHostUnregister(block->ptr));
+        }
+        #endif
+        block->ptr = nullptr;
+    }
+    this->nBlocks = mark.nBlocks;
+    this->used = mark.used;
+}
+
+
+__host__
+void MemArena::arenaFree()
+{
+    MemArenaMark start;
+    start.used = 0;
+    start.nBlocks = 0;
+    this->arenaRelease(start);
+
+    if(this->base != nullptr){
+        if(this->varLocation == IN_VIRTUAL)
+            checkCudaErrors(cudaFree(this->base));
+        #if defined(__linux__)
+        else if(this->varLocation == IN_HOST)
+            munmap(this->mapBase, this->mapSize);
+        #else
+        else if(this->varLocation == IN_HOST)
+            checkCudaErrors(cudaFreeHost(this->base));
+        #endif
+    }
+    this->base = nullptr;
+    this->mapBase = nullptr;
+    this->capacity = 0;
+    this->used = 0;
+}
+
+
+__host__
+size_t MemArena::arenaFootprint()
+{
+    size_t footprint = this->capacity;
+    for(unsigned int i = 0; i < this->nBlocks; i++)
+        if(this->blocks[i].overflow)
+            footprint += this->blocks[i].size;
+    return footprint;
+}
+
+
+__host__
+void memArenaSetup()
+{
+    #if MEM_ARENA
+    // Arrays of each GPU
+    size_t capDevice = 2*MEM_SIZE_POP + MEM_SIZE_MAP_BC + MEM_SIZE_TILE_CLASS + MEM_SIZE_TILE_LIST
+        + MEM_SIZE_POST_COL_SLOT + 2*MEM_SIZE_HALO_BUFFER
+        + Macroscopics::macrMemSize(IN_VIRTUAL, MACR_FIELDS_DEVICE);
+    #if DATA_REDUCTION_GPU
+    capDevice += MEM_SIZE_MACR_PROC_SUMS;
+    #endif
+    if(RANDOM_NUMBERS)
+        capDevice += sizeof(float)*NUMBER_LBM_NODES;
+    #ifdef IBM
+    // IBM auxiliary velocities and forces
+    capDevice += 6*MEM_SIZE_IBM_SCALAR;
+    #if IBM_BORDER_PACK
+    // IBM border buffers, to send and to receive in each side
+    capDevice += 4*MEM_SIZE_IBM_BORDER_BUFFER;
+    #endif
+    #endif
+    // Arrays sized in runtime (boundary conditions indexes, IBM nodes, etc.)
+    // and alignment of the arrays
+    capDevice += (size_t)MEM_ARENA_EXTRA_MB*BYTES_PER_MB 
+        + (size_t)MEM_ARENA_MAX_BLOCKS*MEM_ARENA_ALIGNMENT;
+
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        memArenaDevice[i].arenaReserve(capDevice, IN_VIRTUAL);
+    }
+
+    // Host macroscopics, allocated only in their first use
+    size_t capHost = (size_t)MEM_ARENA_EXTRA_MB*BYTES_PER_MB;
+    if(MACR_HOST_REQUIRED)
+        capHost += Macroscopics::macrMemSize(IN_HOST, MACR_FIELDS_HOST) 
+            + 4*MEM_ARENA_HUGE_PAGE_SIZE;
+    if(MACR_HOST_OLD)
+        capHost += Macroscopics::macrMemSize(IN_HOST, MACR_FIELDS_HOST) 
+            + 4*MEM_ARENA_HUGE_PAGE_SIZE;
+    // First tile of each plane in the tile lists
+    if(BULK_TILES)
+        capHost += (size_t)N_GPUS*(MEM_SIZE_TILE_PLANES + MEM_ARENA_HUGE_PAGE_SIZE);
+    // Halo buffers staged in host for MPI
+    if(MPI_BACKEND && !MPI_CUDA_AWARE)
+        capHost += 2*MEM_SIZE_HALO_BUFFER + 2*MEM_ARENA_ALIGNMENT;
+    memArenaHost.arenaReserve(capHost, IN_HOST);
+    #endif
+}
+
+
+__host__
+void* simMalloc(size_t size, int varLocation)
+{
+    void* ptr = nullptr;
+
+    #if MEM_ARENA
+    if(varLocation == IN_HOST)
+        return memArenaHost.arenaAlloc(size);
+
+    // Arena of current device. With more than one GPU in the device, the
+    // first of them with room for the array
+    int device;
+    checkCudaErrors(cudaGetDevice(&device));
+    int arenaIdx = -1;
+    for(int i = gpuEnd()-1; i >= gpuBegin(); i--){
+        if((int)GPUS_TO_USE[i] != device)
+            continue;
+        MemArena* arena = &(memArenaDevice[i]);
+        if(arenaIdx < 0 || arena->used+size+arena->alignment <= arena->capacity)
+            arenaIdx = i;
+    }
+    if(arenaIdx >= 0)
+        return memArenaDevice[arenaIdx].arenaAlloc(size);
+    #endif
+
+    if(varLocation == IN_HOST)
+        checkCudaErrors(cudaMallocHost((void**)&ptr, size));
+    else
+        checkCudaErrors(cudaMallocManaged((void**)&ptr, size));
+    return ptr;
+}
+
+
+__host__
+void simFree(void* ptr, int varLocation)
+{
+    #if !MEM_ARENA
+    if(ptr == nullptr)
+        return;
+    if(varLocation == IN_HOST)
+        checkCudaErrors(cudaFreeHost(ptr));
+    else
+        checkCudaErrors(cudaFree(ptr));
+    #endif
+}
+
+
+__host__
+void memArenaReport()
+{
+    #if MEM_ARENA
+    printf("--------------------------------- MEMORY ARENAS --------------------------------\n");
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        MemArena* arena = &(memArenaDevice[i]);
+        printf("  GPU %d: reserved %10.2f MB, used %10.2f MB, footprint %10.2f MB (%u arrays)\n",
+            i, (double)arena->capacity/BYTES_PER_MB, (double)arena->used/BYTES_PER_MB, 
+            (double)arena->arenaFootprint()/BYTES_PER_MB, arena->nBlocks);
+    }
+    printf("   Host: reserved %10.2f MB, used %10.2f MB, footprint %10.2f MB (%u arrays)\n",
+        (double)memArenaHost.capacity/BYTES_PER_MB, (double)memArenaHost.used/BYTES_PER_MB, 
+        (double)memArenaHost.arenaFootprint()/BYTES_PER_MB, memArenaHost.nBlocks);
+    fflush(stdout);
+    #endif
+}
+
+
+__host__
+void memArenaMarkDevices(MemArenaMark marks[N_GPUS])
+{
+    #if MEM_ARENA
+    for(int i = gpuBegin(); i < gpuEnd(); i++)
+        marks[i] = memArenaDevice[i].arenaMark();
+    #endif
+}
+
+
+__host__
+void memArenaReleaseDevices(const MemArenaMark marks[N_GPUS])
+{
+    #if MEM_ARENA
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        memArenaDevice[i].arenaRelease(marks[i]);
+    }
+    #endif
+}
+
+
+__host__
+void memArenaFreeAll()
+{
+    #if MEM_ARENA
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        memArenaDevice[i].arenaFree();
+    }
+    memArenaHost.arenaFree();
+    #endif
+}
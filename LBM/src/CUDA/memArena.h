@@ -0,0 +1,169 @@
+/*
+*   @file memArena.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Simulation memory arenas, with one region reserved for each device
+*          and one for host, from which the simulation arrays are carved
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __MEM_ARENA_H
+#define __MEM_ARENA_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "var.h"
+#include "errorDef.h"
+
+#define MEM_ARENA_MAX_BLOCKS (256)  // maximum number of arrays of each arena
+#define MEM_ARENA_PAGE_SIZE ((size_t)4096)
+#define MEM_ARENA_HUGE_PAGE_SIZE ((size_t)(2<<20))
+
+/*
+*   Array carved from an arena (or allocated apart, if it did not fit)
+*/
+typedef struct memArenaBlock {
+    void* ptr;      // array pointer
+    size_t size;    // array size, in bytes (with alignment)
+    bool overflow;  // allocated apart from the arena region
+} MemArenaBlock;
+
+/*
+*   Position in an arena, to release the arrays carved after it
+*/
+typedef struct memArenaMark {
+    size_t used;            // size carved from region, in bytes
+    unsigned int nBlocks;   // number of arrays
+} MemArenaMark;
+
+/*
+*   Memory arena. The region is reserved once and the arrays are carved
+*   from it in sequence. The memory is only returned by arenaFree
+*/
+typedef struct memArena {
+    int varLocation;        // IN_VIRTUAL (device) or IN_HOST
+    char* base;             // base of the region (aligned)
+    size_t capacity;        // region size, in bytes
+    size_t used;            // size carved from region, in bytes
+    size_t alignment;       // arrays alignment, in bytes
+    void* mapBase;          // base of the region from mmap (host)
+    size_t mapSize;         // size of the region from mmap (host)
+    unsigned int nBlocks;   // number of arrays
+    MemArenaBlock blocks[MEM_ARENA_MAX_BLOCKS];
+
+    __host__
+    memArena();
+
+    /*
+    *   @brief Reserve the arena region
+    *   @param capacity: region size, in bytes
+    *   @param varLocation: IN_VIRTUAL (managed memory of current device) or 
+    *                       IN_HOST (pinned per array, with huge pages if 
+    *                       MEM_ARENA_HUGE_PAGES)
+    */
+    __host__
+    void arenaReserve(size_t capacity, int varLocation);
+
+    /*
+    *   @brief Carve an array from the arena. If it does not fit, the array is 
+    *          allocated apart, but it is still freed with the arena
+    *   @param size: array size, in bytes
+    *   @return array pointer
+    */
+    __host__
+    void* arenaAlloc(size_t size);
+
+    /*
+    *   @brief Current position of the arena
+    *   @return mark of the arrays carved so far
+    */
+    __host__
+    MemArenaMark arenaMark();
+
+    /*
+    *   @brief Release the arrays carved after the mark, so their memory is 
+    *          carved again. Arrays allocated apart are freed
+    *   @param mark: position to return to, from arenaMark
+    */
+    __host__
+    void arenaRelease(const MemArenaMark mark);
+
+    /*
+    *   @brief Free the region and all its arrays
+    */
+    __host__
+    void arenaFree();
+
+    /*
+    *   @brief Total memory of the arena, including arrays allocated apart
+    *   @return memory size, in bytes
+    */
+    __host__
+    size_t arenaFootprint();
+} MemArena;
+
+
+/*
+*   @brief Reserve the arenas of each GPU and of host, with the capacity 
+*          required by the simulation arrays plus MEM_ARENA_EXTRA_MB
+*/
+__host__
+void memArenaSetup();
+
+
+/*
+*   @brief Allocate simulation array. With MEM_ARENA, it is carved from the
+*          arena of the current device (IN_VIRTUAL) or of host (IN_HOST)
+*   @param size: array size, in bytes
+*   @param varLocation: IN_VIRTUAL or IN_HOST
+*   @return array pointer
+*/
+__host__
+void* simMalloc(size_t size, int varLocation);
+
+
+/*
+*   @brief Free simulation array. With MEM_ARENA it does nothing, the array is
+*          freed by memArenaFreeAll (or released by memArenaReleaseDevices)
+*   @param ptr: array pointer
+*   @param varLocation: IN_VIRTUAL or IN_HOST
+*/
+__host__
+void simFree(void* ptr, int varLocation);
+
+
+/*
+*   @brief Print memory footprint of the arenas
+*/
+__host__
+void memArenaReport();
+
+
+/*
+*   @brief Marks of the arenas of each GPU, before arrays that may be 
+*          built again (boundary conditions from a geometry cache that is 
+*          rejected). Without MEM_ARENA it does nothing
+*   @param marks[N_GPUS]: marks to write to
+*/
+__host__
+void memArenaMarkDevices(MemArenaMark marks[N_GPUS]);
+
+
+/*
+*   @brief Release the arrays carved in the arenas of each GPU after their 
+*          marks. The arrays must not be used anymore (freed by simFree).
+*          Without MEM_ARENA it does nothing
+*   @param marks[N_GPUS]: marks from memArenaMarkDevices
+*/
+__host__
+void memArenaReleaseDevices(const MemArenaMark marks[N_GPUS]);
+
+
+/*
+*   @brief Free all arenas and its arrays
+*/
+__host__
+void memArenaFreeAll();
+
+#endif // !__MEM_ARENA_H
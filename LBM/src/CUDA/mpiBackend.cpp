@@ -0,0 +1,199 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "mpiBackend.h"
+
+// Rank of process and number of ranks
+static int mpiRank = 0;
+static int mpiSize = 1;
+
+
+#if MPI_BACKEND
+/*
+*   @brief Aborts MPI if the process exits before mpiBackendFinalize, as in
+*          the errors checks (exit(-1)), so the other ranks do not hang
+*/
+__host__
+static void mpiBackendAtExit()
+{
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if(!finalized){
+        fflush(stdout);
+        MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+}
+#endif
+
+
+__host__
+void mpiBackendInit(int* argc, char*** argv)
+{
+    #if MPI_BACKEND
+    checkMPIErrors(MPI_Init(argc, argv));
+    atexit(mpiBackendAtExit);
+    checkMPIErrors(MPI_Comm_rank(MPI_COMM_WORLD, &mpiRank));
+    checkMPIErrors(MPI_Comm_size(MPI_COMM_WORLD, &mpiSize));
+    if(mpiSize != (int)N_GPUS){
+        if(mpiRank == 0)
+            printf("MPI_BACKEND requires one rank for each GPU (N_GPUS: %d, ranks: %d)\n",
+                N_GPUS, mpiSize);
+        fflush(stdout);
+        MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+    #endif
+}
+
+
+__host__
+void mpiBackendFinalize()
+{
+    #if MPI_BACKEND
+    checkMPIErrors(MPI_Finalize());
+    #endif
+}
+
+
+__host__
+void mpiBackendAbort(const int code)
+{
+    fflush(stdout);
+    #if MPI_BACKEND
+    MPI_Abort(MPI_COMM_WORLD, code);
+    #endif
+    exit(code);
+}
+
+
+__host__
+void mpiGatherDevices(cudaDeviceProp* devices)
+{
+    #if MPI_BACKEND
+    // One GPU for each rank, devices[r] from rank r
+    const int bytes = (int)sizeof(cudaDeviceProp);
+    if(mpiRank == 0)
+        checkMPIErrors(MPI_Gather(MPI_IN_PLACE, bytes, MPI_BYTE, devices, bytes, 
+            MPI_BYTE, 0, MPI_COMM_WORLD));
+    else
+        checkMPIErrors(MPI_Gather(&devices[mpiRank], bytes, MPI_BYTE, nullptr, 
+            bytes, MPI_BYTE, 0, MPI_COMM_WORLD));
+    #endif
+}
+
+
+__host__
+int gpuBegin()
+{
+    return MPI_BACKEND ? mpiRank : 0;
+}
+
+
+__host__
+int gpuEnd()
+{
+    return MPI_BACKEND ? mpiRank+1 : N_GPUS;
+}
+
+
+__host__
+bool isRootProcess()
+{
+    return mpiRank == 0;
+}
+
+
+__host__
+void mpiSumAll(dfloat* values, const int n)
+{
+    #if MPI_BACKEND
+    checkMPIErrors(MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_DFLOAT, MPI_SUM, MPI_COMM_WORLD));
+    #endif
+}
+
+
+__host__
+void mpiSumAll(size_t* values, const int n)
+{
+    #if MPI_BACKEND
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "size_t must have 64 bits");
+    checkMPIErrors(MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD));
+    #endif
+}
+
+
+__host__
+double mpiMaxAll(const double value)
+{
+    double maxValue = value;
+    #if MPI_BACKEND
+    checkMPIErrors(MPI_Allreduce(&value, &maxValue, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+    #endif
+    return maxValue;
+}
+
+
+#if MPI_BACKEND
+/*
+*   @brief Sends the partition of the field from rank to root
+*   @param field: global array (NX_TOTAL, NY_TOTAL, NZ_TOTAL)
+*   @param partition[N_GPUS]: box of each GPU in global array
+*/
+__host__
+static void mpiGatherField(dfloat* field, MPI_Datatype* partition)
+{
+    if(mpiRank != 0){
+        checkMPIErrors(MPI_Send(field, 1, partition[mpiRank], 0, 0, MPI_COMM_WORLD));
+        return;
+    }
+    for(int r = 1; r < mpiSize; r++)
+        checkMPIErrors(MPI_Recv(field, 1, partition[r], r, 0, MPI_COMM_WORLD, 
+            MPI_STATUS_IGNORE));
+}
+#endif
+
+
+__host__
+void mpiGatherMacr(Macroscopics* macrHost)
+{
+    #if MPI_BACKEND
+    // Box of each GPU in global arrays, slowest dimension first
+    MPI_Datatype partition[N_GPUS];
+    const int sizes[3] = {NZ_TOTAL, NY_TOTAL, NX_TOTAL};
+    for(int r = 0; r < mpiSize; r++){
+        const int subsizes[3] = {decompNZ(r), NY, NX};
+        const int starts[3] = {decompOrigin(r, 2), decompOrigin(r, 1), decompOrigin(r, 0)};
+        checkMPIErrors(MPI_Type_create_subarray(3, sizes, subsizes, starts, 
+            MPI_ORDER_C, MPI_DFLOAT, &partition[r]));
+        checkMPIErrors(MPI_Type_commit(&partition[r]));
+    }
+
+    mpiGatherField(macrHost->rho, partition);
+    mpiGatherField(macrHost->u.x, partition);
+    mpiGatherField(macrHost->u.y, partition);
+    mpiGatherField(macrHost->u.z, partition);
+    #ifdef NON_NEWTONIAN_FLUID
+    mpiGatherField(macrHost->omega, partition);
+    #endif
+
+    for(int r = 0; r < mpiSize; r++)
+        checkMPIErrors(MPI_Type_free(&partition[r]));
+    #endif
+}
@@ -0,0 +1,154 @@
+/*
+*   @file mpiBackend.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Multi process backend (MPI_BACKEND), with one MPI rank for each
+*          GPU (partition of the grid), so the GPUs may be in several nodes.
+*          Each process only handles the GPUs in [gpuBegin(), gpuEnd()):
+*          all GPUs without MPI_BACKEND and the GPU of its rank with it.
+*          The reductions and the gather of macroscopics are no-ops with a 
+*          single process
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __MPI_BACKEND_H
+#define __MPI_BACKEND_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "var.h"
+#include "globalFunctions.h"
+#include "structs/macroscopics.h"
+
+#if MPI_BACKEND
+#include <mpi.h>
+
+#ifdef SINGLE_PRECISION
+#define MPI_DFLOAT MPI_FLOAT
+#else
+#define MPI_DFLOAT MPI_DOUBLE
+#endif
+
+#define checkMPIErrors(err)  __checkMPIErrors(err,#err,__FILE__,__LINE__)
+
+
+inline void __checkMPIErrors(int err, const char *const func, const char *const file, const int line)
+{
+    if (err != MPI_SUCCESS)
+    {
+        char msg[MPI_MAX_ERROR_STRING];
+        int len = 0;
+        MPI_Error_string(err, msg, &len);
+        fprintf(stderr, "MPI error at %s(%d)\"%s\": [%d] %s.\n",
+            file, line, func, err, msg); fflush(stderr);
+        MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+}
+#endif
+
+#if MPI_BACKEND && defined(IBM)
+#error "MPI_BACKEND can not be used with IBM"
+#endif
+#if MPI_BACKEND && !POP_PACKED_HALO
+#error "MPI_BACKEND requires POP_PACKED_HALO"
+#endif
+
+
+/*
+*   @brief Initializes MPI and checks that there is one rank for each GPU
+*   @param argc: pointer to number of arguments of main
+*   @param argv: pointer to arguments of main
+*/
+__host__
+void mpiBackendInit(int* argc, char*** argv);
+
+
+/*
+*   @brief Finalizes MPI, after all processes are done
+*/
+__host__
+void mpiBackendFinalize();
+
+
+/*
+*   @brief Ends all processes after an error in any of them. Other ranks may
+*          be waiting in a communication, so MPI is aborted instead of 
+*          finalized. Without MPI_BACKEND it is exit(code)
+*   @param code: exit code
+*/
+__host__
+void mpiBackendAbort(const int code);
+
+
+/*
+*   @brief Gathers the properties of the device of each GPU in root process,
+*          each process has only the ones of its GPUs
+*   @param devices[N_GPUS]: properties of devices, filled in
+*                           [gpuBegin(), gpuEnd()) of each process
+*/
+__host__
+void mpiGatherDevices(cudaDeviceProp* devices);
+
+
+/*
+*   @brief First GPU handled by the process
+*   @return GPU number
+*/
+__host__
+int gpuBegin();
+
+
+/*
+*   @brief Last GPU handled by the process + 1
+*   @return GPU number
+*/
+__host__
+int gpuEnd();
+
+
+/*
+*   @brief Checks if the process is the root one, that prints the reports and
+*          saves the files of the whole domain
+*   @return true if rank is 0 or without MPI_BACKEND, false otherwise
+*/
+__host__
+bool isRootProcess();
+
+
+/*
+*   @brief Sums values of all processes, the result is in all of them
+*   @param values[n]: values of process, overwritten by the sums
+*   @param n: number of values
+*/
+__host__
+void mpiSumAll(dfloat* values, const int n);
+
+
+/*
+*   @brief Sums counts of all processes, the result is in all of them
+*   @param values[n]: counts of process, overwritten by the sums
+*   @param n: number of counts
+*/
+__host__
+void mpiSumAll(size_t* values, const int n);
+
+
+/*
+*   @brief Maximum of a value of all processes (e.g. elapsed time)
+*   @param value: value of process
+*   @return maximum value, in all processes
+*/
+__host__
+double mpiMaxAll(const double value);
+
+
+/*
+*   @brief Gathers the partitions of the host macroscopics (global arrays,
+*          each process with its partitions copied) in the root process
+*   @param macrHost: host macroscopics to gather
+*/
+__host__
+void mpiGatherMacr(Macroscopics* macrHost);
+
+#endif // !__MPI_BACKEND_H
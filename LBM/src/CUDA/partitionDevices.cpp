@@ -0,0 +1,104 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "partitionDevices.h"
+
+#include <cstring>
+
+unsigned int GPUS_TO_USE[N_GPUS];
+// Partitions in the same device in any process
+static bool sharedAny = false;
+
+
+__host__
+void partitionDevicesSetup(int argc, char* argv[])
+{
+    // Last list in arguments, if any
+    unsigned int devices[N_GPUS];
+    int nDevices = 0;
+    for(int a = 1; a < argc-1; a++){
+        if(strcmp(argv[a], PARTITION_DEVICES_ARG) != 0)
+            continue;
+        nDevices = 0;
+        const char* list = argv[a+1];
+        char* end = (char*)list;
+        while(*end != '\0' && nDevices < (int)N_GPUS){
+            const char* start = end;
+            const long device = strtol(start, &end, 10);
+            if(end == start || device < 0 || (*end != ',' && *end != '\0')){
+                fprintf(stderr, "Invalid list of devices \"%s\", use as %s 0,1\n", 
+                    list, PARTITION_DEVICES_ARG); fflush(stderr);
+                exit(-1);
+            }
+            devices[nDevices++] = (unsigned int)device;
+            if(*end == ',')
+                end++;
+        }
+    }
+    for(int i = 0; i < N_GPUS; i++)
+        GPUS_TO_USE[i] = (nDevices > 0) ? devices[i % nDevices] : GPUS_TO_USE_DEFAULT[i];
+
+    int deviceCount = 0;
+    checkCudaErrors(cudaGetDeviceCount(&deviceCount));
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        if((int)GPUS_TO_USE[i] >= deviceCount){
+            fprintf(stderr, "Device %u of GPU %d not found, there are %d devices\n", 
+                GPUS_TO_USE[i], i, deviceCount); fflush(stderr);
+            exit(-1);
+        }
+    }
+
+    size_t nShared = partitionDevicesShared() ? 1 : 0;
+    mpiSumAll(&nShared, 1);
+    sharedAny = (nShared > 0);
+
+    // The features below are dropped with shared devices, warn about it
+    #if BC_POST_COL_BUFFER
+    if(partitionDevicesShared()){
+        fprintf(stderr, "Warning: partitions from GPU %d share a device, "
+            "BC_POST_COL_BUFFER is not used in them\n", gpuBegin()); fflush(stderr);
+    }
+    #endif
+    #if DECOMP_Z_BALANCE
+    if(sharedAny && isRootProcess()){
+        fprintf(stderr, "Warning: partitions share a device, "
+            "DECOMP_Z_BALANCE is not used and the z slabs are uniform\n"); fflush(stderr);
+    }
+    #endif
+}
+
+
+__host__
+bool partitionDevicesShared()
+{
+    for(int i = gpuBegin(); i < gpuEnd(); i++)
+        for(int j = i+1; j < gpuEnd(); j++)
+            if(GPUS_TO_USE[i] == GPUS_TO_USE[j])
+                return true;
+    return false;
+}
+
+
+__host__
+bool partitionDevicesSharedAny()
+{
+    return sharedAny;
+}
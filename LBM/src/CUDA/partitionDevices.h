@@ -0,0 +1,64 @@
+/*
+*   @file partitionDevices.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Device of each partition of the grid (GPUS_TO_USE), chosen in 
+*          runtime. The devices are listed in the arguments, as 
+*          "--gpus 0,1,2,3", and repeated until all partitions have one, so
+*          "--gpus 0" runs all partitions in device 0. Without the argument, 
+*          GPUS_TO_USE_DEFAULT is used. Partitions in the same device run the
+*          same transfers between them as in different devices. They share
+*          its constant memory, so the per partition data in it is not used:
+*          the post collision populations are saved in pop (as without 
+*          BC_POST_COL_BUFFER) and the z slabs are kept uniform (as without
+*          DECOMP_Z_BALANCE), with a warning in stderr. The number of 
+*          partitions is still N_GPUS, fixed in compilation
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __PARTITION_DEVICES_H
+#define __PARTITION_DEVICES_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "var.h"
+#include "errorDef.h"
+#include "globalFunctions.h"
+#include "mpiBackend.h"
+
+// Argument with the list of devices
+#define PARTITION_DEVICES_ARG "--gpus"
+
+
+/*
+*   @brief Sets the device of each partition from the arguments of main and
+*          checks that the devices of the process exist. Must be called 
+*          before any device is set
+*   @param argc: number of arguments of main
+*   @param argv: arguments of main
+*/
+__host__
+void partitionDevicesSetup(int argc, char* argv[]);
+
+
+/*
+*   @brief Checks if two partitions of the process are in the same device
+*   @return true if a device has more than one partition, false otherwise
+*/
+__host__
+bool partitionDevicesShared();
+
+
+/*
+*   @brief Checks if two partitions of any process are in the same device,
+*          so all processes take the same decisions (DECOMP_Z_BALANCE)
+*   @return true if a device of any process has more than one partition, 
+*           false otherwise
+*/
+__host__
+bool partitionDevicesSharedAny();
+
+#endif // !__PARTITION_DEVICES_H
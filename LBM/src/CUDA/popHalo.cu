@@ -0,0 +1,52 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "popHalo.h"
+
+
+__global__
+void gpuPopulationsHaloCopy(dfloat* popPostStream)
+{
+    const unsigned int k = threadIdx.x + blockDim.x * blockIdx.x;
+    // -1 because of the halo plane in z
+    const int z = (int)(threadIdx.y + blockDim.y * blockIdx.y) - 1;
+
+    if(k >= N_HALO_PERIMETER || z >= NZ+1)
+        return;
+
+    int x, y;
+    haloPerimeterCoord(k, x, y);
+    popHaloCopyNode(popPostStream, x, y, z);
+}
+
+
+__host__
+void popHaloCopyHost(dfloat* popPostStream)
+{
+    #pragma omp parallel for collapse(2)
+    for(int z = -1; z < NZ+1; z++){
+        for(int k = 0; k < (int)N_HALO_PERIMETER; k++){
+            int x, y;
+            haloPerimeterCoord(k, x, y);
+            popHaloCopyNode(popPostStream, x, y, z);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/*
+*   @file popHalo.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Periodic faces of populations with halo layout (POP_HALO_LAYOUT)
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __POP_HALO_H
+#define __POP_HALO_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "globalFunctions.h"
+#include "errorDef.h"
+
+// Halo nodes in the perimeter of each plane of z
+constexpr unsigned int N_HALO_PERIMETER = 2*(NX+2) + 2*NY;
+// Planes of z with halo nodes to copy (ghost planes -1 and NZ included)
+constexpr unsigned int N_HALO_PLANES = NZ+2;
+
+
+/*
+*   @brief Converts an index of the perimeter of halo nodes to its 
+*          coordinates x and y
+*   @param k: perimeter index, in [0, N_HALO_PERIMETER)
+*   @param x: x of the halo node, in [-1, NX]
+*   @param y: y of the halo node, in [-1, NY]
+*/
+__host__ __device__
+void __forceinline__ haloPerimeterCoord(const unsigned int k, int& x, int& y)
+{
+    if(k < NX+2){
+        x = k-1;
+        y = -1;
+    }
+    else if(k < 2*(NX+2)){
+        x = k-(NX+2)-1;
+        y = NY;
+    }
+    else if(k < 2*(NX+2)+NY){
+        x = -1;
+        y = k-2*(NX+2);
+    }
+    else{
+        x = NX;
+        y = k-2*(NX+2)-NY;
+    }
+}
+
+
+/*
+*   @brief Moves the populations streamed to a halo node to the node in the 
+*          opposite face (periodic in x and y). Only populations streamed from
+*          the domain are moved. The ghost planes in z are kept, being 
+*          exchanged by gpuPopulationsTransfer
+*   @param pop: post streaming populations
+*   @param x: x of the halo node, in [-1, NX]
+*   @param y: y of the halo node, in [-1, NY]
+*   @param z: z of the halo node, in [-1, NZ]
+*/
+__host__ __device__
+void __forceinline__ popHaloCopyNode(dfloat* pop, const int x, const int y, const int z)
+{
+    const int xDst = (x < 0) ? NX-1 : ((x >= NX) ? 0 : x);
+    const int yDst = (y < 0) ? NY-1 : ((y >= NY) ? 0 : y);
+
+    #pragma unroll
+    for(char i = 1; i < Q; i++){
+        const int xSrc = x - velCx(i);
+        const int ySrc = y - velCy(i);
+        const int zSrc = z - velCz(i);
+        if(xSrc < 0 || xSrc >= NX || ySrc < 0 || ySrc >= NY || zSrc < 0 || zSrc >= NZ)
+            continue;
+        pop[idxPop(xDst, yDst, z, i)] = pop[idxPop(x, y, z, i)];
+    }
+}
+
+
+/*
+*   @brief Copies the populations streamed to the halo nodes to the periodic
+*          faces. Must be called after streaming and before the populations
+*          transfer. Grid must be (N_HALO_PERIMETER/threads.x, N_HALO_PLANES)
+*   @param popPostStream: post streaming populations
+*/
+__global__
+void gpuPopulationsHaloCopy(dfloat* popPostStream);
+
+
+/*
+*   @brief Host equivalent of gpuPopulationsHaloCopy, used for the 
+*          populations loaded from checkpoint
+*   @param popPostStream: post streaming populations (in host)
+*/
+__host__
+void popHaloCopyHost(dfloat* popPostStream);
+
+#endif // !__POP_HALO_H
@@ -0,0 +1,39 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "postColBuffer.h"
+
+#if BC_POST_COL_BUFFER
+__constant__ dfloat* gpuPostColBuffer;
+__constant__ unsigned int* gpuPostColSlot;
+__constant__ size_t gpuPostColTotal;
+#endif
+
+
+__host__
+void postColBufferUpload(dfloat* buffer, unsigned int* slot, size_t total)
+{
+    #if BC_POST_COL_BUFFER
+    checkCudaErrors(cudaMemcpyToSymbol(gpuPostColBuffer, &buffer, sizeof(dfloat*)));
+    checkCudaErrors(cudaMemcpyToSymbol(gpuPostColSlot, &slot, sizeof(unsigned int*)));
+    checkCudaErrors(cudaMemcpyToSymbol(gpuPostColTotal, &total, sizeof(size_t)));
+    #endif
+}
@@ -0,0 +1,99 @@
+/*
+*   @file postColBuffer.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Compact buffer of post collision populations of the nodes that
+*          save them (BC_POST_COL_BUFFER), in order of index. The slots are
+*          not stored for each node: each row of 32 nodes in x has a mask of
+*          its nodes with slot and the slot of the first one, so the slot of
+*          a node is the first one plus the nodes of the mask before it
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __POST_COL_BUFFER_H
+#define __POST_COL_BUFFER_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "var.h"
+#include "errorDef.h"
+#include "globalFunctions.h"
+
+// Slot of nodes that do not save post collision populations
+#define POST_COL_NO_SLOT (0xFFFFFFFF)
+
+#if BC_POST_COL_BUFFER
+// Buffer of post collision populations, gpuPostColBuffer[i*total + slot]
+extern __constant__ dfloat* gpuPostColBuffer;
+// Slots of rows of nodes, the masks (NUMBER_POST_COL_ROWS) and then the 
+// slots of the first node of each row
+extern __constant__ unsigned int* gpuPostColSlot;
+// Number of slots in buffer
+extern __constant__ size_t gpuPostColTotal;
+
+
+/*
+*   @brief Slot of node in the buffer of post collision populations
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*   @return node's slot, POST_COL_NO_SLOT if it has none
+*/
+__device__ __forceinline__
+unsigned int postColSlot(
+    const unsigned int x,
+    const unsigned int y,
+    const unsigned int z)
+{
+    // Halo and ghost nodes (-1 or N) have no slot, neither the nodes of a
+    // device without buffer
+    if(x >= NX || y >= NY || z >= NZ || gpuPostColSlot == nullptr)
+        return POST_COL_NO_SLOT;
+    const size_t row = ((size_t)NY*z + y)*POST_COL_ROWS_X + x/32;
+    const unsigned int mask = gpuPostColSlot[row];
+    const unsigned int bit = 1u << (x % 32);
+    if(!(mask & bit))
+        return POST_COL_NO_SLOT;
+    return gpuPostColSlot[NUMBER_POST_COL_ROWS + row] + __popc(mask & (bit - 1));
+}
+#endif
+
+
+/*
+*   @brief Post collision population of node, from the compact buffer if the
+*          node has a slot, otherwise from the populations
+*   @param fPostCol[(NX, NY, NZ, Q)]: post collision populations from last step
+*   @param x: node's x value
+*   @param y: node's y value
+*   @param z: node's z value
+*   @param d: population number
+*   @return post collision population
+*/
+__device__ __forceinline__
+dfloat postColPop(const dfloat* fPostCol,
+    const unsigned int x,
+    const unsigned int y,
+    const unsigned int z,
+    const unsigned int d)
+{
+    #if BC_POST_COL_BUFFER
+    const unsigned int slot = postColSlot(x, y, z);
+    if(slot != POST_COL_NO_SLOT)
+        return gpuPostColBuffer[gpuPostColTotal*d + slot];
+    #endif
+    return fPostCol[idxPop(x, y, z, d)];
+}
+
+
+/*
+*   @brief Copies the buffer and slots of the GPU to the constant memory of
+*          current device. Null slots disable the buffer in the device
+*   @param buffer: buffer of post collision populations
+*   @param slot: slots of rows of nodes
+*   @param total: number of slots in buffer
+*/
+__host__
+void postColBufferUpload(dfloat* buffer, unsigned int* slot, size_t total);
+
+#endif // !__POST_COL_BUFFER_H
@@ -242,8 +242,9 @@ void operateSimCheckpoint(
     // Everything will fit in this array
     dfloat* tmp = (dfloat*)malloc(MEM_SIZE_POP);
 
-    // Load/save current step
-    f_arr(step, f_filename("curr_step", 0), sizeof(int), tmp);
+    // Load/save current step (saved by root process only)
+    if(oper == __LOAD_CHECKPOINT || isRootProcess())
+        f_arr(step, f_filename("curr_step", 0), sizeof(int), tmp);
 
     #ifdef IBM
     // Load particles centers positions
@@ -252,10 +253,20 @@ void operateSimCheckpoint(
         NUM_PARTICLES*sizeof(ParticleCenter), tmp);
     #endif
 
-    for(int i = 0; i < N_GPUS; i++){
+    // Each process loads/saves the files of its GPUs
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
         checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
         // Load/save pop
         f_arr(pop[i].pop, f_filename("pop", i), MEM_SIZE_POP, tmp);
+        #if POP_HALO_LAYOUT
+        // Periodic faces from the halo nodes in host (populations read are 
+        // still in tmp), so they are consistent even if the checkpoint was 
+        // not saved after the face copy
+        if(oper == __LOAD_CHECKPOINT){
+            popHaloCopyHost(tmp);
+            checkCudaErrors(cudaMemcpy(pop[i].pop, tmp, MEM_SIZE_POP, cudaMemcpyDefault));
+        }
+        #endif
         // Load/save popAux
         f_arr(pop[i].popAux, f_filename("popAux", i), MEM_SIZE_POP, tmp);
         // Load/save macroscopics
@@ -18,6 +18,8 @@
 #include "structs/populations.h"
 #include "NNF/nnf.h"
 #include "IBM/ibm.h"
+#include "mpiBackend.h"
+#include "popHalo.h"
 
 
 
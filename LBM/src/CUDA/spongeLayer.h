@@ -0,0 +1,93 @@
+/*
+*   @file spongeLayer.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Absorbing sponge layer in the outer shell of the domain (SPONGE_LAYER)
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __SPONGE_LAYER_H
+#define __SPONGE_LAYER_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "globalFunctions.h"
+#include "structs/nodeTypeMap.h"
+
+
+/*
+*   @brief Sponge level of a node, ramped quadratically from the inner side
+*          of the sponge (0) to the domain face (SPONGE_LEVEL_MAX)
+*   @param xDomain: node's x value in the whole domain (all GPUs)
+*   @param yDomain: node's y value in the whole domain (all GPUs)
+*   @param zDomain: node's z value in the whole domain (all GPUs)
+*   @return sponge level, 0 if node is outside the sponge
+*/
+__host__ __device__
+unsigned char __forceinline__ spongeLevel(const int xDomain, const int yDomain, const int zDomain)
+{
+    // Depth of the node in the sponge, relative to its thickness (1 at the face)
+    dfloat depth = 0;
+    if(xDomain < SPONGE_WIDTH_W)
+        depth = myMax(depth, (dfloat)(SPONGE_WIDTH_W - xDomain) / SPONGE_WIDTH_W);
+    if(NX_TOTAL-1-xDomain < SPONGE_WIDTH_E)
+        depth = myMax(depth, (dfloat)(SPONGE_WIDTH_E - (NX_TOTAL-1-xDomain)) / SPONGE_WIDTH_E);
+    if(yDomain < SPONGE_WIDTH_S)
+        depth = myMax(depth, (dfloat)(SPONGE_WIDTH_S - yDomain) / SPONGE_WIDTH_S);
+    if(NY_TOTAL-1-yDomain < SPONGE_WIDTH_N)
+        depth = myMax(depth, (dfloat)(SPONGE_WIDTH_N - (NY_TOTAL-1-yDomain)) / SPONGE_WIDTH_N);
+    if(zDomain < SPONGE_WIDTH_B)
+        depth = myMax(depth, (dfloat)(SPONGE_WIDTH_B - zDomain) / SPONGE_WIDTH_B);
+    if(NZ_TOTAL-1-zDomain < SPONGE_WIDTH_F)
+        depth = myMax(depth, (dfloat)(SPONGE_WIDTH_F - (NZ_TOTAL-1-zDomain)) / SPONGE_WIDTH_F);
+
+    // Smooth ramp, so the sponge itself does not reflect waves
+    return (unsigned char)(depth*depth*SPONGE_LEVEL_MAX + 0.5);
+}
+
+
+/*
+*   @brief Population of the target equilibrium of the sponge
+*   @param i: population number
+*   @return equilibrium population with SPONGE_RHO and SPONGE_UX/UY/UZ
+*/
+__host__ __device__
+constexpr dfloat spongeFeq(const int i)
+{
+    return velW(i)*SPONGE_RHO*(1 
+        + 3*(velCx(i)*SPONGE_UX + velCy(i)*SPONGE_UY + velCz(i)*SPONGE_UZ)
+        + 4.5*(velCx(i)*SPONGE_UX + velCy(i)*SPONGE_UY + velCz(i)*SPONGE_UZ)
+            *(velCx(i)*SPONGE_UX + velCy(i)*SPONGE_UY + velCz(i)*SPONGE_UZ)
+        - 1.5*(SPONGE_UX*SPONGE_UX + SPONGE_UY*SPONGE_UY + SPONGE_UZ*SPONGE_UZ));
+}
+
+
+/*
+*   @brief Relaxes post collision populations of sponge node towards the
+*          target equilibrium, f = (1-sigma)*f + sigma*fEqTarget
+*   @param fNode[Q]: node populations to relax
+*   @param level: node's sponge level (from NodeTypeMap)
+*/
+__device__
+void __forceinline__ spongeRelax(dfloat* fNode, const unsigned char level)
+{
+    const dfloat sigma = (SPONGE_SIGMA_MAX/SPONGE_LEVEL_MAX)*level;
+    const dfloat tSigma = 1 - sigma;
+
+    #pragma unroll
+    for(int i = 0; i < Q; i++)
+        fNode[i] = tSigma*fNode[i] + sigma*spongeFeq(i);
+}
+
+
+/*
+*   @brief Sets the sponge level of the nodes without boundary condition 
+*          in the sponge layer. Must be called after gpuBuildBoundaryConditions
+*   @param gpuMapBC: device pointer to the boundary conditions map
+*   @param gpuNumber: Current GPU number
+*/
+__global__
+void gpuBuildSpongeLayer(NodeTypeMap* const gpuMapBC, int gpuNumber);
+
+#endif // !__SPONGE_LAYER_H
@@ -0,0 +1,235 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "stepGraph.h"
+
+
+__host__
+void stepGraphSetup(StepGraph* graph)
+{
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        // Blocking streams, so the following kernels in default stream 
+        // wait for them
+        checkCudaErrors(cudaStreamCreate(&(graph->stream[i])));
+        checkCudaErrors(cudaEventCreateWithFlags(&(graph->collideDone[i]), 
+            cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(graph->interiorDone[i]), 
+            cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(graph->transferDone[i]), 
+            cudaEventDisableTiming));
+        checkCudaErrors(cudaEventCreateWithFlags(&(graph->join[i]), 
+            cudaEventDisableTiming));
+    }
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaEventCreateWithFlags(&(graph->fork), cudaEventDisableTiming));
+    for(int p = 0; p < STEP_GRAPH_N_POP; p++){
+        graph->popKey[p] = nullptr;
+        graph->exec[p][0] = nullptr;
+        graph->exec[p][1] = nullptr;
+    }
+    graph->nPop = 0;
+    graph->nRecorded = 0;
+}
+
+
+__host__
+void stepGraphFree(StepGraph* graph)
+{
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    for(int p = 0; p < graph->nPop; p++)
+        for(int s = 0; s < 2; s++)
+            if(graph->exec[p][s] != nullptr)
+                checkCudaErrors(cudaGraphExecDestroy(graph->exec[p][s]));
+    checkCudaErrors(cudaEventDestroy(graph->fork));
+    for(int i = gpuBegin(); i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaStreamDestroy(graph->stream[i]));
+        checkCudaErrors(cudaEventDestroy(graph->collideDone[i]));
+        checkCudaErrors(cudaEventDestroy(graph->interiorDone[i]));
+        checkCudaErrors(cudaEventDestroy(graph->transferDone[i]));
+        checkCudaErrors(cudaEventDestroy(graph->join[i]));
+    }
+}
+
+
+/*
+*   @brief Launches the step of all GPUs in the streams of the graph, ordered
+*          by events. All streams used depend on the fork event and are 
+*          joined back to the stream of first GPU, as required to capture
+*   @param graph: step graph
+*   @param (others): as in stepGraphLaunch
+*/
+__host__
+static void stepGraphStep(StepGraph* graph,
+    HaloOverlap* overlap,
+    HaloBuffers* halo,
+    const DomainDecomposition* decomp,
+    Populations* pop,
+    Macroscopics* macr,
+    BoundaryConditionsInfo* bcInfos,
+    dim3* gridsBC,
+    const dim3 grid,
+    const dim3 threads,
+    const dim3 gridTransfer,
+    const dim3 threadsTransfer,
+    const bool save,
+    const int step)
+{
+    const int first = gpuBegin();
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[first]));
+    checkCudaErrors(cudaEventRecord(graph->fork, graph->stream[first]));
+    for(int i = first+1; i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaStreamWaitEvent(graph->stream[i], graph->fork, 0));
+    }
+
+    #if HALO_OVERLAP
+    // Collision and streaming and transfer in the streams of the overlap
+    for(int i = first; i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaStreamWaitEvent(overlap->streamBorder[i], graph->fork, 0));
+        checkCudaErrors(cudaStreamWaitEvent(overlap->streamInterior[i], graph->fork, 0));
+    }
+    haloOverlapStep(overlap, halo, decomp, pop, macr, grid, threads, 
+        gridTransfer, threadsTransfer, save, step);
+    for(int i = first; i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaEventRecord(graph->collideDone[i], overlap->streamBorder[i]));
+        checkCudaErrors(cudaEventRecord(graph->interiorDone[i], overlap->streamInterior[i]));
+    }
+    for(int i = first; i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaStreamWaitEvent(graph->stream[i], graph->collideDone[i], 0));
+        checkCudaErrors(cudaStreamWaitEvent(graph->stream[i], graph->interiorDone[i], 0));
+        #if !POP_PACKED_HALO
+        // Border planes of GPU are written by the transfer of previous GPU
+        const int prv = (i+N_GPUS-1)%N_GPUS;
+        checkCudaErrors(cudaStreamWaitEvent(graph->stream[i], graph->collideDone[prv], 0));
+        #endif
+    }
+    #else
+    for(int i = first; i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        macrCollisionStream(&pop[i], macr[i], grid, threads, graph->stream[i], 
+            save, step, 0);
+        #if POP_HALO_LAYOUT
+        // Populations streamed to halo nodes to periodic faces
+        const dim3 gridHalo((N_HALO_PERIMETER+N_THREADS-1)/N_THREADS, N_HALO_PLANES, 1);
+        gpuPopulationsHaloCopy<<<gridHalo, dim3(N_THREADS, 1, 1), 0, graph->stream[i]>>>
+            (pop[i].popAux);
+        #endif
+        checkCudaErrors(cudaEventRecord(graph->collideDone[i], graph->stream[i]));
+        getLastCudaError("LBM kernel error\n");
+    }
+
+    #if POP_PACKED_HALO
+    // Unpack waits for the copies from the neighbor GPUs
+    haloExchange(halo, decomp, pop, graph->stream);
+    #else
+    // Transfer between each GPU and the next one, as soon as both are done
+    for(int i = first; i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        const int nxt = (i+1)%N_GPUS;
+        checkCudaErrors(cudaStreamWaitEvent(graph->stream[i], graph->collideDone[nxt], 0));
+        gpuPopulationsTransfer<<<gridTransfer, threadsTransfer, 0, graph->stream[i]>>>
+            (pop[i].popAux, pop[nxt].popAux);
+        checkCudaErrors(cudaEventRecord(graph->transferDone[i], graph->stream[i]));
+        getLastCudaError("Mem transfer kernel error\n");
+    }
+    for(int i = first; i < gpuEnd(); i++){
+        // Border planes of GPU are written by the transfer of previous GPU
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        const int prv = (i+N_GPUS-1)%N_GPUS;
+        checkCudaErrors(cudaStreamWaitEvent(graph->stream[i], graph->transferDone[prv], 0));
+    }
+    #endif
+    #endif
+
+    // Boundary conditions, then join
+    for(int i = first; i < gpuEnd(); i++){
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        applyBC(&bcInfos[i], &pop[i], gridsBC[i], graph->stream[i]);
+        checkCudaErrors(cudaEventRecord(graph->join[i], graph->stream[i]));
+    }
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[first]));
+    for(int i = first+1; i < gpuEnd(); i++)
+        checkCudaErrors(cudaStreamWaitEvent(graph->stream[first], graph->join[i], 0));
+}
+
+
+__host__
+void stepGraphLaunch(StepGraph* graph,
+    HaloOverlap* overlap,
+    HaloBuffers* halo,
+    const DomainDecomposition* decomp,
+    Populations* pop,
+    Macroscopics* macr,
+    BoundaryConditionsInfo* bcInfos,
+    dim3* gridsBC,
+    const dim3 grid,
+    const dim3 threads,
+    const dim3 gridTransfer,
+    const dim3 threadsTransfer,
+    const bool save,
+    const int step)
+{
+    const int first = gpuBegin();
+
+    // Graph of the populations (their pointers are in the kernels arguments)
+    int p = 0;
+    while(p < graph->nPop && graph->popKey[p] != pop[first].pop)
+        p++;
+    if(p == graph->nPop){
+        if(p >= STEP_GRAPH_N_POP){
+            fprintf(stderr, "Populations changed after the step graphs were recorded\n");
+            fflush(stderr);
+            exit(-1);
+        }
+        graph->popKey[p] = pop[first].pop;
+        graph->nPop++;
+    }
+    cudaGraphExec_t* exec = &(graph->exec[p][save ? 1 : 0]);
+
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[first]));
+    if(*exec == nullptr){
+        cudaGraph_t stepCaptured;
+        checkCudaErrors(cudaStreamBeginCapture(graph->stream[first], 
+            cudaStreamCaptureModeGlobal));
+        stepGraphStep(graph, overlap, halo, decomp, pop, macr, bcInfos, gridsBC,
+            grid, threads, gridTransfer, threadsTransfer, save, step);
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[first]));
+        checkCudaErrors(cudaStreamEndCapture(graph->stream[first], &stepCaptured));
+        checkCudaErrors(cudaGraphInstantiateWithFlags(exec, stepCaptured, 0));
+        checkCudaErrors(cudaGraphDestroy(stepCaptured));
+        graph->nRecorded++;
+    }
+    checkCudaErrors(cudaGraphLaunch(*exec, graph->stream[first]));
+}
+
+
+__host__
+void stepGraphSync(StepGraph* graph)
+{
+    // The graph launch is done when the nodes of all GPUs are done
+    checkCudaErrors(cudaSetDevice(GPUS_TO_USE[gpuBegin()]));
+    checkCudaErrors(cudaStreamSynchronize(graph->stream[gpuBegin()]));
+}
@@ -0,0 +1,121 @@
+/*
+*   @file stepGraph.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Step of all GPUs recorded in CUDA graphs (STEP_GRAPH): collision
+*          and streaming, transfer between GPUs and boundary conditions, with
+*          the dependencies between GPUs as events instead of device 
+*          synchronizations. The step is captured once for each populations
+*          swap and save flag and then replayed, so the steps are queued 
+*          with one launch each and only synchronized when used by host
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __STEP_GRAPH_H
+#define __STEP_GRAPH_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "var.h"
+#include "errorDef.h"
+#include "lbm.h"
+#include "popHalo.h"
+#include "haloPack.h"
+#include "haloOverlap.h"
+#include "mpiBackend.h"
+#include "structs/populations.h"
+#include "structs/macroscopics.h"
+#include "structs/boundaryConditionsInfo.h"
+
+#if STEP_GRAPH && MPI_BACKEND
+#error "STEP_GRAPH can not be used with MPI_BACKEND"
+#endif
+#if STEP_GRAPH && BC_GROUPS_TIMING
+#error "STEP_GRAPH can not be used with BC_GROUPS_TIMING"
+#endif
+
+// Populations of first GPU recorded (pop and popAux are swapped each step)
+#define STEP_GRAPH_N_POP (2)
+
+
+/*
+*   Streams, events and recorded graphs of the step
+*/
+typedef struct stepGraph {
+    cudaStream_t stream[N_GPUS];        // stream of each GPU, the graphs are
+                                        // launched in the one of first GPU
+    cudaEvent_t fork;                   // start of step (first GPU)
+    cudaEvent_t collideDone[N_GPUS];    // collision and streaming done
+    cudaEvent_t interiorDone[N_GPUS];   // interior planes done (HALO_OVERLAP)
+    cudaEvent_t transferDone[N_GPUS];   // transfer to next GPU done
+    cudaEvent_t join[N_GPUS];           // step of GPU done
+    dfloat* popKey[STEP_GRAPH_N_POP];   // populations of first GPU of graphs
+    cudaGraphExec_t exec[STEP_GRAPH_N_POP][2];  // graph of each populations
+                                                // and save flag
+    int nPop;                           // number of populations recorded
+    int nRecorded;                      // number of graphs recorded
+} StepGraph;
+
+
+/*
+*   @brief Creates streams and events of the step graph
+*   @param graph: step graph to setup
+*/
+__host__
+void stepGraphSetup(StepGraph* graph);
+
+
+/*
+*   @brief Destroys streams, events and recorded graphs
+*   @param graph: step graph to free
+*/
+__host__
+void stepGraphFree(StepGraph* graph);
+
+
+/*
+*   @brief Launches the step of all GPUs, recording its graph if it is the
+*          first step with these populations and save flag. Asynchronous. 
+*          The kernels do not depend on the step, it is only used to record
+*   @param graph: step graph
+*   @param overlap: overlap streams and events (HALO_OVERLAP, nullptr 
+*                   otherwise)
+*   @param halo: packed buffers of each GPU (POP_PACKED_HALO)
+*   @param decomp: domain decomposition (POP_PACKED_HALO)
+*   @param pop: populations of each GPU
+*   @param macr: macroscopics of each GPU
+*   @param bcInfos: boundary conditions info of each GPU
+*   @param gridsBC: grid of gpuApplyBC of each GPU
+*   @param grid: grid of gpuMacrCollisionStream (all planes)
+*   @param threads: threads of gpuMacrCollisionStream
+*   @param gridTransfer: grid of gpuPopulationsTransfer
+*   @param threadsTransfer: threads of gpuPopulationsTransfer
+*   @param save: save macroscopics
+*   @param step: simulation step
+*/
+__host__
+void stepGraphLaunch(StepGraph* graph,
+    HaloOverlap* overlap,
+    HaloBuffers* halo,
+    const DomainDecomposition* decomp,
+    Populations* pop,
+    Macroscopics* macr,
+    BoundaryConditionsInfo* bcInfos,
+    dim3* gridsBC,
+    const dim3 grid,
+    const dim3 threads,
+    const dim3 gridTransfer,
+    const dim3 threadsTransfer,
+    const bool save,
+    const int step);
+
+
+/*
+*   @brief Waits for the steps launched, in all GPUs
+*   @param graph: step graph
+*/
+__host__
+void stepGraphSync(StepGraph* graph);
+
+#endif // !__STEP_GRAPH_H
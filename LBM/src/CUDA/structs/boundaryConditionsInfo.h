@@ -11,9 +11,33 @@
 #include "../var.h"
 #include "../globalFunctions.h"
 #include "../errorDef.h"
+#include "../memArena.h"
 #include "nodeTypeMap.h"
+#include "../boundaryConditionsSchemes/interpolatedBounceBack.h"
+#include "../boundaryConditionsSchemes/outflow.h"
 #include <cuda.h>
 
+// Maximum number of groups of boundary conditions nodes, one for each
+// scheme (4 bits), direction (5 bits) and geometry (1 bit)
+#define BC_GROUPS_MAX (1 << 10)
+
+/*
+*   Group of boundary conditions nodes with same scheme, direction and geometry
+*/
+typedef struct bcGroup {
+    unsigned char scheme;       // boundary condition scheme
+    unsigned char direction;    // boundary condition direction
+    unsigned char geometry;     // boundary condition geometry
+    size_t first;               // first node of group in idxBCNodes
+    size_t count;               // number of nodes of group
+    #if BC_GROUPS_TIMING
+    cudaEvent_t start;          // events around group kernel
+    cudaEvent_t stop;
+    float timeElapsed;          // total time of group kernel, in ms
+    #endif
+} BCGroup;
+
+
 /* 
 *   Struct for boundary conditions info
 */
@@ -22,8 +46,41 @@ typedef struct boundaryConditionsInfo{
     size_t totalBCNodes;
     // Number of non local boundary conditions nodes
     size_t totalNonLocalBCNodes;
-    // Index of non local boundary conditions nodes
+    // Index of non local boundary conditions nodes, sorted by groups
     size_t* idxBCNodes;
+    // Number of groups of boundary conditions nodes
+    unsigned int totalBCGroups;
+    // Groups of boundary conditions nodes (host)
+    BCGroup bcGroups[BC_GROUPS_MAX];
+    // Number of links of interpolated bounce back (unknown populations)
+    size_t totalInterpBBLinks;
+    // Links of interpolated bounce back, idxScalar(x, y, z)*Q + population
+    size_t* idxInterpBBLinks;
+    // Wall distance (q) of the links of interpolated bounce back
+    float* qInterpBBLinks;
+    // First outflow node in idxBCNodes (outflow groups are the last ones)
+    size_t firstOutflowNode;
+    // Number of outflow nodes
+    size_t totalOutflowNodes;
+    // Values of previous step of outflow nodes, 
+    // popOutflowPrev[k*totalOutflowNodes + n] (OUTFLOW_N_PREV values)
+    dfloat* popOutflowPrev;
+    // Number of slots in buffer of post collision populations
+    size_t totalPostColNodes;
+    // Slots of rows of 32 nodes in x, the masks of nodes with slot 
+    // (NUMBER_POST_COL_ROWS) and then the slots of the first node of each row
+    unsigned int* slotPostCol;
+    // Buffer of post collision populations, popPostColBC[i*totalPostColNodes + slot]
+    dfloat* popPostColBC;
+    // Number of links of symmetry with the mirrored population from another
+    // partition
+    size_t totalSymLinks;
+    // Links of symmetry, idxPop of the unknown population
+    size_t* idxSymLinks;
+    // Links of symmetry, idxPop of the mirrored population after the halo exchange
+    size_t* idxSymSrc;
+    // Values of the links of symmetry, read before the boundary conditions
+    dfloat* popSymLinks;
 
     /* Constructor */
     __host__
@@ -32,6 +89,19 @@ typedef struct boundaryConditionsInfo{
         this->totalBCNodes = 0;
         this->totalNonLocalBCNodes = 0;
         this->idxBCNodes = nullptr;
+        this->totalInterpBBLinks = 0;
+        this->idxInterpBBLinks = nullptr;
+        this->qInterpBBLinks = nullptr;
+        this->firstOutflowNode = 0;
+        this->totalOutflowNodes = 0;
+        this->popOutflowPrev = nullptr;
+        this->totalPostColNodes = 0;
+        this->slotPostCol = nullptr;
+        this->popPostColBC = nullptr;
+        this->totalSymLinks = 0;
+        this->idxSymLinks = nullptr;
+        this->idxSymSrc = nullptr;
+        this->popSymLinks = nullptr;
     }
 
     /* Destructor */
@@ -41,6 +111,19 @@ typedef struct boundaryConditionsInfo{
         this->totalBCNodes = 0;
         this->totalNonLocalBCNodes = 0;
         this->idxBCNodes = nullptr;
+        this->totalInterpBBLinks = 0;
+        this->idxInterpBBLinks = nullptr;
+        this->qInterpBBLinks = nullptr;
+        this->firstOutflowNode = 0;
+        this->totalOutflowNodes = 0;
+        this->popOutflowPrev = nullptr;
+        this->totalPostColNodes = 0;
+        this->slotPostCol = nullptr;
+        this->popPostColBC = nullptr;
+        this->totalSymLinks = 0;
+        this->idxSymLinks = nullptr;
+        this->idxSymSrc = nullptr;
+        this->popSymLinks = nullptr;
     }
 
     /**
@@ -52,7 +135,7 @@ typedef struct boundaryConditionsInfo{
         if(this->totalBCNodes <= 0)
             return;
         size_t memSizeIdxBC = this->totalBCNodes*sizeof(size_t);
-        checkCudaErrors(cudaMallocManaged((void**)&(this->idxBCNodes), memSizeIdxBC));
+        this->idxBCNodes = (size_t*)simMalloc(memSizeIdxBC, IN_VIRTUAL);
     }
 
     /**
@@ -63,56 +146,306 @@ typedef struct boundaryConditionsInfo{
     {
         if(this->idxBCNodes == nullptr || this->totalBCNodes == 0)
             return;
-        checkCudaErrors(cudaFree(this->idxBCNodes));
+        simFree(this->idxBCNodes, IN_VIRTUAL);
         this->idxBCNodes = nullptr;
+        #if BC_GROUPS_TIMING
+        for(unsigned int g = 0; g < this->totalBCGroups; g++)
+        {
+            checkCudaErrors(cudaEventDestroy(this->bcGroups[g].start));
+            checkCudaErrors(cudaEventDestroy(this->bcGroups[g].stop));
+        }
+        #endif
+        this->totalBCGroups = 0;
     }
 
     /**
-    *   @brief setup boundary conditions informations and nodes, using BC map
+    *   @brief Checks if node is in the boundary conditions nodes (interpolated
+    *          bounce back nodes are applied by its links)
+    *   
+    *   @param ntm: node's map
+    *   @return true if node is a boundary condition node
+    */
+    __host__ __device__
+    static bool isBCNode(NodeTypeMap& ntm)
+    {
+        return ntm.getIsUsed() && ntm.getSchemeBC() != BC_NULL && !ntm.isInterpBB();
+    }
+
+    /**
+    *   @brief Group key of boundary condition node
     *   
-    *   @param mapBC: map with simulation's BC
+    *   @param ntm: node's map
+    *   @return key, with scheme, direction and geometry
+    */
+    __host__ __device__
+    static unsigned int bcGroupKey(NodeTypeMap& ntm)
+    {
+        return (((unsigned int)ntm.getSchemeBC() << 6) 
+            | ((unsigned int)ntm.getDirection() << 1) | ntm.getGeometry());
+    }
+
+    #if BC_GROUPS_TIMING
+    /**
+    *   @brief Adds the time of the last kernel of each group. Must be called 
+    *          after the device is synchronized
     */
     __host__
-    void setupBoundaryConditionsInfo(NodeTypeMap* mapBC)
+    void updateBCGroupsTime()
     {
-        this->totalBCNodes = 0;
-        this->totalNonLocalBCNodes = 0;
+        for(unsigned int g = 0; g < this->totalBCGroups; g++)
+        {
+            float t = 0;
+            checkCudaErrors(cudaEventElapsedTime(&t, 
+                this->bcGroups[g].start, this->bcGroups[g].stop));
+            this->bcGroups[g].timeElapsed += t;
+        }
+    }
+    #endif
 
-        // get number of BC nodes
-        for(int z = 0; z < NZ; z++)
-            for(int y = 0; y < NY; y++)
-                for(int x = 0; x < NX; x++)
-                {
-                    NodeTypeMap ntm = mapBC[idxScalar(x, y, z)];
-                    if(ntm.getIsUsed())
-                        if(ntm.getSchemeBC() != BC_NULL)
-                        {
-                            this->totalBCNodes++;
-                            if(!(ntm.isBCLocal()))
-                                this->totalNonLocalBCNodes++;
-                        }
-                }
+    /**
+    *   @brief Free links of interpolated bounce back
+    */
+    __host__
+    void freeInterpBBLinks()
+    {
+        if(this->idxInterpBBLinks == nullptr || this->totalInterpBBLinks == 0)
+            return;
+        simFree(this->idxInterpBBLinks, IN_VIRTUAL);
+        simFree(this->qInterpBBLinks, IN_VIRTUAL);
+        this->idxInterpBBLinks = nullptr;
+        this->qInterpBBLinks = nullptr;
+        this->totalInterpBBLinks = 0;
+    }
 
-        if(this->totalBCNodes <= 0)
+    /**
+    *   @brief Setup links of interpolated bounce back from the wall distances 
+    *          of its nodes. Only the links cut by the wall are stored
+    *   
+    *   @param wallDist: wall distances of interpolated bounce back nodes
+    */
+    __host__
+    void setupInterpBBLinks(const InterpBBWallDist* wallDist)
+    {
+        this->totalInterpBBLinks = 0;
+        for(size_t j = 0; j < wallDist->q.size(); j++)
+            if(wallDist->q[j] >= 0)
+                this->totalInterpBBLinks++;
+
+        if(this->totalInterpBBLinks <= 0)
+            return;
+
+        this->idxInterpBBLinks = (size_t*)simMalloc(
+            this->totalInterpBBLinks*sizeof(size_t), IN_VIRTUAL);
+        this->qInterpBBLinks = (float*)simMalloc(
+            this->totalInterpBBLinks*sizeof(float), IN_VIRTUAL);
+
+        size_t l = 0;
+        for(size_t n = 0; n < wallDist->idxNodes.size(); n++)
+            for(int i = 0; i < Q; i++)
+            {
+                const float q = wallDist->q[n*Q+i];
+                if(q < 0)
+                    continue;
+                this->idxInterpBBLinks[l] = wallDist->idxNodes[n]*Q + i;
+                this->qInterpBBLinks[l] = q;
+                l++;
+            }
+    }
+
+    /**
+    *   @brief Setup outflow nodes from the groups and allocate their buffer 
+    *          of previous step values. Must be called after the groups are 
+    *          set up
+    */
+    __host__
+    void setupOutflowBC()
+    {
+        this->firstOutflowNode = this->totalBCNodes;
+        this->totalOutflowNodes = 0;
+        this->popOutflowPrev = nullptr;
+        for(unsigned int g = 0; g < this->totalBCGroups; g++)
+        {
+            NodeTypeMap ntm;
+            ntm.map = 0;
+            ntm.setSchemeBC(this->bcGroups[g].scheme);
+            if(!ntm.isOutflow())
+                continue;
+            // outflow schemes have the greatest keys, so its groups are 
+            // contiguous at the end of idxBCNodes
+            if(this->totalOutflowNodes == 0)
+                this->firstOutflowNode = this->bcGroups[g].first;
+            this->totalOutflowNodes += this->bcGroups[g].count;
+        }
+
+        if(this->totalOutflowNodes <= 0)
+            return;
+        this->popOutflowPrev = (dfloat*)simMalloc(
+            this->totalOutflowNodes*OUTFLOW_N_PREV*sizeof(dfloat), IN_VIRTUAL);
+    }
+
+    /**
+    *   @brief Free buffer of outflow nodes
+    */
+    __host__
+    void freeOutflowBC()
+    {
+        if(this->popOutflowPrev == nullptr || this->totalOutflowNodes == 0)
+            return;
+        simFree(this->popOutflowPrev, IN_VIRTUAL);
+        this->popOutflowPrev = nullptr;
+        this->totalOutflowNodes = 0;
+    }
+
+    /**
+    *   @brief Free buffer of post collision populations and its slots
+    */
+    __host__
+    void freePostColBuffer()
+    {
+        if(this->slotPostCol != nullptr)
+            simFree(this->slotPostCol, IN_VIRTUAL);
+        if(this->popPostColBC != nullptr)
+            simFree(this->popPostColBC, IN_VIRTUAL);
+        this->slotPostCol = nullptr;
+        this->popPostColBC = nullptr;
+        this->totalPostColNodes = 0;
+    }
+
+    /**
+    *   @brief Free links of symmetry
+    */
+    __host__
+    void freeSymmetryLinks()
+    {
+        if(this->idxSymLinks == nullptr || this->totalSymLinks == 0)
             return;
+        simFree(this->idxSymLinks, IN_VIRTUAL);
+        simFree(this->idxSymSrc, IN_VIRTUAL);
+        simFree(this->popSymLinks, IN_VIRTUAL);
+        this->idxSymLinks = nullptr;
+        this->idxSymSrc = nullptr;
+        this->popSymLinks = nullptr;
+        this->totalSymLinks = 0;
+    }
+
+    /**
+    *   @brief Setup groups of boundary conditions nodes from its number of 
+    *          nodes and allocate BC indexes. Groups are in order of key
+    *   
+    *   @param groupCount[BC_GROUPS_MAX]: number of nodes of each group key
+    *   @param groupFirst[BC_GROUPS_MAX]: first node of each group key in 
+    *                                     idxBCNodes, to write to
+    */
+    __host__
+    void setupBCGroups(const size_t* groupCount, size_t* groupFirst)
+    {
+        this->totalBCNodes = 0;
+        this->totalNonLocalBCNodes = 0;
+        this->totalBCGroups = 0;
+        // links are set by setupInterpBBLinks
+        this->totalInterpBBLinks = 0;
+        this->idxInterpBBLinks = nullptr;
+        this->qInterpBBLinks = nullptr;
+        // outflow nodes are set by setupOutflowBC
+        this->firstOutflowNode = 0;
+        this->totalOutflowNodes = 0;
+        this->popOutflowPrev = nullptr;
+
+        for(unsigned int key = 0; key < BC_GROUPS_MAX; key++)
+        {
+            groupFirst[key] = this->totalBCNodes;
+            if(groupCount[key] == 0)
+                continue;
+            BCGroup* group = &(this->bcGroups[this->totalBCGroups]);
+            group->scheme = (key >> 6) & 0b1111;
+            group->direction = (key >> 1) & 0b11111;
+            group->geometry = key & 0b1;
+            group->first = this->totalBCNodes;
+            group->count = groupCount[key];
+            #if BC_GROUPS_TIMING
+            checkCudaErrors(cudaEventCreate(&(group->start)));
+            checkCudaErrors(cudaEventCreate(&(group->stop)));
+            group->timeElapsed = 0;
+            #endif
+            // locality depends only on the scheme
+            NodeTypeMap ntm;
+            ntm.map = 0;
+            ntm.setSchemeBC(group->scheme);
+            if(!(ntm.isBCLocal()))
+                this->totalNonLocalBCNodes += group->count;
+            this->totalBCNodes += group->count;
+            this->totalBCGroups++;
+        }
 
         // allocate memory for idx
         allocateIdxBC();
+    }
 
-        // update index of non local boundary conditions
-        int i = 0;
+    /**
+    *   @brief setup boundary conditions informations and nodes, using BC map
+    *          in host (OpenMP). Nodes are sorted in groups with same scheme, 
+    *          direction and geometry, and by index in each group. Each plane
+    *          in z is counted and scattered in parallel, with the first node 
+    *          of each plane from the prefix sum of the counts
+    *   
+    *   @param mapBC: map with simulation's BC (host)
+    */
+    __host__
+    void setupBoundaryConditionsInfo(NodeTypeMap* mapBC)
+    {
+        // number of nodes of each group in each plane
+        size_t* planeCount = (size_t*)calloc((size_t)NZ*BC_GROUPS_MAX, sizeof(size_t));
+        #pragma omp parallel for schedule(dynamic)
         for(int z = 0; z < NZ; z++)
+        {
+            size_t* count = &(planeCount[(size_t)z*BC_GROUPS_MAX]);
             for(int y = 0; y < NY; y++)
                 for(int x = 0; x < NX; x++)
                 {
                     NodeTypeMap ntm = mapBC[idxScalar(x, y, z)];
-                    if(ntm.getIsUsed())
-                        if(ntm.getSchemeBC() != BC_NULL)
-                        {
-                            this->idxBCNodes[i] = idxScalar(x, y, z);
-                            i++;
-                        }
+                    if(isBCNode(ntm))
+                        count[bcGroupKey(ntm)]++;
                 }
+        }
+
+        size_t* groupCount = (size_t*)calloc(BC_GROUPS_MAX, sizeof(size_t));
+        size_t* groupFirst = (size_t*)calloc(BC_GROUPS_MAX, sizeof(size_t));
+        for(int z = 0; z < NZ; z++)
+            for(unsigned int key = 0; key < BC_GROUPS_MAX; key++)
+                groupCount[key] += planeCount[(size_t)z*BC_GROUPS_MAX+key];
+        setupBCGroups(groupCount, groupFirst);
+
+        if(this->totalBCNodes > 0)
+        {
+            // first node of each group in each plane (exclusive prefix sum in z)
+            for(unsigned int key = 0; key < BC_GROUPS_MAX; key++)
+            {
+                size_t first = groupFirst[key];
+                for(int z = 0; z < NZ; z++)
+                {
+                    const size_t count = planeCount[(size_t)z*BC_GROUPS_MAX+key];
+                    planeCount[(size_t)z*BC_GROUPS_MAX+key] = first;
+                    first += count;
+                }
+            }
+
+            // update index of boundary conditions
+            #pragma omp parallel for schedule(dynamic)
+            for(int z = 0; z < NZ; z++)
+            {
+                size_t* next = &(planeCount[(size_t)z*BC_GROUPS_MAX]);
+                for(int y = 0; y < NY; y++)
+                    for(int x = 0; x < NX; x++)
+                    {
+                        NodeTypeMap ntm = mapBC[idxScalar(x, y, z)];
+                        if(isBCNode(ntm))
+                            this->idxBCNodes[next[bcGroupKey(ntm)]++] = idxScalar(x, y, z);
+                    }
+            }
+        }
+        free(planeCount);
+        free(groupCount);
+        free(groupFirst);
     }
 
 }BoundaryConditionsInfo;
@@ -12,6 +12,7 @@
 
 #include "../var.h"
 #include "../errorDef.h"
+#include "../memArena.h"
 
 /*
 *   Struct for dfloat in x, y, z
@@ -70,14 +71,10 @@ typedef struct dfloat3SoA {
         this->varLocation = location;
         switch(location){
         case IN_VIRTUAL:
-            checkCudaErrors(cudaMallocManaged((void**)&(this->x), memSize));
-            checkCudaErrors(cudaMallocManaged((void**)&(this->y), memSize));
-            checkCudaErrors(cudaMallocManaged((void**)&(this->z), memSize));
-            break;
         case IN_HOST:
-            checkCudaErrors(cudaMallocHost((void**)&(this->x), memSize));
-            checkCudaErrors(cudaMallocHost((void**)&(this->y), memSize));
-            checkCudaErrors(cudaMallocHost((void**)&(this->z), memSize));
+            this->x = (dfloat*)simMalloc(memSize, location);
+            this->y = (dfloat*)simMalloc(memSize, location);
+            this->z = (dfloat*)simMalloc(memSize, location);
             break;
         default:
             break;
@@ -92,15 +89,10 @@ typedef struct dfloat3SoA {
         switch (this->varLocation)
         {
         case IN_VIRTUAL:
-            checkCudaErrors(cudaFree(this->x));
-            checkCudaErrors(cudaFree(this->y));
-            checkCudaErrors(cudaFree(this->z));
-            break;
-
         case IN_HOST:
-            checkCudaErrors(cudaFreeHost(this->x));
-            checkCudaErrors(cudaFreeHost(this->y));
-            checkCudaErrors(cudaFreeHost(this->z));
+            simFree(this->x, this->varLocation);
+            simFree(this->y, this->varLocation);
+            simFree(this->z, this->varLocation);
             break;
         default:
             break;
@@ -11,6 +11,16 @@
 
 #include "../globalFunctions.h"
 #include "macroscopics.h"
+#include "../errorDef.h"
+#include "../memArena.h"
+#include "../mpiBackend.h"
+
+// Positions of the values in the array of sums used by the reductions
+#define MACR_PROC_SUM_RES 0     // numerator of residual
+#define MACR_PROC_SUM_RHO 1     // sum of rho
+#define MACR_PROC_SUM_UZ_XZ 2   // sum of uz in each XZ plan (NY_TOTAL values)
+#define MACR_PROC_N_SUMS (2+NY_TOTAL) // total number of sums
+#define MEM_SIZE_MACR_PROC_SUMS (sizeof(dfloat)*MACR_PROC_N_SUMS)
 
 
 /*
@@ -25,7 +35,9 @@ typedef struct macrProc{
     // Treated values below
     dfloat residual;
     dfloat avgRho;
-    dfloat avgUzPlanXZ[NY]; // average Uz velocity in all XZ plans
+    dfloat avgUzPlanXZ[NY_TOTAL]; // average Uz velocity in all XZ plans
+
+    dfloat* sumsGPU[N_GPUS];   // sums of each GPU for reductions (MACR_PROC_N_SUMS)
 
     /* Constructor */
     __host__
@@ -36,8 +48,10 @@ typedef struct macrProc{
         step = nullptr;
         residual = 1;
         avgRho = RHO_0;
-        for(int i = 0; i < NY; i++)
+        for(int i = 0; i < NY_TOTAL; i++)
             avgUzPlanXZ[i] = 0;
+        for(int i = 0; i < N_GPUS; i++)
+            sumsGPU[i] = nullptr;
     }
 
     /* Destructor */
@@ -55,12 +69,25 @@ typedef struct macrProc{
     __host__
     void allocateMacrProc()
     {
+        #if DATA_REDUCTION_GPU
+        for(int i = gpuBegin(); i < gpuEnd(); i++){
+            checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+            sumsGPU[i] = (dfloat*)simMalloc(MEM_SIZE_MACR_PROC_SUMS, IN_VIRTUAL);
+        }
+        #endif
     }
 
     /* Free allocated variables, if required dynamic allocation */
     __host__
     void freeMacrProc()
     {
+        for(int i = 0; i < N_GPUS; i++){
+            if(sumsGPU[i] != nullptr){
+                checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+                simFree(sumsGPU[i], IN_VIRTUAL);
+                sumsGPU[i] = nullptr;
+            }
+        }
     }
 
 }MacrProc;
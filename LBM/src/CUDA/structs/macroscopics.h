@@ -12,10 +12,43 @@
 #include "../var.h"
 #include "../globalFunctions.h"
 #include "../errorDef.h"
+#include "../memArena.h"
 #include "../NNF/nnf.h"
 #include "globalStructs.h"
 #include <cuda.h>
 
+// Macroscopics fields, so only the ones with consumers are allocated
+#define MACR_FIELD_RHO      (0b0001)
+#define MACR_FIELD_U        (0b0010)
+#define MACR_FIELD_F        (0b0100)
+#define MACR_FIELD_OMEGA    (0b1000)
+
+#ifdef IBM
+#define MACR_FIELD_F_DEVICE MACR_FIELD_F
+#else
+#define MACR_FIELD_F_DEVICE (0)
+#endif
+#if defined(IBM) && EXPORT_FORCES
+#define MACR_FIELD_F_HOST MACR_FIELD_F
+#else
+#define MACR_FIELD_F_HOST (0)
+#endif
+#ifdef NON_NEWTONIAN_FLUID
+#define MACR_FIELD_OMEGA_USED MACR_FIELD_OMEGA
+#else
+#define MACR_FIELD_OMEGA_USED (0)
+#endif
+
+// Fields in device. Density and velocity are always used by LBM kernels
+#define MACR_FIELDS_DEVICE (MACR_FIELD_RHO | MACR_FIELD_U | MACR_FIELD_F_DEVICE \
+    | MACR_FIELD_OMEGA_USED)
+// Fields in host, only the ones saved to files or treated in host
+#define MACR_FIELDS_HOST (MACR_FIELD_RHO | MACR_FIELD_U | MACR_FIELD_F_HOST \
+    | MACR_FIELD_OMEGA_USED)
+// Host macroscopics are only required to save them or to treat data in host
+#define MACR_HOST_REQUIRED (MACR_SAVE || MACR_SAVE_LAST || MACR_HOST_OLD \
+    || (DATA_REPORT && !DATA_REDUCTION_GPU))
+
 /*
 *   Struct for LBM macroscopics
 */
@@ -23,6 +56,7 @@ typedef struct macroscopics
 {
 private:
     int varLocation;
+    unsigned int fields;    // allocated fields (MACR_FIELD_*)
 public:
     dfloat* rho;    // density
     dfloat3SoA u;  // velocity
@@ -39,6 +73,8 @@ public:
     __host__
     macroscopics()
     {
+        this->varLocation = 0;
+        this->fields = 0;
         this->rho = nullptr;
 
         #ifdef NON_NEWTONIAN_FLUID
@@ -57,32 +93,74 @@ public:
         #endif
     }
 
-    /* Allocate macroscopics */
+    /* 
+        Memory size of macroscopics fields. In host, there are values of all 
+        GPUs, without the border nodes, that are only required in device
+    */
+    __host__
+    static size_t macrMemSize(int varLocation, unsigned int fields)
+    {
+        size_t memBorder = (varLocation == IN_HOST ? 
+            TOTAL_MEM_SIZE_SCALAR : MEM_SIZE_IBM_SCALAR);
+        size_t memNoBorder = (varLocation == IN_HOST ? 
+            TOTAL_MEM_SIZE_SCALAR : MEM_SIZE_SCALAR);
+        size_t memSize = 0;
+
+        if(fields & MACR_FIELD_RHO)
+            memSize += memBorder;
+        if(fields & MACR_FIELD_U)
+            memSize += 3*memBorder;
+        if(fields & MACR_FIELD_F)
+            memSize += 3*memBorder;
+        if(fields & MACR_FIELD_OMEGA)
+            memSize += memNoBorder;
+        return memSize;
+    }
+
+    /* Checks if macroscopics are allocated */
     __host__
-    void macrAllocation(int varLocation)
+    bool isAllocated()
     {
+        return this->fields != 0;
+    }
+
+    /* Allocate macroscopics fields (MACR_FIELD_*) */
+    __host__
+    void macrAllocation(int varLocation, unsigned int fields)
+    {
+        // Fields not used in compilation are not allocated
+        fields &= (MACR_FIELD_RHO | MACR_FIELD_U | MACR_FIELD_F_DEVICE | MACR_FIELD_OMEGA_USED);
         this->varLocation = varLocation;
+        this->fields = fields;
         switch (varLocation)
         {
         case IN_HOST:
             // allocate with CUDA for pinned memory and for all GPUS
-            checkCudaErrors(cudaMallocHost((void**)&(this->rho), TOTAL_MEM_SIZE_IBM_SCALAR));
-            this->u.allocateMemory(TOTAL_NUMBER_LBM_IB_MACR_NODES, IN_HOST);
+            if(fields & MACR_FIELD_RHO)
+                this->rho = (dfloat*)simMalloc(TOTAL_MEM_SIZE_SCALAR, IN_HOST);
+            if(fields & MACR_FIELD_U)
+                this->u.allocateMemory(TOTAL_NUMBER_LBM_NODES, IN_HOST);
             #ifdef IBM
-            this->f.allocateMemory(TOTAL_NUMBER_LBM_IB_MACR_NODES, IN_HOST);
+            if(fields & MACR_FIELD_F)
+                this->f.allocateMemory(TOTAL_NUMBER_LBM_NODES, IN_HOST);
             #endif
             #ifdef NON_NEWTONIAN_FLUID
-            checkCudaErrors(cudaMallocHost((void**)&(this->omega), TOTAL_MEM_SIZE_SCALAR));
+            if(fields & MACR_FIELD_OMEGA)
+                this->omega = (dfloat*)simMalloc(TOTAL_MEM_SIZE_SCALAR, IN_HOST);
             #endif
             break;
         case IN_VIRTUAL:
-            checkCudaErrors(cudaMallocManaged((void**)&(this->rho), MEM_SIZE_IBM_SCALAR));
-            this->u.allocateMemory(NUMBER_LBM_IB_MACR_NODES, IN_VIRTUAL);
+            if(fields & MACR_FIELD_RHO)
+                this->rho = (dfloat*)simMalloc(MEM_SIZE_IBM_SCALAR, IN_VIRTUAL);
+            if(fields & MACR_FIELD_U)
+                this->u.allocateMemory(NUMBER_LBM_IB_MACR_NODES, IN_VIRTUAL);
             #ifdef IBM
-            this->f.allocateMemory(NUMBER_LBM_IB_MACR_NODES, IN_VIRTUAL);
+            if(fields & MACR_FIELD_F)
+                this->f.allocateMemory(NUMBER_LBM_IB_MACR_NODES, IN_VIRTUAL);
             #endif
             #ifdef NON_NEWTONIAN_FLUID
-            checkCudaErrors(cudaMallocManaged((void**)&(this->omega), MEM_SIZE_SCALAR));
+            if(fields & MACR_FIELD_OMEGA)
+                this->omega = (dfloat*)simMalloc(MEM_SIZE_SCALAR, IN_VIRTUAL);
             #endif
             break;
         default:
@@ -90,6 +168,14 @@ public:
         }
     }
 
+    /* Allocate macroscopics fields only in its first use */
+    __host__
+    void macrAllocationLazy(int varLocation, unsigned int fields)
+    {
+        if(!this->isAllocated())
+            this->macrAllocation(varLocation, fields);
+    }
+
     /* Free macroscopics */
     __host__
     void macrFree()
@@ -97,28 +183,37 @@ public:
         switch (this->varLocation)
         {
         case IN_HOST:
-            checkCudaErrors(cudaFreeHost(this->rho));
-            this->u.freeMemory();
+            if(this->fields & MACR_FIELD_RHO)
+                simFree(this->rho, IN_HOST);
+            if(this->fields & MACR_FIELD_U)
+                this->u.freeMemory();
             #ifdef IBM
-            this->f.freeMemory();
+            if(this->fields & MACR_FIELD_F)
+                this->f.freeMemory();
             #endif
             #ifdef NON_NEWTONIAN_FLUID
-            checkCudaErrors(cudaFreeHost(this->omega));
+            if(this->fields & MACR_FIELD_OMEGA)
+                simFree(this->omega, IN_HOST);
             #endif
             break;
         case IN_VIRTUAL:
-            checkCudaErrors(cudaFree(this->rho));
-            this->u.freeMemory();
+            if(this->fields & MACR_FIELD_RHO)
+                simFree(this->rho, IN_VIRTUAL);
+            if(this->fields & MACR_FIELD_U)
+                this->u.freeMemory();
             #ifdef IBM
-            this->f.freeMemory();
+            if(this->fields & MACR_FIELD_F)
+                this->f.freeMemory();
             #endif
             #ifdef NON_NEWTONIAN_FLUID
-            checkCudaErrors(cudaFree(this->omega));
+            if(this->fields & MACR_FIELD_OMEGA)
+                simFree(this->omega, IN_VIRTUAL);
             #endif
             break;
         default:
             break;
         }
+        this->fields = 0;
     }
 
     /*  
@@ -204,6 +299,59 @@ public:
 
     }
 
+    /*
+    *   @brief Copies macroscopics of a GPU partition to the global arrays 
+    *          (NX_TOTAL, NY_TOTAL, NZ_TOTAL), in the partition origin. With
+    *          uniform z slabs the partition is contiguous in the global arrays
+    *   @param macrRef: macroscopics of the GPU (IN_VIRTUAL)
+    *   @param gpuNumber: GPU number
+    */
+    __host__
+    void copyMacrPartition(macroscopics* macrRef, const int gpuNumber)
+    {
+        if(DECOMP_Z_SLABS && !DECOMP_Z_BALANCE){
+            this->copyMacr(macrRef, NUMBER_LBM_NODES*gpuNumber);
+            return;
+        }
+
+        // Partition boxes, one for each field
+        const size_t baseIdxRef = idxScalarWBorder(0, 0, 0);
+        copyPartitionField(this->rho, macrRef->rho+baseIdxRef, gpuNumber);
+        copyPartitionField(this->u.x, macrRef->u.x+baseIdxRef, gpuNumber);
+        copyPartitionField(this->u.y, macrRef->u.y+baseIdxRef, gpuNumber);
+        copyPartitionField(this->u.z, macrRef->u.z+baseIdxRef, gpuNumber);
+        #if defined(IBM) && EXPORT_FORCES
+        copyPartitionField(this->f.x, macrRef->f.x+baseIdxRef, gpuNumber);
+        copyPartitionField(this->f.y, macrRef->f.y+baseIdxRef, gpuNumber);
+        copyPartitionField(this->f.z, macrRef->f.z+baseIdxRef, gpuNumber);
+        #endif
+        #ifdef NON_NEWTONIAN_FLUID
+        // Omega has no ghost nodes
+        copyPartitionField(this->omega, macrRef->omega, gpuNumber);
+        #endif
+    }
+
+private:
+    /*
+    *   @brief Copies one field of a GPU partition (NX, NY, decompNZ) to the
+    *          global array, in the partition origin
+    *   @param dst: global array to write to
+    *   @param src: partition array, from its first node
+    *   @param gpuNumber: GPU number
+    */
+    __host__
+    static void copyPartitionField(dfloat* dst, dfloat* src, const int gpuNumber)
+    {
+        cudaMemcpy3DParms params = {0};
+        params.srcPtr = make_cudaPitchedPtr(src, NX*sizeof(dfloat), NX, NY);
+        params.dstPtr = make_cudaPitchedPtr(dst, NX_TOTAL*sizeof(dfloat), NX_TOTAL, NY_TOTAL);
+        params.dstPos = make_cudaPos(decompOrigin(gpuNumber, 0)*sizeof(dfloat), 
+            decompOrigin(gpuNumber, 1), decompOrigin(gpuNumber, 2));
+        params.extent = make_cudaExtent(NX*sizeof(dfloat), NY, decompNZ(gpuNumber));
+        params.kind = cudaMemcpyDefault;
+        checkCudaErrors(cudaMemcpy3D(&params));
+    }
+
 } Macroscopics;
 
 
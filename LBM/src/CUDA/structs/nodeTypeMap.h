@@ -13,9 +13,9 @@
 #include <stdint.h>
 
 // OFFSET DEFINES
+#define IS_USED_OFFSET 31
 #define SPC_INTERP_BB_OFFSET 23
 #define SAVE_POST_COL_OFFSET 22
-#define IS_USED_OFFSET 21
 #define BC_SCHEME_OFFSET 18
 #define DIRECTION_OFFSET 13
 #define GEOMETRY_OFFSET 12
@@ -25,13 +25,13 @@
 #define RHO_IDX_OFFSET 0
 
 // USED DEFINE
-#define IS_USED (0b1 << IS_USED_OFFSET)
+#define IS_USED (0b1u << IS_USED_OFFSET)
 
 // SAVE POST COLLISION DEFINE
 #define SAVE_POST_COL (0b1 << SAVE_POST_COL_OFFSET)
 
 // BC SCHEME DEFINES (define only if they are compiled)
-#define BC_SCHEME_BITS (0b111 << BC_SCHEME_OFFSET)
+#define BC_SCHEME_BITS (0b1111 << BC_SCHEME_OFFSET)
 #define BC_NULL (0b000)
 
 #if COMP_VEL_ZOU_HE || COMP_ALL_BC
@@ -55,6 +55,16 @@
 
 #define BC_SCHEME_SPECIAL (0b111)
 
+#if COMP_SYMMETRY || COMP_ALL_BC
+#define BC_SCHEME_SYMMETRY (0b1000)
+#endif
+#if COMP_OUTFLOW_CONVECTIVE || COMP_ALL_BC
+#define BC_SCHEME_OUTFLOW_CONVECTIVE (0b1001)
+#endif
+#if COMP_OUTFLOW_NON_REFLECTING || COMP_ALL_BC
+#define BC_SCHEME_OUTFLOW_NON_REFLECTING (0b1010)
+#endif
+
 // DIRECTION DEFINES
 #define DIRECTION_BITS (0b11111 << DIRECTION_OFFSET)
 #define NORTH (0b00000) //y=NY
@@ -107,14 +117,28 @@
 #define UNKNOWN_POP_8 (0b10000000) // [x, y] = ( 1, -1)
 // DIRECTION IS USED TO CHECK IF NODE IS OF THE INSIDE OR OUTSIDE CIRCLE
 
+// SPONGE LAYER DEFINES
+// Nodes without boundary condition (BC_NULL) use the interpolated bounce back
+// special bits for the sponge level (0 for no sponge, SPONGE_LEVEL_MAX for 
+// maximum strength)
+#define SPONGE_OFFSET SPC_INTERP_BB_OFFSET
+#define SPONGE_BITS SPC_INTERP_BB_BITS
+#define SPONGE_LEVEL_MAX (0b11111111)
+
+// TILE CLASS DEFINES (classification of tiles of nodes, see gpuBuildTileClass)
+#define TILE_MIXED (0b00)   // nodes must read the map
+#define TILE_BULK (0b01)    // all nodes are used, without BC, post collision 
+                            // saving or sponge
+#define TILE_SOLID (0b10)   // all nodes are not used
+
 /*
 *   Struct for mapping the type of each node using 32-bit variable for 
 *   each node. The struct is organized as:
-*   USED (1b) - SAVE_POST_COL (1b) - BC SCHEME (3b) - DIRECTION (5b) 
-*   - GEOMETRY (1b) - UX_VAL_IDX (3b) - UY_VAL_IDX (3b) - UZ_VAL_IDX (3b) 
-*   - RHO_VAL_IDX (3b) - SPC_INTERP_BB_BITS (8b)
+*   USED (1b) - SPC_INTERP_BB_BITS (8b) - SAVE_POST_COL (1b) - BC SCHEME (4b) 
+*   - DIRECTION (5b) - GEOMETRY (1b) - UX_VAL_IDX (3b) - UY_VAL_IDX (3b) 
+*   - UZ_VAL_IDX (3b) - RHO_VAL_IDX (3b)
 *
-*   With SPC_INTERP_BB_BITS being the MSB and RHO_VAL_IDX[0] the LSB. 
+*   With USED being the MSB and RHO_VAL_IDX[0] the LSB. 
 *   The bit sets meaning are explained below:
 *
 *   USED: node is used
@@ -129,6 +153,7 @@
 *   RHO_VAL_IDX: index for global array with the rho value for the node
 *   SCP_INTERP_BC_BITS: bits to represent the known populations for the in
 *       the direction bounce back interpolated boundary condition normal 
+*       (for nodes without boundary condition, the sponge layer level)
 *
 */
 typedef struct nodeTypeMap {
@@ -150,9 +175,9 @@ typedef struct nodeTypeMap {
     void setIsUsed(const bool isUsed)
     {
         if (isUsed)
-            map |= (0x1 << IS_USED_OFFSET);
+            map |= IS_USED;
         else
-            map &= ~(0x1 << IS_USED_OFFSET);
+            map &= ~IS_USED;
     }
 
     __device__ __host__
@@ -271,13 +296,34 @@ typedef struct nodeTypeMap {
     __device__ __host__
     char isBCLocal()
     {
-        // if it's not free slip nor special, is local
+        // if it's not free slip, symmetry nor special, is local
         #ifdef BC_SCHEME_FREE_SLIP
-        return !((this->getSchemeBC() == BC_SCHEME_FREE_SLIP) || 
-            (this->getSchemeBC() == BC_SCHEME_SPECIAL));
-        #else
+        if(this->getSchemeBC() == BC_SCHEME_FREE_SLIP)
+            return false;
+        #endif
+        #ifdef BC_SCHEME_SYMMETRY
+        if(this->getSchemeBC() == BC_SCHEME_SYMMETRY)
+            return false;
+        #endif
+        // outflow reads the interior neighbor
+        if(this->isOutflow())
+            return false;
         return !(this->getSchemeBC() == BC_SCHEME_SPECIAL);
+    }
+
+    __device__ __host__
+    bool isOutflow()
+    {
+        // outflow nodes use the previous step values of the outflow buffer
+        #ifdef BC_SCHEME_OUTFLOW_CONVECTIVE
+        if(this->getSchemeBC() == BC_SCHEME_OUTFLOW_CONVECTIVE)
+            return true;
+        #endif
+        #ifdef BC_SCHEME_OUTFLOW_NON_REFLECTING
+        if(this->getSchemeBC() == BC_SCHEME_OUTFLOW_NON_REFLECTING)
+            return true;
         #endif
+        return false;
     }
 
     __device__ __host__
@@ -319,6 +365,40 @@ typedef struct nodeTypeMap {
         return this->getDirection() == SOUTH; 
     }
 
+    __device__ __host__
+    bool isInterpBB()
+    {
+        // interpolated bounce back nodes are applied by its links
+        #ifdef BC_SCHEME_INTERP_BOUNCE_BACK
+        return this->getSchemeBC() == BC_SCHEME_INTERP_BOUNCE_BACK;
+        #else
+        return false;
+        #endif
+    }
+
+    __device__ __host__
+    bool isBulk()
+    {
+        // used node that only collides and streams
+        return this->getIsUsed() && !this->getSavePostCol() 
+            && (this->getSpongeLevel() == 0);
+    }
+
+    __device__ __host__
+    void setSpongeLevel(const unsigned char level)
+    {
+        if (this->getSchemeBC() == BC_NULL)
+            map = (map & ~SPONGE_BITS) | (((uint32_t)level) << SPONGE_OFFSET);
+    }
+
+    __device__ __host__
+    unsigned char getSpongeLevel()
+    {
+        if (this->getSchemeBC() != BC_NULL)
+            return 0;
+        return ((map & SPONGE_BITS) >> SPONGE_OFFSET);
+    }
+
 } NodeTypeMap;
 
 #endif // !__NODE_TYPE_MAP_H
@@ -11,7 +11,9 @@
 
 #include "../var.h"
 #include "../errorDef.h"
+#include "../memArena.h"
 #include "nodeTypeMap.h"
+#include "../mapBCPalette.h"
 #include <cuda.h>
 
 /*
@@ -22,7 +24,12 @@ typedef struct populations
 public:    
     dfloat* pop;            // Populations
     dfloat* popAux;         // Auxiliary populations
-    NodeTypeMap* mapBC;     // Boundary conditions map
+    MapBC mapBC;            // Boundary conditions map (palette indexes 
+                            // with MAP_BC_PALETTE)
+    unsigned char* tileClass; // Class of each tile of nodes (BULK_TILES)
+    unsigned int* tileList; // Bulk and then mixed tiles, sorted by z (BULK_TILES)
+    size_t* tilePlaneFirst; // First tile in tileList of each plane, for bulk 
+                            // and for mixed tiles (BULK_TILES, in host)
 
     /* Constructor */
     __host__
@@ -30,7 +37,14 @@ public:
     {
         this->pop = nullptr;
         this->popAux = nullptr;
+        #if MAP_BC_PALETTE
+        this->mapBC.idx = nullptr;
+        #else
         this->mapBC = nullptr;
+        #endif
+        this->tileClass = nullptr;
+        this->tileList = nullptr;
+        this->tilePlaneFirst = nullptr;
     }
 
     /* Destructor */
@@ -39,25 +53,50 @@ public:
     {
         this->pop = nullptr;
         this->popAux = nullptr;
+        #if MAP_BC_PALETTE
+        this->mapBC.idx = nullptr;
+        #else
         this->mapBC = nullptr;
+        #endif
+        this->tileClass = nullptr;
+        this->tileList = nullptr;
+        this->tilePlaneFirst = nullptr;
     }
 
     /* Allocate populations */
     __host__
     void popAllocation()
     {
-        checkCudaErrors(cudaMallocManaged((void**)&(this->pop), MEM_SIZE_POP));
-        checkCudaErrors(cudaMallocManaged((void**)&(this->popAux), MEM_SIZE_POP));
-        checkCudaErrors(cudaMalloc((void**)&(this->mapBC), MEM_SIZE_MAP_BC));
+        this->pop = (dfloat*)simMalloc(MEM_SIZE_POP, IN_VIRTUAL);
+        this->popAux = (dfloat*)simMalloc(MEM_SIZE_POP, IN_VIRTUAL);
+        #if MAP_BC_PALETTE
+        this->mapBC.idx = (unsigned char*)simMalloc(MEM_SIZE_MAP_BC, IN_VIRTUAL);
+        #else
+        this->mapBC = (NodeTypeMap*)simMalloc(MEM_SIZE_MAP_BC, IN_VIRTUAL);
+        #endif
+        #if BULK_TILES
+        this->tileClass = (unsigned char*)simMalloc(MEM_SIZE_TILE_CLASS, IN_VIRTUAL);
+        this->tileList = (unsigned int*)simMalloc(MEM_SIZE_TILE_LIST, IN_VIRTUAL);
+        this->tilePlaneFirst = (size_t*)simMalloc(MEM_SIZE_TILE_PLANES, IN_HOST);
+        #endif
     }
 
     /* Free populations */
     __host__
     void popFree()
     {
-        checkCudaErrors(cudaFree(this->pop));
-        checkCudaErrors(cudaFree(this->popAux));
-        checkCudaErrors(cudaFree(this->mapBC));
+        simFree(this->pop, IN_VIRTUAL);
+        simFree(this->popAux, IN_VIRTUAL);
+        #if MAP_BC_PALETTE
+        simFree(this->mapBC.idx, IN_VIRTUAL);
+        #else
+        simFree(this->mapBC, IN_VIRTUAL);
+        #endif
+        #if BULK_TILES
+        simFree(this->tileClass, IN_VIRTUAL);
+        simFree(this->tileList, IN_VIRTUAL);
+        simFree(this->tilePlaneFirst, IN_HOST);
+        #endif
     }
 
     /* Swap populations pointers */
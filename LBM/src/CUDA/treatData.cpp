@@ -25,54 +25,51 @@
 void treatData(MacrProc* processing)
 {
     /* DATA TREATMENT EXAMPLE */
-    dfloat denRes = 1.0, numRes = 0.0; // denominator and numerator for residual
     Macroscopics* macrCurr = processing->macrCurr; 
-    Macroscopics* macrOld = processing->macrOld; 
+    dfloat sums[MACR_PROC_N_SUMS] = {0};
 
-    processing->avgRho = 0;
-
-    for(int z = 0; z < NZ_TOTAL; z++)
+    // Partitions of the GPUs of the process (all of them without MPI_BACKEND)
+    for(int i = gpuBegin(); i < gpuEnd(); i++)
     {
-        for(int y = 0; y < NY; y++)
+        const int x0 = decompOrigin(i, 0);
+        const int y0 = decompOrigin(i, 1);
+        const int z0 = decompOrigin(i, 2);
+
+        #pragma omp parallel for reduction(+:sums[:MACR_PROC_N_SUMS])
+        for(int z = z0; z < z0+decompNZ(i); z++)
         {
-            for(int x = 0; x < NX; x++)
+            for(int y = y0; y < y0+NY; y++)
             {
-                size_t idx = idxScalar(x, y, z);
-                /* ------- Residual calculation ------- */
-                const dfloat rhoVar = macrCurr->rho[idx];
-                const dfloat diff_ux = macrCurr->u.x[idx];
-                const dfloat diff_uy = macrCurr->u.y[idx];
-                const dfloat diff_uz = macrCurr->u.z[idx];
-
-                numRes += rhoVar*(diff_ux * diff_ux + diff_uy * diff_uy + diff_uz * diff_uz);
-                /* ------------------------------------ */
-
-                /* ------- Avg. rho calculation ------- */
-                processing->avgRho += macrCurr->rho[idx];
-                // printf("%d %d %d %f\n", x, y, z, macrCurr->rho[idx]);
-                /* ------------------------------------ */
-                
-                /* ----- Avg. Uz plan calculation ----- */
-                processing->avgUzPlanXZ[y] += macrCurr->u.z[idx];
-                /* ------------------------------------ */
+                for(int x = x0; x < x0+NX; x++)
+                {
+                    size_t idx = idxScalarGlobal(x, y, z);
+                    treatDataNodeSums(macrCurr->rho[idx], macrCurr->u.x[idx], 
+                        macrCurr->u.y[idx], macrCurr->u.z[idx], &sums[MACR_PROC_SUM_RES], 
+                        &sums[MACR_PROC_SUM_RHO], &sums[MACR_PROC_SUM_UZ_XZ+y]);
+                }
             }
         }
     }
+    // Sums of the partitions of the other processes
+    mpiSumAll(sums, MACR_PROC_N_SUMS);
+
+    treatDataFromSums(processing, sums);
+}
 
+
+void treatDataFromSums(MacrProc* processing, dfloat* sums)
+{
     /* ------- Residual calculation ------- */
-    if(denRes != 0)
-        processing->residual = numRes/(2*N*N*N);
-    else
-        processing->residual = 1;
+    processing->residual = sums[MACR_PROC_SUM_RES]/(2*N*N*N);
     /* ------------------------------------ */
 
     /* ------- Avg. rho calculation ------- */
-    processing->avgRho /= TOTAL_NUMBER_LBM_NODES;
+    processing->avgRho = sums[MACR_PROC_SUM_RHO]/TOTAL_NUMBER_LBM_NODES;
     /* ------------------------------------ */
 
     /* ----- Avg. Uz plan calculation ----- */
-    for(int y = 0; y < NY; y++)
-        processing->avgUzPlanXZ[y] /= (NX*NZ_TOTAL);
+    for(int y = 0; y < NY_TOTAL; y++)
+        processing->avgUzPlanXZ[y] = sums[MACR_PROC_SUM_UZ_XZ+y]/(NX_TOTAL*NZ_TOTAL);
     /* ------------------------------------ */
 }
 
@@ -108,7 +105,7 @@ void saveTreatData(MacrProc* processing)
     {
         // write header
         fprintf(fileAvgUz, "y\tavg uz\n");
-        for(int y = 0; y < NY; y++)
+        for(int y = 0; y < NY_TOTAL; y++)
         {
             fprintf(fileAvgUz, "%d\t%.6e\n", y, processing->avgUzPlanXZ[y]);
         }
@@ -11,16 +11,50 @@
 
 #include "structs/macrProc.h"
 #include "lbmReport.h" // for getVarFilename()
+#include "mpiBackend.h"
 #include <cmath>
 
 
 /*
-*   @brief Treat data required by the struct MacrProc
+*   @brief Adds the contribution of one node to the sums used for treated data.
+*          Same code is used by host (OpenMP) and device reductions
+*   @param rho: node's density
+*   @param ux: node's x velocity
+*   @param uy: node's y velocity
+*   @param uz: node's z velocity
+*   @param sumRes: numerator of residual to add to
+*   @param sumRho: sum of density to add to
+*   @param sumUz: sum of uz in node's XZ plan to add to
+*/
+__host__ __device__
+void __forceinline__ treatDataNodeSums(const dfloat rho, const dfloat ux, const dfloat uy,
+    const dfloat uz, dfloat* sumRes, dfloat* sumRho, dfloat* sumUz)
+{
+    /* ------- Residual calculation ------- */
+    *sumRes += rho*(ux*ux + uy*uy + uz*uz);
+    /* ------- Avg. rho calculation ------- */
+    *sumRho += rho;
+    /* ----- Avg. Uz plan calculation ----- */
+    *sumUz += uz;
+}
+
+
+/*
+*   @brief Treat data required by the struct MacrProc, reducing in host with 
+*          OpenMP the values in processing->macrCurr
 *   @param processing: struct to be updated with treated values
 */
 void treatData(MacrProc* processing);
 
 
+/*
+*   @brief Update treated values from the sums of the whole domain
+*   @param processing: struct to be updated with treated values
+*   @param sums[MACR_PROC_N_SUMS]: sums of the whole domain
+*/
+void treatDataFromSums(MacrProc* processing, dfloat* sums);
+
+
 /*
 *   @brief Stop simulation by conditions of treated data
 *   @param processing: struct with treated data
@@ -0,0 +1,99 @@
+/*
+*   LBM-CERNN
+*   Copyright (C) 2018-2019 Waine Barbosa de Oliveira Junior
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License along
+*   with this program; if not, write to the Free Software Foundation, Inc.,
+*   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*   Contact: cernn-ct@utfpr.edu.br and waine@alunos.utfpr.edu.br
+*/
+
+#include "treatDataGPU.h"
+
+
+__global__
+void gpuTreatDataReduction(Macroscopics macr, dfloat* sums, const int gpuNumber)
+{
+    __shared__ dfloat sRes[N_THREADS];
+    __shared__ dfloat sRho[N_THREADS];
+    __shared__ dfloat sUz[N_THREADS];
+
+    const unsigned int tid = threadIdx.x;
+    const unsigned int x = threadIdx.x + blockDim.x * blockIdx.x;
+    const unsigned int y = threadIdx.y + blockDim.y * blockIdx.y;
+    const unsigned int z = threadIdx.z + blockDim.z * blockIdx.z;
+
+    // All threads must reach the barriers, so nodes out of domain just add 0
+    sRes[tid] = 0;
+    sRho[tid] = 0;
+    sUz[tid] = 0;
+    if (x < NX && y < NY && z < decompLocalNZ())
+    {
+        const size_t idx = idxScalarWBorder(x, y, z);
+        treatDataNodeSums(macr.rho[idx], macr.u.x[idx], macr.u.y[idx], macr.u.z[idx],
+            &sRes[tid], &sRho[tid], &sUz[tid]);
+    }
+    __syncthreads();
+
+    // Tree reduction in shared memory with sequential addressing, so the
+    // active threads are contiguous. N_THREADS may not be a power of 2, so
+    // it starts from the largest power of 2 below it
+    unsigned int sFirst = 1;
+    while(2*sFirst < blockDim.x)
+        sFirst *= 2;
+    for(unsigned int s = sFirst; s > 0; s >>= 1)
+    {
+        if(tid < s && tid + s < blockDim.x)
+        {
+            sRes[tid] += sRes[tid+s];
+            sRho[tid] += sRho[tid+s];
+            sUz[tid] += sUz[tid+s];
+        }
+        __syncthreads();
+    }
+
+    if(tid == 0 && y < NY)
+    {
+        atomicAdd(&sums[MACR_PROC_SUM_RES], sRes[0]);
+        atomicAdd(&sums[MACR_PROC_SUM_RHO], sRho[0]);
+        atomicAdd(&sums[MACR_PROC_SUM_UZ_XZ+y+decompOrigin(gpuNumber, 1)], sUz[0]);
+    }
+}
+
+
+__host__
+void treatDataGPU(MacrProc* processing, Macroscopics* macr, dim3 grid, dim3 threads)
+{
+    // Run reductions in all GPUs concurrently
+    for(int i = gpuBegin(); i < gpuEnd(); i++)
+    {
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaMemset(processing->sumsGPU[i], 0, MEM_SIZE_MACR_PROC_SUMS));
+        gpuTreatDataReduction<<<grid, threads>>>(macr[i], processing->sumsGPU[i], i);
+        getLastCudaError("Treat data reduction error");
+    }
+
+    dfloat sums[MACR_PROC_N_SUMS] = {0};
+    for(int i = gpuBegin(); i < gpuEnd(); i++)
+    {
+        checkCudaErrors(cudaSetDevice(GPUS_TO_USE[i]));
+        checkCudaErrors(cudaDeviceSynchronize());
+        for(int j = 0; j < MACR_PROC_N_SUMS; j++)
+            sums[j] += processing->sumsGPU[i][j];
+    }
+    // Sums of the GPUs of the other processes
+    mpiSumAll(sums, MACR_PROC_N_SUMS);
+
+    treatDataFromSums(processing, sums);
+}
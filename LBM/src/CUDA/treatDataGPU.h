@@ -0,0 +1,43 @@
+/*
+*   @file treatDataGPU.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Data/macroscopics treatment with reductions in GPU
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __TREAT_DATA_GPU_H
+#define __TREAT_DATA_GPU_H
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "treatData.h"
+#include "errorDef.h"
+
+
+/*
+*   @brief Reduces the macroscopics of one GPU into the sums required for 
+*          treated data. Each block must be one row of x (same y and z), as 
+*          the grid used for LBM
+*   @param macr: macroscopics of the GPU
+*   @param sums[MACR_PROC_N_SUMS]: sums to add the GPU values to (must be 
+*                                  zeroed before)
+*   @param gpuNumber: GPU number, for the planes in y of the whole domain
+*/
+__global__
+void gpuTreatDataReduction(Macroscopics macr, dfloat* sums, const int gpuNumber);
+
+
+/*
+*   @brief Treat data required by the struct MacrProc, reducing the 
+*          macroscopics in each GPU. Only the sums are transfered to host
+*   @param processing: struct to be updated with treated values
+*   @param macr[N_GPUS]: macroscopics of each GPU
+*   @param grid: grid used for LBM
+*   @param threads: threads used for LBM
+*/
+__host__
+void treatDataGPU(MacrProc* processing, Macroscopics* macr, dim3 grid, dim3 threads);
+
+#endif //!__TREAT_DATA_GPU_H
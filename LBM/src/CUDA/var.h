@@ -54,6 +54,11 @@ constexpr unsigned int SCALE = 1;
  
 #define DATA_STOP false                 // stop condition by treated data
 #define DATA_SAVE false                 // save reported data to file
+#define DATA_REDUCTION_GPU true         // treat reported data with reductions in GPU
+                                        // (only treated values are sent to host)
+#define MACR_SAVE_LAST true             // save macroscopics in last step
+#define MACR_HOST_OLD false             // keep macroscopics of last sync in host 
+                                        // (MacrProc::macrOld, for custom treatments)
 
 // Interval to make checkpoint to save all simulation data and restart from it.
 // It must not be very frequent (10000 or more), because it takes a long time
@@ -76,17 +81,36 @@ constexpr int INI_STEP = 0; // initial simulation step (0 default)
 
 
 /* --------------------------  SIMULATION DEFINES -------------------------- */
-constexpr unsigned int N_GPUS = 1;    // Number of GPUS to use
-constexpr unsigned int GPUS_TO_USE[N_GPUS] = {0};    // Which GPUs to use
+constexpr unsigned int N_GPUS = 1;    // Number of GPUS to use (partitions of the grid)
+// Which GPUs to use, if not given in runtime as "--gpus 0,1" (partitionDevices.h).
+// A GPU may be repeated to run more than one partition in it
+constexpr unsigned int GPUS_TO_USE_DEFAULT[N_GPUS] = {0};
 
 #define MACR_SAVE (0)
 
 constexpr int N = 256 * SCALE;
-constexpr int NX = N;        // size x of the grid 
-                                    // (32 multiple for better performance)
-constexpr int NY = N;        // size y of the grid
-constexpr int NZ = N;        // size z of the grid in one GPU
-constexpr int NZ_TOTAL = NZ;       // size z of the grid
+constexpr int NX_TOTAL = N;        // size x of the grid 
+                                    // (32 multiple in each GPU for better performance)
+constexpr int NY_TOTAL = N;        // size y of the grid
+constexpr int NZ_TOTAL = N;        // size z of the grid
+
+// Partitions of the grid among the GPUs (NX, NY and NZ are the sizes in one 
+// GPU). With DECOMP_AUTO the one with minimum halo area is chosen among z 
+// slabs, pencils and blocks, otherwise DECOMP_MANUAL_P* (product N_GPUS).
+// IBM and the transfers without POP_PACKED_HALO only support z slabs
+#define DECOMP_AUTO true
+constexpr int DECOMP_MANUAL_PX = 1;
+constexpr int DECOMP_MANUAL_PY = 1;
+constexpr int DECOMP_MANUAL_PZ = N_GPUS;
+// Z slabs with thickness balanced by the work of their planes, counted from
+// the built boundary conditions map. Each GPU allocates NZ planes, 
+// DECOMP_BALANCE_EXTRA % more than the uniform slabs, and uses the ones of
+// its slab. Requires POP_PACKED_HALO, not with IBM or POP_HALO_LAYOUT
+#define DECOMP_Z_BALANCE false
+constexpr int DECOMP_BALANCE_EXTRA = 25;
+constexpr int DECOMP_BALANCE_WORK_SOLID = 1;    // work of node not used
+constexpr int DECOMP_BALANCE_WORK_FLUID = 4;    // work of node without BC
+constexpr int DECOMP_BALANCE_WORK_BC = 12;      // work of node with BC
 
 constexpr dfloat U_MAX = 16.0/(125.0*3.141592);  
 constexpr dfloat RE = 1600.0;	
@@ -123,12 +147,101 @@ constexpr dfloat RESID_MAX = 1e-5;      // maximal residual
 /* ------------------------------------------------------------------------- */
 
 
+/* -------------------------- SPONGE LAYER DEFINES ------------------------- */
+// Absorbing layer in the outer shell of the domain. Its nodes relax towards
+// the target equilibrium (SPONGE_RHO, SPONGE_UX, SPONGE_UY, SPONGE_UZ), with
+// strength ramped from 0 in the inner side to SPONGE_SIGMA_MAX at the face.
+// Only nodes without boundary condition are part of the sponge
+#define SPONGE_LAYER false
+// Thickness of the sponge in each face, in nodes (0 for no sponge in face)
+constexpr int SPONGE_WIDTH_W = 0;   // x=0
+constexpr int SPONGE_WIDTH_E = 0;   // x=NX-1
+constexpr int SPONGE_WIDTH_S = 0;   // y=0
+constexpr int SPONGE_WIDTH_N = 0;   // y=NY-1
+constexpr int SPONGE_WIDTH_B = 0;   // z=0
+constexpr int SPONGE_WIDTH_F = 0;   // z=NZ_TOTAL-1
+constexpr dfloat SPONGE_SIGMA_MAX = 0.5; // maximum relaxation towards target (0 to 1)
+constexpr dfloat SPONGE_RHO = RHO_0;    // target density
+constexpr dfloat SPONGE_UX = 0;         // target velocity in x
+constexpr dfloat SPONGE_UY = 0;         // target velocity in y
+constexpr dfloat SPONGE_UZ = 0;         // target velocity in z
+/* ------------------------------------------------------------------------- */
+
+/* ---------------------------- GEOMETRY DEFINES --------------------------- */
+// Solid geometry from triangle mesh (STL or OBJ), voxelized over the boundary
+// conditions map after the builders. Fluid nodes next to the mesh are set as
+// interpolated bounce back, with wall distances from the mesh. The wall 
+// distances are evaluated once in setup
+#define GEOMETRY_MESH false
+#define GEOMETRY_MESH_FILE "geometry.stl"
+// Mesh coordinates in lattice units, p_lattice = p_mesh*SCALE + OFFSET
+constexpr dfloat GEOMETRY_MESH_SCALE = 1;
+constexpr dfloat GEOMETRY_MESH_OFFSET_X = 0;
+constexpr dfloat GEOMETRY_MESH_OFFSET_Y = 0;
+constexpr dfloat GEOMETRY_MESH_OFFSET_Z = 0;
+// Wall distances of interpolated bounce back nodes from the signed distance
+// function of the builder (builderSignedDistance), instead of mesh
+#define GEOMETRY_SDF false
+// Cache of the built geometry (boundary conditions map and indexes, IBM 
+// particles and Euler nodes) in a file in PATH_FILES, named by the hash of
+// the configuration. Builders and particles creation are code, so change 
+// GEOMETRY_CACHE_TAG (or delete the file) when they are modified
+#define GEOMETRY_CACHE false
+#define GEOMETRY_CACHE_TAG "001"
+/* ------------------------------------------------------------------------- */
+
 /* ------------------------------ GPU DEFINES ------------------------------ */
-const int N_THREADS = (NX%64?((NX%32||(NX<32))?NX:32):64); // NX or 32 or 64 
-                                    // multiple of 32 for better performance.
 const int CURAND_SEED = 0;          // seed for random numbers for CUDA
 constexpr float CURAND_STD_DEV = 0.5; // standard deviation for random numbers 
                                     // in normal distribution
+#define POP_HALO_LAYOUT false       // pad populations with one halo node in each side,
+                                    // so streaming has no modulos. Periodic faces are
+                                    // filled afterwards by gpuPopulationsHaloCopy
+#define POP_PACKED_HALO false       // transfer only the populations crossing the GPUs,
+                                    // packed in contiguous buffers, without ghost plane
+                                    // in z (not with POP_HALO_LAYOUT)
+#define HALO_OVERLAP false          // update border planes in z first and transfer them
+                                    // to the adjacent GPUs while the interior planes are
+                                    // updated (not with POP_HALO_LAYOUT)
+#define MPI_BACKEND false           // one MPI process for each GPU (mpirun -np N_GPUS),
+                                    // so the GPUs may be in several nodes. GPUS_TO_USE
+                                    // is the device of each rank in its node (ranks
+                                    // may share a device). Requires
+                                    // POP_PACKED_HALO, not with IBM
+#define MPI_CUDA_AWARE false        // MPI transfers device buffers directly, otherwise
+                                    // they are staged in host
+#define STEP_GRAPH false            // record the step of all GPUs (collision, transfer 
+                                    // and boundary conditions) in CUDA graphs, replayed
+                                    // without synchronizing each step. The transfer of
+                                    // HALO_OVERLAP is not timed. Not with MPI_BACKEND
+                                    // or BC_GROUPS_TIMING
+#define BULK_TILES false            // classify tiles of nodes (one for each block of 
+                                    // gpuMacrCollisionStream) as bulk, mixed or solid.
+                                    // Bulk tiles do not read the boundary conditions map,
+                                    // each class runs its own kernel
+#define MAP_BC_PALETTE false        // store boundary conditions map as 8 bits indexes of
+                                    // a palette of node types in constant memory
+constexpr int MAP_BC_PALETTE_SIZE = 256; // maximum number of node types in palette
+#define BC_GROUPS false             // apply boundary conditions nodes in groups with same
+                                    // scheme, direction and geometry (one kernel each)
+#define BC_GROUPS_TIMING false      // time each group of boundary conditions nodes
+#define BC_POST_COL_BUFFER false    // save post collision populations of boundary 
+                                    // conditions nodes in a compact buffer, not in pop
+#define BC_INFO_DEVICE false        // build boundary conditions info in device (stream
+                                    // compaction), otherwise in host (OpenMP)
+// full boundary conditions map is copied to host in setup (host info and 
+// signed distance function walls are evaluated in host)
+#define MAP_BC_IN_HOST (!BC_INFO_DEVICE || GEOMETRY_SDF)
+/* ------------------------------------------------------------------------- */
+
+/* ----------------------------- MEMORY DEFINES ---------------------------- */
+#define MEM_ARENA false             // carve arrays from one region for each GPU and host
+#define MEM_ARENA_ALIGNMENT (256)   // alignment of arrays, in bytes (128 for cache
+                                    // line, 4096 for page). Host arrays are page aligned
+#define MEM_ARENA_HUGE_PAGES (1)    // host arena pages: 0 for normal, 1 for transparent
+                                    // huge pages, 2 for explicit huge pages (hugetlbfs)
+#define MEM_ARENA_EXTRA_MB (64)     // extra memory for arrays sized in runtime (boundary
+                                    // conditions indexes, IBM nodes, etc.)
 /* ------------------------------------------------------------------------- */
 
 /* -------------------- BOUNDARY CONDITIONS TO COMPILE --------------------- */
@@ -139,6 +252,13 @@ constexpr float CURAND_STD_DEV = 0.5; // standard deviation for random numbers
 #define COMP_VEL_ZOU_HE false           // Compile velocity zou he
 #define COMP_VEL_BOUNCE_BACK false      // Compile velocityr bounce back
 #define COMP_INTERP_BOUNCE_BACK false   // Compile interpolated bounce back
+#define COMP_SYMMETRY false             // Compile symmetry (specular reflection)
+#define COMP_OUTFLOW_CONVECTIVE false   // Compile convective outflow
+#define COMP_OUTFLOW_NON_REFLECTING false // Compile non reflecting (characteristic) outflow
+
+// Relaxation of non reflecting outflow density towards its target (RHO_BC), 
+// per step. 0 is perfectly non reflecting, but the mean density may drift
+constexpr dfloat OUTFLOW_NR_SIGMA = 0.005;
 /* ------------------------------------------------------------------------- */
 
 /* ------------------------------------------------------------------------- */
@@ -154,6 +274,37 @@ constexpr float CURAND_STD_DEV = 0.5; // standard deviation for random numbers
 #include "velocitySets/D3Q27.h"
 #endif // !D3Q27
 
+/* -------------------------- DOMAIN DECOMPOSITION ------------------------- */
+#include "decomposition.h"
+#if defined(IBM) || !POP_PACKED_HALO || DECOMP_Z_BALANCE
+#define DECOMP_SLABS_ONLY true
+#else
+#define DECOMP_SLABS_ONLY false
+#endif
+#if DECOMP_AUTO
+constexpr int DECOMP_PX = decompSelect(0, N_GPUS, NX_TOTAL, NY_TOTAL, NZ_TOTAL, DECOMP_SLABS_ONLY);
+constexpr int DECOMP_PY = decompSelect(1, N_GPUS, NX_TOTAL, NY_TOTAL, NZ_TOTAL, DECOMP_SLABS_ONLY);
+constexpr int DECOMP_PZ = decompSelect(2, N_GPUS, NX_TOTAL, NY_TOTAL, NZ_TOTAL, DECOMP_SLABS_ONLY);
+#else
+constexpr int DECOMP_PX = DECOMP_MANUAL_PX;
+constexpr int DECOMP_PY = DECOMP_MANUAL_PY;
+constexpr int DECOMP_PZ = DECOMP_MANUAL_PZ;
+#endif
+static_assert(decompIsValid(DECOMP_PX, DECOMP_PY, DECOMP_PZ, N_GPUS, NX_TOTAL, NY_TOTAL, 
+    NZ_TOTAL, DECOMP_SLABS_ONLY), "Partitions of the grid among the GPUs are not valid");
+// z slabs, the GPUs only share faces in z
+constexpr bool DECOMP_Z_SLABS = (DECOMP_PX == 1 && DECOMP_PY == 1);
+
+constexpr int NX = NX_TOTAL/DECOMP_PX;  // size x of the grid in one GPU
+constexpr int NY = NY_TOTAL/DECOMP_PY;  // size y of the grid in one GPU
+// size z of the grid in one GPU (maximum of the slabs with DECOMP_Z_BALANCE)
+constexpr int NZ = DECOMP_Z_BALANCE ? decompBalanceNZ(NZ_TOTAL, DECOMP_PZ, 
+    DECOMP_BALANCE_EXTRA) : NZ_TOTAL/DECOMP_PZ;
+
+const int N_THREADS = (NX%64?((NX%32||(NX<32))?NX:32):64); // NX or 32 or 64 
+                                    // multiple of 32 for better performance.
+/* ------------------------------------------------------------------------- */
+
 // Pow function to use
 #ifdef SINGLE_PRECISION
     #define POW_FUNCTION powf 
@@ -176,14 +327,69 @@ constexpr size_t BYTES_PER_MB = (1<<20);
 const size_t NUMBER_LBM_NODES = NX*NY*NZ;
 // There are ghosts nodes in z for IBM macroscopics (velocity, density, force)
 #define NUMBER_LBM_IB_MACR_NODES (size_t)(NX*NY*(NZ+MACR_BORDER_NODES*2))
-// There is 1 ghost node in z for communication multi-gpu
-const size_t NUMBER_LBM_POP_NODES = NX*NY*(NZ+1);
+// There is 1 ghost node in z for communication multi-gpu, unless the 
+// populations are transfered in packed buffers. With halo layout there is 
+// also 1 halo node in each side of x and y and one more ghost in z
+#if POP_HALO_LAYOUT
+#define POP_HALO 1
+#else
+#define POP_HALO 0
+#endif
+#if POP_PACKED_HALO
+#define POP_GHOST 0
+#else
+#define POP_GHOST 1
+#endif
+constexpr int NX_POP = NX+2*POP_HALO;
+constexpr int NY_POP = NY+2*POP_HALO;
+constexpr int NZ_POP = NZ+POP_GHOST+POP_HALO;
+const size_t NUMBER_LBM_POP_NODES = (size_t)NX_POP*NY_POP*NZ_POP;
 const size_t MEM_SIZE_POP = sizeof(dfloat) * NUMBER_LBM_POP_NODES * Q;
 const size_t MEM_SIZE_SCALAR = sizeof(dfloat) * NUMBER_LBM_NODES;
 #define MEM_SIZE_IBM_SCALAR (size_t)(sizeof(dfloat) * NUMBER_LBM_IB_MACR_NODES)
+// Packed IBM border planes of one side (velocities and forces)
+#define MEM_SIZE_IBM_BORDER_BUFFER (size_t)(sizeof(dfloat) * 6 * NX * NY * MACR_BORDER_NODES)
+#if MAP_BC_PALETTE
+const size_t MEM_SIZE_MAP_BC = sizeof(unsigned char) * NUMBER_LBM_NODES;
+#else
 const size_t MEM_SIZE_MAP_BC = sizeof(uint32_t) * NUMBER_LBM_NODES;
+#endif
+// Full boundary conditions map, as built by gpuBuildBoundaryConditions
+const size_t MEM_SIZE_MAP_BC_FULL = sizeof(uint32_t) * NUMBER_LBM_NODES;
+// Tiles of N_THREADS nodes in x, one for each block of gpuMacrCollisionStream
+constexpr int N_TILES_X = (NX+N_THREADS-1)/N_THREADS;
+const size_t NUMBER_TILES = (size_t)N_TILES_X*NY*NZ;
+#if BULK_TILES
+const size_t MEM_SIZE_TILE_CLASS = sizeof(unsigned char) * NUMBER_TILES;
+const size_t MEM_SIZE_TILE_LIST = sizeof(unsigned int) * NUMBER_TILES;
+// First tile of each plane (and end), for bulk and for mixed tiles
+const size_t MEM_SIZE_TILE_PLANES = sizeof(size_t) * 2 * (NZ+1);
+#else
+const size_t MEM_SIZE_TILE_CLASS = 0;
+const size_t MEM_SIZE_TILE_LIST = 0;
+const size_t MEM_SIZE_TILE_PLANES = 0;
+#endif
+// Buffers of populations crossing to other GPUs, to send or to receive. 
+// Q_FACE populations cross each face shared with other GPUs (edges and 
+// corners are part of the faces, so it is exact for z slabs)
+#if POP_PACKED_HALO
+const size_t MEM_SIZE_HALO_BUFFER = sizeof(dfloat) * Q_FACE * 2 * 
+    ((DECOMP_PX > 1 ? (size_t)NY*NZ : 0) + (DECOMP_PY > 1 ? (size_t)NX*NZ : 0) 
+    + (DECOMP_PZ > 1 ? (size_t)NX*NY : 0));
+#else
+const size_t MEM_SIZE_HALO_BUFFER = 0;
+#endif
+// Slots of the nodes in buffer of post collision populations, for each row
+// of 32 nodes in x the mask of nodes with slot and the slot of the first one
+constexpr int POST_COL_ROWS_X = (NX+31)/32;
+const size_t NUMBER_POST_COL_ROWS = (size_t)POST_COL_ROWS_X*NY*NZ;
+#if BC_POST_COL_BUFFER
+const size_t MEM_SIZE_POST_COL_SLOT = 2 * sizeof(unsigned int) * NUMBER_POST_COL_ROWS;
+#else
+const size_t MEM_SIZE_POST_COL_SLOT = 0;
+#endif
 // Values for all GPUs
-const size_t TOTAL_NUMBER_LBM_NODES = NX*NY*NZ_TOTAL;
+const size_t TOTAL_NUMBER_LBM_NODES = (size_t)NX_TOTAL*NY_TOTAL*NZ_TOTAL;
 #define TOTAL_NUMBER_LBM_IB_MACR_NODES (size_t)(NUMBER_LBM_IB_MACR_NODES * N_GPUS)
 const size_t TOTAL_NUMBER_LBM_POP_NODES = NUMBER_LBM_POP_NODES * N_GPUS;
 const size_t TOTAL_MEM_SIZE_POP = MEM_SIZE_POP * N_GPUS;
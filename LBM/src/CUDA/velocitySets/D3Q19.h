@@ -29,6 +29,7 @@
 */
 
 constexpr unsigned char Q = 19;        // number of velocities
+constexpr unsigned char Q_FACE = 5;    // number of velocities crossing a face
 constexpr dfloat W0 = 1.0 / 3;         // population 0 weight (0, 0, 0)
 constexpr dfloat W1 = 1.0 / 18;        // adjacent populations (1, 0, 0)
 constexpr dfloat W2 = 1.0 / 36;        // diagonal populations (1, 1, 0)
@@ -44,4 +45,35 @@ __device__ const char cx[Q] = { 0, 1,-1, 0, 0, 0, 0, 1,-1, 1,-1, 0, 0, 1,-1, 1,-
 __device__ const char cy[Q] = { 0, 0, 0, 1,-1, 0, 0, 1,-1, 0, 0, 1,-1,-1, 1, 0, 0, 1,-1 };
 __device__ const char cz[Q] = { 0, 0, 0, 0, 0, 1,-1, 0, 0, 1,-1, 1,-1, 0, 0,-1, 1,-1, 1 };
 
+// populations velocities and weights for compile time evaluation, 
+// accessible by host and device (see velocitySetUnroll.h)
+__host__ __device__
+constexpr int velCx(const int i)
+{
+    constexpr char c[Q] = { 0, 1,-1, 0, 0, 0, 0, 1,-1, 1,-1, 0, 0, 1,-1, 1,-1, 0, 0 };
+    return c[i];
+}
+
+__host__ __device__
+constexpr int velCy(const int i)
+{
+    constexpr char c[Q] = { 0, 0, 0, 1,-1, 0, 0, 1,-1, 0, 0, 1,-1,-1, 1, 0, 0, 1,-1 };
+    return c[i];
+}
+
+__host__ __device__
+constexpr int velCz(const int i)
+{
+    constexpr char c[Q] = { 0, 0, 0, 0, 0, 1,-1, 0, 0, 1,-1, 1,-1, 0, 0,-1, 1,-1, 1 };
+    return c[i];
+}
+
+__host__ __device__
+constexpr dfloat velW(const int i)
+{
+    // weight depends only on the number of non zero components
+    const int dist = (velCx(i) != 0) + (velCy(i) != 0) + (velCz(i) != 0);
+    return (dist == 0) ? W0 : ((dist == 1) ? W1 : W2);
+}
+
 #endif // !__D3Q19_H
\ No newline at end of file
@@ -37,6 +37,7 @@
 */
 
 constexpr unsigned char Q = 27;         // number of velocities
+constexpr unsigned char Q_FACE = 9;     // number of velocities crossing a face
 constexpr dfloat W0 = 8.0 / 27;        // weight dist 0 population (0, 0, 0)
 constexpr dfloat W1 = 2.0 / 27;        // weight dist 1 populations (1, 0, 0)
 constexpr dfloat W2 = 1.0 / 54;        // weight dist 2 populations (1, 1, 0)
@@ -54,5 +55,36 @@ __device__ const char cx[Q] = { 0, 1,-1, 0, 0, 0, 0, 1,-1, 1,-1, 0, 0, 1,-1, 1,-
 __device__ const char cy[Q] = { 0, 0, 0, 1,-1, 0, 0, 1,-1, 0, 0, 1,-1,-1, 1, 0, 0, 1,-1, 1,-1, 1,-1,-1, 1, 1,-1};
 __device__ const char cz[Q] = { 0, 0, 0, 0, 0, 1,-1, 0, 0, 1,-1, 1,-1, 0, 0,-1, 1,-1, 1, 1,-1,-1, 1, 1,-1, 1,-1};
 
+// populations velocities and weights for compile time evaluation, 
+// accessible by host and device (see velocitySetUnroll.h)
+__host__ __device__
+constexpr int velCx(const int i)
+{
+    constexpr char c[Q] = { 0, 1,-1, 0, 0, 0, 0, 1,-1, 1,-1, 0, 0, 1,-1, 1,-1, 0, 0, 1,-1, 1,-1, 1,-1,-1, 1};
+    return c[i];
+}
+
+__host__ __device__
+constexpr int velCy(const int i)
+{
+    constexpr char c[Q] = { 0, 0, 0, 1,-1, 0, 0, 1,-1, 0, 0, 1,-1,-1, 1, 0, 0, 1,-1, 1,-1, 1,-1,-1, 1, 1,-1};
+    return c[i];
+}
+
+__host__ __device__
+constexpr int velCz(const int i)
+{
+    constexpr char c[Q] = { 0, 0, 0, 0, 0, 1,-1, 0, 0, 1,-1, 1,-1, 0, 0,-1, 1,-1, 1, 1,-1,-1, 1, 1,-1, 1,-1};
+    return c[i];
+}
+
+__host__ __device__
+constexpr dfloat velW(const int i)
+{
+    // weight depends only on the number of non zero components
+    const int dist = (velCx(i) != 0) + (velCy(i) != 0) + (velCz(i) != 0);
+    return (dist == 0) ? W0 : ((dist == 1) ? W1 : ((dist == 2) ? W2 : W3));
+}
+
 
 #endif // !__D3Q27_H
\ No newline at end of file
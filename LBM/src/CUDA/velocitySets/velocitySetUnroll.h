@@ -0,0 +1,400 @@
+/*
+*   @file velocitySetUnroll.h
+*   @author Waine Jr. (waine@alunos.utfpr.edu.br)
+*   @brief Per population operations unrolled in compile time from the
+*          velocity set description (velCx, velCy, velCz and velW), so any
+*          velocity set gets the unrolled code without hand edits.
+*          Components equal to zero are not evaluated and opposite
+*          populations share the same expressions, with opposite signs
+*   @version 0.3.0
+*   @date 16/12/2019
+*/
+
+#ifndef __VELOCITY_SET_UNROLL_H
+#define __VELOCITY_SET_UNROLL_H
+
+#include "../var.h"
+#include "../globalFunctions.h"
+
+
+/*
+*   @brief Sign of the first non zero component of population velocity.
+*          Opposite populations have opposite signs
+*   @param i: population number
+*   @return 1, -1 or 0 (population 0)
+*/
+__host__ __device__
+constexpr int velSign(const int i)
+{
+    return (velCx(i) != 0) ? velCx(i) : ((velCy(i) != 0) ? velCy(i) : velCz(i));
+}
+
+
+/*
+*   @brief Opposite population (velocity -c). The velocity sets have opposite
+*          populations in pairs (1, 2), (3, 4), ...
+*   @param i: population number
+*   @return opposite population number
+*/
+__host__ __device__
+constexpr int velOpp(const int i)
+{
+    return (i == 0) ? 0 : ((i % 2) ? i+1 : i-1);
+}
+
+
+/*
+*   @brief Checks if populations from i are opposite to velOpp, in compile time
+*/
+constexpr bool velOppCheck(const int i = 0)
+{
+    return (i >= Q) ? true : 
+        ((velCx(velOpp(i)) == -velCx(i)) && (velCy(velOpp(i)) == -velCy(i))
+        && (velCz(velOpp(i)) == -velCz(i)) && velOppCheck(i+1));
+}
+static_assert(velOppCheck(), "Velocity set populations are not in opposite pairs");
+
+
+/*
+*   @brief Next population with velocity component in direction equal to value
+*   @param dir: direction (0 for x, 1 for y, 2 for z)
+*   @param value: component value
+*   @param i: first population to check
+*   @return population number, Q if there is none
+*/
+__host__ __device__
+constexpr int velNext(const int dir, const int value, const int i)
+{
+    return (i >= Q) ? Q :
+        (((dir == 0 ? velCx(i) : (dir == 1 ? velCy(i) : velCz(i))) == value) ?
+            i : velNext(dir, value, i+1));
+}
+
+
+/*
+*   @brief Number of populations with velocity component in direction equal 
+*          to value
+*   @param dir: direction (0 for x, 1 for y, 2 for z)
+*   @param value: component value
+*   @param i: first population to count
+*   @return number of populations
+*/
+__host__ __device__
+constexpr int velCountDir(const int dir, const int value, const int i = 0)
+{
+    return (i >= Q) ? 0 :
+        (((dir == 0 ? velCx(i) : (dir == 1 ? velCy(i) : velCz(i))) == value) ? 1 : 0)
+            + velCountDir(dir, value, i+1);
+}
+
+
+/*
+*   @brief Component of population velocity in direction
+*   @param dir: direction (0 for x, 1 for y, 2 for z)
+*   @param i: population number
+*   @return velocity component
+*/
+__host__ __device__
+constexpr int velComp(const int dir, const int i)
+{
+    return (dir == 0) ? velCx(i) : ((dir == 1) ? velCy(i) : velCz(i));
+}
+
+
+/*
+*   @brief Next population with velocity components in two directions equal 
+*          to values
+*   @param dir: first direction (0 for x, 1 for y, 2 for z)
+*   @param value: component value in first direction
+*   @param dir2: second direction
+*   @param value2: component value in second direction
+*   @param i: first population to check
+*   @return population number, Q if there is none
+*/
+__host__ __device__
+constexpr int velNextPlane(const int dir, const int value, const int dir2, 
+    const int value2, const int i)
+{
+    return (i >= Q) ? Q :
+        ((velComp(dir, i) == value && velComp(dir2, i) == value2) ?
+            i : velNextPlane(dir, value, dir2, value2, i+1));
+}
+
+
+/*
+*   @brief Population with velocity (vx, vy, vz)
+*   @param vx: velocity component in x
+*   @param vy: velocity component in y
+*   @param vz: velocity component in z
+*   @param i: first population to check
+*   @return population number, Q if there is none
+*/
+__host__ __device__
+constexpr int velFind(const int vx, const int vy, const int vz, const int i = 0)
+{
+    return (i >= Q) ? Q :
+        ((velCx(i) == vx && velCy(i) == vy && velCz(i) == vz) ? 
+            i : velFind(vx, vy, vz, i+1));
+}
+
+
+/*
+*   @brief Selects value according to the velocity component sign, in compile time
+*   @param valueNeg: value for component -1
+*   @param valueZero: value for component 0
+*   @param valuePos: value for component 1
+*/
+template <int C, typename T>
+__host__ __device__ __forceinline__
+T velSelect(const T valueNeg, const T valueZero, const T valuePos)
+{
+    if constexpr (C > 0)
+        return valuePos;
+    else if constexpr (C < 0)
+        return valueNeg;
+    else
+        return valueZero;
+}
+
+
+/*
+*   @brief Dot product between the velocity (cx, cy, cz) and (ax, ay, az),
+*          only with non zero components
+*/
+template <int CX, int CY, int CZ>
+__device__ __forceinline__
+dfloat velDotComp(const dfloat ax, const dfloat ay, const dfloat az)
+{
+    const dfloat tx = (CX > 0) ? ax : -ax;
+    const dfloat ty = (CY > 0) ? ay : -ay;
+    const dfloat tz = (CZ > 0) ? az : -az;
+    if constexpr (CX != 0 && CY != 0 && CZ != 0)
+        return tx + ty + tz;
+    else if constexpr (CX != 0 && CY != 0)
+        return tx + ty;
+    else if constexpr (CX != 0 && CZ != 0)
+        return tx + tz;
+    else if constexpr (CY != 0 && CZ != 0)
+        return ty + tz;
+    else if constexpr (CX != 0)
+        return tx;
+    else if constexpr (CY != 0)
+        return ty;
+    else
+        return tz;
+}
+
+
+/*
+*   @brief Dot product between the population velocity multiplied by its sign
+*          (velSign) and (ax, ay, az). It is the same for opposite populations
+*   @param ax, ay, az: vector to multiply
+*/
+template <int I>
+__device__ __forceinline__
+dfloat velDotShared(const dfloat ax, const dfloat ay, const dfloat az)
+{
+    constexpr int s = velSign(I);
+    return velDotComp<s*velCx(I), s*velCy(I), s*velCz(I)>(ax, ay, az);
+}
+
+
+/*
+*   @brief Sum of populations with velocity component in direction equal to value
+*   @param fNode[Q]: node populations
+*/
+template <int DIR, int VALUE, int I = velNext(DIR, VALUE, 0)>
+__device__ __forceinline__
+dfloat popSumDir(const dfloat* fNode)
+{
+    constexpr int next = velNext(DIR, VALUE, I+1);
+    if constexpr (next >= Q)
+        return fNode[I];
+    else
+        return fNode[I] + popSumDir<DIR, VALUE, next>(fNode);
+}
+
+
+/*
+*   @brief Sum of populations with velocity components in two directions 
+*          equal to values
+*   @param fNode[Q]: node populations
+*/
+template <int DIR, int VALUE, int DIR2, int VALUE2, 
+    int I = velNextPlane(DIR, VALUE, DIR2, VALUE2, 0)>
+__device__ __forceinline__
+dfloat popSumPlane(const dfloat* fNode)
+{
+    constexpr int next = velNextPlane(DIR, VALUE, DIR2, VALUE2, I+1);
+    if constexpr (next >= Q)
+        return fNode[I];
+    else
+        return fNode[I] + popSumPlane<DIR, VALUE, DIR2, VALUE2, next>(fNode);
+}
+
+
+/*
+*   @brief Momentum in direction T of the populations with velocity component
+*          in direction DIR equal to zero, sum(f*cT). Zero if T is DIR
+*   @param fNode[Q]: node populations
+*/
+template <int DIR, int T>
+__device__ __forceinline__
+dfloat popMomentPlane(const dfloat* fNode)
+{
+    if constexpr (T == DIR)
+        return 0;
+    else
+        return popSumPlane<DIR, 0, T, 1>(fNode) - popSumPlane<DIR, 0, T, -1>(fNode);
+}
+
+
+/*
+*   @brief Evaluates node macroscopics from its populations and force
+*   @param fNode[Q]: node populations
+*   @param fxVar, fyVar, fzVar: node force
+*   @param rhoVar, uxVar, uyVar, uzVar: node macroscopics to update
+*/
+__device__ __forceinline__
+void popMacroscopics(const dfloat* fNode, const dfloat fxVar, const dfloat fyVar,
+    const dfloat fzVar, dfloat& rhoVar, dfloat& uxVar, dfloat& uyVar, dfloat& uzVar)
+{
+    // rho = sum(f[i])
+    // ux = (sum(f[i]*cx[i])+0.5*fxVar) / rho
+    // uy = (sum(f[i]*cy[i])+0.5*fyVar) / rho
+    // uz = (sum(f[i]*cz[i])+0.5*fzVar) / rho
+    rhoVar = fNode[0];
+    #pragma unroll
+    for(int i = 1; i < Q; i++)
+        rhoVar += fNode[i];
+    const dfloat invRho = 1/rhoVar;
+    uxVar = (popSumDir<0, 1>(fNode) - popSumDir<0, -1>(fNode) + 0.5*fxVar) * invRho;
+    uyVar = (popSumDir<1, 1>(fNode) - popSumDir<1, -1>(fNode) + 0.5*fyVar) * invRho;
+    uzVar = (popSumDir<2, 1>(fNode) - popSumDir<2, -1>(fNode) + 0.5*fzVar) * invRho;
+}
+
+
+/*
+*   @brief Collision with equilibrium and force term (Guo), for all populations
+*          fNode = T_OMEGA*fNode + OMEGA*fEq + TT_OMEGA*force
+*   @param fNode[Q]: node populations to collide
+*   @param rhoVar: node density
+*   @param ux3, uy3, uz3: node velocity multiplied by 3
+*   @param p1_muu15: 1 - 1.5*(ux^2 + uy^2 + uz^2)
+*   @param fx, fy, fz: force to use in force term
+*/
+template <int I = 0>
+__device__ __forceinline__
+void popCollision(dfloat* fNode, const dfloat rhoVar, const dfloat ux3, const dfloat uy3,
+    const dfloat uz3, const dfloat p1_muu15, const dfloat fx, const dfloat fy, const dfloat fz)
+{
+    // Shared by all populations
+    // -F.u3
+    const dfloat forceU = - fx*ux3 - fy*uy3 - fz*uz3;
+
+    if constexpr (I == 0){
+        fNode[0] = T_OMEGA*fNode[0] + (OMEGA*W0*rhoVar)*p1_muu15 + (W0*TT_OMEGA)*forceU;
+    }
+    else{
+        constexpr int s = velSign(I);
+        // Shared with opposite population
+        const dfloat cu3 = velDotShared<I>(ux3, uy3, uz3);
+        const dfloat cf = velDotShared<I>(fx, fy, fz);
+        const dfloat eqShared = p1_muu15 + 0.5*cu3*cu3;
+        const dfloat forceShared = forceU + 3*cu3*cf;
+        // fEq = w*rho*(1 - 1.5*u^2 + c.u3 + 0.5*(c.u3)^2)
+        // force = w*(3*c.F - F.u3 + 3*(c.u3)*(c.F))
+        const dfloat eq = (s > 0) ? (eqShared + cu3) : (eqShared - cu3);
+        const dfloat force = (s > 0) ? (forceShared + 3*cf) : (forceShared - 3*cf);
+        fNode[I] = T_OMEGA*fNode[I] + (OMEGA*velW(I)*rhoVar)*eq + (velW(I)*TT_OMEGA)*force;
+    }
+
+    if constexpr (I+1 < Q)
+        popCollision<I+1>(fNode, rhoVar, ux3, uy3, uz3, p1_muu15, fx, fy, fz);
+}
+
+
+/*
+*   @brief Streams node populations to its neighbours
+*   @param popAux: populations to stream to
+*   @param fNode[Q]: node populations
+*   @param x, y, z: node coordinates
+*   @param xp1, yp1, zp1: node coordinates plus 1
+*   @param xm1, ym1, zm1: node coordinates minus 1
+*/
+template <int I = 0>
+__device__ __forceinline__
+void popStream(dfloat* popAux, const dfloat* fNode, const int x, const int y, const int z,
+    const int xp1, const int yp1, const int zp1, const int xm1, const int ym1, const int zm1)
+{
+    // popAux(x+cx, y+cy, z+cz, i) = fNode(i)
+    popAux[idxPop(velSelect<velCx(I)>(xm1, x, xp1), velSelect<velCy(I)>(ym1, y, yp1),
+        velSelect<velCz(I)>(zm1, z, zp1), I)] = fNode[I];
+
+    if constexpr (I+1 < Q)
+        popStream<I+1>(popAux, fNode, x, y, z, xp1, yp1, zp1, xm1, ym1, zm1);
+}
+
+
+/*
+*   @brief Unknown populations of Zou-He boundary condition in node of face
+*          with normal SIGN in direction DIR (velocity component -SIGN), from
+*          the opposite ones and the transverse momentum corrections nt
+*          f = fOpp + 6*w*rho*(c.u) - (c.nt)
+*   @param f: populations post streaming to update
+*   @param fNode[Q]: node populations post streaming
+*   @param x, y, z: node coordinates
+*   @param rho: node density
+*   @param ux, uy, uz: node velocity
+*   @param ntx, nty, ntz: transverse momentum corrections (not used in DIR)
+*/
+template <int DIR, int SIGN, int I = 1>
+__device__ __forceinline__
+void popZouHe(dfloat* f, const dfloat* fNode, const int x, const int y, const int z,
+    const dfloat rho, const dfloat ux, const dfloat uy, const dfloat uz,
+    const dfloat ntx, const dfloat nty, const dfloat ntz)
+{
+    if constexpr (velComp(DIR, I) == -SIGN){
+        // Transverse components of velocity
+        constexpr int tx = (DIR == 0) ? 0 : velCx(I);
+        constexpr int ty = (DIR == 1) ? 0 : velCy(I);
+        constexpr int tz = (DIR == 2) ? 0 : velCz(I);
+        const dfloat fOpp = fNode[velOpp(I)] 
+            + (6*velW(I))*rho*velDotComp<velCx(I), velCy(I), velCz(I)>(ux, uy, uz);
+        if constexpr (tx != 0 || ty != 0 || tz != 0)
+            f[idxPop(x, y, z, I)] = fOpp - velDotComp<tx, ty, tz>(ntx, nty, ntz);
+        else
+            f[idxPop(x, y, z, I)] = fOpp;
+    }
+
+    if constexpr (I+1 < Q)
+        popZouHe<DIR, SIGN, I+1>(f, fNode, x, y, z, rho, ux, uy, uz, ntx, nty, ntz);
+}
+
+
+/*
+*   @brief Transfers populations streamed out of GPU (cz != 0) to the adjacent
+*          one, as in gpuPopulationsTransfer
+*   @param popBase: base post streaming populations
+*   @param popNxt: next post streaming populations
+*   @param x, y: node coordinates
+*   @param zMax: z to write populations with cz=-1 in base
+*   @param zRead: z to read populations with cz=1 from base
+*   @param zReadM: z to read populations with cz=-1 from next
+*/
+template <int I = 1>
+__device__ __forceinline__
+void popTransfer(dfloat* popBase, dfloat* popNxt, const int x, const int y,
+    const int zMax, const int zRead, const int zReadM)
+{
+    if constexpr (velCz(I) < 0)
+        popBase[idxPop(x, y, zMax, I)] = popNxt[idxPop(x, y, zReadM, I)];
+    else if constexpr (velCz(I) > 0)
+        popNxt[idxPop(x, y, 0, I)] = popBase[idxPop(x, y, zRead, I)];
+
+    if constexpr (I+1 < Q)
+        popTransfer<I+1>(popBase, popNxt, x, y, zMax, zRead, zReadM);
+}
+
+
+#endif // !__VELOCITY_SET_UNROLL_H
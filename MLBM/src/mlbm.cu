@@ -60,14 +60,14 @@ __global__ void gpuMomCollisionStream(
     pop[18] = multiplyTerm * (pics2 -uy_t30 + uz_t30 + piyy_t45 + pizz_t45 - piyz_t90);   
     #ifdef D3Q27
     multiplyTerm = rhoVar * W3;
-    pop[19] = multiplyTerm * (pics2 + ux_t30 + uyVar_t30 + uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 + pixz_t90 + piyz_t90));
-    pop[20] = multiplyTerm * (pics2 - ux_t30 - uyVar_t30 - uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 + pixz_t90 + piyz_t90));
-    pop[21] = multiplyTerm * (pics2 + ux_t30 + uyVar_t30 - uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 - pixz_t90 - piyz_t90));
-    pop[22] = multiplyTerm * (pics2 - ux_t30 - uyVar_t30 + uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 - pixz_t90 - piyz_t90));
-    pop[23] = multiplyTerm * (pics2 + ux_t30 - uyVar_t30 + uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 - pixz_t90 + piyz_t90));
-    pop[24] = multiplyTerm * (pics2 - ux_t30 + uyVar_t30 - uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 - pixz_t90 + piyz_t90));
-    pop[25] = multiplyTerm * (pics2 - ux_t30 + uyVar_t30 + uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 + pixz_t90 - piyz_t90));
-    pop[26] = multiplyTerm * (pics2 + ux_t30 - uyVar_t30 - uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 + pixz_t90 - piyz_t90));
+    pop[19] = multiplyTerm * (pics2 + ux_t30 + uy_t30 + uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 + pixz_t90 + piyz_t90));
+    pop[20] = multiplyTerm * (pics2 - ux_t30 - uy_t30 - uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 + pixz_t90 + piyz_t90));
+    pop[21] = multiplyTerm * (pics2 + ux_t30 + uy_t30 - uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 - pixz_t90 - piyz_t90));
+    pop[22] = multiplyTerm * (pics2 - ux_t30 - uy_t30 + uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 - pixz_t90 - piyz_t90));
+    pop[23] = multiplyTerm * (pics2 + ux_t30 - uy_t30 + uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 - pixz_t90 + piyz_t90));
+    pop[24] = multiplyTerm * (pics2 - ux_t30 + uy_t30 - uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 - pixz_t90 + piyz_t90));
+    pop[25] = multiplyTerm * (pics2 - ux_t30 + uy_t30 + uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 + pixz_t90 - piyz_t90));
+    pop[26] = multiplyTerm * (pics2 + ux_t30 - uy_t30 - uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 + pixz_t90 - piyz_t90));
     #endif //D3Q27
 
     __shared__ dfloat s_pop[BLOCK_LBM_SIZE * (Q - 1)];
@@ -393,14 +393,14 @@ __global__ void gpuMomCollisionStream(
     pop[18] = multiplyTerm * (pics2 + (-uy_t30 + uz_t30) + (piyy_t45 + pizz_t45) - piyz_t90);   
     #ifdef D3Q27
     multiplyTerm = rhoVar * W3;
-    pop[19] = multiplyTerm * (pics2 + ux_t30 + uyVar_t30 + uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 + pixz_t90 + piyz_t90));
-    pop[20] = multiplyTerm * (pics2 - ux_t30 - uyVar_t30 - uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 + pixz_t90 + piyz_t90));
-    pop[21] = multiplyTerm * (pics2 + ux_t30 + uyVar_t30 - uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 - pixz_t90 - piyz_t90));
-    pop[22] = multiplyTerm * (pics2 - ux_t30 - uyVar_t30 + uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 - pixz_t90 - piyz_t90));
-    pop[23] = multiplyTerm * (pics2 + ux_t30 - uyVar_t30 + uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 - pixz_t90 + piyz_t90));
-    pop[24] = multiplyTerm * (pics2 - ux_t30 + uyVar_t30 - uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 - pixz_t90 + piyz_t90));
-    pop[25] = multiplyTerm * (pics2 - ux_t30 + uyVar_t30 + uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 + pixz_t90 - piyz_t90));
-    pop[26] = multiplyTerm * (pics2 + ux_t30 - uyVar_t30 - uzVar_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 + pixz_t90 - piyz_t90));
+    pop[19] = multiplyTerm * (pics2 + ux_t30 + uy_t30 + uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 + pixz_t90 + piyz_t90));
+    pop[20] = multiplyTerm * (pics2 - ux_t30 - uy_t30 - uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 + pixz_t90 + piyz_t90));
+    pop[21] = multiplyTerm * (pics2 + ux_t30 + uy_t30 - uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 - pixz_t90 - piyz_t90));
+    pop[22] = multiplyTerm * (pics2 - ux_t30 - uy_t30 + uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 + (pixy_t90 - pixz_t90 - piyz_t90));
+    pop[23] = multiplyTerm * (pics2 + ux_t30 - uy_t30 + uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 - pixz_t90 + piyz_t90));
+    pop[24] = multiplyTerm * (pics2 - ux_t30 + uy_t30 - uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 - pixz_t90 + piyz_t90));
+    pop[25] = multiplyTerm * (pics2 - ux_t30 + uy_t30 + uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 + pixz_t90 - piyz_t90));
+    pop[26] = multiplyTerm * (pics2 + ux_t30 - uy_t30 - uz_t30 + pixx_t45 + piyy_t45 + pizz_t45 - (pixy_t90 + pixz_t90 - piyz_t90));
     #endif //D3Q27
     
     /* write to global mom */